@@ -135,7 +135,8 @@ bool
 Parser::parse( const std::string & filepath,
                Handler & handler ) const
 {
-    std::ifstream fin( filepath );
+    // v1-v3 logs are binary data.
+    std::ifstream fin( filepath, std::ios_base::in | std::ios_base::binary );
     if ( ! fin )
     {
         return false;
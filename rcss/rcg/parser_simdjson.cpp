@@ -41,21 +41,148 @@
 
 #include "simdjson/simdjson.h"
 
+#include <algorithm>
+#include <fstream>
 #include <string_view>
 #include <functional>
+#include <vector>
+#include <cstring>
 
 namespace rcss {
 namespace rcg {
 
+namespace {
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief incremental scanner for the elements of the top-level JSON array.
+
+  The scanner remembers the nesting state between calls, so the input can be
+  given block by block. The separators between elements are overwritten by
+  spaces, so that the complete elements can be iterated by simdjson's
+  document stream as a sequence of whitespace separated documents.
+*/
+class ArrayElementScanner {
+private:
+    int M_depth; //!< nesting depth. 0 means outside of the top-level array
+    bool M_started; //!< true if the top-level '[' has been found
+    bool M_finished; //!< true if the top-level ']' has been found
+    bool M_in_string;
+    bool M_escaped;
+
+public:
+
+    ArrayElementScanner()
+        : M_depth( 0 ),
+          M_started( false ),
+          M_finished( false ),
+          M_in_string( false ),
+          M_escaped( false )
+      { }
+
+    bool started() const { return M_started; }
+    bool finished() const { return M_finished; }
+
+    /*!
+      \brief scan [begin, end) in buf.
+      \return the position just after the last complete element.
+      -1 if the input is not a JSON array.
+    */
+    std::ptrdiff_t scan( char * buf,
+                         const std::ptrdiff_t begin,
+                         const std::ptrdiff_t end )
+      {
+          std::ptrdiff_t last_element_end = 0;
+
+          for ( std::ptrdiff_t i = begin; i < end && ! M_finished; ++i )
+          {
+              const char c = buf[i];
+
+              if ( M_in_string )
+              {
+                  if ( M_escaped ) M_escaped = false;
+                  else if ( c == '\\' ) M_escaped = true;
+                  else if ( c == '"' ) M_in_string = false;
+                  continue;
+              }
+
+              if ( ! M_started )
+              {
+                  if ( c == '[' )
+                  {
+                      M_started = true;
+                      M_depth = 1;
+                      buf[i] = ' ';
+                      last_element_end = i + 1;
+                      continue;
+                  }
+
+                  if ( c == ' ' || c == '\t' || c == '\r' || c == '\n' )
+                  {
+                      continue;
+                  }
+
+                  return -1;
+              }
+
+              switch ( c ) {
+              case '"':
+                  M_in_string = true;
+                  break;
+              case '{':
+              case '[':
+                  ++M_depth;
+                  break;
+              case '}':
+              case ']':
+                  --M_depth;
+                  if ( M_depth == 1 )
+                  {
+                      last_element_end = i + 1;
+                  }
+                  else if ( M_depth == 0 )
+                  {
+                      // the end of the top-level array
+                      M_finished = true;
+                      buf[i] = ' ';
+                      last_element_end = i + 1;
+                  }
+                  break;
+              case ',':
+                  if ( M_depth == 1 )
+                  {
+                      buf[i] = ' ';
+                  }
+                  break;
+              default:
+                  break;
+              }
+          }
+
+          return last_element_end;
+      }
+};
+
+}
+
 
 struct ParserSimdJSON::Impl {
 
     using Func = std::function< bool( simdjson::ondemand::value & val, Handler & handler ) >;
-    std::unordered_map< std::string, Func > funcs_;
+    // all keys are string literals
+    std::unordered_map< std::string_view, Func > funcs_;
     //std::unordered_map< simdjson::ondemand::raw_json_string, Func > funcs_;
 
+    //! the parser instance reused for monitor packets
+    simdjson::ondemand::parser packet_parser_;
+
     Impl();
 
+    bool parseElements( simdjson::ondemand::parser & parser,
+                        const char * buf,
+                        const std::size_t len,
+                        Handler & handler );
+
     bool parseData( simdjson::ondemand::field & field,
                     Handler & handler );
 
@@ -136,6 +263,30 @@ ParserSimdJSON::Impl::Impl()
           };
 }
 
+/*-------------------------------------------------------------------*/
+bool
+ParserSimdJSON::Impl::parseElements( simdjson::ondemand::parser & parser,
+                                     const char * buf,
+                                     const std::size_t len,
+                                     Handler & handler )
+{
+    // all elements are given at once. batch_size has to be larger than the largest element.
+    simdjson::ondemand::document_stream stream = parser.iterate_many( buf, len, std::max( len, simdjson::dom::MINIMAL_BATCH_SIZE ) );
+
+    for ( simdjson::ondemand::document_reference doc : stream )
+    {
+        for ( simdjson::ondemand::field field : doc.get_object() )
+        {
+            if ( ! parseData( field, handler ) )
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
 /*-------------------------------------------------------------------*/
 bool
 ParserSimdJSON::Impl::parseData( simdjson::ondemand::field & field,
@@ -146,8 +297,8 @@ ParserSimdJSON::Impl::parseData( simdjson::ondemand::field & field,
     //std::string str_key( key );
     //std::cerr << "(ParserSimdJSON::Impl::parseData) key=" << field.key() << " str=" << str_key << std::endl;
     //std::unordered_map< std::string, Func >::iterator it = funcs_.find( str_key );
-    std::string key( field.key_raw_json_token() );
-    std::unordered_map< std::string, Func >::iterator it = funcs_.find( key );
+    const std::string_view key = field.key_raw_json_token();
+    std::unordered_map< std::string_view, Func >::iterator it = funcs_.find( key );
     if ( it == funcs_.end() )
     {
         std::cerr << "(ParserSimdJSON::Impl::parseData) func not found. key=" << key
@@ -199,8 +350,8 @@ ParserSimdJSON::Impl::parseServerParam( simdjson::ondemand::value & val,
             return false;
         }
 
-        const std::string name( key.substr( 1, key.length() - 2 ) );
-        const std::string value( param.value().raw_json_token() );
+        const std::string_view name = key.substr( 1, key.length() - 2 );
+        const std::string_view value = param.value().raw_json_token();
 
         server_param.setValue( name, value );
     }
@@ -226,8 +377,8 @@ ParserSimdJSON::Impl::parsePlayerParam( simdjson::ondemand::value & val,
             return false;
         }
 
-        const std::string name( key.substr( 1, key.length() - 2 ) );
-        const std::string value( param.value().raw_json_token() );
+        const std::string_view name = key.substr( 1, key.length() - 2 );
+        const std::string_view value = param.value().raw_json_token();
 
         player_param.setValue( name, value );
     }
@@ -253,8 +404,8 @@ ParserSimdJSON::Impl::parsePlayerType( simdjson::ondemand::value & val,
             return false;
         }
 
-        const std::string name( key.substr( 1, key.length() - 2 ) );
-        const std::string value( param.value().raw_json_token() );
+        const std::string_view name = key.substr( 1, key.length() - 2 );
+        const std::string_view value = param.value().raw_json_token();
 
         player_type.setValue( name, value );
     }
@@ -559,21 +710,52 @@ ParserSimdJSON::parse( std::istream & is,
 
     handler.handleLogVersion( REC_VERSION_JSON );
 
+    //
+    // The input is read block by block. Only the complete elements of the
+    // top-level array are passed to the document stream, and the incomplete
+    // tail is carried over to the next block.
+    // Therefore, the memory usage is bounded by the block size and the size
+    // of the largest element, regardless of the file size.
+    //
+    const std::size_t BLOCK_SIZE = 1024 * 1024;
+
+    ArrayElementScanner scanner;
+    std::vector< char > buf;
+    std::size_t size = 0;
+
     try
     {
         simdjson::ondemand::parser parser;
-        simdjson::padded_string json( std::string( std::istreambuf_iterator< char >( is ), {} ) );
-        simdjson::ondemand::document rcg = parser.iterate( json );
-        simdjson::ondemand::array root_array = rcg.get_array();
 
-        for ( simdjson::ondemand::object data : root_array )
+        while ( ! scanner.finished() )
         {
-            for ( simdjson::ondemand::field field : data )
+            buf.resize( size + BLOCK_SIZE + simdjson::SIMDJSON_PADDING );
+            is.read( buf.data() + size, BLOCK_SIZE );
+            const std::size_t n_read = is.gcount();
+            if ( n_read == 0 )
+            {
+                break;
+            }
+
+            const std::ptrdiff_t complete = scanner.scan( buf.data(), size, size + n_read );
+            size += n_read;
+
+            if ( complete < 0 )
+            {
+                std::cerr << "(ParserSimdJSON::parse) ERROR\n\t"
+                          << "the top-level value is not an array." << std::endl;
+                return false;
+            }
+
+            if ( complete > 0 )
             {
-                if ( ! M_impl->parseData( field, handler ) )
+                if ( ! M_impl->parseElements( parser, buf.data(), complete, handler ) )
                 {
                     return false;
                 }
+
+                std::memmove( buf.data(), buf.data() + complete, size - complete );
+                size -= complete;
             }
         }
     }
@@ -583,6 +765,13 @@ ParserSimdJSON::parse( std::istream & is,
         return false;
     }
 
+    if ( ! scanner.finished() )
+    {
+        std::cerr << "(ParserSimdJSON::parse) ERROR\n\t"
+                  << "unexpected end of the input." << std::endl;
+        return false;
+    }
+
     handler.handleEOF();
     return true;
 }
@@ -592,34 +781,15 @@ bool
 ParserSimdJSON::parse( const std::string & filepath,
                        Handler & handler ) const
 {
-    handler.handleLogVersion( REC_VERSION_JSON );
-
-    try
-    {
-        simdjson::ondemand::parser parser;
-        simdjson::padded_string json = simdjson::padded_string::load( filepath );
-        simdjson::ondemand::document rcg = parser.iterate( json );
-        simdjson::ondemand::array root_array = rcg.get_array();
-
-        for ( simdjson::ondemand::object data : root_array )
-        {
-            for ( simdjson::ondemand::field field : data )
-            {
-                if ( ! M_impl->parseData( field, handler ) )
-                {
-                    return false;
-                }
-            }
-        }
-    }
-    catch ( std::exception & e )
+    std::ifstream fin( filepath, std::ios_base::in | std::ios_base::binary );
+    if ( ! fin )
     {
-        std::cerr << "(ParserSimdJSON::parse) ERROR\n\t" << e.what() << std::endl;
+        std::cerr << "(ParserSimdJSON::parse) ERROR\n\t"
+                  << "could not open the file. [" << filepath << "]" << std::endl;
         return false;
     }
 
-    handler.handleEOF();
-    return true;
+    return parse( fin, handler );
 }
 
 /*-------------------------------------------------------------------*/
@@ -627,17 +797,35 @@ bool
 ParserSimdJSON::parseData( const std::string & input,
                            Handler & handler ) const
 {
-    simdjson::ondemand::parser parser;
     simdjson::padded_string json( input );
-    simdjson::ondemand::document data = parser.iterate( json );
+    return parseData( json.data(), json.size(), handler );
+}
+
+/*-------------------------------------------------------------------*/
+bool
+ParserSimdJSON::parseData( const char * buf,
+                           const std::size_t len,
+                           Handler & handler ) const
+{
+    static_assert( PADDING >= simdjson::SIMDJSON_PADDING, "insufficient padding size" );
 
-    for ( simdjson::ondemand::field field : data.get_object() )
+    try
     {
-        if ( ! M_impl->parseData( field, handler ) )
+        simdjson::ondemand::document data = M_impl->packet_parser_.iterate( buf, len, len + PADDING );
+
+        for ( simdjson::ondemand::field field : data.get_object() )
         {
-            return false;
+            if ( ! M_impl->parseData( field, handler ) )
+            {
+                return false;
+            }
         }
     }
+    catch ( std::exception & e )
+    {
+        std::cerr << "(ParserSimdJSON::parseData) ERROR\n\t" << e.what() << std::endl;
+        return false;
+    }
 
     return true;
 }
@@ -37,6 +37,7 @@
 
 #include <string>
 #include <memory>
+#include <cstddef>
 
 namespace rcss {
 namespace rcg {
@@ -48,6 +49,11 @@ namespace rcg {
  */
 class ParserSimdJSON
     : public Parser {
+public:
+
+    //! the number of extra readable bytes required after the input of parseData( const char *, ... )
+    static constexpr std::size_t PADDING = 64;
+
 private:
     struct Impl;
     std::shared_ptr< Impl > M_impl;
@@ -75,10 +81,21 @@ public:
       \param handler reference to the rcg data handler.
       \retval true, if successfuly parsed.
       \retval false, if incorrect format is detected.
+
+      The input stream is read block by block, and each element of the
+      top-level array is passed to the handler as soon as it is parsed.
+      The whole file is never held in memory.
     */
     bool parse( std::istream & is,
                 Handler & handler ) const override;
 
+    /*!
+      \brief parse the file by the streaming parser.
+      \param filepath path to the JSON rcg file.
+      \param handler reference to the rcg data handler.
+      \retval true, if successfuly parsed.
+      \retval false, if incorrect format is detected.
+    */
     bool parse( const std::string & filepath,
                 Handler & handler ) const override;
 
@@ -96,6 +113,21 @@ public:
     bool parseData( const std::string & input,
                     Handler & handler ) const;
 
+    /*!
+      \brief parse one monitor packet in the caller's buffer without copying.
+      \param buf the data buffer. at least (len + PADDING) bytes must be allocated.
+      \param len the length of the data
+      \param handler reference to the rcg data handler.
+      \retval true, if successfuly parsed.
+      \retval false, if incorrect format is detected.
+
+      The ondemand parser instance is reused among calls, so that decoding a
+      packet does not allocate the parser state again.
+    */
+    bool parseData( const char * buf,
+                    const std::size_t len,
+                    Handler & handler ) const;
+
 
 };
 
@@ -38,75 +38,961 @@
 #include "handler.h"
 #include "types.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <cstdlib>
 #include <cstring>
 #include <cmath>
 #include <climits>
 #include <cstdio>
+#include <cstdint>
+#include <charconv>
+#include <string_view>
+
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace rcss {
+namespace rcg {
+
+namespace {
+
+/*
+  Light-weight tokenizer helpers for the show line.
+  Each reader advances buf only when the token has been read successfully.
+  The show line is never copied, and no heap allocation occurs.
+*/
+
+/*-------------------------------------------------------------------*/
+inline
+bool
+is_space( const char c )
+{
+    // space, tab, CR, LF and other control characters
+    return static_cast< unsigned char >( c ) <= ' ';
+}
+
+/*-------------------------------------------------------------------*/
+inline
+bool
+is_delimiter( const char c )
+{
+    return is_space( c ) || c == '(' || c == ')';
+}
+
+/*-------------------------------------------------------------------*/
+inline
+const char *
+skip_space( const char * buf,
+            const char * end )
+{
+    while ( buf != end && is_space( *buf ) ) ++buf;
+    return buf;
+}
+
+/*-------------------------------------------------------------------*/
+inline
+bool
+read_paren( const char *& buf,
+            const char * end,
+            const char paren )
+{
+    const char * ptr = skip_space( buf, end );
+    if ( ptr == end || *ptr != paren )
+    {
+        return false;
+    }
+
+    buf = ptr + 1;
+    return true;
+}
+
+/*-------------------------------------------------------------------*/
+inline
+bool
+read_word( const char *& buf,
+           const char * end,
+           std::string_view & word )
+{
+    const char * first = skip_space( buf, end );
+    const char * last = first;
+    while ( last != end && ! is_delimiter( *last ) ) ++last;
+
+    if ( first == last )
+    {
+        return false;
+    }
+
+    word = std::string_view( first, last - first );
+    buf = last;
+    return true;
+}
+
+/*-------------------------------------------------------------------*/
+inline
+bool
+read_keyword( const char *& buf,
+              const char * end,
+              const std::string_view & keyword )
+{
+    const char * ptr = buf;
+    std::string_view word;
+    if ( ! read_word( ptr, end, word )
+         || word != keyword )
+    {
+        return false;
+    }
+
+    buf = ptr;
+    return true;
+}
+
+/*-------------------------------------------------------------------*/
+template < std::size_t N >
+bool
+read_name( const char *& buf,
+           const char * end,
+           char ( &name )[N] )
+{
+    const char * ptr = buf;
+    std::string_view word;
+    if ( ! read_word( ptr, end, word )
+         || word.length() >= N )
+    {
+        return false;
+    }
+
+    word.copy( name, word.length() );
+    name[word.length()] = '\0';
+    buf = ptr;
+    return true;
+}
+
+/*-------------------------------------------------------------------*/
+inline
+int
+digit_value( const char c,
+             const int base )
+{
+    int d = base;
+    if ( '0' <= c && c <= '9' ) d = c - '0';
+    else if ( 'a' <= c && c <= 'f' ) d = c - 'a' + 10;
+    else if ( 'A' <= c && c <= 'F' ) d = c - 'A' + 10;
+    return ( d < base ? d : -1 );
+}
+
+/*-------------------------------------------------------------------*/
+template < typename T >
+bool
+read_int( const char *& buf,
+          const char * end,
+          T & value,
+          const int base = 10 )
+{
+    const char * ptr = skip_space( buf, end );
+    const bool negative = ( ptr != end && *ptr == '-' );
+    if ( negative ) ++ptr;
+
+    if ( base == 16
+         && end - ptr > 2
+         && ptr[0] == '0'
+         && ( ptr[1] == 'x' || ptr[1] == 'X' ) )
+    {
+        ptr += 2;
+    }
+
+    // at most 9 decimal digits (or 7 hex digits) to avoid any overflow.
+    const int max_digits = ( base == 16 ? 7 : 9 );
+    const char * first = ptr;
+    long val = 0;
+    int d;
+    while ( ptr != end
+            && ptr - first < max_digits
+            && ( d = digit_value( *ptr, base ) ) >= 0 )
+    {
+        val = val * base + d;
+        ++ptr;
+    }
+
+    if ( ptr == first
+         || ( ptr != end && ! is_delimiter( *ptr ) ) )
+    {
+        return false;
+    }
+
+    value = static_cast< T >( negative ? -val : val );
+    buf = ptr;
+    return true;
+}
+
+/*-------------------------------------------------------------------*/
+template < typename T >
+inline
+bool
+read_hex( const char *& buf,
+          const char * end,
+          T & value )
+{
+    return read_int( buf, end, value, 16 );
+}
+
+/*-------------------------------------------------------------------*/
+inline
+bool
+read_float( const char *& buf,
+            const char * end,
+            float & value )
+{
+    static const float pow10[] = { 1.0e0f, 1.0e1f, 1.0e2f, 1.0e3f, 1.0e4f, 1.0e5f,
+                                   1.0e6f, 1.0e7f, 1.0e8f, 1.0e9f, 1.0e10f };
+
+    const char * ptr = skip_space( buf, end );
+
+    //
+    // fast path for the plain decimal notation, e.g. "-12.3456".
+    // If the mantissa fits in 24 bits and the number of fractional digits is
+    // at most 10, both operands are exactly representable and one IEEE division
+    // gives the correctly rounded result, i.e., the same value as strtof.
+    //
+    {
+        const char * p = ptr;
+        const bool negative = ( p != end && *p == '-' );
+        if ( negative ) ++p;
+
+        const char * first = p;
+        std::uint32_t mantissa = 0;
+        while ( p != end && static_cast< unsigned >( *p - '0' ) < 10 )
+        {
+            mantissa = mantissa * 10 + ( *p - '0' );
+            ++p;
+        }
+        int n_digits = static_cast< int >( p - first );
+        int n_frac = 0;
+        if ( p != end && *p == '.' )
+        {
+            ++p;
+            first = p;
+            while ( p != end && static_cast< unsigned >( *p - '0' ) < 10 )
+            {
+                mantissa = mantissa * 10 + ( *p - '0' );
+                ++p;
+            }
+            n_frac = static_cast< int >( p - first );
+            n_digits += n_frac;
+        }
+
+        if ( 0 < n_digits && n_digits <= 8
+             && mantissa < ( 1u << 24 )
+             && n_frac <= 10
+             && ( p == end || is_delimiter( *p ) ) )
+        {
+            const float val = static_cast< float >( mantissa ) / pow10[n_frac];
+            value = ( negative ? -val : val );
+            buf = p;
+            return true;
+        }
+    }
+
+    float val = 0.0f;
+#if defined(__cpp_lib_to_chars)
+    const std::from_chars_result result = std::from_chars( ptr, end, val );
+    if ( result.ec != std::errc()
+         || ( result.ptr != end && ! is_delimiter( *result.ptr ) ) )
+    {
+        return false;
+    }
+    ptr = result.ptr;
+#else
+    // the show line is terminated by the null character of std::string.
+    char * next = nullptr;
+    val = std::strtof( ptr, &next );
+    if ( next == ptr
+         || ( next != end && ! is_delimiter( *next ) ) )
+    {
+        return false;
+    }
+    ptr = next;
+#endif
+
+    value = val;
+    buf = ptr;
+    return true;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief tokenized show line. handler notification is deferred.
+*/
+struct ShowLine {
+    ShowInfoT show_;
+    int playmode_; //!< playmode id. negative value means no playmode info.
+    int n_team_; //!< the number of team values. 0 means no team info.
+    char name_l_[32];
+    char name_r_[32];
+    int team_[6]; //!< score_l, score_r, pen_score_l, pen_miss_l, pen_score_r, pen_miss_r
+};
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief tokenize the show line without any allocation.
+  \return true if the whole line has been accepted.
+
+  (show <Time> [(pm <Playmode>)] [(tm <Team> <Team>)] <Ball> <Players>)
+*/
+bool
+tokenize_show( const char * buf,
+               const char * end,
+               ShowLine & data )
+{
+    ShowInfoT & show = data.show_;
+    data.playmode_ = -1;
+    data.n_team_ = 0;
+
+    if ( ! read_paren( buf, end, '(' )
+         || ! read_keyword( buf, end, "show" )
+         || ! read_int( buf, end, show.time_ ) )
+    {
+        return false;
+    }
+
+    //
+    // playmode
+    //
+    buf = skip_space( buf, end );
+    if ( end - buf > 3
+         && ! std::strncmp( buf, "(pm", 3 ) )
+    {
+        if ( ! read_paren( buf, end, '(' )
+             || ! read_keyword( buf, end, "pm" )
+             || ! read_int( buf, end, data.playmode_ )
+             || ! read_paren( buf, end, ')' ) )
+        {
+            return false;
+        }
+    }
+
+    //
+    // team
+    //
+    buf = skip_space( buf, end );
+    if ( end - buf > 3
+         && ! std::strncmp( buf, "(tm", 3 ) )
+    {
+        if ( ! read_paren( buf, end, '(' )
+             || ! read_keyword( buf, end, "tm" )
+             || ! read_name( buf, end, data.name_l_ )
+             || ! read_name( buf, end, data.name_r_ ) )
+        {
+            return false;
+        }
+
+        while ( data.n_team_ < 6 && read_int( buf, end, data.team_[data.n_team_] ) )
+        {
+            ++data.n_team_;
+        }
+
+        if ( ( data.n_team_ != 2 && data.n_team_ != 6 )
+             || ! read_paren( buf, end, ')' ) )
+        {
+            return false;
+        }
+
+        if ( ! std::strcmp( data.name_l_, "null" ) ) data.name_l_[0] = '\0';
+        if ( ! std::strcmp( data.name_r_, "null" ) ) data.name_r_[0] = '\0';
+    }
+
+    //
+    // ball: ((b) x y vx vy)
+    //
+    {
+        BallT & ball = show.ball_;
+        if ( ! read_paren( buf, end, '(' )
+             || ! read_paren( buf, end, '(' )
+             || ! read_keyword( buf, end, "b" )
+             || ! read_paren( buf, end, ')' )
+             || ! read_float( buf, end, ball.x_ )
+             || ! read_float( buf, end, ball.y_ )
+             || ! read_float( buf, end, ball.vx_ )
+             || ! read_float( buf, end, ball.vy_ )
+             || ! read_paren( buf, end, ')' ) )
+        {
+            return false;
+        }
+    }
+
+    //
+    // players
+    // ((side unum) type state x y vx vy body neck [pointx pointy] (v h 90) [(fp dist dir)] (s 4000 1 1[ capacity])[(f side unum)]
+    //              (c 1 1 1 1 1 1 1 1 1 1 1[ 1]))
+    //
+    for ( int i = 0; i < MAX_PLAYER*2; ++i )
+    {
+        buf = skip_space( buf, end );
+        if ( buf == end || *buf == ')' ) break;
+
+        std::string_view side;
+        int unum = 0;
+        if ( ! read_paren( buf, end, '(' )
+             || ! read_paren( buf, end, '(' )
+             || ! read_word( buf, end, side )
+             || side.length() != 1
+             || ( side[0] != 'l' && side[0] != 'r' )
+             || ! read_int( buf, end, unum )
+             || unum < 1 || MAX_PLAYER < unum
+             || ! read_paren( buf, end, ')' ) )
+        {
+            return false;
+        }
+
+        PlayerT & p = show.player_[ side[0] == 'l' ? unum - 1 : unum - 1 + MAX_PLAYER ];
+        p.side_ = side[0];
+        p.unum_ = static_cast< Int16 >( unum );
+
+        if ( ! read_int( buf, end, p.type_ )
+             || ! read_hex( buf, end, p.state_ )
+             || ! read_float( buf, end, p.x_ )
+             || ! read_float( buf, end, p.y_ )
+             || ! read_float( buf, end, p.vx_ )
+             || ! read_float( buf, end, p.vy_ )
+             || ! read_float( buf, end, p.body_ )
+             || ! read_float( buf, end, p.neck_ ) )
+        {
+            return false;
+        }
+
+        // arm
+        buf = skip_space( buf, end );
+        if ( buf != end && *buf != '(' )
+        {
+            if ( ! read_float( buf, end, p.point_x_ )
+                 || ! read_float( buf, end, p.point_y_ ) )
+            {
+                return false;
+            }
+        }
+
+        // (v quality width)
+        std::string_view quality;
+        if ( ! read_paren( buf, end, '(' )
+             || ! read_keyword( buf, end, "v" )
+             || ! read_word( buf, end, quality )
+             || quality.length() != 1
+             || ! read_float( buf, end, p.view_width_ )
+             || ! read_paren( buf, end, ')' ) )
+        {
+            return false;
+        }
+        p.view_quality_ = quality[0];
+
+        std::string_view tag;
+        if ( ! read_paren( buf, end, '(' )
+             || ! read_word( buf, end, tag ) )
+        {
+            return false;
+        }
+
+        // (fp dist dir)
+        // focus point is introduced in the monitor protocol v6
+        if ( tag == "fp" )
+        {
+            if ( ! read_float( buf, end, p.focus_dist_ )
+                 || ! read_float( buf, end, p.focus_dir_ )
+                 || ! read_paren( buf, end, ')' )
+                 || ! read_paren( buf, end, '(' )
+                 || ! read_word( buf, end, tag ) )
+            {
+                return false;
+            }
+        }
+
+        // (s stamina effort recovery[ capacity])
+        // capacity is introduced in the monitor protocol v5
+        if ( tag != "s"
+             || ! read_float( buf, end, p.stamina_ )
+             || ! read_float( buf, end, p.effort_ )
+             || ! read_float( buf, end, p.recovery_ ) )
+        {
+            return false;
+        }
+        read_float( buf, end, p.stamina_capacity_ );
+
+        if ( ! read_paren( buf, end, ')' )
+             || ! read_paren( buf, end, '(' )
+             || ! read_word( buf, end, tag ) )
+        {
+            return false;
+        }
+
+        // (f side unum)
+        if ( tag == "f" )
+        {
+            std::string_view focus_side;
+            if ( ! read_word( buf, end, focus_side )
+                 || focus_side.length() != 1
+                 || ! read_int( buf, end, p.focus_unum_ )
+                 || ! read_paren( buf, end, ')' )
+                 || ! read_paren( buf, end, '(' )
+                 || ! read_word( buf, end, tag ) )
+            {
+                return false;
+            }
+            p.focus_side_ = focus_side[0];
+        }
+
+        // (c kick dash turn catch move tneck cview say tackle pointto atttention[ change_focus])
+        if ( tag != "c"
+             || ! read_int( buf, end, p.kick_count_ )
+             || ! read_int( buf, end, p.dash_count_ )
+             || ! read_int( buf, end, p.turn_count_ )
+             || ! read_int( buf, end, p.catch_count_ )
+             || ! read_int( buf, end, p.move_count_ )
+             || ! read_int( buf, end, p.turn_neck_count_ )
+             || ! read_int( buf, end, p.change_view_count_ )
+             || ! read_int( buf, end, p.say_count_ )
+             || ! read_int( buf, end, p.tackle_count_ )
+             || ! read_int( buf, end, p.pointto_count_ )
+             || ! read_int( buf, end, p.attentionto_count_ ) )
+        {
+            return false;
+        }
+        read_int( buf, end, p.change_focus_count_ );
+
+        if ( ! read_paren( buf, end, ')' )
+             || ! read_paren( buf, end, ')' ) )
+        {
+            return false;
+        }
+    }
+
+    if ( ! read_paren( buf, end, ')' ) )
+    {
+        return false;
+    }
+
+    return true;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief pass the tokenized show line to the handler.
+  \return false if the handler rejected the data (e.g. the loading is canceled).
+*/
+bool
+notify_show( const ShowLine & data,
+             Handler & handler )
+{
+    const ShowInfoT & show = data.show_;
+
+    bool result = true;
+
+    if ( data.playmode_ >= 0 )
+    {
+        result &= handler.handlePlayMode( show.time_, static_cast< PlayMode >( data.playmode_ ) );
+    }
+
+    if ( data.n_team_ > 0 )
+    {
+        const bool pen = ( data.n_team_ == 6 );
+        result &= handler.handleTeam( show.time_,
+                                      TeamT( data.name_l_, data.team_[0], ( pen ? data.team_[2] : 0 ), ( pen ? data.team_[3] : 0 ) ),
+                                      TeamT( data.name_r_, data.team_[1], ( pen ? data.team_[4] : 0 ), ( pen ? data.team_[5] : 0 ) ) );
+    }
+
+    result &= handler.handleShow( show );
+
+    return result;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief read-only view of the whole file contents.
+  The file is memory-mapped if possible. Otherwise, it is read into the buffer.
+*/
+class FileImage {
+private:
+    const char * M_data;
+    std::size_t M_size;
+#ifdef HAVE_SYS_MMAN_H
+    void * M_map;
+#endif
+    std::string M_buffer;
+
+public:
+
+    explicit
+    FileImage( const std::string & filepath )
+        : M_data( nullptr ),
+          M_size( 0 )
+#ifdef HAVE_SYS_MMAN_H
+        , M_map( MAP_FAILED )
+#endif
+      {
+#ifdef HAVE_SYS_MMAN_H
+          const int fd = ::open( filepath.c_str(), O_RDONLY );
+          if ( fd >= 0 )
+          {
+              struct stat st;
+              if ( ::fstat( fd, &st ) == 0
+                   && st.st_size > 0 )
+              {
+                  M_map = ::mmap( nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+                  if ( M_map != MAP_FAILED )
+                  {
+                      ::madvise( M_map, st.st_size, MADV_SEQUENTIAL );
+                      M_data = static_cast< const char * >( M_map );
+                      M_size = st.st_size;
+                  }
+              }
+              ::close( fd );
+          }
+
+          if ( M_data )
+          {
+              return;
+          }
+#endif
+          std::ifstream fin( filepath, std::ios_base::in | std::ios_base::binary );
+          if ( fin )
+          {
+              M_buffer.assign( std::istreambuf_iterator< char >( fin ),
+                               std::istreambuf_iterator< char >() );
+              M_data = M_buffer.data();
+              M_size = M_buffer.size();
+          }
+      }
+
+    ~FileImage()
+      {
+#ifdef HAVE_SYS_MMAN_H
+          if ( M_map != MAP_FAILED )
+          {
+              ::munmap( M_map, M_size );
+          }
+#endif
+      }
+
+    FileImage( const FileImage & ) = delete;
+    FileImage & operator=( const FileImage & ) = delete;
+
+    const char * data() const { return M_data; }
+    std::size_t size() const { return M_size; }
+};
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief a block of lines that is tokenized by a worker thread.
+*/
+struct LineChunk {
+    //! one line. show_index_ is an index of shows_, or -1 if the line has to be parsed by parseLine().
+    struct Entry {
+        const char * begin_;
+        const char * end_;
+        int show_index_;
+    };
+
+    const char * begin_;
+    const char * end_;
+    std::vector< Entry > entries_;
+    std::vector< ShowLine > shows_;
+    bool ready_;
+
+    LineChunk( const char * begin,
+               const char * end )
+        : begin_( begin ),
+          end_( end ),
+          ready_( false )
+      { }
+};
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief tokenize all show lines in the chunk. other lines are kept as is.
+*/
+void
+tokenize_chunk( LineChunk & chunk )
+{
+    chunk.entries_.reserve( ( chunk.end_ - chunk.begin_ ) / 2048 + 1 );
+    chunk.shows_.reserve( ( chunk.end_ - chunk.begin_ ) / 2048 + 1 );
+
+    const char * line = chunk.begin_;
+    while ( line < chunk.end_ )
+    {
+        const char * eol = static_cast< const char * >( std::memchr( line, '\n', chunk.end_ - line ) );
+        if ( ! eol ) eol = chunk.end_;
+
+        int show_index = -1;
+        if ( eol - line > 6
+             && ! std::strncmp( line, "(show ", 6 ) )
+        {
+            chunk.shows_.emplace_back();
+            if ( tokenize_show( line, eol, chunk.shows_.back() ) )
+            {
+                show_index = static_cast< int >( chunk.shows_.size() ) - 1;
+            }
+            else
+            {
+                chunk.shows_.pop_back();
+            }
+        }
+
+        chunk.entries_.push_back( LineChunk::Entry{ line, eol, show_index } );
+        line = eol + 1;
+    }
+}
+
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+bool
+ParserV4::parse( std::istream & is,
+                 Handler & handler ) const
+{
+    // streampos must be the first point!!!
+    is.seekg( 0 );
+
+    if ( ! is.good() )
+    {
+        return false;
+    }
+
+    std::string line;
+    line.reserve( 8192 );
+
+    // skip header line
+    if ( ! std::getline( is, line )
+         || line.length() < 4
+         || line.compare( 0, 3, "ULG" ) != 0 )
+    {
+        std::cerr << "Unknown header line: [" << line << "]" << std::endl;
+        return false;
+    }
+
+    const int version = std::stoi( line.substr( 3 ) );
+    if ( version != REC_VERSION_4
+         && version != REC_VERSION_5
+         && version != REC_VERSION_6 )
+    {
+        std::cerr << "Unsupported rcg version: [" << line << "]" << std::endl;
+        return false;
+    }
+
+    if ( ! handler.handleLogVersion( version ) )
+    {
+        std::cerr << "Unsupported game log version: [" << line << "]" << std::endl;
+        return false;
+    }
+
+    int n_line = 1;
+    while ( std::getline( is, line ) )
+    {
+        ++n_line;
+        if ( ! parseLine( n_line, line, handler ) )
+        {
+            return false;
+        }
+    }
+
+    if ( is.eof() )
+    {
+        return handler.handleEOF();
+    }
 
-namespace rcss {
-namespace rcg {
+    return false;
+}
 
 /*-------------------------------------------------------------------*/
 /*!
 
  */
 bool
-ParserV4::parse( std::istream & is,
+ParserV4::parse( const std::string & filepath,
                  Handler & handler ) const
 {
-    // streampos must be the first point!!!
-    is.seekg( 0 );
-
-    if ( ! is.good() )
+    const FileImage image( filepath );
+    if ( ! image.data() )
     {
+        std::cerr << "Could not read the file [" << filepath << "]" << std::endl;
         return false;
     }
 
-    std::string line;
-    line.reserve( 8192 );
+    const char * const first = image.data();
+    const char * const last = first + image.size();
 
-    // skip header line
-    if ( ! std::getline( is, line )
-         || line.length() < 4
-         || line.compare( 0, 3, "ULG" ) != 0 )
+    //
+    // header line
+    //
+    const char * eol = static_cast< const char * >( std::memchr( first, '\n', last - first ) );
+    if ( ! eol ) eol = last;
+
+    const std::string header( first, eol );
+    const char * const body = ( eol == last ? last : eol + 1 );
+    if ( header.length() < 4
+         || header.compare( 0, 3, "ULG" ) != 0 )
     {
-        std::cerr << "Unknown header line: [" << line << "]" << std::endl;
+        std::cerr << "Unknown header line: [" << header << "]" << std::endl;
         return false;
     }
 
-    const int version = std::stoi( line.substr( 3 ) );
+    const int version = std::atoi( header.c_str() + 3 );
     if ( version != REC_VERSION_4
          && version != REC_VERSION_5
          && version != REC_VERSION_6 )
     {
-        std::cerr << "Unsupported rcg version: [" << line << "]" << std::endl;
+        std::cerr << "Unsupported rcg version: [" << header << "]" << std::endl;
         return false;
     }
 
     if ( ! handler.handleLogVersion( version ) )
     {
-        std::cerr << "Unsupported game log version: [" << line << "]" << std::endl;
+        std::cerr << "Unsupported game log version: [" << header << "]" << std::endl;
         return false;
     }
 
+    //
+    // split the body at the line boundaries
+    //
+    const std::size_t CHUNK_SIZE = 1024 * 1024;
+
+    std::vector< LineChunk > chunks;
+    chunks.reserve( ( last - body ) / CHUNK_SIZE + 1 );
+    for ( const char * begin = body; begin < last; )
+    {
+        const char * end = begin + std::min( CHUNK_SIZE, static_cast< std::size_t >( last - begin ) );
+        if ( end < last )
+        {
+            end = static_cast< const char * >( std::memchr( end, '\n', last - end ) );
+            end = ( end ? end + 1 : last );
+        }
+        chunks.emplace_back( begin, end );
+        begin = end;
+    }
+
+    //
+    // show lines are tokenized by the worker threads.
+    // the handler is always notified from this thread, in the order of lines.
+    //
+    const std::size_t n_threads = std::min( static_cast< std::size_t >( std::thread::hardware_concurrency() ),
+                                            chunks.size() );
+    const std::size_t window = std::max( n_threads, std::size_t( 1 ) ) * 2; // bounds the memory usage
+
+    std::mutex mtx;
+    std::condition_variable cond;
+    std::size_t next_chunk = 0;
+    std::size_t done_chunk = 0;
+    bool canceled = false;
+
+    auto worker = [&]()
+    {
+        while ( true )
+        {
+            std::size_t idx = 0;
+            {
+                std::unique_lock< std::mutex > lock( mtx );
+                cond.wait( lock, [&]() { return canceled
+                                                || next_chunk >= chunks.size()
+                                                || next_chunk < done_chunk + window; } );
+                if ( canceled
+                     || next_chunk >= chunks.size() )
+                {
+                    return;
+                }
+                idx = next_chunk++;
+            }
+
+            tokenize_chunk( chunks[idx] );
+
+            {
+                std::lock_guard< std::mutex > lock( mtx );
+                chunks[idx].ready_ = true;
+            }
+            cond.notify_all();
+        }
+    };
+
+    std::vector< std::thread > threads;
+    if ( n_threads > 1 )
+    {
+        threads.reserve( n_threads );
+        for ( std::size_t i = 0; i < n_threads; ++i )
+        {
+            threads.emplace_back( worker );
+        }
+    }
+
+    bool result = true;
     int n_line = 1;
-    while ( std::getline( is, line ) )
+    std::string line;
+    for ( std::size_t i = 0; i < chunks.size() && result; ++i )
     {
-        ++n_line;
-        if ( ! parseLine( n_line, line, handler ) )
+        LineChunk & chunk = chunks[i];
+        if ( threads.empty() )
         {
-            return false;
+            tokenize_chunk( chunk );
+        }
+        else
+        {
+            std::unique_lock< std::mutex > lock( mtx );
+            cond.wait( lock, [&]() { return chunk.ready_; } );
+        }
+
+        for ( const LineChunk::Entry & e : chunk.entries_ )
+        {
+            ++n_line;
+            if ( e.show_index_ >= 0 )
+            {
+                if ( ! notify_show( chunk.shows_[e.show_index_], handler ) )
+                {
+                    result = false;
+                    break;
+                }
+            }
+            else
+            {
+                line.assign( e.begin_, e.end_ );
+                if ( ! parseLine( n_line, line, handler ) )
+                {
+                    result = false;
+                    break;
+                }
+            }
         }
+
+        // release the tokenized data
+        std::vector< LineChunk::Entry >().swap( chunk.entries_ );
+        std::vector< ShowLine >().swap( chunk.shows_ );
+
+        {
+            std::lock_guard< std::mutex > lock( mtx );
+            done_chunk = i + 1;
+            canceled = ! result;
+        }
+        cond.notify_all();
     }
 
-    if ( is.eof() )
+    for ( std::thread & t : threads )
     {
-        return handler.handleEOF();
+        t.join();
     }
 
-    return false;
+    if ( ! result )
+    {
+        return false;
+    }
+
+    return handler.handleEOF();
 }
 
 /*-------------------------------------------------------------------*/
@@ -118,40 +1004,44 @@ ParserV4::parseLine( const int n_line,
                      const std::string & line,
                      Handler & handler ) const
 {
-    char name[32];
+    const char * buf = line.data();
+    const char * end = buf + line.length();
+    std::string_view name;
 
-    if ( std::sscanf( line.c_str(), " ( %s ", name ) != 1 )
+    if ( ! read_paren( buf, end, '(' )
+         || ! read_word( buf, end, name ) )
     {
         std::cerr << n_line << ": Illegal line: [" << line << ']'
                   << std::endl;;
         return false;
     }
 
-    if ( ! std::strcmp( name, "show" ) )
+    if ( name == "show" )
     {
-        parseShow( n_line, line, handler );
+        // the show line rejected by the handler stops the parser.
+        return parseShow( n_line, line, handler );
     }
-    else if ( ! std::strcmp( name, "playmode" ) )
+    else if ( name == "playmode" )
     {
         parsePlayMode( n_line, line, handler );
     }
-    else if ( ! std::strcmp( name, "team" ) )
+    else if ( name == "team" )
     {
         parseTeam( n_line, line, handler );
     }
-    else if ( ! std::strcmp( name, "msg" ) )
+    else if ( name == "msg" )
     {
         parseMsg( n_line, line, handler );
     }
-    else if ( ! std::strcmp( name, "player_type" ) )
+    else if ( name == "player_type" )
     {
         parsePlayerType( n_line, line, handler );
     }
-    else if ( ! std::strcmp( name, "player_param" ) )
+    else if ( name == "player_param" )
     {
         parsePlayerParam( n_line, line, handler );
     }
-    else if ( ! std::strcmp( name, "server_param" ) )
+    else if ( name == "server_param" )
     {
         parseServerParam( n_line, line, handler );
     }
@@ -170,451 +1060,305 @@ ParserV4::parseLine( const int n_line,
 
  */
 bool
-ParserV4::parseShow( const int n_line,
-                     const std::string & line,
+ParserV4::parseLine( const int n_line,
+                     const std::string_view line,
                      Handler & handler ) const
 {
-    /*
-      (show <Time> <Ball> <Players>)
-    */
-
-    const char * buf = line.c_str();
+    const char * buf = line.data();
+    const char * end = buf + line.length();
 
-    if ( 0 )
+    if ( read_paren( buf, end, '(' )
+         && read_keyword( buf, end, "show" ) )
     {
-        int n_read = 0;
-
-        // time
-        int time = 0;
-
-        if ( std::sscanf( buf, " ( show %d %n ",
-                          &time, &n_read ) != 1 )
+        ShowLine data;
+        if ( tokenize_show( line.data(), end, data ) )
         {
-            std::cerr << n_line << ": error: "
-                      << "Illegal time info \"" << line << "\"" << std::endl;
-            return false;
+            return notify_show( data, handler );
         }
-        buf += n_read;
+    }
 
-        //
-        // playmode
-        //
-        if ( *(buf + 1) == 'p' )
-        {
-            int pm = 0;
-            if ( std::sscanf( buf,
-                              " ( pm %d ) %n ",
-                              &pm, &n_read ) == 1 )
-            {
-                buf += n_read;
-                handler.handlePlayMode( time, static_cast< PlayMode >( pm ) );
-            }
-        }
+    return parseLine( n_line, std::string( line ), handler );
+}
 
-        //
-        // team
-        //
-        if ( *(buf + 1) == 't' )
-        {
-            char name_l[32], name_r[32];
-            int score_l = 0, score_r = 0;
-            int pen_score_l = 0, pen_miss_l = 0, pen_score_r = 0, pen_miss_r = 0;
+/*-------------------------------------------------------------------*/
+/*!
 
-            int n = std::sscanf( buf,
-                                 " ( tm %31s %31s %d %d %d %d %d %d ",
-                                 name_l, name_r,
-                                 &score_l, &score_r,
-                                 &pen_score_l, &pen_miss_l,
-                                 &pen_score_r, &pen_miss_r );
+ */
+bool
+ParserV4::parseShow( const int n_line,
+                     const std::string & line,
+                     Handler & handler ) const
+{
+    /*
+      (show <Time> [(pm <Playmode>)] [(tm <Team> <Team>)] <Ball> <Players>)
+    */
 
-            if ( n != 4 && n != 8 )
-            {
-                std::cerr << n_line << ": error: n=" << n << ' '
-                          << "Illegal team info. \"" << line << "\"" << std::endl;;
-                return false;
-            }
-            while ( *buf != ')' && *buf != '\0' ) ++buf;
-            while ( *buf == ')' && *buf != '\0' ) ++buf;
+    // The handler is notified only after the whole line has been accepted,
+    // so that the legacy scanner can safely retry the line on failure.
+    ShowLine data;
+    if ( tokenize_show( line.data(), line.data() + line.length(), data ) )
+    {
+        return notify_show( data, handler );
+    }
 
-            if ( ! std::strcmp( name_l, "null" ) ) std::memset( name_l, 0, 4 );
-            if ( ! std::strcmp( name_r, "null" ) ) std::memset( name_r, 0, 4 );
+    // the format error detected by the legacy scanner is not fatal.
+    parseShowLegacy( n_line, line, handler );
+    return true;
+}
 
-            TeamT team_l( name_l, score_l, pen_score_l, pen_miss_l );
-            TeamT team_r( name_r, score_r, pen_score_r, pen_miss_r );
+/*-------------------------------------------------------------------*/
+/*!
 
-            handler.handleTeam( time, team_l, team_r );
-        }
+ */
+bool
+ParserV4::parseShowLegacy( const int n_line,
+                           const std::string & line,
+                           Handler & handler ) const
+{
+    /*
+      (show <Time> <Ball> <Players>)
+    */
 
-        //
-        // show main
-        //
+    const char * buf = line.c_str();
 
-        ShowInfoT show;
+    ShowInfoT show;
 
-        show.time_ = time;
+    char * next;
 
-        //
-        // ball
-        //
+    //
+    // time
+    //
+    while ( *buf == ' ' ) ++buf;
+    while ( *buf != '\0' && *buf != ' ' ) ++buf;
+    long time = std::strtol( buf, &next, 10 ); buf = next;
 
-        if ( std::sscanf( buf, " ((b) %f %f %f %f) %n",
-                          &show.ball_.x_, &show.ball_.y_,
-                          &show.ball_.vx_, &show.ball_.vy_,
-                          &n_read ) != 4 )
-        {
-            std::cerr << n_line << ": error: "
-                      << "Illegal ball info \"" << line << "\"" << std::endl;
-            return false;
-        }
-        buf += n_read;
+    if ( time == LONG_MIN || time == LONG_MAX )
+    {
+        std::cerr << n_line << ": error: "
+                  << " Illegal show info time. "
+                  << " \"" << line << "\""
+                  << std::endl;
+        return false;
+    }
 
-        //
-        // players
-        //
+    show.time_ = static_cast< UInt32 >( time );
 
-        char side;
-        short unum;
-        short type;
-        int state;
-        float x, y, vx, vy, body, neck;
-        for ( int i = 0; i < MAX_PLAYER * 2; ++i )
-        {
-            if ( *buf == ')' ) break;
+    while ( *buf == ' ' ) ++buf;
 
-            if ( std::sscanf( buf,
-                              " ((%c %hd) %hd %x %f %f %f %f %f %f %n",
-                              &side, &unum,
-                              &type, &state,
-                              &x, &y, &vx, &vy, &body, &neck,
-                              &n_read ) != 10 )
-            {
-                std::cerr << n_line << ": error: "
-                          << " Illegal player id or pos " << i << " \"" << line << "\""
-                          << std::endl;;
-                return false;
-            }
+    //
+    // playmode
+    //
+    if ( ! std::strncmp( buf, "(pm", 3 ) )
+    {
+        int n_read = 0;
+        int pm = 0;
+        if ( std::sscanf( buf,
+                          " ( pm %d ) %n ",
+                          &pm, &n_read ) == 1 )
+        {
             buf += n_read;
+            handler.handlePlayMode( time, static_cast< PlayMode >( pm ) );
+        }
+    }
 
-            int idx = unum - 1;
-            if ( side == 'r' ) idx += MAX_PLAYER;
-            if ( idx < 0 || MAX_PLAYER*2 <= idx )
-            {
-                std::cerr << n_line << ": error: "
-                          << " Illegal player id " << i << " \"" << line << "\""
-                          << std::endl;;
-                return false;
-            }
-
-            PlayerT & p = show.player_[idx];
-
-            p.side_ = side;
-            p.unum_ = unum;
-            p.type_ = type;
-            p.state_ = state;
-            p.x_ = x;
-            p.y_ = y;
-            p.vx_ = vx;
-            p.vy_ = vy;
-            p.body_ = body;
-            p.neck_ = neck;
-
-            if ( *buf != '('
-                 && std::sscanf( buf,
-                                 " %f %f %n",
-                                 &p.point_x_, &p.point_y_,
-                                 &n_read ) == 2 )
-            {
-                buf += n_read;
-            }
-
-            if ( std::sscanf( buf,
-                              " (v %c %f) (s %f %f %f) %n",
-                              &p.view_quality_, &p.view_width_,
-                              &p.stamina_, &p.effort_, &p.recovery_,
-                              &n_read ) != 5 )
-            {
-                std::cerr << n_line << ": error: "
-                          << "Illegal player view or stamina (" << side << ' ' << unum
-                          << ") [" << line << "]" << std::endl;;
-                return false;
-            }
-            buf += n_read;
+    //
+    // team
+    //
+    if ( ! std::strncmp( buf, "(tm", 3 ) )
+    {
+        char name_l[32], name_r[32];
+        int score_l = 0, score_r = 0;
+        int pen_score_l = 0, pen_miss_l = 0, pen_score_r = 0, pen_miss_r = 0;
+
+        int n = std::sscanf( buf,
+                             " ( tm %31s %31s %d %d %d %d %d %d ",
+                             name_l, name_r,
+                             &score_l, &score_r,
+                             &pen_score_l, &pen_miss_l,
+                             &pen_score_r, &pen_miss_r );
+
+        if ( n != 4 && n != 8 )
+        {
+            std::cerr << n_line << ": error: n=" << n << ' '
+                      << "Illegal team info. \"" << line << "\"" << std::endl;;
+            return false;
+        }
+        while ( *buf != ')' && *buf != '\0' ) ++buf;
+        while ( *buf == ')' && *buf != '\0' ) ++buf;
 
-            if ( *(buf + 1) == 'f'
-                 && std::sscanf( buf,
-                                 " ( f %c %hd ) %n",
-                                 &p.focus_side_, &p.focus_unum_,
-                                 &n_read ) == 2 )
-            {
-                buf += n_read;
-            }
+        if ( ! std::strcmp( name_l, "null" ) ) std::memset( name_l, 0, 4 );
+        if ( ! std::strcmp( name_r, "null" ) ) std::memset( name_r, 0, 4 );
 
-            if ( std::sscanf( buf,
-                              " (c %hd %hd %hd %hd %hd %hd %hd %hd %hd %hd %hd)) %n",
-                              &p.kick_count_,
-                              &p.dash_count_,
-                              &p.turn_count_,
-                              &p.catch_count_,
-                              &p.move_count_,
-                              &p.turn_neck_count_,
-                              &p.change_view_count_,
-                              &p.say_count_,
-                              &p.tackle_count_,
-                              &p.pointto_count_,
-                              &p.attentionto_count_,
-                              &n_read ) != 11 )
-            {
-                std::cerr << n_line << ": error: "
-                          << "Illegal player count (" << side << ' ' << unum
-                          << ") [" << line << "]" << std::endl;;
-                return false;
-            }
-            buf += n_read;
-        }
+        TeamT team_l( name_l, score_l, pen_score_l, pen_miss_l );
+        TeamT team_r( name_r, score_r, pen_score_r, pen_miss_r );
 
-        handler.handleShow( show );
+        handler.handleTeam( time, team_l, team_r );
     }
-    else
-    {
-        ShowInfoT show;
-
-        char * next;
 
-        //
-        // time
-        //
+    // ball
+    {
+        // ((b) x y vx vy)
+        while ( *buf == ' ' ) ++buf;
+        while ( *buf != '\0' && *buf != ')' ) ++buf;
+        while ( *buf == ')' ) ++buf;
+        BallT & ball = show.ball_;
+        ball.x_ = strtof( buf, &next ); buf = next;
+        ball.y_ = strtof( buf, &next ); buf = next;
+        ball.vx_ = strtof( buf, &next ); buf = next;
+        ball.vy_ = strtof( buf, &next ); buf = next;
+        while ( *buf == ')' ) ++buf;
         while ( *buf == ' ' ) ++buf;
-        while ( *buf != '\0' && *buf != ' ' ) ++buf;
-        long time = std::strtol( buf, &next, 10 ); buf = next;
 
-        if ( time == LONG_MIN || time == LONG_MAX )
+        if ( ball.vy_ == HUGE_VALF )
         {
             std::cerr << n_line << ": error: "
-                      << " Illegal show info time. "
+                      << " Illegal ball info. "
                       << " \"" << line << "\""
-                      << std::endl;
+                      << std::endl;;
             return false;
         }
+    }
 
-        show.time_ = static_cast< UInt32 >( time );
+    // players
+    // ((side unum) type state x y vx vy body neck [pointx pointy] (v h 90) (s 4000 1 1)[(f side unum)])
+    //              (c 1 1 1 1 1 1 1 1 1 1 1))
+    for ( int i = 0; i < MAX_PLAYER*2; ++i )
+    {
+        if ( *buf == '\0' || *buf == ')' ) break;
 
+        // ((side unum)
         while ( *buf == ' ' ) ++buf;
-
-        //
-        // playmode
-        //
-        if ( ! std::strncmp( buf, "(pm", 3 ) )
+        while ( *buf == '(' ) ++buf;
+        char side = *buf;
+        if ( side != 'l' && side != 'r' )
         {
-            int n_read = 0;
-            int pm = 0;
-            if ( std::sscanf( buf,
-                              " ( pm %d ) %n ",
-                              &pm, &n_read ) == 1 )
-            {
-                buf += n_read;
-                handler.handlePlayMode( time, static_cast< PlayMode >( pm ) );
-            }
+            std::cerr << n_line << ": error: "
+                      << " Illegal player side. " << side << ' ' << i
+                      << " \"" << buf << "\""
+                      << std::endl;;
+            return false;
         }
 
-        //
-        // team
-        //
-        if ( ! std::strncmp( buf, "(tm", 3 ) )
+        ++buf;
+        long unum = std::strtol( buf, &next, 10 ); buf = next;
+        if ( unum < 0 || MAX_PLAYER < unum )
         {
-            char name_l[32], name_r[32];
-            int score_l = 0, score_r = 0;
-            int pen_score_l = 0, pen_miss_l = 0, pen_score_r = 0, pen_miss_r = 0;
+            std::cerr << n_line << ": error: "
+                      << " Illegal player unum. " << side << ' ' << i
+                      << " \"" << buf << "\""
+                      << std::endl;;
+            return false;
+        }
 
-            int n = std::sscanf( buf,
-                                 " ( tm %31s %31s %d %d %d %d %d %d ",
-                                 name_l, name_r,
-                                 &score_l, &score_r,
-                                 &pen_score_l, &pen_miss_l,
-                                 &pen_score_r, &pen_miss_r );
+        while ( *buf == ')' ) ++buf;
 
-            if ( n != 4 && n != 8 )
-            {
-                std::cerr << n_line << ": error: n=" << n << ' '
-                          << "Illegal team info. \"" << line << "\"" << std::endl;;
-                return false;
-            }
-            while ( *buf != ')' && *buf != '\0' ) ++buf;
-            while ( *buf == ')' && *buf != '\0' ) ++buf;
+        const int idx = ( side == 'l' ? unum - 1 : unum - 1 + MAX_PLAYER );
 
-            if ( ! std::strcmp( name_l, "null" ) ) std::memset( name_l, 0, 4 );
-            if ( ! std::strcmp( name_r, "null" ) ) std::memset( name_r, 0, 4 );
+        PlayerT & p = show.player_[idx];
+        p.side_ = side;
+        p.unum_ = static_cast< Int16 >( unum );
 
-            TeamT team_l( name_l, score_l, pen_score_l, pen_miss_l );
-            TeamT team_r( name_r, score_r, pen_score_r, pen_miss_r );
+        // x y vx vy body neck
+        p.type_ = static_cast< Int16 >( std::strtol( buf, &next, 10 ) ); buf = next;
+        p.state_ = static_cast< Int32 >( std::strtol( buf, &next, 16 ) ); buf = next;
+        p.x_ = strtof( buf, &next ); buf = next;
+        p.y_ = strtof( buf, &next ); buf = next;
+        p.vx_ = strtof( buf, &next ); buf = next;
+        p.vy_ = strtof( buf, &next ); buf = next;
+        p.body_ = strtof( buf, &next ); buf = next;
+        p.neck_ = strtof( buf, &next ); buf = next;
+        while ( *buf == ' ' ) ++buf;
 
-            handler.handleTeam( time, team_l, team_r );
+        // arm
+        if ( *buf != '\0' && *buf != '(' )
+        {
+            p.point_x_ = strtof( buf, &next ); buf = next;
+            p.point_y_ = strtof( buf, &next ); buf = next;
         }
 
-        // ball
-        {
-            // ((b) x y vx vy)
-            while ( *buf == ' ' ) ++buf;
-            while ( *buf != '\0' && *buf != ')' ) ++buf;
-            while ( *buf == ')' ) ++buf;
-            BallT & ball = show.ball_;
-            ball.x_ = strtof( buf, &next ); buf = next;
-            ball.y_ = strtof( buf, &next ); buf = next;
-            ball.vx_ = strtof( buf, &next ); buf = next;
-            ball.vy_ = strtof( buf, &next ); buf = next;
-            while ( *buf == ')' ) ++buf;
-            while ( *buf == ' ' ) ++buf;
+        // (v quality width)
+        while ( *buf != '\0' && *buf != 'v' ) ++buf;
+        ++buf; // skip 'v'
+        while ( *buf == ' ' ) ++buf;
+        p.view_quality_ = *buf; ++buf;
+        p.view_width_ = strtof( buf, &next ); buf = next;
+        while ( *buf == ' ' || *buf == ')' ) ++buf;
 
-            if ( ball.vy_ == HUGE_VALF )
-            {
-                std::cerr << n_line << ": error: "
-                          << " Illegal ball info. "
-                          << " \"" << line << "\""
-                          << std::endl;;
-                return false;
-            }
+        // (fp dist dir)
+        // focus point is introduced in the monitor protocol v6
+        if ( ! std::strncmp( buf, "(fp ", 4 ) )
+        {
+            buf += 4;
+            p.focus_dist_ = strtof( buf, &next ); buf = next;
+            p.focus_dir_ = strtof( buf, &next ); buf = next;
+            while ( *buf == ' ' || *buf == ')' ) ++buf;
         }
 
-        // players
-        // ((side unum) type state x y vx vy body neck [pointx pointy] (v h 90) (s 4000 1 1)[(f side unum)])
-        //              (c 1 1 1 1 1 1 1 1 1 1 1))
-        for ( int i = 0; i < MAX_PLAYER*2; ++i )
+        // (s stamina effort recovery[ capacity])
+        // capacity is introduced in the monitor protocol v5
+        while ( *buf != '\0' && *buf != 's' ) ++buf;
+        ++buf; // skip 's' //while ( *buf != '\0' && *buf != ' ' ) ++buf;
+        p.stamina_ = strtof( buf, &next ); buf = next;
+        p.effort_ = strtof( buf, &next ); buf = next;
+        p.recovery_ = strtof( buf, &next ); buf = next;
+        while ( *buf == ' ' ) ++buf;
+        if ( *buf != ')' )
         {
-            if ( *buf == '\0' || *buf == ')' ) break;
-
-            // ((side unum)
-            while ( *buf == ' ' ) ++buf;
-            while ( *buf == '(' ) ++buf;
-            char side = *buf;
-            if ( side != 'l' && side != 'r' )
-            {
-                std::cerr << n_line << ": error: "
-                          << " Illegal player side. " << side << ' ' << i
-                          << " \"" << buf << "\""
-                          << std::endl;;
-                return false;
-            }
-
-            ++buf;
-            long unum = std::strtol( buf, &next, 10 ); buf = next;
-            if ( unum < 0 || MAX_PLAYER < unum )
-            {
-                std::cerr << n_line << ": error: "
-                          << " Illegal player unum. " << side << ' ' << i
-                          << " \"" << buf << "\""
-                          << std::endl;;
-                return false;
-            }
-
-            while ( *buf == ')' ) ++buf;
-
-            const int idx = ( side == 'l' ? unum - 1 : unum - 1 + MAX_PLAYER );
-
-            PlayerT & p = show.player_[idx];
-            p.side_ = side;
-            p.unum_ = static_cast< Int16 >( unum );
-
-            // x y vx vy body neck
-            p.type_ = static_cast< Int16 >( std::strtol( buf, &next, 10 ) ); buf = next;
-            p.state_ = static_cast< Int32 >( std::strtol( buf, &next, 16 ) ); buf = next;
-            p.x_ = strtof( buf, &next ); buf = next;
-            p.y_ = strtof( buf, &next ); buf = next;
-            p.vx_ = strtof( buf, &next ); buf = next;
-            p.vy_ = strtof( buf, &next ); buf = next;
-            p.body_ = strtof( buf, &next ); buf = next;
-            p.neck_ = strtof( buf, &next ); buf = next;
-            while ( *buf == ' ' ) ++buf;
-
-            // arm
-            if ( *buf != '\0' && *buf != '(' )
-            {
-                p.point_x_ = strtof( buf, &next ); buf = next;
-                p.point_y_ = strtof( buf, &next ); buf = next;
-            }
-
-            // (v quality width)
-            while ( *buf != '\0' && *buf != 'v' ) ++buf;
-            ++buf; // skip 'v'
-            while ( *buf == ' ' ) ++buf;
-            p.view_quality_ = *buf; ++buf;
-            p.view_width_ = strtof( buf, &next ); buf = next;
-            while ( *buf == ' ' || *buf == ')' ) ++buf;
+            p.stamina_capacity_ = strtof( buf, &next ); buf = next;
+        }
+        while ( *buf != '\0' && *buf != ')' ) ++buf;
+        while ( *buf == ')' ) ++buf;
 
-            // (fp dist dir)
-            // focus point is introduced in the monitor protocol v6
-            if ( ! std::strncmp( buf, "(fp ", 4 ) )
-            {
-                buf += 4;
-                p.focus_dist_ = strtof( buf, &next ); buf = next;
-                p.focus_dir_ = strtof( buf, &next ); buf = next;
-                while ( *buf == ' ' || *buf == ')' ) ++buf;
-            }
+        while ( *buf != '\0' && *buf != '(' ) ++buf;
 
-            // (s stamina effort recovery[ capacity])
-            // capacity is introduced in the monitor protocol v5
-            while ( *buf != '\0' && *buf != 's' ) ++buf;
-            ++buf; // skip 's' //while ( *buf != '\0' && *buf != ' ' ) ++buf;
-            p.stamina_ = strtof( buf, &next ); buf = next;
-            p.effort_ = strtof( buf, &next ); buf = next;
-            p.recovery_ = strtof( buf, &next ); buf = next;
+        // (f side unum)
+        if ( *(buf + 1) == 'f' )
+        {
+            while ( *buf != '\0' && *buf != ' ' ) ++buf;
             while ( *buf == ' ' ) ++buf;
-            if ( *buf != ')' )
-            {
-                p.stamina_capacity_ = strtof( buf, &next ); buf = next;
-            }
-            while ( *buf != '\0' && *buf != ')' ) ++buf;
-            while ( *buf == ')' ) ++buf;
-
-            while ( *buf != '\0' && *buf != '(' ) ++buf;
-
-            // (f side unum)
-            if ( *(buf + 1) == 'f' )
-            {
-                while ( *buf != '\0' && *buf != ' ' ) ++buf;
-                while ( *buf == ' ' ) ++buf;
-                p.focus_side_ = *buf; ++buf;
-                p.focus_unum_ = static_cast< Int16 >( std::strtol( buf, &next, 10 ) ); buf = next;
-                while ( *buf == ' ' ) ++buf;
-                while ( *buf == ')' ) ++buf;
-                while ( *buf == ' ' ) ++buf;
-            }
-
-            // (c kick dash turn catch move tneck cview say tackle pointto atttention)
-            while ( *buf == '(' ) ++buf;
-            ++buf; // skip 'c' //while ( *buf != '\0' && *buf != ' ' ) ++buf;
-            p.kick_count_ = static_cast< UInt16 >( std::strtol( buf, &next, 10 ) ); buf = next;
-            p.dash_count_ = static_cast< UInt16 >( std::strtol( buf, &next, 10 ) ); buf = next;
-            p.turn_count_ = static_cast< UInt16 >( std::strtol( buf, &next, 10 ) ); buf = next;
-            p.catch_count_ = static_cast< UInt16 >( std::strtol( buf, &next, 10 ) ); buf = next;
-            p.move_count_ = static_cast< UInt16 >( std::strtol( buf, &next, 10 ) ); buf = next;
-            p.turn_neck_count_ = static_cast< UInt16 >( std::strtol( buf, &next, 10 ) ); buf = next;
-            p.change_view_count_ = static_cast< UInt16 >( std::strtol( buf, &next, 10 ) ); buf = next;
-            p.say_count_ = static_cast< UInt16 >( std::strtol( buf, &next, 10 ) ); buf = next;
-            p.tackle_count_ = static_cast< UInt16 >( std::strtol( buf, &next, 10 ) ); buf = next;
-            p.pointto_count_ = static_cast< UInt16 >( std::strtol( buf, &next, 10 ) ); buf = next;
-            p.attentionto_count_ = static_cast< UInt16 >( std::strtol( buf, &next, 10 ) ); buf = next;
+            p.focus_side_ = *buf; ++buf;
+            p.focus_unum_ = static_cast< Int16 >( std::strtol( buf, &next, 10 ) ); buf = next;
             while ( *buf == ' ' ) ++buf;
-            if ( *buf != ')' )
-            {
-                p.change_focus_count_ = static_cast< UInt16 >( std::strtol( buf, &next, 10 ) ); buf = next;
-            }
-
             while ( *buf == ')' ) ++buf;
             while ( *buf == ' ' ) ++buf;
+        }
 
-            if ( *buf == '\0'
-                 && i != MAX_PLAYER*2 - 1 )
-            {
-                std::cerr << n_line << ": error: "
-                          << " Illegal player info. " << side << ' ' << unum
-                          << " \"" << line << "\""
-                          << std::endl;;
-                return false;
-            }
+        // (c kick dash turn catch move tneck cview say tackle pointto atttention)
+        while ( *buf == '(' ) ++buf;
+        ++buf; // skip 'c' //while ( *buf != '\0' && *buf != ' ' ) ++buf;
+        p.kick_count_ = static_cast< UInt16 >( std::strtol( buf, &next, 10 ) ); buf = next;
+        p.dash_count_ = static_cast< UInt16 >( std::strtol( buf, &next, 10 ) ); buf = next;
+        p.turn_count_ = static_cast< UInt16 >( std::strtol( buf, &next, 10 ) ); buf = next;
+        p.catch_count_ = static_cast< UInt16 >( std::strtol( buf, &next, 10 ) ); buf = next;
+        p.move_count_ = static_cast< UInt16 >( std::strtol( buf, &next, 10 ) ); buf = next;
+        p.turn_neck_count_ = static_cast< UInt16 >( std::strtol( buf, &next, 10 ) ); buf = next;
+        p.change_view_count_ = static_cast< UInt16 >( std::strtol( buf, &next, 10 ) ); buf = next;
+        p.say_count_ = static_cast< UInt16 >( std::strtol( buf, &next, 10 ) ); buf = next;
+        p.tackle_count_ = static_cast< UInt16 >( std::strtol( buf, &next, 10 ) ); buf = next;
+        p.pointto_count_ = static_cast< UInt16 >( std::strtol( buf, &next, 10 ) ); buf = next;
+        p.attentionto_count_ = static_cast< UInt16 >( std::strtol( buf, &next, 10 ) ); buf = next;
+        while ( *buf == ' ' ) ++buf;
+        if ( *buf != ')' )
+        {
+            p.change_focus_count_ = static_cast< UInt16 >( std::strtol( buf, &next, 10 ) ); buf = next;
         }
 
-        handler.handleShow( show );
+        while ( *buf == ')' ) ++buf;
+        while ( *buf == ' ' ) ++buf;
+
+        if ( *buf == '\0'
+             && i != MAX_PLAYER*2 - 1 )
+        {
+            std::cerr << n_line << ": error: "
+                      << " Illegal player info. " << side << ' ' << unum
+                      << " \"" << line << "\""
+                      << std::endl;;
+            return false;
+        }
     }
 
+    handler.handleShow( show );
+
     return true;
 }
 
@@ -722,6 +1466,22 @@ ParserV4::parsePlayMode( const int n_line,
     */
 
     int time = 0;
+
+    {
+        const char * buf = line.data();
+        const char * end = buf + line.length();
+        std::string_view pm_string;
+
+        if ( read_paren( buf, end, '(' )
+             && read_keyword( buf, end, "playmode" )
+             && read_int( buf, end, time )
+             && read_word( buf, end, pm_string )
+             && read_paren( buf, end, ')' ) )
+        {
+            return handler.handlePlayMode( time, std::string( pm_string ) );
+        }
+    }
+
     char pm_string[32];
 
     if ( std::sscanf( line.c_str(),
@@ -745,8 +1505,41 @@ ParserV4::parseTeam( const int n_line,
                      const std::string & line,
                      Handler & handler ) const
 {
+    /*
+      (team <Time> <TeamName> <TeamName> <Score> <Score> [<PenScore> <PenMiss> <PenScore> <PenMiss>])
+    */
+
     int time = 0;
     char name_l[32], name_r[32];
+
+    {
+        const char * buf = line.data();
+        const char * end = buf + line.length();
+        int values[6];
+        int n = 0;
+
+        if ( read_paren( buf, end, '(' )
+             && read_keyword( buf, end, "team" )
+             && read_int( buf, end, time )
+             && read_name( buf, end, name_l )
+             && read_name( buf, end, name_r ) )
+        {
+            while ( n < 6 && read_int( buf, end, values[n] ) )
+            {
+                ++n;
+            }
+
+            if ( n == 2 || n == 6 )
+            {
+                TeamT team_l( name_l, values[0], ( n == 6 ? values[2] : 0 ), ( n == 6 ? values[3] : 0 ) );
+                TeamT team_r( name_r, values[1], ( n == 6 ? values[4] : 0 ), ( n == 6 ? values[5] : 0 ) );
+
+                handler.handleTeam( time, team_l, team_r );
+                return true;
+            }
+        }
+    }
+
     int score_l = 0, score_r = 0;
     int pen_score_l = 0, pen_miss_l = 0, pen_score_r = 0, pen_miss_r = 0;
 
@@ -36,6 +36,7 @@
 #include <rcss/rcg/types.h>
 
 #include <string>
+#include <string_view>
 
 namespace rcss {
 namespace rcg {
@@ -69,6 +70,20 @@ public:
     bool parse( std::istream & is,
                 Handler & handler ) const override;
 
+    /*!
+      \brief parse the uncompressed rcg file.
+      \param filepath path to the rcg file.
+      \param handler reference to the rcg data handler.
+      \retval true, if successfuly parsed.
+      \retval false, if incorrect format is detected.
+
+      The file is memory-mapped and split into chunks at line boundaries.
+      Show lines are tokenized by worker threads, but the handler is always
+      called from the caller's thread in the order of lines.
+    */
+    bool parse( const std::string & filepath,
+                Handler & handler ) const override;
+
     /*!
       \brief parse data line.
       \param n_line the number of total read line
@@ -84,6 +99,36 @@ public:
                     const std::string & line,
                     Handler & handler ) const;
 
+    /*!
+      \brief parse data line without copying it.
+      \param n_line the number of total read line
+      \param line the data string. null termination is not required.
+      \param handler reference to the rcg data handler.
+      \retval true, if successfuly parsed.
+      \retval false, if incorrect format is detected.
+
+      Show lines are tokenized in place. Other lines are copied and passed to
+      parseLine( const int, const std::string &, Handler & ).
+    */
+    bool parseLine( const int n_line,
+                    const std::string_view line,
+                    Handler & handler ) const;
+
+    /*!
+      \brief parse null terminated data line without copying it.
+      \param n_line the number of total read line
+      \param line the null terminated data string.
+      \param handler reference to the rcg data handler.
+      \retval true, if successfuly parsed.
+      \retval false, if incorrect format is detected.
+    */
+    bool parseLine( const int n_line,
+                    const char * line,
+                    Handler & handler ) const
+      {
+          return parseLine( n_line, std::string_view( line ), handler );
+      }
+
 protected:
 
     /*!
@@ -91,14 +136,27 @@ protected:
       \param n_line the number of total read line
       \param line the data string
       \param handler reference to the data handler object
-      \retval true if successfully parsed.
-      \retval false if failed to parse.
+      \retval true if successfully parsed or the line is skipped.
+      \retval false if the handler rejected the data.
     */
     virtual
     bool parseShow( const int n_line,
                     const std::string & line,
                     Handler & handler ) const;
 
+    /*!
+      \brief parse SHOW_MODE info by the tolerant strtol/strtof based scanner.
+      This is used as a fallback when parseShow() fails to tokenize the line.
+      \param n_line the number of total read line
+      \param line the data string
+      \param handler reference to the data handler object
+      \retval true if successfully parsed.
+      \retval false if failed to parse.
+    */
+    bool parseShowLegacy( const int n_line,
+                          const std::string & line,
+                          Handler & handler ) const;
+
     /*!
       \brief parse MSG_MODE info(msg_info_t)
       \param n_line the number of total read line
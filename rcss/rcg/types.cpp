@@ -37,11 +37,17 @@
 
 #include "util.h"
 
+#include <algorithm>
+#include <array>
 #include <iostream>
 #include <iomanip>
-#include <map>
-#include <unordered_map>
+#include <iterator>
+#include <limits>
+#include <string_view>
 #include <variant>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
 
 #ifdef HAVE_ARPA_INET_H
@@ -54,10 +60,240 @@
 namespace rcss {
 namespace rcg {
 
-using ParamMap = std::unordered_map< std::string, std::variant< int*, double*, bool*, std::string* > >;
-
 namespace {
 
+/*-------------------------------------------------------------------*/
+/*!
+  \brief pointer to the parameter member variable of T
+*/
+template < typename T >
+using ParamMember = std::variant< int T::*, double T::*, bool T::*, std::string T::* >;
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief parameter name and its member variable
+*/
+template < typename T >
+struct ParamEntry {
+    std::string_view name_;
+    ParamMember< T > member_;
+};
+
+/*-------------------------------------------------------------------*/
+constexpr
+std::size_t
+ceil_pow2( const std::size_t n )
+{
+    std::size_t result = 1;
+    while ( result < n )
+    {
+        result <<= 1;
+    }
+    return result;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief seeded FNV-1a hash for the parameter names
+*/
+constexpr
+std::uint32_t
+param_hash( const std::string_view name,
+            const std::uint32_t seed )
+{
+    std::uint32_t h = 2166136261u ^ ( seed * 0x9e3779b9u );
+    for ( const char c : name )
+    {
+        h ^= static_cast< unsigned char >( c );
+        h *= 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    return h;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief perfect hash table of the parameter entries built at compile time.
+
+  The names are first distributed to the buckets by param_hash( name, 0 ).
+  Then, a seed is searched for each bucket so that all names in the bucket
+  are mapped to free slots (hash and displace).
+  A lookup costs two hash computations and one string comparison.
+*/
+template < typename T, std::size_t N >
+class ParamTable {
+public:
+    static constexpr std::size_t BUCKETS = ceil_pow2( N / 2 + 1 );
+    static constexpr std::size_t SLOTS = ceil_pow2( N * 2 );
+    static constexpr std::uint32_t MAX_SEED = 0xffff;
+
+private:
+    const ParamEntry< T > * entries_;
+    std::array< std::uint16_t, BUCKETS > seeds_;
+    std::array< std::int16_t, SLOTS > slots_;
+    std::array< std::uint16_t, N > sorted_; //!< entry indices sorted by name
+    bool valid_;
+
+public:
+
+    constexpr
+    explicit
+    ParamTable( const ParamEntry< T > ( &entries )[N] )
+        : entries_( entries ),
+          seeds_{},
+          slots_{},
+          sorted_{},
+          valid_( true )
+      {
+          for ( std::size_t s = 0; s < SLOTS; ++s )
+          {
+              slots_[s] = -1;
+          }
+
+          // sort by name. the printed messages are ordered by this.
+          for ( std::size_t i = 0; i < N; ++i )
+          {
+              std::size_t j = i;
+              while ( j > 0 && entries[i].name_ < entries[sorted_[j - 1]].name_ )
+              {
+                  sorted_[j] = sorted_[j - 1];
+                  --j;
+              }
+              sorted_[j] = static_cast< std::uint16_t >( i );
+          }
+
+          for ( std::size_t i = 1; i < N; ++i )
+          {
+              if ( entries[sorted_[i - 1]].name_ == entries[sorted_[i]].name_ )
+              {
+                  valid_ = false;
+                  return;
+              }
+          }
+
+          std::size_t bucket_size[BUCKETS] = {};
+          std::size_t max_bucket_size = 0;
+          for ( std::size_t i = 0; i < N; ++i )
+          {
+              const std::size_t b = param_hash( entries[i].name_, 0 ) & ( BUCKETS - 1 );
+              bucket_size[b] += 1;
+              max_bucket_size = std::max( max_bucket_size, bucket_size[b] );
+          }
+
+          // place the larger buckets first
+          for ( std::size_t size = max_bucket_size; size > 0; --size )
+          {
+              for ( std::size_t b = 0; b < BUCKETS; ++b )
+              {
+                  if ( bucket_size[b] != size )
+                  {
+                      continue;
+                  }
+
+                  std::size_t keys[N] = {};
+                  std::size_t n_keys = 0;
+                  for ( std::size_t i = 0; i < N; ++i )
+                  {
+                      if ( ( param_hash( entries[i].name_, 0 ) & ( BUCKETS - 1 ) ) == b )
+                      {
+                          keys[n_keys++] = i;
+                      }
+                  }
+
+                  if ( ! placeBucket( b, keys, n_keys ) )
+                  {
+                      valid_ = false;
+                      return;
+                  }
+              }
+          }
+      }
+
+    constexpr
+    bool valid() const
+      {
+          return valid_;
+      }
+
+    constexpr
+    std::size_t size() const
+      {
+          return N;
+      }
+
+    /*!
+      \brief get the entry by the sorted order
+     */
+    const ParamEntry< T > & sorted( const std::size_t i ) const
+      {
+          return entries_[sorted_[i]];
+      }
+
+    const ParamEntry< T > * begin() const
+      {
+          return entries_;
+      }
+
+    const ParamEntry< T > * end() const
+      {
+          return entries_ + N;
+      }
+
+    /*!
+      \brief find the entry by the parameter name
+      \return pointer to the entry, or nullptr if not found
+     */
+    const ParamEntry< T > * find( const std::string_view name ) const
+      {
+          const std::uint32_t seed = seeds_[param_hash( name, 0 ) & ( BUCKETS - 1 )];
+          const int index = slots_[param_hash( name, seed ) & ( SLOTS - 1 )];
+          if ( index < 0
+               || entries_[index].name_ != name )
+          {
+              return nullptr;
+          }
+          return entries_ + index;
+      }
+
+private:
+
+    constexpr
+    bool placeBucket( const std::size_t bucket,
+                      const std::size_t * keys,
+                      const std::size_t n_keys )
+      {
+          for ( std::uint32_t seed = 1; seed <= MAX_SEED; ++seed )
+          {
+              std::size_t placed = 0;
+              while ( placed < n_keys )
+              {
+                  const std::size_t s = param_hash( entries_[keys[placed]].name_, seed ) & ( SLOTS - 1 );
+                  if ( slots_[s] >= 0 )
+                  {
+                      break;
+                  }
+                  slots_[s] = static_cast< std::int16_t >( keys[placed] );
+                  ++placed;
+              }
+
+              if ( placed == n_keys )
+              {
+                  seeds_[bucket] = static_cast< std::uint16_t >( seed );
+                  return true;
+              }
+
+              // rollback
+              for ( std::size_t i = 0; i < placed; ++i )
+              {
+                  slots_[param_hash( entries_[keys[i]].name_, seed ) & ( SLOTS - 1 )] = -1;
+              }
+          }
+          return false;
+      }
+};
+
 /*-------------------------------------------------------------------*/
 inline
 float
@@ -140,58 +376,121 @@ clean_string( std::string str )
     return str;
 }
 
+/*-------------------------------------------------------------------*/
+/*!
+  \brief copy the value string to the null terminated buffer for strtol/strtod
+*/
+template < std::size_t SIZE >
+bool
+copy_value( const std::string_view value,
+            char ( &buf )[SIZE] )
+{
+    if ( value.length() >= SIZE )
+    {
+        return false;
+    }
+
+    std::memcpy( buf, value.data(), value.length() );
+    buf[value.length()] = '\0';
+    return true;
+}
+
+/*-------------------------------------------------------------------*/
+bool
+parse_integer( const std::string_view value,
+               int * result )
+{
+    char buf[64];
+    if ( ! copy_value( value, buf ) )
+    {
+        return false;
+    }
+
+    char * end = nullptr;
+    errno = 0;
+    const long v = std::strtol( buf, &end, 10 );
+    if ( end == buf
+         || errno == ERANGE
+         || v < std::numeric_limits< int >::min()
+         || std::numeric_limits< int >::max() < v )
+    {
+        return false;
+    }
+
+    *result = static_cast< int >( v );
+    return true;
+}
+
 /*-------------------------------------------------------------------*/
 bool
-set_value( const std::string & param_name,
-           const std::string & name,
-           const std::string & value,
-           ParamMap & param_map )
+parse_double( const std::string_view value,
+              double * result )
 {
-    ParamMap::iterator it = param_map.find( name );
-    if ( it != param_map.end() )
+    char buf[64];
+    if ( ! copy_value( value, buf ) )
     {
-        int ** int_ptr = std::get_if< int * >( &it->second );
-        if ( int_ptr )
+        return false;
+    }
+
+    char * end = nullptr;
+    errno = 0;
+    const double v = std::strtod( buf, &end );
+    if ( end == buf
+         || errno == ERANGE )
+    {
+        return false;
+    }
+
+    *result = v;
+    return true;
+}
+
+/*-------------------------------------------------------------------*/
+template < typename T, std::size_t N >
+bool
+set_value( const std::string_view param_name,
+           const std::string_view name,
+           const std::string_view value,
+           const ParamTable< T, N > & table,
+           T & param )
+{
+    const ParamEntry< T > * entry = table.find( name );
+    if ( entry )
+    {
+        int T::* const * int_member = std::get_if< int T::* >( &entry->member_ );
+        if ( int_member )
         {
-            try
-            {
-                **int_ptr = std::stoi( value );
-                return true;
-            }
-            catch ( std::exception & e )
+            if ( ! parse_integer( value, &( param.*( *int_member ) ) ) )
             {
-                std::cerr << e.what()
-                          << ' ' << param_name << " (" << name << ' ' << value << ')' << std::endl;
+                std::cerr << "Illegal integer value. "
+                          << param_name << " (" << name << ' ' << value << ')' << std::endl;
                 return false;
             }
+            return true;
         }
 
-        double ** double_ptr = std::get_if< double * >( &it->second );
-        if ( double_ptr )
+        double T::* const * double_member = std::get_if< double T::* >( &entry->member_ );
+        if ( double_member )
         {
-            try
-            {
-                **double_ptr = std::stod( value );
-            }
-            catch ( std::exception & e )
+            if ( ! parse_double( value, &( param.*( *double_member ) ) ) )
             {
-                std::cerr << e.what()
-                          << ' ' << param_name << " (" << name << ' ' << value << ')' << std::endl;
+                std::cerr << "Illegal double value. "
+                          << param_name << " (" << name << ' ' << value << ')' << std::endl;
                 return false;
             }
             return true;
         }
 
-        bool ** bool_ptr = std::get_if< bool * >( &it->second );
-        if ( bool_ptr )
+        bool T::* const * bool_member = std::get_if< bool T::* >( &entry->member_ );
+        if ( bool_member )
         {
             if ( value == "0" || value == "false" || value == "off" )
             {
-                **bool_ptr = false;
+                param.*( *bool_member ) = false;
             }
             else if ( value == "1" || value == "true" || value == "on" )
             {
-                **bool_ptr = true;
+                param.*( *bool_member ) = true;
             }
             else
             {
@@ -200,10 +499,10 @@ set_value( const std::string & param_name,
             return true;
         }
 
-        std::string ** string_ptr = std::get_if< std::string * >( &it->second );
-        if ( string_ptr )
+        std::string T::* const * string_member = std::get_if< std::string T::* >( &entry->member_ );
+        if ( string_member )
         {
-            **string_ptr = clean_string( value );
+            param.*( *string_member ) = clean_string( std::string( value ) );
             return true;
         }
     }
@@ -213,32 +512,34 @@ set_value( const std::string & param_name,
 }
 
 /*-------------------------------------------------------------------*/
+template < typename T, std::size_t N >
 bool
-set_integer( const std::string & name,
+set_integer( const std::string_view name,
              const int value,
-             ParamMap & param_map )
+             const ParamTable< T, N > & table,
+             T & param )
 {
-    ParamMap::iterator it = param_map.find( name );
-    if ( it != param_map.end() )
+    const ParamEntry< T > * entry = table.find( name );
+    if ( entry )
     {
-        int ** int_ptr = std::get_if< int * >( &it->second );
-        if ( int_ptr )
+        int T::* const * int_member = std::get_if< int T::* >( &entry->member_ );
+        if ( int_member )
         {
-            **int_ptr = value;
+            param.*( *int_member ) = value;
             return true;
         }
 
-        double ** double_ptr = std::get_if< double * >( &it->second );
-        if ( double_ptr )
+        double T::* const * double_member = std::get_if< double T::* >( &entry->member_ );
+        if ( double_member )
         {
-            **double_ptr = static_cast< double >( value );
+            param.*( *double_member ) = static_cast< double >( value );
             return true;
         }
 
-        bool ** bool_ptr = std::get_if< bool * >( &it->second );
-        if ( bool_ptr )
+        bool T::* const * bool_member = std::get_if< bool T::* >( &entry->member_ );
+        if ( bool_member )
         {
-            **bool_ptr = ( value == 0 ? false : true );
+            param.*( *bool_member ) = ( value == 0 ? false : true );
             return true;
         }
     }
@@ -248,18 +549,20 @@ set_integer( const std::string & name,
 }
 
 /*-------------------------------------------------------------------*/
+template < typename T, std::size_t N >
 bool
-set_double( const std::string & name,
+set_double( const std::string_view name,
             const double value,
-            ParamMap & param_map )
+            const ParamTable< T, N > & table,
+            T & param )
 {
-    ParamMap::iterator it = param_map.find( name );
-    if ( it != param_map.end() )
+    const ParamEntry< T > * entry = table.find( name );
+    if ( entry )
     {
-        double ** double_ptr = std::get_if< double * >( &it->second );
-        if ( double_ptr )
+        double T::* const * double_member = std::get_if< double T::* >( &entry->member_ );
+        if ( double_member )
         {
-            **double_ptr = value;
+            param.*( *double_member ) = value;
             return true;
         }
     }
@@ -269,18 +572,20 @@ set_double( const std::string & name,
 }
 
 /*-------------------------------------------------------------------*/
+template < typename T, std::size_t N >
 bool
-set_boolean( const std::string & name,
+set_boolean( const std::string_view name,
              const bool value,
-             ParamMap & param_map )
+             const ParamTable< T, N > & table,
+             T & param )
 {
-    ParamMap::iterator it = param_map.find( name );
-    if ( it != param_map.end() )
+    const ParamEntry< T > * entry = table.find( name );
+    if ( entry )
     {
-        bool ** bool_ptr = std::get_if< bool * >( &it->second );
-        if ( bool_ptr )
+        bool T::* const * bool_member = std::get_if< bool T::* >( &entry->member_ );
+        if ( bool_member )
         {
-            **bool_ptr = value;
+            param.*( *bool_member ) = value;
             return true;
         }
     }
@@ -290,18 +595,20 @@ set_boolean( const std::string & name,
 }
 
 /*-------------------------------------------------------------------*/
+template < typename T, std::size_t N >
 bool
-set_string( const std::string & name,
+set_string( const std::string_view name,
             const std::string & value,
-            ParamMap & param_map )
+            const ParamTable< T, N > & table,
+            T & param )
 {
-    ParamMap::iterator it = param_map.find( name );
-    if ( it != param_map.end() )
+    const ParamEntry< T > * entry = table.find( name );
+    if ( entry )
     {
-        std::string ** string_ptr = std::get_if< std::string * >( &it->second );
-        if ( string_ptr )
+        std::string T::* const * string_member = std::get_if< std::string T::* >( &entry->member_ );
+        if ( string_member )
         {
-            **string_ptr = value;
+            param.*( *string_member ) = value;
             return true;
         }
     }
@@ -311,9 +618,11 @@ set_string( const std::string & name,
 }
 
 /*-------------------------------------------------------------------*/
+template < typename T, std::size_t N >
 bool
 parse_server_message( const std::string & msg,
-                      ParamMap & param_map )
+                      const ParamTable< T, N > & table,
+                      T & param )
 {
     int n_read = 0;
 
@@ -340,7 +649,7 @@ parse_server_message( const std::string & msg,
         }
         pos += 1;
 
-        const std::string name_str( msg, pos, end_pos - pos );
+        const std::string_view name_str( msg.data() + pos, end_pos - pos );
 
         pos = end_pos; // pos indcates the position of the white space after the param name
 
@@ -373,13 +682,13 @@ parse_server_message( const std::string & msg,
         // pos indicates the first position of the value string
         // end_pos indicates the position of the end of paren
 
-        const std::string value_str( msg, pos, end_pos - pos );
+        const std::string_view value_str( msg.data() + pos, end_pos - pos );
         pos = end_pos;
 
         // pos indicates the position of the end of paren
 
-        // set the value to the parameter map
-        set_value( msg, name_str, value_str, param_map );
+        // set the value to the parameter variable
+        set_value( msg, name_str, value_str, table, param );
     }
 
     return true;
@@ -387,52 +696,53 @@ parse_server_message( const std::string & msg,
 
 /*-------------------------------------------------------------------*/
 /*!
-  \brief visitor function to print the parameter variables stored as std::variant
+  \brief visitor function to print the parameter variables pointed by std::variant
 */
+template < typename T >
 struct ValuePrinter {
     std::ostream & os_;
+    const T & param_;
 
-    ValuePrinter( std::ostream & os )
-        : os_( os )
+    ValuePrinter( std::ostream & os,
+                  const T & param )
+        : os_( os ),
+          param_( param )
       { }
 
-    std::ostream & operator()( const int * v )
+    std::ostream & operator()( int T::* v )
       {
-          return os_ << *v;
+          return os_ << param_.*v;
       }
-    std::ostream & operator()( const double * v )
+    std::ostream & operator()( double T::* v )
       {
-          return os_ << *v;
+          return os_ << param_.*v;
       }
-    std::ostream & operator()( const bool * v )
+    std::ostream & operator()( bool T::* v )
       {
-          return os_ << std::boolalpha << *v;
+          return os_ << std::boolalpha << param_.*v;
       }
-    std::ostream & operator()( const std::string * v )
+    std::ostream & operator()( std::string T::* v )
       {
-          return os_ << std::quoted( *v );
+          return os_ << std::quoted( param_.*v );
       }
 };
 
 /*-------------------------------------------------------------------*/
+template < typename T, std::size_t N >
 std::ostream &
 print_server_message( std::ostream & os,
                       const std::string & message_name,
-                      const ParamMap & param_map )
+                      const ParamTable< T, N > & table,
+                      const T & param )
 {
-    std::map< ParamMap::key_type, ParamMap::mapped_type > sorted_map;
-    for ( const ParamMap::value_type & v : param_map )
-    {
-        sorted_map.insert( v );
-    }
-
     os << '(' << message_name << ' ';
 
-    ValuePrinter printer( os );
-    for ( const decltype( sorted_map )::value_type & v : sorted_map )
+    ValuePrinter< T > printer( os, param );
+    for ( std::size_t i = 0; i < table.size(); ++i )
     {
-        os << '(' << v.first << ' ';
-        std::visit( printer, v.second );
+        const ParamEntry< T > & v = table.sorted( i );
+        os << '(' << v.name_ << ' ';
+        std::visit( printer, v.member_ );
         os << ')';
     }
 
@@ -442,78 +752,65 @@ print_server_message( std::ostream & os,
 }
 
 /*-------------------------------------------------------------------*/
+template < typename T, std::size_t N >
 std::ostream &
 print_json( std::ostream & os,
             const std::string & message_name,
-            const ParamMap & param_map )
+            const ParamTable< T, N > & table,
+            const T & param )
 {
-    std::map< ParamMap::key_type, ParamMap::mapped_type > sorted_map;
-    for ( const ParamMap::value_type & v : param_map )
-    {
-        sorted_map.insert( v );
-    }
-
     os << '{' << std::quoted( message_name ) << ':' << '{';
 
-    ValuePrinter printer( os );
+    ValuePrinter< T > printer( os, param );
     bool first = true;
-    for ( const decltype( sorted_map )::value_type & v : sorted_map )
+    for ( std::size_t i = 0; i < table.size(); ++i )
     {
+        const ParamEntry< T > & v = table.sorted( i );
         if ( first ) first = false; else os << ',';
-        os << std::quoted( v.first ) << ':';
-        std::visit( printer, v.second );
+        os << std::quoted( v.name_ ) << ':';
+        std::visit( printer, v.member_ );
     }
 
     os << '}' << '}';
     return os;
 }
 
-
-
 /*-------------------------------------------------------------------*/
+/*!
+  \brief visitor function to copy the parameter variables pointed by std::variant
+*/
+template < typename T >
 struct ValueSetter {
+    T & to_;
+    const T & from_;
 
-    ValueSetter()
+    ValueSetter( T & to,
+                 const T & from )
+        : to_( to ),
+          from_( from )
       { }
 
-    void operator()( const int * s,
-                     int * t )
-      {
-          *t = *s;
-      }
-    void operator()( const int *, double * ) { }
-    void operator()( const int *, bool * ) { }
-    void operator()( const int *, std::string * ) { }
-
-    void operator()( const double * s,
-                     double * t )
-      {
-          *t = *s;
-      }
-    void operator()( const double *, int * ) {}
-    void operator()( const double *, bool * ) {}
-    void operator()( const double *, std::string * ) {}
-
-    void operator()( const bool * s,
-                     bool * t )
-      {
-          *t = *s;
-      }
-    void operator()( const bool *, int * ) {}
-    void operator()( const bool *, double * ) {}
-    void operator()( const bool *, std::string * ) {}
-
-    void operator()( const std::string * s,
-                     std::string * t )
+    template < typename V >
+    void operator()( V T::* v )
       {
-          *t = *s;
+          to_.*v = from_.*v;
       }
-    void operator()( const std::string *, int * ) {}
-    void operator()( const std::string *, double * ) {}
-    void operator()( const std::string *, bool * ) {}
-
 };
 
+/*-------------------------------------------------------------------*/
+template < typename T, std::size_t N >
+void
+copy_params( const ParamTable< T, N > & table,
+             const T & from,
+             T & to )
+{
+    ValueSetter< T > setter( to, from );
+    for ( const ParamEntry< T > & v : table )
+    {
+        std::visit( setter, v.member_ );
+    }
+}
+
 }
 
 /*-------------------------------------------------------------------*/
@@ -537,12 +834,240 @@ TeamT::TeamT( const team_t & from )
 /*-------------------------------------------------------------------*/
 
 /*-------------------------------------------------------------------*/
-struct ServerParamT::Impl {
-    ParamMap param_map_;
+namespace {
 
-    Impl( ServerParamT * param );
+/*-------------------------------------------------------------------*/
+constexpr ParamEntry< ServerParamT > server_param_entries[] = {
+    { "goal_width", &ServerParamT::goal_width_ },
+    { "inertia_moment", &ServerParamT::inertia_moment_ },
+    { "player_size", &ServerParamT::player_size_ },
+    { "player_decay", &ServerParamT::player_decay_ },
+    { "player_rand", &ServerParamT::player_rand_ },
+    { "player_weight", &ServerParamT::player_weight_ },
+    { "player_speed_max", &ServerParamT::player_speed_max_ },
+    { "player_accel_max", &ServerParamT::player_accel_max_ },
+    { "stamina_max", &ServerParamT::stamina_max_ },
+    { "stamina_inc_max", &ServerParamT::stamina_inc_max_ },
+    { "recover_init", &ServerParamT::recover_init_ }, // not necessary
+    { "recover_dec_thr", &ServerParamT::recover_dec_thr_ },
+    { "recover_min", &ServerParamT::recover_min_ },
+    { "recover_dec", &ServerParamT::recover_dec_ },
+    { "effort_init", &ServerParamT::effort_init_ },
+    { "effort_dec_thr", &ServerParamT::effort_dec_thr_ },
+    { "effort_min", &ServerParamT::effort_min_ },
+    { "effort_dec", &ServerParamT::effort_dec_ },
+    { "effort_inc_thr", &ServerParamT::effort_inc_thr_ },
+    { "effort_inc", &ServerParamT::effort_inc_ },
+    { "kick_rand", &ServerParamT::kick_rand_ },
+    { "team_actuator_noise", &ServerParamT::team_actuator_noise_ },
+    { "prand_factor_l", &ServerParamT::player_rand_factor_l_ },
+    { "prand_factor_r", &ServerParamT::player_rand_factor_r_ },
+    { "kick_rand_factor_l", &ServerParamT::kick_rand_factor_l_ },
+    { "kick_rand_factor_r", &ServerParamT::kick_rand_factor_r_ },
+    { "ball_size", &ServerParamT::ball_size_ },
+    { "ball_decay", &ServerParamT::ball_decay_ },
+    { "ball_rand", &ServerParamT::ball_rand_ },
+    { "ball_weight", &ServerParamT::ball_weight_ },
+    { "ball_speed_max", &ServerParamT::ball_speed_max_ },
+    { "ball_accel_max", &ServerParamT::ball_accel_max_ },
+    { "dash_power_rate", &ServerParamT::dash_power_rate_ },
+    { "kick_power_rate", &ServerParamT::kick_power_rate_ },
+    { "kickable_margin", &ServerParamT::kickable_margin_ },
+    { "control_radius", &ServerParamT::control_radius_ },
+    //( "control_radius_width", &(p->control_radius_width_ ) ) );
+    // { "kickable_area", &ServerParamT::kickable_area_ }, // not needed
+    { "catch_probability", &ServerParamT::catch_probability_ },
+    { "catchable_area_l", &ServerParamT::catchable_area_l_ },
+    { "catchable_area_w", &ServerParamT::catchable_area_w_ },
+    { "goalie_max_moves", &ServerParamT::goalie_max_moves_ },
+    { "maxpower", &ServerParamT::max_power_ },
+    { "minpower", &ServerParamT::min_power_ },
+    { "maxmoment", &ServerParamT::max_moment_ },
+    { "minmoment", &ServerParamT::min_moment_ },
+    { "maxneckmoment", &ServerParamT::max_neck_moment_ },
+    { "minneckmoment", &ServerParamT::min_neck_moment_ },
+    { "maxneckang", &ServerParamT::max_neck_angle_ },
+    { "minneckang", &ServerParamT::min_neck_angle_ },
+    { "visible_angle", &ServerParamT::visible_angle_ },
+    { "visible_distance", &ServerParamT::visible_distance_ },
+    { "audio_cut_dist", &ServerParamT::audio_cut_dist_ },
+    { "quantize_step", &ServerParamT::dist_quantize_step_ },
+    { "quantize_step_l", &ServerParamT::landmark_dist_quantize_step_ },
+    //( "quantize_step_dir", &(p->dir_quantize_step_ ) ) );
+    //( "quantize_step_dist_team_l", &(p->dist_quantize_step_l_ ) ) );
+    //( "quantize_step_dist_team_r", &(p->dist_quantize_step_r_ ) ) );
+    //( "quantize_step_dist_l_team_l", &(p->landmark_dist_quantize_step_l_ ) ) );
+    //( "quantize_step_dist_l_team_r", &(p->landmark_dist_quantize_step_r_ ) ) );
+    //( "quantize_step_dir_team_l", &(p->dir_quantize_step_l_ ) ) );
+    //( "quantize_step_dir_team_r", &(p->dir_quantize_step_r_ ) ) );
+    { "ckick_margin", &ServerParamT::corner_kick_margin_ },
+    { "wind_dir", &ServerParamT::wind_dir_ },
+    { "wind_force", &ServerParamT::wind_force_ },
+    { "wind_ang", &ServerParamT::wind_angle_ },
+    { "wind_rand", &ServerParamT::wind_rand_ },
+    { "wind_none", &ServerParamT::wind_none_ },
+    { "wind_random", &ServerParamT::use_wind_random_ },
+    { "half_time", &ServerParamT::half_time_ },
+    { "drop_ball_time", &ServerParamT::drop_ball_time_ },
+    { "port", &ServerParamT::port_ },
+    { "coach_port", &ServerParamT::coach_port_ },
+    { "olcoach_port", &ServerParamT::online_coach_port_ },
+    { "say_coach_cnt_max", &ServerParamT::coach_say_count_max_ },
+    { "say_coach_msg_size", &ServerParamT::coach_say_msg_size_ },
+    { "simulator_step", &ServerParamT::simulator_step_ },
+    { "send_step", &ServerParamT::send_step_ },
+    { "recv_step", &ServerParamT::recv_step_ },
+    { "sense_body_step", &ServerParamT::sense_body_step_ },
+    // { "lcm_step", &ServerParamT::lcm_step_ }, // not needed
+    { "say_msg_size", &ServerParamT::player_say_msg_size_ },
+    { "clang_win_size", &ServerParamT::clang_win_size_ },
+    { "clang_define_win", &ServerParamT::clang_define_win_ },
+    { "clang_meta_win", &ServerParamT::clang_meta_win_ },
+    { "clang_advice_win", &ServerParamT::clang_advice_win_ },
+    { "clang_info_win", &ServerParamT::clang_info_win_ },
+    { "clang_del_win", &ServerParamT::clang_del_win_ },
+    { "clang_rule_win", &ServerParamT::clang_rule_win_ },
+    { "clang_mess_delay", &ServerParamT::clang_mess_delay_ },
+    { "clang_mess_per_cycle", &ServerParamT::clang_mess_per_cycle_ },
+    { "hear_max", &ServerParamT::player_hear_max_ },
+    { "hear_inc", &ServerParamT::player_hear_inc_ },
+    { "hear_decay", &ServerParamT::player_hear_decay_ },
+    { "catch_ban_cycle", &ServerParamT::catch_ban_cycle_ },
+    { "coach", &ServerParamT::coach_mode_ },
+    { "coach_w_referee", &ServerParamT::coach_with_referee_mode_ },
+    { "old_coach_hear", &ServerParamT::use_old_coach_hear_ },
+    { "send_vi_step", &ServerParamT::online_coach_look_step_ },
+    { "use_offside", &ServerParamT::use_offside_ },
+    { "offside_kick_margin", &ServerParamT::offside_kick_margin_ },
+    { "forbid_kick_off_offside", &ServerParamT::kickoff_offside_ },
+    { "verbose", &ServerParamT::verbose_ },
+    { "offside_active_area_size", &ServerParamT::offside_active_area_size_ },
+    { "slow_down_factor", &ServerParamT::slow_down_factor_ },
+    { "synch_mode", &ServerParamT::synch_mode_ },
+    { "synch_offset", &ServerParamT::synch_offset_ },
+    { "synch_micro_sleep", &ServerParamT::synch_micro_sleep_ },
+    { "start_goal_l", &ServerParamT::start_goal_l_ },
+    { "start_goal_r", &ServerParamT::start_goal_r_ },
+    { "fullstate_l", &ServerParamT::fullstate_l_ },
+    { "fullstate_r", &ServerParamT::fullstate_r_ },
+    { "slowness_on_top_for_left_team", &ServerParamT::slowness_on_top_for_left_team_ },
+    { "slowness_on_top_for_right_team", &ServerParamT::slowness_on_top_for_right_team_ },
+    { "landmark_file", &ServerParamT::landmark_file_ },
+    { "send_comms", &ServerParamT::send_comms_ },
+    { "text_logging", &ServerParamT::text_logging_ },
+    { "game_logging", &ServerParamT::game_logging_ },
+    { "game_log_version", &ServerParamT::game_log_version_ },
+    { "text_log_dir", &ServerParamT::text_log_dir_ },
+    { "game_log_dir", &ServerParamT::game_log_dir_ },
+    { "text_log_fixed_name", &ServerParamT::text_log_fixed_name_ },
+    { "game_log_fixed_name", &ServerParamT::game_log_fixed_name_ },
+    { "text_log_fixed", &ServerParamT::text_log_fixed_ },
+    { "game_log_fixed", &ServerParamT::game_log_fixed_ },
+    { "text_log_dated", &ServerParamT::text_log_dated_ },
+    { "game_log_dated", &ServerParamT::game_log_dated_ },
+    { "log_date_format", &ServerParamT::log_date_format_ },
+    { "log_times", &ServerParamT::log_times_ },
+    { "record_messages", &ServerParamT::record_messages_ },
+    { "text_log_compression", &ServerParamT::text_log_compression_ },
+    { "game_log_compression", &ServerParamT::game_log_compression_ },
+    { "profile", &ServerParamT::profile_ },
+    { "point_to_ban", &ServerParamT::point_to_ban_ },
+    { "point_to_duration", &ServerParamT::point_to_duration_ },
+    { "tackle_dist", &ServerParamT::tackle_dist_ },
+    { "tackle_back_dist", &ServerParamT::tackle_back_dist_ },
+    { "tackle_width", &ServerParamT::tackle_width_ },
+    { "tackle_exponent", &ServerParamT::tackle_exponent_ },
+    { "tackle_cycles", &ServerParamT::tackle_cycles_ },
+    { "tackle_power_rate", &ServerParamT::tackle_power_rate_ },
+    { "freeform_wait_period", &ServerParamT::freeform_wait_period_ },
+    { "freeform_send_period", &ServerParamT::freeform_send_period_ },
+    { "free_kick_faults", &ServerParamT::free_kick_faults_ },
+    { "back_passes", &ServerParamT::back_passes_ },
+    { "proper_goal_kicks", &ServerParamT::proper_goal_kicks_ },
+    { "stopped_ball_vel", &ServerParamT::stopped_ball_vel_ },
+    { "max_goal_kicks", &ServerParamT::max_goal_kicks_ },
+    { "auto_mode", &ServerParamT::auto_mode_ },
+    { "kick_off_wait", &ServerParamT::kick_off_wait_ },
+    { "connect_wait", &ServerParamT::connect_wait_ },
+    { "game_over_wait", &ServerParamT::game_over_wait_ },
+    { "team_l_start", &ServerParamT::team_l_start_ },
+    { "team_r_start", &ServerParamT::team_r_start_ },
+    { "keepaway", &ServerParamT::keepaway_mode_ },
+    { "keepaway_length", &ServerParamT::keepaway_length_ },
+    { "keepaway_width", &ServerParamT::keepaway_width_ },
+    { "keepaway_logging", &ServerParamT::keepaway_logging_ },
+    { "keepaway_log_dir", &ServerParamT::keepaway_log_dir_ },
+    { "keepaway_log_fixed_name", &ServerParamT::keepaway_log_fixed_name_ },
+    { "keepaway_log_fixed", &ServerParamT::keepaway_log_fixed_ },
+    { "keepaway_log_dated", &ServerParamT::keepaway_log_dated_ },
+    { "keepaway_start", &ServerParamT::keepaway_start_ },
+    { "nr_normal_halfs", &ServerParamT::nr_normal_halfs_ },
+    { "nr_extra_halfs", &ServerParamT::nr_extra_halfs_ },
+    { "penalty_shoot_outs", &ServerParamT::penalty_shoot_outs_ },
+    { "pen_before_setup_wait", &ServerParamT::pen_before_setup_wait_ },
+    { "pen_setup_wait", &ServerParamT::pen_setup_wait_ },
+    { "pen_ready_wait", &ServerParamT::pen_ready_wait_ },
+    { "pen_taken_wait", &ServerParamT::pen_taken_wait_ },
+    { "pen_nr_kicks", &ServerParamT::pen_nr_kicks_ },
+    { "pen_max_extra_kicks", &ServerParamT::pen_max_extra_kicks_ },
+    { "pen_dist_x", &ServerParamT::pen_dist_x_ },
+    { "pen_random_winner", &ServerParamT::pen_random_winner_ },
+    { "pen_max_goalie_dist_x", &ServerParamT::pen_max_goalie_dist_x_ },
+    { "pen_allow_mult_kicks", &ServerParamT::pen_allow_mult_kicks_ },
+    { "pen_coach_moves_players", &ServerParamT::pen_coach_moves_players_ },
+    // v11
+    { "ball_stuck_area", &ServerParamT::ball_stuck_area_ },
+    { "coach_msg_file", &ServerParamT::coach_msg_file_ },
+    // v12
+    { "max_tackle_power", &ServerParamT::max_tackle_power_ },
+    { "max_back_tackle_power", &ServerParamT::max_back_tackle_power_ },
+    { "player_speed_max_min", &ServerParamT::player_speed_max_min_ },
+    { "extra_stamina", &ServerParamT::extra_stamina_ },
+    { "synch_see_offset", &ServerParamT::synch_see_offset_ },
+    { "max_monitors", &ServerParamT::max_monitors_ },
+    // v12.1.3
+    { "extra_half_time", &ServerParamT::extra_half_time_ },
+    // v13
+    { "stamina_capacity", &ServerParamT::stamina_capacity_ },
+    { "max_dash_angle", &ServerParamT::max_dash_angle_ },
+    { "min_dash_angle", &ServerParamT::min_dash_angle_ },
+    { "dash_angle_step", &ServerParamT::dash_angle_step_ },
+    { "side_dash_rate", &ServerParamT::side_dash_rate_ },
+    { "back_dash_rate", &ServerParamT::back_dash_rate_ },
+    { "max_dash_power", &ServerParamT::max_dash_power_ },
+    { "min_dash_power", &ServerParamT::min_dash_power_ },
+    // 14.0.0
+    { "tackle_rand_factor", &ServerParamT::tackle_rand_factor_ },
+    { "foul_detect_probability", &ServerParamT::foul_detect_probability_ },
+    { "foul_exponent", &ServerParamT::foul_exponent_ },
+    { "foul_cycles", &ServerParamT::foul_cycles_ },
+    { "golden_goal", &ServerParamT::golden_goal_ },
+    // 15.0
+    { "red_card_probability", &ServerParamT::red_card_probability_ },
+    // 16.0
+    { "illegal_defense_duration", &ServerParamT::illegal_defense_duration_ },
+    { "illegal_defense_number", &ServerParamT::illegal_defense_number_ },
+    { "illegal_defense_dist_x", &ServerParamT::illegal_defense_dist_x_ },
+    { "illegal_defense_width", &ServerParamT::illegal_defense_width_ },
+    { "fixed_teamname_l", &ServerParamT::fixed_teamname_l_ },
+    { "fixed_teamname_r", &ServerParamT::fixed_teamname_r_ },
+    // 17.0
+    { "max_catch_angle", &ServerParamT::max_catch_angle_ },
+    { "min_catch_angle", &ServerParamT::min_catch_angle_ },
+    // 19.0
+    { "dist_noise_rate", &ServerParamT::dist_noise_rate_ },
+    { "focus_dist_noise_rate", &ServerParamT::focus_dist_noise_rate_ },
+    { "land_dist_noise_rate", &ServerParamT::land_dist_noise_rate_ },
+    { "land_focus_dist_noise_rate", &ServerParamT::land_focus_dist_noise_rate_ },
 };
 
+/*-------------------------------------------------------------------*/
+constexpr ParamTable< ServerParamT, std::size( server_param_entries ) > server_param_table( server_param_entries );
+
+static_assert( server_param_table.valid(), "server_param: parameter names must be unique" );
+
+}
+
 /*-------------------------------------------------------------------*/
 ServerParamT::ServerParamT()
     : goal_width_( 14.02 ),
@@ -747,273 +1272,37 @@ ServerParamT::ServerParamT()
       dist_noise_rate_( 0.0125 ),
       focus_dist_noise_rate_( 0.0125 ),
       land_dist_noise_rate_( 0.00125 ),
-      land_focus_dist_noise_rate_( 0.00125 ),
-      impl_( new Impl( this ) )
+      land_focus_dist_noise_rate_( 0.00125 )
 {
 
 }
 
 /*-------------------------------------------------------------------*/
-ServerParamT::Impl::Impl( ServerParamT * p )
-{
-    param_map_.insert( ParamMap::value_type( "goal_width", &(p->goal_width_ ) ) );
-    param_map_.insert( ParamMap::value_type( "inertia_moment", &(p->inertia_moment_ ) ) );
-    param_map_.insert( ParamMap::value_type( "player_size", &(p->player_size_ ) ) );
-    param_map_.insert( ParamMap::value_type( "player_decay", &(p->player_decay_ ) ) );
-    param_map_.insert( ParamMap::value_type( "player_rand", &(p->player_rand_ ) ) );
-    param_map_.insert( ParamMap::value_type( "player_weight", &(p->player_weight_ ) ) );
-    param_map_.insert( ParamMap::value_type( "player_speed_max", &(p->player_speed_max_ ) ) );
-    param_map_.insert( ParamMap::value_type( "player_accel_max", &(p->player_accel_max_ ) ) );
-    param_map_.insert( ParamMap::value_type( "stamina_max", &(p->stamina_max_ ) ) );
-    param_map_.insert( ParamMap::value_type( "stamina_inc_max", &(p->stamina_inc_max_ ) ) );
-    param_map_.insert( ParamMap::value_type( "recover_init", &(p->recover_init_ ) ) ); // not necessary
-    param_map_.insert( ParamMap::value_type( "recover_dec_thr", &(p->recover_dec_thr_ ) ) );
-    param_map_.insert( ParamMap::value_type( "recover_min", &(p->recover_min_ ) ) );
-    param_map_.insert( ParamMap::value_type( "recover_dec", &(p->recover_dec_ ) ) );
-    param_map_.insert( ParamMap::value_type( "effort_init", &(p->effort_init_ ) ) );
-    param_map_.insert( ParamMap::value_type( "effort_dec_thr", &(p->effort_dec_thr_ ) ) );
-    param_map_.insert( ParamMap::value_type( "effort_min", &(p->effort_min_ ) ) );
-    param_map_.insert( ParamMap::value_type( "effort_dec", &(p->effort_dec_ ) ) );
-    param_map_.insert( ParamMap::value_type( "effort_inc_thr", &(p->effort_inc_thr_ ) ) );
-    param_map_.insert( ParamMap::value_type( "effort_inc",  &(p->effort_inc_ ) ) );
-    param_map_.insert( ParamMap::value_type( "kick_rand", &(p->kick_rand_ ) ) );
-    param_map_.insert( ParamMap::value_type( "team_actuator_noise", &(p->team_actuator_noise_ ) ) );
-    param_map_.insert( ParamMap::value_type( "prand_factor_l", &(p->player_rand_factor_l_ ) ) );
-    param_map_.insert( ParamMap::value_type( "prand_factor_r", &(p->player_rand_factor_r_ ) ) );
-    param_map_.insert( ParamMap::value_type( "kick_rand_factor_l", &(p->kick_rand_factor_l_ ) ) );
-    param_map_.insert( ParamMap::value_type( "kick_rand_factor_r", &(p->kick_rand_factor_r_ ) ) );
-    param_map_.insert( ParamMap::value_type( "ball_size", &(p->ball_size_ ) ) );
-    param_map_.insert( ParamMap::value_type( "ball_decay", &(p->ball_decay_ ) ) );
-    param_map_.insert( ParamMap::value_type( "ball_rand", &(p->ball_rand_ ) ) );
-    param_map_.insert( ParamMap::value_type( "ball_weight", &(p->ball_weight_ ) ) );
-    param_map_.insert( ParamMap::value_type( "ball_speed_max", &(p->ball_speed_max_ ) ) );
-    param_map_.insert( ParamMap::value_type( "ball_accel_max", &(p->ball_accel_max_ ) ) );
-    param_map_.insert( ParamMap::value_type( "dash_power_rate", &(p->dash_power_rate_ ) ) );
-    param_map_.insert( ParamMap::value_type( "kick_power_rate", &(p->kick_power_rate_ ) ) );
-    param_map_.insert( ParamMap::value_type( "kickable_margin", &(p->kickable_margin_ ) ) );
-    param_map_.insert( ParamMap::value_type( "control_radius", &(p->control_radius_ ) ) );
-    //( "control_radius_width", &(p->control_radius_width_ ) ) );
-    //( "kickable_area", &(p->kickable_area_ ) ) ); // not needed
-    param_map_.insert( ParamMap::value_type( "catch_probability", &(p->catch_probability_ ) ) );
-    param_map_.insert( ParamMap::value_type( "catchable_area_l", &(p->catchable_area_l_ ) ) );
-    param_map_.insert( ParamMap::value_type( "catchable_area_w", &(p->catchable_area_w_ ) ) );
-    param_map_.insert( ParamMap::value_type( "goalie_max_moves", &(p->goalie_max_moves_ ) ) );
-    param_map_.insert( ParamMap::value_type( "maxpower", &(p->max_power_ ) ) );
-    param_map_.insert( ParamMap::value_type( "minpower", &(p->min_power_ ) ) );
-    param_map_.insert( ParamMap::value_type( "maxmoment", &(p->max_moment_ ) ) );
-    param_map_.insert( ParamMap::value_type( "minmoment", &(p->min_moment_ ) ) );
-    param_map_.insert( ParamMap::value_type( "maxneckmoment", &(p->max_neck_moment_ ) ) );
-    param_map_.insert( ParamMap::value_type( "minneckmoment", &(p->min_neck_moment_ ) ) );
-    param_map_.insert( ParamMap::value_type( "maxneckang", &(p->max_neck_angle_ ) ) );
-    param_map_.insert( ParamMap::value_type( "minneckang", &(p->min_neck_angle_ ) ) );
-    param_map_.insert( ParamMap::value_type( "visible_angle", &(p->visible_angle_ ) ) );
-    param_map_.insert( ParamMap::value_type( "visible_distance", &(p->visible_distance_ ) ) );
-    param_map_.insert( ParamMap::value_type( "audio_cut_dist", &(p->audio_cut_dist_ ) ) );
-    param_map_.insert( ParamMap::value_type( "quantize_step", &(p->dist_quantize_step_ ) ) );
-    param_map_.insert( ParamMap::value_type( "quantize_step_l", &(p->landmark_dist_quantize_step_ ) ) );
-    //( "quantize_step_dir", &(p->dir_quantize_step_ ) ) );
-    //( "quantize_step_dist_team_l", &(p->dist_quantize_step_l_ ) ) );
-    //( "quantize_step_dist_team_r", &(p->dist_quantize_step_r_ ) ) );
-    //( "quantize_step_dist_l_team_l", &(p->landmark_dist_quantize_step_l_ ) ) );
-    //( "quantize_step_dist_l_team_r", &(p->landmark_dist_quantize_step_r_ ) ) );
-    //( "quantize_step_dir_team_l", &(p->dir_quantize_step_l_ ) ) );
-    //( "quantize_step_dir_team_r", &(p->dir_quantize_step_r_ ) ) );
-    param_map_.insert( ParamMap::value_type( "ckick_margin", &(p->corner_kick_margin_ ) ) );
-    param_map_.insert( ParamMap::value_type( "wind_dir", &(p->wind_dir_ ) ) );
-    param_map_.insert( ParamMap::value_type( "wind_force", &(p->wind_force_ ) ) );
-    param_map_.insert( ParamMap::value_type( "wind_ang", &(p->wind_angle_ ) ) );
-    param_map_.insert( ParamMap::value_type( "wind_rand", &(p->wind_rand_ ) ) );
-    param_map_.insert( ParamMap::value_type( "wind_none", &(p->wind_none_ ) ) );
-    param_map_.insert( ParamMap::value_type( "wind_random", &(p->use_wind_random_ ) ) );
-    param_map_.insert( ParamMap::value_type( "half_time", &(p->half_time_ ) ) );
-    param_map_.insert( ParamMap::value_type( "drop_ball_time", &(p->drop_ball_time_ ) ) );
-    param_map_.insert( ParamMap::value_type( "port", &(p->port_ ) ) );
-    param_map_.insert( ParamMap::value_type( "coach_port", &(p->coach_port_ ) ) );
-    param_map_.insert( ParamMap::value_type( "olcoach_port", &(p->online_coach_port_ ) ) );
-    param_map_.insert( ParamMap::value_type( "say_coach_cnt_max", &(p->coach_say_count_max_ ) ) );
-    param_map_.insert( ParamMap::value_type( "say_coach_msg_size", &(p->coach_say_msg_size_ ) ) );
-    param_map_.insert( ParamMap::value_type( "simulator_step", &(p->simulator_step_ ) ) );
-    param_map_.insert( ParamMap::value_type( "send_step", &(p->send_step_ ) ) );
-    param_map_.insert( ParamMap::value_type( "recv_step", &(p->recv_step_ ) ) );
-    param_map_.insert( ParamMap::value_type( "sense_body_step", &(p->sense_body_step_ ) ) );
-    //( "lcm_step", &(p->lcm_step_ ) ) ); // not needed
-    param_map_.insert( ParamMap::value_type( "say_msg_size", &(p->player_say_msg_size_ ) ) );
-    param_map_.insert( ParamMap::value_type( "clang_win_size", &(p->clang_win_size_ ) ) );
-    param_map_.insert( ParamMap::value_type( "clang_define_win", &(p->clang_define_win_ ) ) );
-    param_map_.insert( ParamMap::value_type( "clang_meta_win", &(p->clang_meta_win_ ) ) );
-    param_map_.insert( ParamMap::value_type( "clang_advice_win", &(p->clang_advice_win_ ) ) );
-    param_map_.insert( ParamMap::value_type( "clang_info_win", &(p->clang_info_win_ ) ) );
-    param_map_.insert( ParamMap::value_type( "clang_del_win", &(p->clang_del_win_ ) ) );
-    param_map_.insert( ParamMap::value_type( "clang_rule_win", &(p->clang_rule_win_ ) ) );
-    param_map_.insert( ParamMap::value_type( "clang_mess_delay", &(p->clang_mess_delay_ ) ) );
-    param_map_.insert( ParamMap::value_type( "clang_mess_per_cycle", &(p->clang_mess_per_cycle_ ) ) );
-    param_map_.insert( ParamMap::value_type( "hear_max", &(p->player_hear_max_ ) ) );
-    param_map_.insert( ParamMap::value_type( "hear_inc", &(p->player_hear_inc_ ) ) );
-    param_map_.insert( ParamMap::value_type( "hear_decay", &(p->player_hear_decay_ ) ) );
-    param_map_.insert( ParamMap::value_type( "catch_ban_cycle", &(p->catch_ban_cycle_ ) ) );
-    param_map_.insert( ParamMap::value_type( "coach", &(p->coach_mode_ ) ) );
-    param_map_.insert( ParamMap::value_type( "coach_w_referee", &(p->coach_with_referee_mode_ ) ) );
-    param_map_.insert( ParamMap::value_type( "old_coach_hear", &(p->use_old_coach_hear_ ) ) );
-    param_map_.insert( ParamMap::value_type( "send_vi_step", &(p->online_coach_look_step_ ) ) );
-    param_map_.insert( ParamMap::value_type( "use_offside", &(p->use_offside_ ) ) );
-    param_map_.insert( ParamMap::value_type( "offside_kick_margin", &(p->offside_kick_margin_ ) ) );
-    param_map_.insert( ParamMap::value_type( "forbid_kick_off_offside", &(p->kickoff_offside_ ) ) );
-    param_map_.insert( ParamMap::value_type( "verbose", &(p->verbose_ ) ) );
-    param_map_.insert( ParamMap::value_type( "offside_active_area_size", &(p->offside_active_area_size_ ) ) );
-    param_map_.insert( ParamMap::value_type( "slow_down_factor", &(p->slow_down_factor_ ) ) );
-    param_map_.insert( ParamMap::value_type( "synch_mode", &(p->synch_mode_ ) ) );
-    param_map_.insert( ParamMap::value_type( "synch_offset", &(p->synch_offset_ ) ) );
-    param_map_.insert( ParamMap::value_type( "synch_micro_sleep", &(p->synch_micro_sleep_ ) ) );
-    param_map_.insert( ParamMap::value_type( "start_goal_l", &(p->start_goal_l_ ) ) );
-    param_map_.insert( ParamMap::value_type( "start_goal_r", &(p->start_goal_r_ ) ) );
-    param_map_.insert( ParamMap::value_type( "fullstate_l", &(p->fullstate_l_ ) ) );
-    param_map_.insert( ParamMap::value_type( "fullstate_r", &(p->fullstate_r_ ) ) );
-    param_map_.insert( ParamMap::value_type( "slowness_on_top_for_left_team", &(p->slowness_on_top_for_left_team_ ) ) );
-    param_map_.insert( ParamMap::value_type( "slowness_on_top_for_right_team", &(p->slowness_on_top_for_right_team_ ) ) );
-    param_map_.insert( ParamMap::value_type( "landmark_file", &(p->landmark_file_ ) ) );
-    param_map_.insert( ParamMap::value_type( "send_comms", &(p->send_comms_ ) ) );
-    param_map_.insert( ParamMap::value_type( "text_logging", &(p->text_logging_ ) ) );
-    param_map_.insert( ParamMap::value_type( "game_logging", &(p->game_logging_ ) ) );
-    param_map_.insert( ParamMap::value_type( "game_log_version", &(p->game_log_version_ ) ) );
-    param_map_.insert( ParamMap::value_type( "text_log_dir", &(p->text_log_dir_ ) ) );
-    param_map_.insert( ParamMap::value_type( "game_log_dir", &(p->game_log_dir_ ) ) );
-    param_map_.insert( ParamMap::value_type( "text_log_fixed_name", &(p->text_log_fixed_name_ ) ) );
-    param_map_.insert( ParamMap::value_type( "game_log_fixed_name", &(p->game_log_fixed_name_ ) ) );
-    param_map_.insert( ParamMap::value_type( "text_log_fixed", &(p->text_log_fixed_ ) ) );
-    param_map_.insert( ParamMap::value_type( "game_log_fixed", &(p->game_log_fixed_ ) ) );
-    param_map_.insert( ParamMap::value_type( "text_log_dated", &(p->text_log_dated_ ) ) );
-    param_map_.insert( ParamMap::value_type( "game_log_dated", &(p->game_log_dated_ ) ) );
-    param_map_.insert( ParamMap::value_type( "log_date_format", &(p->log_date_format_ ) ) );
-    param_map_.insert( ParamMap::value_type( "log_times", &(p->log_times_ ) ) );
-    param_map_.insert( ParamMap::value_type( "record_messages", &(p->record_messages_ ) ) );
-    param_map_.insert( ParamMap::value_type( "text_log_compression", &(p->text_log_compression_ ) ) );
-    param_map_.insert( ParamMap::value_type( "game_log_compression", &(p->game_log_compression_ ) ) );
-    param_map_.insert( ParamMap::value_type( "profile", &(p->profile_ ) ) );
-    param_map_.insert( ParamMap::value_type( "point_to_ban", &(p->point_to_ban_ ) ) );
-    param_map_.insert( ParamMap::value_type( "point_to_duration", &(p->point_to_duration_ ) ) );
-    param_map_.insert( ParamMap::value_type( "tackle_dist", &(p->tackle_dist_ ) ) );
-    param_map_.insert( ParamMap::value_type( "tackle_back_dist", &(p->tackle_back_dist_ ) ) );
-    param_map_.insert( ParamMap::value_type( "tackle_width", &(p->tackle_width_ ) ) );
-    param_map_.insert( ParamMap::value_type( "tackle_exponent", &(p->tackle_exponent_ ) ) );
-    param_map_.insert( ParamMap::value_type( "tackle_cycles", &(p->tackle_cycles_ ) ) );
-    param_map_.insert( ParamMap::value_type( "tackle_power_rate", &(p->tackle_power_rate_ ) ) );
-    param_map_.insert( ParamMap::value_type( "freeform_wait_period", &(p->freeform_wait_period_ ) ) );
-    param_map_.insert( ParamMap::value_type( "freeform_send_period", &(p->freeform_send_period_ ) ) );
-    param_map_.insert( ParamMap::value_type( "free_kick_faults", &(p->free_kick_faults_ ) ) );
-    param_map_.insert( ParamMap::value_type( "back_passes", &(p->back_passes_ ) ) );
-    param_map_.insert( ParamMap::value_type( "proper_goal_kicks", &(p->proper_goal_kicks_ ) ) );
-    param_map_.insert( ParamMap::value_type( "stopped_ball_vel", &(p->stopped_ball_vel_ ) ) );
-    param_map_.insert( ParamMap::value_type( "max_goal_kicks", &(p->max_goal_kicks_ ) ) );
-    param_map_.insert( ParamMap::value_type( "auto_mode", &(p->auto_mode_ ) ) );
-    param_map_.insert( ParamMap::value_type( "kick_off_wait", &(p->kick_off_wait_ ) ) );
-    param_map_.insert( ParamMap::value_type( "connect_wait", &(p->connect_wait_ ) ) );
-    param_map_.insert( ParamMap::value_type( "game_over_wait", &(p->game_over_wait_ ) ) );
-    param_map_.insert( ParamMap::value_type( "team_l_start", &(p->team_l_start_ ) ) );
-    param_map_.insert( ParamMap::value_type( "team_r_start", &(p->team_r_start_ ) ) );
-    param_map_.insert( ParamMap::value_type( "keepaway", &(p->keepaway_mode_ ) ) );
-    param_map_.insert( ParamMap::value_type( "keepaway_length", &(p->keepaway_length_ ) ) );
-    param_map_.insert( ParamMap::value_type( "keepaway_width", &(p->keepaway_width_ ) ) );
-    param_map_.insert( ParamMap::value_type( "keepaway_logging", &(p->keepaway_logging_ ) ) );
-    param_map_.insert( ParamMap::value_type( "keepaway_log_dir", &(p->keepaway_log_dir_ ) ) );
-    param_map_.insert( ParamMap::value_type( "keepaway_log_fixed_name", &(p->keepaway_log_fixed_name_ ) ) );
-    param_map_.insert( ParamMap::value_type( "keepaway_log_fixed", &(p->keepaway_log_fixed_ ) ) );
-    param_map_.insert( ParamMap::value_type( "keepaway_log_dated", &(p->keepaway_log_dated_ ) ) );
-    param_map_.insert( ParamMap::value_type( "keepaway_start", &(p->keepaway_start_ ) ) );
-    param_map_.insert( ParamMap::value_type( "nr_normal_halfs", &(p->nr_normal_halfs_ ) ) );
-    param_map_.insert( ParamMap::value_type( "nr_extra_halfs", &(p->nr_extra_halfs_ ) ) );
-    param_map_.insert( ParamMap::value_type( "penalty_shoot_outs", &(p->penalty_shoot_outs_ ) ) );
-    param_map_.insert( ParamMap::value_type( "pen_before_setup_wait", &(p->pen_before_setup_wait_ ) ) );
-    param_map_.insert( ParamMap::value_type( "pen_setup_wait", &(p->pen_setup_wait_ ) ) );
-    param_map_.insert( ParamMap::value_type( "pen_ready_wait", &(p->pen_ready_wait_ ) ) );
-    param_map_.insert( ParamMap::value_type( "pen_taken_wait", &(p->pen_taken_wait_ ) ) );
-    param_map_.insert( ParamMap::value_type( "pen_nr_kicks", &(p->pen_nr_kicks_ ) ) );
-    param_map_.insert( ParamMap::value_type( "pen_max_extra_kicks", &(p->pen_max_extra_kicks_ ) ) );
-    param_map_.insert( ParamMap::value_type( "pen_dist_x", &(p->pen_dist_x_ ) ) );
-    param_map_.insert( ParamMap::value_type( "pen_random_winner", &(p->pen_random_winner_ ) ) );
-    param_map_.insert( ParamMap::value_type( "pen_max_goalie_dist_x", &(p->pen_max_goalie_dist_x_ ) ) );
-    param_map_.insert( ParamMap::value_type( "pen_allow_mult_kicks", &(p->pen_allow_mult_kicks_ ) ) );
-    param_map_.insert( ParamMap::value_type( "pen_coach_moves_players", &(p->pen_coach_moves_players_ ) ) );
-    // v11
-    param_map_.insert( ParamMap::value_type( "ball_stuck_area", &(p->ball_stuck_area_ ) ) );
-    param_map_.insert( ParamMap::value_type( "coach_msg_file", &(p->coach_msg_file_ ) ) );
-    // v12
-    param_map_.insert( ParamMap::value_type( "max_tackle_power", &(p->max_tackle_power_ ) ) );
-    param_map_.insert( ParamMap::value_type( "max_back_tackle_power", &(p->max_back_tackle_power_ ) ) );
-    param_map_.insert( ParamMap::value_type( "player_speed_max_min", &(p->player_speed_max_min_ ) ) );
-    param_map_.insert( ParamMap::value_type( "extra_stamina", &(p->extra_stamina_ ) ) );
-    param_map_.insert( ParamMap::value_type( "synch_see_offset", &(p->synch_see_offset_ ) ) );
-    param_map_.insert( ParamMap::value_type( "max_monitors", &(p->max_monitors_ ) ) );
-    // v12.1.3
-    param_map_.insert( ParamMap::value_type( "extra_half_time", &(p->extra_half_time_ ) ) );
-    // v13
-    param_map_.insert( ParamMap::value_type( "stamina_capacity", &(p->stamina_capacity_ ) ) );
-    param_map_.insert( ParamMap::value_type( "max_dash_angle", &(p->max_dash_angle_ ) ) );
-    param_map_.insert( ParamMap::value_type( "min_dash_angle", &(p->min_dash_angle_ ) ) );
-    param_map_.insert( ParamMap::value_type( "dash_angle_step", &(p->dash_angle_step_ ) ) );
-    param_map_.insert( ParamMap::value_type( "side_dash_rate", &(p->side_dash_rate_ ) ) );
-    param_map_.insert( ParamMap::value_type( "back_dash_rate", &(p->back_dash_rate_ ) ) );
-    param_map_.insert( ParamMap::value_type( "max_dash_power", &(p->max_dash_power_ ) ) );
-    param_map_.insert( ParamMap::value_type( "min_dash_power", &(p->min_dash_power_ ) ) );
-    // 14.0.0
-    param_map_.insert( ParamMap::value_type( "tackle_rand_factor", &(p->tackle_rand_factor_ ) ) );
-    param_map_.insert( ParamMap::value_type( "foul_detect_probability", &(p->foul_detect_probability_ ) ) );
-    param_map_.insert( ParamMap::value_type( "foul_exponent", &(p->foul_exponent_ ) ) );
-    param_map_.insert( ParamMap::value_type( "foul_cycles", &(p->foul_cycles_ ) ) );
-    param_map_.insert( ParamMap::value_type( "golden_goal", &(p->golden_goal_ ) ) );
-    // 15.0
-    param_map_.insert( ParamMap::value_type( "red_card_probability", &(p->red_card_probability_ ) ) );
-    // 16.0
-    param_map_.insert( ParamMap::value_type( "illegal_defense_duration", &(p->illegal_defense_duration_ ) ) );
-    param_map_.insert( ParamMap::value_type( "illegal_defense_number", &(p->illegal_defense_number_ ) ) );
-    param_map_.insert( ParamMap::value_type( "illegal_defense_dist_x", &(p->illegal_defense_dist_x_ ) ) );
-    param_map_.insert( ParamMap::value_type( "illegal_defense_width", &(p->illegal_defense_width_ ) ) );
-    param_map_.insert( ParamMap::value_type( "fixed_teamname_l", &(p->fixed_teamname_l_ ) ) );
-    param_map_.insert( ParamMap::value_type( "fixed_teamname_r", &(p->fixed_teamname_r_ ) ) );
-    // 17.0
-    param_map_.insert( ParamMap::value_type( "max_catch_angle", &(p->max_catch_angle_ ) ) );
-    param_map_.insert( ParamMap::value_type( "min_catch_angle", &(p->min_catch_angle_ ) ) );
-    // 19.0
-    param_map_.insert( ParamMap::value_type( "dist_noise_rate", &(p->dist_noise_rate_ ) ) );
-    param_map_.insert( ParamMap::value_type( "focus_dist_noise_rate", &(p->focus_dist_noise_rate_ ) ) );
-    param_map_.insert( ParamMap::value_type( "land_dist_noise_rate", &(p->land_dist_noise_rate_ ) ) );
-    param_map_.insert( ParamMap::value_type( "land_focus_dist_noise_rate", &(p->land_focus_dist_noise_rate_ ) ) );
-}
-
 void
 ServerParamT::copyFrom( const ServerParamT & other )
 {
-    for ( const ParamMap::value_type & v : other.impl_->param_map_ )
-    {
-        try
-        {
-            std::visit( ValueSetter(), v.second, impl_->param_map_.at( v.first ) );
-        }
-        catch ( std::exception & e )
-        {
-            std::cerr << "(ServerParamT::copyFrom) " << e.what() << std::endl;
-        }
-    }
+    copy_params( server_param_table, other, *this );
 }
 
 /*-------------------------------------------------------------------*/
 std::ostream &
 ServerParamT::toServerString( std::ostream & os ) const
 {
-    return print_server_message( os, "server_param", impl_->param_map_ );
+    return print_server_message( os, "server_param", server_param_table, *this );
 }
 
 /*-------------------------------------------------------------------*/
 std::ostream &
 ServerParamT::toJSON( std::ostream & os ) const
 {
-    return print_json( os, "server_param", impl_->param_map_ );
+    return print_json( os, "server_param", server_param_table, *this );
 }
 
 /*-------------------------------------------------------------------*/
 bool
 ServerParamT::fromServerString( const std::string & msg )
 {
-    return parse_server_message( msg, impl_->param_map_ );
+    return parse_server_message( msg, server_param_table, *this );
 }
 
 /*-------------------------------------------------------------------*/
@@ -1209,10 +1498,10 @@ ServerParamT::fromStruct( const server_params_t & from )
 
 /*-------------------------------------------------------------------*/
 bool
-ServerParamT::setValue( const std::string & name,
-                        const std::string & value )
+ServerParamT::setValue( const std::string_view name,
+                        const std::string_view value )
 {
-    return set_value( "server_param", name, value, impl_->param_map_ );
+    return set_value( "server_param", name, value, server_param_table, *this );
 }
 
 /*-------------------------------------------------------------------*/
@@ -1220,7 +1509,7 @@ bool
 ServerParamT::setInt( const std::string & name,
                       const int value )
 {
-    return set_integer( name, value, impl_->param_map_ );
+    return set_integer( name, value, server_param_table, *this );
 }
 
 /*-------------------------------------------------------------------*/
@@ -1228,7 +1517,7 @@ bool
 ServerParamT::setDouble( const std::string & name,
                          const double value )
 {
-    return set_double( name, value, impl_->param_map_ );
+    return set_double( name, value, server_param_table, *this );
 }
 
 /*-------------------------------------------------------------------*/
@@ -1236,7 +1525,7 @@ bool
 ServerParamT::setBool( const std::string & name,
                        const bool value )
 {
-    return set_boolean( name, value, impl_->param_map_ );
+    return set_boolean( name, value, server_param_table, *this );
 }
 
 /*-------------------------------------------------------------------*/
@@ -1244,19 +1533,56 @@ bool
 ServerParamT::setString( const std::string & name,
                          const std::string & value )
 {
-    return set_string( name, value, impl_->param_map_ );
+    return set_string( name, value, server_param_table, *this );
 }
 
 /*-------------------------------------------------------------------*/
 /*-------------------------------------------------------------------*/
 /*-------------------------------------------------------------------*/
 
-struct PlayerParamT::Impl {
-    Impl( PlayerParamT * p );
+namespace {
 
-    ParamMap param_map_;
+/*-------------------------------------------------------------------*/
+constexpr ParamEntry< PlayerParamT > player_param_entries[] = {
+    { "player_types", &PlayerParamT::player_types_ },
+    { "subs_max", &PlayerParamT::substitute_max_ },
+    { "pt_max", &PlayerParamT::pt_max_ },
+    { "allow_mult_default_type", &PlayerParamT::allow_mult_default_type_ },
+    { "player_speed_max_delta_min", &PlayerParamT::player_speed_max_delta_min_ },
+    { "player_speed_max_delta_max", &PlayerParamT::player_speed_max_delta_max_ },
+    { "stamina_inc_max_delta_factor", &PlayerParamT::stamina_inc_max_delta_factor_ },
+    { "player_decay_delta_min", &PlayerParamT::player_decay_delta_min_ },
+    { "player_decay_delta_max", &PlayerParamT::player_decay_delta_max_ },
+    { "inertia_moment_delta_factor", &PlayerParamT::inertia_moment_delta_factor_ },
+    { "dash_power_rate_delta_min", &PlayerParamT::dash_power_rate_delta_min_ },
+    { "dash_power_rate_delta_max", &PlayerParamT::dash_power_rate_delta_max_ },
+    { "player_size_delta_factor", &PlayerParamT::player_size_delta_factor_ },
+    { "kickable_margin_delta_min", &PlayerParamT::kickable_margin_delta_min_ },
+    { "kickable_margin_delta_max", &PlayerParamT::kickable_margin_delta_max_ },
+    { "kick_rand_delta_factor", &PlayerParamT::kick_rand_delta_factor_ },
+    { "extra_stamina_delta_min", &PlayerParamT::extra_stamina_delta_min_ },
+    { "extra_stamina_delta_max", &PlayerParamT::extra_stamina_delta_max_ },
+    { "effort_max_delta_factor", &PlayerParamT::effort_max_delta_factor_ },
+    { "effort_min_delta_factor", &PlayerParamT::effort_min_delta_factor_ },
+    { "random_seed", &PlayerParamT::random_seed_ },
+    { "new_dash_power_rate_delta_min", &PlayerParamT::new_dash_power_rate_delta_min_ },
+    { "new_dash_power_rate_delta_max", &PlayerParamT::new_dash_power_rate_delta_max_ },
+    { "new_stamina_inc_max_delta_factor", &PlayerParamT::new_stamina_inc_max_delta_factor_ },
+    // 14.0.0
+    { "kick_power_rate_delta_min", &PlayerParamT::kick_power_rate_delta_min_ },
+    { "kick_power_rate_delta_max", &PlayerParamT::kick_power_rate_delta_max_ },
+    { "foul_detect_probability_delta_factor", &PlayerParamT::foul_detect_probability_delta_factor_ },
+    { "catchable_area_l_stretch_min", &PlayerParamT::catchable_area_l_stretch_min_ },
+    { "catchable_area_l_stretch_max", &PlayerParamT::catchable_area_l_stretch_max_ },
 };
 
+/*-------------------------------------------------------------------*/
+constexpr ParamTable< PlayerParamT, std::size( player_param_entries ) > player_param_table( player_param_entries );
+
+static_assert( player_param_table.valid(), "player_param: parameter names must be unique" );
+
+}
+
 /*-------------------------------------------------------------------*/
 PlayerParamT::PlayerParamT()
     : player_types_( 18 ),
@@ -1287,83 +1613,37 @@ PlayerParamT::PlayerParamT()
       kick_power_rate_delta_max_( 0.0 ),
       foul_detect_probability_delta_factor_( 0.0 ),
       catchable_area_l_stretch_min_( 0.0 ),
-      catchable_area_l_stretch_max_( 0.0 ),
-      impl_( new Impl( this ) )
+      catchable_area_l_stretch_max_( 0.0 )
 {
 
 }
 
-/*-------------------------------------------------------------------*/
-PlayerParamT::Impl::Impl( PlayerParamT * p )
-{
-    param_map_.insert( ParamMap::value_type( "player_types", &(p->player_types_ ) ) );
-    param_map_.insert( ParamMap::value_type( "subs_max", &(p->substitute_max_ ) ) );
-    param_map_.insert( ParamMap::value_type( "pt_max", &(p->pt_max_ ) ) );
-    param_map_.insert( ParamMap::value_type( "allow_mult_default_type", &(p->allow_mult_default_type_ ) ) );
-    param_map_.insert( ParamMap::value_type( "player_speed_max_delta_min", &(p->player_speed_max_delta_min_ ) ) );
-    param_map_.insert( ParamMap::value_type( "player_speed_max_delta_max", &(p->player_speed_max_delta_max_ ) ) );
-    param_map_.insert( ParamMap::value_type( "stamina_inc_max_delta_factor", &(p->stamina_inc_max_delta_factor_ ) ) );
-    param_map_.insert( ParamMap::value_type( "player_decay_delta_min", &(p->player_decay_delta_min_ ) ) );
-    param_map_.insert( ParamMap::value_type( "player_decay_delta_max", &(p->player_decay_delta_max_ ) ) );
-    param_map_.insert( ParamMap::value_type( "inertia_moment_delta_factor", &(p->inertia_moment_delta_factor_ ) ) );
-    param_map_.insert( ParamMap::value_type( "dash_power_rate_delta_min", &(p->dash_power_rate_delta_min_ ) ) );
-    param_map_.insert( ParamMap::value_type( "dash_power_rate_delta_max", &(p->dash_power_rate_delta_max_ ) ) );
-    param_map_.insert( ParamMap::value_type( "player_size_delta_factor", &(p->player_size_delta_factor_ ) ) );
-    param_map_.insert( ParamMap::value_type( "kickable_margin_delta_min", &(p->kickable_margin_delta_min_ ) ) );
-    param_map_.insert( ParamMap::value_type( "kickable_margin_delta_max", &(p->kickable_margin_delta_max_ ) ) );
-    param_map_.insert( ParamMap::value_type( "kick_rand_delta_factor", &(p->kick_rand_delta_factor_ ) ) );
-    param_map_.insert( ParamMap::value_type( "extra_stamina_delta_min", &(p->extra_stamina_delta_min_ ) ) );
-    param_map_.insert( ParamMap::value_type( "extra_stamina_delta_max", &(p->extra_stamina_delta_max_ ) ) );
-    param_map_.insert( ParamMap::value_type( "effort_max_delta_factor", &(p->effort_max_delta_factor_ ) ) );
-    param_map_.insert( ParamMap::value_type( "effort_min_delta_factor", &(p->effort_min_delta_factor_ ) ) );
-    param_map_.insert( ParamMap::value_type( "random_seed", &(p->random_seed_ ) ) );
-    param_map_.insert( ParamMap::value_type( "new_dash_power_rate_delta_min", &(p->new_dash_power_rate_delta_min_ ) ) );
-    param_map_.insert( ParamMap::value_type( "new_dash_power_rate_delta_max", &(p->new_dash_power_rate_delta_max_ ) ) );
-    param_map_.insert( ParamMap::value_type( "new_stamina_inc_max_delta_factor", &(p->new_stamina_inc_max_delta_factor_ ) ) );
-    // 14.0.0
-    param_map_.insert( ParamMap::value_type( "kick_power_rate_delta_min", &(p->kick_power_rate_delta_min_ ) ) );
-    param_map_.insert( ParamMap::value_type( "kick_power_rate_delta_max", &(p->kick_power_rate_delta_max_ ) ) );
-    param_map_.insert( ParamMap::value_type( "foul_detect_probability_delta_factor", &(p->foul_detect_probability_delta_factor_ ) ) );
-    param_map_.insert( ParamMap::value_type( "catchable_area_l_stretch_min", &(p->catchable_area_l_stretch_min_ ) ) );
-    param_map_.insert( ParamMap::value_type( "catchable_area_l_stretch_max", &(p->catchable_area_l_stretch_max_ ) ) );
-}
-
 /*-------------------------------------------------------------------*/
 void
 PlayerParamT::copyFrom( const PlayerParamT & other )
 {
-    for ( const ParamMap::value_type & v : other.impl_->param_map_ )
-    {
-        try
-        {
-            std::visit( ValueSetter(), v.second, impl_->param_map_.at( v.first ) );
-        }
-        catch ( std::exception & e )
-        {
-            std::cerr << "(PlayerParamT::copyFrom) " << e.what() << std::endl;
-        }
-    }
+    copy_params( player_param_table, other, *this );
 }
 
 /*-------------------------------------------------------------------*/
 std::ostream &
 PlayerParamT::toServerString( std::ostream & os ) const
 {
-    return print_server_message( os, "player_param", impl_->param_map_ );
+    return print_server_message( os, "player_param", player_param_table, *this );
 }
 
 /*-------------------------------------------------------------------*/
 std::ostream &
 PlayerParamT::toJSON( std::ostream & os ) const
 {
-    return print_json( os, "player_param", impl_->param_map_ );
+    return print_json( os, "player_param", player_param_table, *this );
 }
 
 /*-------------------------------------------------------------------*/
 bool
 PlayerParamT::fromServerString( const std::string & msg )
 {
-    return parse_server_message( msg, impl_->param_map_ );
+    return parse_server_message( msg, player_param_table, *this );
 }
 
 /*-------------------------------------------------------------------*/
@@ -1415,10 +1695,10 @@ PlayerParamT::fromStruct( const player_params_t & from )
 
 /*-------------------------------------------------------------------*/
 bool
-PlayerParamT::setValue( const std::string & name,
-                        const std::string & value )
+PlayerParamT::setValue( const std::string_view name,
+                        const std::string_view value )
 {
-    return set_value( "player_param", name, value, impl_->param_map_ );
+    return set_value( "player_param", name, value, player_param_table, *this );
 }
 
 /*-------------------------------------------------------------------*/
@@ -1426,7 +1706,7 @@ bool
 PlayerParamT::setInt( const std::string & name,
                       const int value )
 {
-    return set_integer( name, value, impl_->param_map_ );
+    return set_integer( name, value, player_param_table, *this );
 }
 
 /*-------------------------------------------------------------------*/
@@ -1434,7 +1714,7 @@ bool
 PlayerParamT::setDouble( const std::string & name,
                          const double value )
 {
-    return set_double( name, value, impl_->param_map_ );
+    return set_double( name, value, player_param_table, *this );
 }
 
 /*-------------------------------------------------------------------*/
@@ -1442,19 +1722,60 @@ bool
 PlayerParamT::setBool( const std::string & name,
                        const bool value )
 {
-    return set_boolean( name, value, impl_->param_map_ );
+    return set_boolean( name, value, player_param_table, *this );
 }
 
 /*-------------------------------------------------------------------*/
 /*-------------------------------------------------------------------*/
 /*-------------------------------------------------------------------*/
 
-struct PlayerTypeT::Impl {
-    Impl( PlayerTypeT * param );
+namespace {
 
-    ParamMap param_map_;
+/*-------------------------------------------------------------------*/
+constexpr ParamEntry< PlayerTypeT > player_type_entries[] = {
+    { "id", &PlayerTypeT::id_ },
+
+    { "player_speed_max", &PlayerTypeT::player_speed_max_ },
+    { "stamina_inc_max", &PlayerTypeT::stamina_inc_max_ },
+    { "player_decay", &PlayerTypeT::player_decay_ },
+    { "inertia_moment", &PlayerTypeT::inertia_moment_ },
+    { "dash_power_rate", &PlayerTypeT::dash_power_rate_ },
+    { "player_size", &PlayerTypeT::player_size_ },
+    { "kickable_margin", &PlayerTypeT::kickable_margin_ },
+    { "kick_rand", &PlayerTypeT::kick_rand_ },
+    { "extra_stamina", &PlayerTypeT::extra_stamina_ },
+    { "effort_max", &PlayerTypeT::effort_max_ },
+    { "effort_min", &PlayerTypeT::effort_min_ },
+    // 14.0.0
+    { "kick_power_rate", &PlayerTypeT::kick_power_rate_ },
+    { "foul_detect_probability", &PlayerTypeT::foul_detect_probability_ },
+    { "catchable_area_l_stretch", &PlayerTypeT::catchable_area_l_stretch_ },
+    // 18.0
+    { "unum_far_length", &PlayerTypeT::unum_far_length_ },
+    { "unum_too_far_length", &PlayerTypeT::unum_too_far_length_ },
+    { "team_far_length", &PlayerTypeT::team_far_length_ },
+    { "team_too_far_length", &PlayerTypeT::team_too_far_length_ },
+    { "player_max_observation_length", &PlayerTypeT::player_max_observation_length_ },
+    { "ball_vel_far_length", &PlayerTypeT::ball_vel_far_length_ },
+    { "ball_vel_too_far_length", &PlayerTypeT::ball_vel_too_far_length_ },
+    { "ball_max_observation_length", &PlayerTypeT::ball_max_observation_length_ },
+    { "flag_chg_far_length", &PlayerTypeT::flag_chg_far_length_ },
+    { "flag_chg_too_far_length", &PlayerTypeT::flag_chg_too_far_length_ },
+    { "flag_max_observation_length", &PlayerTypeT::flag_max_observation_length_ },
+    // 19.0
+    { "dist_noise_rate", &PlayerTypeT::dist_noise_rate_ },
+    { "focus_dist_noise_rate", &PlayerTypeT::focus_dist_noise_rate_ },
+    { "land_dist_noise_rate", &PlayerTypeT::land_dist_noise_rate_ },
+    { "land_focus_dist_noise_rate", &PlayerTypeT::land_focus_dist_noise_rate_ },
 };
 
+/*-------------------------------------------------------------------*/
+constexpr ParamTable< PlayerTypeT, std::size( player_type_entries ) > player_type_table( player_type_entries );
+
+static_assert( player_type_table.valid(), "player_type: parameter names must be unique" );
+
+}
+
 /*-------------------------------------------------------------------*/
 PlayerTypeT::PlayerTypeT()
     : id_( 0 ),
@@ -1486,56 +1807,16 @@ PlayerTypeT::PlayerTypeT()
       dist_noise_rate_( 0.0125 ),
       focus_dist_noise_rate_( 0.0125 ),
       land_dist_noise_rate_( 0.00125 ),
-      land_focus_dist_noise_rate_( 0.00125 ),
-      impl_( new Impl( this ) )
+      land_focus_dist_noise_rate_( 0.00125 )
 {
 
 }
 
-/*-------------------------------------------------------------------*/
-PlayerTypeT::Impl::Impl( PlayerTypeT * p )
-{
-    param_map_.insert( ParamMap::value_type( "id", &(p->id_ ) ) );
-
-    param_map_.insert( ParamMap::value_type( "player_speed_max", &(p->player_speed_max_ ) ) );
-    param_map_.insert( ParamMap::value_type( "stamina_inc_max", &(p->stamina_inc_max_ ) ) );
-    param_map_.insert( ParamMap::value_type( "player_decay", &(p->player_decay_ ) ) );
-    param_map_.insert( ParamMap::value_type( "inertia_moment", &(p->inertia_moment_ ) ) );
-    param_map_.insert( ParamMap::value_type( "dash_power_rate", &(p->dash_power_rate_ ) ) );
-    param_map_.insert( ParamMap::value_type( "player_size", &(p->player_size_ ) ) );
-    param_map_.insert( ParamMap::value_type( "kickable_margin", &(p->kickable_margin_ ) ) );
-    param_map_.insert( ParamMap::value_type( "kick_rand", &(p->kick_rand_ ) ) );
-    param_map_.insert( ParamMap::value_type( "extra_stamina", &(p->extra_stamina_ ) ) );
-    param_map_.insert( ParamMap::value_type( "effort_max", &(p->effort_max_ ) ) );
-    param_map_.insert( ParamMap::value_type( "effort_min", &(p->effort_min_ ) ) );
-    // 14.0.0
-    param_map_.insert( ParamMap::value_type( "kick_power_rate", &(p->kick_power_rate_ ) ) );
-    param_map_.insert( ParamMap::value_type( "foul_detect_probability", &(p->foul_detect_probability_ ) ) );
-    param_map_.insert( ParamMap::value_type( "catchable_area_l_stretch", &(p->catchable_area_l_stretch_ ) ) );
-    // 18.0
-    param_map_.insert( ParamMap::value_type( "unum_far_length", &(p->unum_far_length_ ) ) );
-    param_map_.insert( ParamMap::value_type( "unum_too_far_length", &(p->unum_too_far_length_ ) ) );
-    param_map_.insert( ParamMap::value_type( "team_far_length", &(p->team_far_length_ ) ) );
-    param_map_.insert( ParamMap::value_type( "team_too_far_length", &(p->team_too_far_length_ ) ) );
-    param_map_.insert( ParamMap::value_type( "player_max_observation_length", &(p->player_max_observation_length_ ) ) );
-    param_map_.insert( ParamMap::value_type( "ball_vel_far_length", &(p->ball_vel_far_length_ ) ) );
-    param_map_.insert( ParamMap::value_type( "ball_vel_too_far_length", &(p->ball_vel_too_far_length_ ) ) );
-    param_map_.insert( ParamMap::value_type( "ball_max_observation_length", &(p->ball_max_observation_length_ ) ) );
-    param_map_.insert( ParamMap::value_type( "flag_chg_far_length", &(p->flag_chg_far_length_ ) ) );
-    param_map_.insert( ParamMap::value_type( "flag_chg_too_far_length", &(p->flag_chg_too_far_length_ ) ) );
-    param_map_.insert( ParamMap::value_type( "flag_max_observation_length", &(p->flag_max_observation_length_ ) ) );
-    // 19.0
-    param_map_.insert( ParamMap::value_type( "dist_noise_rate", &(p->dist_noise_rate_ ) ) );
-    param_map_.insert( ParamMap::value_type( "focus_dist_noise_rate", &(p->focus_dist_noise_rate_ ) ) );
-    param_map_.insert( ParamMap::value_type( "land_dist_noise_rate", &(p->land_dist_noise_rate_ ) ) );
-    param_map_.insert( ParamMap::value_type( "land_focus_dist_noise_rate", &(p->land_focus_dist_noise_rate_ ) ) );
-}
-
 /*-------------------------------------------------------------------*/
 std::ostream &
 PlayerTypeT::toServerString( std::ostream & os ) const
 {
-    //return print_server_message( os, "player_type", param_map_ );
+    //return print_server_message( os, "player_type", player_type_table, *this );
 
     os << "(player_type ";
     to_sexp( os, "id", id_ );
@@ -1646,24 +1927,14 @@ PlayerTypeT::operator=( const PlayerTypeT & other )
 void
 PlayerTypeT::copyFrom( const PlayerTypeT & other )
 {
-    for ( const ParamMap::value_type & v : other.impl_->param_map_ )
-    {
-        try
-        {
-            std::visit( ValueSetter(), v.second, impl_->param_map_.at( v.first ) );
-        }
-        catch ( std::exception & e )
-        {
-            std::cerr << "(PlayerParamT::copyFrom) " << e.what() << std::endl;
-        }
-    }
+    copy_params( player_type_table, other, *this );
 }
 
 /*-------------------------------------------------------------------*/
 bool
 PlayerTypeT::fromServerString( const std::string & msg )
 {
-    return parse_server_message( msg, impl_->param_map_ );
+    return parse_server_message( msg, player_type_table, *this );
 }
 
 /*-------------------------------------------------------------------*/
@@ -1704,10 +1975,10 @@ PlayerTypeT::fromStruct( const player_type_t & from )
 
 /*-------------------------------------------------------------------*/
 bool
-PlayerTypeT::setValue( const std::string & name,
-                       const std::string & value )
+PlayerTypeT::setValue( const std::string_view name,
+                       const std::string_view value )
 {
-    return set_value( "player_type", name, value, impl_->param_map_ );
+    return set_value( "player_type", name, value, player_type_table, *this );
 }
 
 /*-------------------------------------------------------------------*/
@@ -1715,7 +1986,7 @@ bool
 PlayerTypeT::setInt( const std::string & name,
                      const int value )
 {
-    return set_integer( name, value, impl_->param_map_ );
+    return set_integer( name, value, player_type_table, *this );
 }
 
 /*-------------------------------------------------------------------*/
@@ -1723,7 +1994,7 @@ bool
 PlayerTypeT::setDouble( const std::string & name,
                         const double value )
 {
-    return set_double( name, value, impl_->param_map_ );
+    return set_double( name, value, player_type_table, *this );
 }
 
 }
@@ -34,6 +34,7 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include <cmath>
 #include <cstdint>
 
@@ -1619,8 +1620,8 @@ struct ServerParamT {
 
     bool fromStruct( const server_params_t & data );
 
-    bool setValue( const std::string & name,
-                   const std::string & value );
+    bool setValue( const std::string_view name,
+                   const std::string_view value );
 
     bool setInt( const std::string & name,
                  const int value );
@@ -1633,9 +1634,6 @@ struct ServerParamT {
 private:
     ServerParamT( const ServerParamT & ) = delete;
     const ServerParamT & operator=( const ServerParamT & other ) = delete;
-
-    struct Impl;
-    std::shared_ptr< Impl > impl_;
 };
 
 
@@ -1719,8 +1717,8 @@ struct PlayerParamT {
 
     bool fromStruct( const player_params_t & data );
 
-    bool setValue( const std::string & name,
-                   const std::string & value );
+    bool setValue( const std::string_view name,
+                   const std::string_view value );
 
     bool setInt( const std::string & name,
                  const int value );
@@ -1731,9 +1729,6 @@ struct PlayerParamT {
 private:
     PlayerParamT( const PlayerParamT & ) = delete;
     const PlayerParamT& operator=( const PlayerParamT & ) = delete;
-
-    struct Impl;
-    std::shared_ptr< Impl > impl_;
 };
 
 
@@ -1811,16 +1806,12 @@ struct PlayerTypeT {
 
     bool fromStruct( const player_type_t & data );
 
-    bool setValue( const std::string & name,
-                   const std::string & value );
+    bool setValue( const std::string_view name,
+                   const std::string_view value );
     bool setInt( const std::string & name,
                  const int value );
     bool setDouble( const std::string & name,
                     const double value );
-private:
-
-    struct Impl;
-    std::shared_ptr< Impl > impl_;
 };
 
 //! recorded value of rcg v4
@@ -0,0 +1,145 @@
+// -*-c++-*-
+
+/*!
+  \file append_queue.h
+  \brief lock-free single-producer/single-consumer queue Header File.
+*/
+
+/*
+ *Copyright:
+
+ Copyright (C) The RoboCup Soccer Server Maintenance Group.
+ Hidehisa AKIYAMA
+
+ This code is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 3, or (at your option)
+ any later version.
+
+ This code is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this code; see the file COPYING.	If not, write to
+ the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+
+ *EndCopyright:
+ */
+
+/////////////////////////////////////////////////////////////////////
+
+#ifndef RCSSMONITOR_APPEND_QUEUE_H
+#define RCSSMONITOR_APPEND_QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/*!
+  \class AppendQueue
+  \brief unbounded lock-free queue for one producer thread and one consumer thread.
+
+  The elements are appended to the fixed size blocks. The producer
+  publishes each element by the release store of the block size, and
+  a new block is linked only after the previous block is filled, so the
+  consumer never sees a partially written element. The consumer
+  releases the blocks that it has completely read.
+  The producer never waits for the consumer.
+*/
+template < typename T, std::size_t BLOCK_SIZE = 128 >
+class AppendQueue {
+private:
+
+    struct Block {
+        std::array< T, BLOCK_SIZE > data_;
+        std::atomic< std::size_t > size_; //!< the number of the published elements
+        std::atomic< Block * > next_;
+
+        Block()
+            : size_( 0 ),
+              next_( nullptr )
+          { }
+    };
+
+    // producer side
+    Block * M_tail;
+
+    // consumer side
+    Block * M_head;
+    std::size_t M_head_pos;
+
+    // not used
+    AppendQueue( const AppendQueue & ) = delete;
+    AppendQueue & operator=( const AppendQueue & ) = delete;
+
+public:
+
+    AppendQueue()
+        : M_tail( new Block() ),
+          M_head( M_tail ),
+          M_head_pos( 0 )
+      { }
+
+    ~AppendQueue()
+      {
+          while ( M_head )
+          {
+              Block * next = M_head->next_.load( std::memory_order_acquire );
+              delete M_head;
+              M_head = next;
+          }
+      }
+
+    /*!
+      \brief (producer) append the element
+      \param value moved element
+     */
+    void push( T && value )
+      {
+          std::size_t n = M_tail->size_.load( std::memory_order_relaxed );
+          if ( n == BLOCK_SIZE )
+          {
+              Block * block = new Block();
+              M_tail->next_.store( block, std::memory_order_release );
+              M_tail = block;
+              n = 0;
+          }
+
+          M_tail->data_[n] = std::move( value );
+          M_tail->size_.store( n + 1, std::memory_order_release );
+      }
+
+    /*!
+      \brief (consumer) get the oldest element
+      \param value reference to the variable to which the element is moved
+      \return true if an element was available
+     */
+    bool pop( T & value )
+      {
+          if ( M_head_pos == BLOCK_SIZE )
+          {
+              Block * next = M_head->next_.load( std::memory_order_acquire );
+              if ( ! next )
+              {
+                  return false;
+              }
+
+              delete M_head;
+              M_head = next;
+              M_head_pos = 0;
+          }
+
+          if ( M_head_pos == M_head->size_.load( std::memory_order_acquire ) )
+          {
+              return false;
+          }
+
+          value = std::move( M_head->data_[M_head_pos] );
+          ++M_head_pos;
+          return true;
+      }
+};
+
+#endif
@@ -133,6 +133,74 @@ BallPainter::draw( QPainter & painter )
 /*-------------------------------------------------------------------*/
 /*!
 
+*/
+bool
+BallPainter::addFrameRegion( QRegion & region ) const
+{
+    const Options & opt = Options::instance();
+
+    if ( ! opt.showBall() )
+    {
+        return true;
+    }
+
+    DispConstPtr disp = M_disp_holder.currentDisp();
+
+    if ( ! disp )
+    {
+        return true;
+    }
+
+    const rcss::rcg::ServerParamT & SP = M_disp_holder.serverParam();
+
+    // the same radius as draw(), and the margin for the pen width
+    const int ball_radius = ( opt.ballSize() >= 0.01
+                              ? opt.scale( opt.ballSize() )
+                              : std::max( 1, opt.scale( SP.ball_size_ ) ) );
+    const int kickable_radius
+        = std::max( 1, opt.scale( SP.player_size_
+                                  + SP.kickable_margin_
+                                  + SP.ball_size_ ) );
+    const int r = std::max( ball_radius, kickable_radius ) + 2;
+
+    QRect rect( opt.screenX( disp->show_.ball_.x_ ) - r,
+                opt.screenY( disp->show_.ball_.y_ ) - r,
+                r * 2 + 1,
+                r * 2 + 1 );
+
+    if ( opt.ballVelCycle() > 0
+         && disp->show_.ball_.hasVelocity() )
+    {
+        // the ball moves straight, and the trace is inside the rectangle
+        // between the current position and the last point.
+        Vector2D bpos( disp->show_.ball_.x_,
+                       disp->show_.ball_.y_ );
+        Vector2D bvel( disp->show_.ball_.vx_,
+                       disp->show_.ball_.vy_ );
+
+        const int max_cycle = std::min( 100, opt.ballVelCycle() );
+        for ( int i = 0; i < max_cycle; ++i )
+        {
+            bpos += bvel;
+            bvel *= SP.ball_decay_;
+        }
+
+        const int ix = opt.screenX( bpos.x );
+        const int iy = opt.screenY( bpos.y );
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 0, 0))
+        rect = rect.united( QRect( ix - 3, iy - 3, 7, 7 ) );
+#else
+        rect = rect.unite( QRect( ix - 3, iy - 3, 7, 7 ) );
+#endif
+    }
+
+    region += rect;
+    return true;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
 */
 void
 BallPainter::drawVelocity( QPainter & painter ) const
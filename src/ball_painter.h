@@ -52,6 +52,7 @@ public:
     ~BallPainter();
 
     void draw( QPainter & painter ) override;
+    bool addFrameRegion( QRegion & region ) const override;
 
 private:
 
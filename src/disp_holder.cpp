@@ -41,8 +41,6 @@
 
 #include <rcss/rcg/util.h>
 #include <rcss/rcg/parser_v1.h>
-#include <rcss/rcg/parser_v4.h>
-#include <rcss/rcg/parser_simdjson.h>
 
 #ifdef HAVE_ARPA_INET_H
 #include <arpa/inet.h>
@@ -62,9 +60,20 @@
 #include <cstring>
 
 const size_t DispHolder::INVALID_INDEX = size_t( -1 );
-const size_t DispHolder::MAX_SIZE = 65535;
 
 namespace {
+
+//! the maximum cycle registered to the dense cycle index
+const size_t MAX_INDEXED_CYCLE = 1024 * 1024;
+
+inline
+std::uint64_t
+stoppage_key( const rcss::rcg::UInt32 time,
+              const rcss::rcg::UInt32 stime )
+{
+    return ( std::uint64_t( time ) << 32 ) | stime;
+}
+
 // struct TimeCmp {
 //     bool operator()( const DispConstPtr & lhs,
 //                      const rcss::rcg::UInt32 rhs )
@@ -91,9 +100,12 @@ my_ntohs( const rcss::rcg::Int16 val )
 
  */
 DispHolder::DispHolder()
-    : M_current_index( INVALID_INDEX )
+    : M_param_revision( 0 ),
+      M_released_size( 0 ),
+      M_current_index( INVALID_INDEX ),
+      M_cached_index( INVALID_INDEX )
 {
-    M_disp_cont.reserve( MAX_SIZE );
+    M_disp_cont.setMemoryLimit( size_t( Options::instance().maxDispMemory() ) * 1024 * 1024 );
 }
 
 /*-------------------------------------------------------------------*/
@@ -115,13 +127,12 @@ DispHolder::clear()
     M_server_param.copyFrom( rcss::rcg::ServerParamT() );
     M_player_param.copyFrom( rcss::rcg::PlayerParamT() );
     M_player_types.clear();
+    ++M_param_revision;
 
     M_team_graphic_left.clear();
     M_team_graphic_right.clear();
 
-    M_point_cont.clear();
-    M_circle_cont.clear();
-    M_line_cont.clear();
+    M_draw_store.clear();
 
     M_playmode = rcss::rcg::PM_Null;
     M_teams[0].clear();
@@ -131,10 +142,18 @@ DispHolder::clear()
     M_penalty_scores_left.clear();
     M_penalty_scores_right.clear();
 
-    M_disp.reset();
     M_disp_cont.clear();
+    M_disp_cont.setMemoryLimit( size_t( Options::instance().maxDispMemory() ) * 1024 * 1024 );
+
+    M_released_size = 0;
+    M_cycle_index.clear();
+    M_stoppage_index.clear();
+    M_stoppage_keys.clear();
 
     M_current_index = INVALID_INDEX;
+
+    M_cached_index = INVALID_INDEX;
+    M_cached_disp.reset();
 }
 
 /*-------------------------------------------------------------------*/
@@ -162,13 +181,34 @@ DispHolder::playerType( const int id ) const
 DispConstPtr
 DispHolder::currentDisp() const
 {
-    if ( M_current_index != INVALID_INDEX
-         && M_current_index < M_disp_cont.size() )
+    size_t idx = M_current_index;
+
+    if ( idx == INVALID_INDEX
+         || M_disp_cont.size() <= idx )
+    {
+        if ( M_disp_cont.empty() )
+        {
+            return DispConstPtr();
+        }
+
+        idx = M_disp_cont.size() - 1;
+    }
+
+    if ( M_cached_index != idx
+         || ! M_cached_disp )
     {
-        return M_disp_cont[M_current_index];
+        // do not overwrite the data still referred from others
+        if ( ! M_cached_disp
+             || M_cached_disp.use_count() > 1 )
+        {
+            M_cached_disp = std::make_shared< rcss::rcg::DispInfoT >();
+        }
+
+        M_disp_cont.get( idx, *M_cached_disp );
+        M_cached_index = idx;
     }
 
-    return M_disp;
+    return M_cached_disp;
 }
 
 /*-------------------------------------------------------------------*/
@@ -178,7 +218,7 @@ DispHolder::currentDisp() const
 bool
 DispHolder::addDispInfoV1( const rcss::rcg::dispinfo_t & disp )
 {
-    RCGHandler handler( nullptr, *this );
+    RCGHandler handler( *this );
     return handler.handleDispInfo( disp );
 }
 
@@ -189,7 +229,7 @@ DispHolder::addDispInfoV1( const rcss::rcg::dispinfo_t & disp )
 bool
 DispHolder::addDispInfoV2( const rcss::rcg::dispinfo_t2 & disp )
 {
-    RCGHandler handler( nullptr, *this );
+    RCGHandler handler( *this );
     return handler.handleDispInfo2( disp );
 }
 
@@ -198,60 +238,73 @@ DispHolder::addDispInfoV2( const rcss::rcg::dispinfo_t2 & disp )
 
  */
 bool
-DispHolder::addDispInfoV3( const char * msg )
-{
-    rcss::rcg::ParserV4 parser;
-    RCGHandler handler( nullptr, *this );
-    return parser.parseLine( -1, msg, handler );
-}
-
-
-/*-------------------------------------------------------------------*/
-/*!
-
- */
-bool
-DispHolder::addJSON( const char * msg )
+DispHolder::handleShow( const rcss::rcg::ShowInfoT & show )
 {
-    rcss::rcg::ParserSimdJSON parser;
-    RCGHandler handler( nullptr, *this );
-    return parser.parseData( msg, handler );
-}
+    const size_t removed = M_disp_cont.push_back( M_playmode, M_teams[0], M_teams[1], show );
 
+    if ( removed > 0 )
+    {
+        // the oldest data were released to keep the memory budget.
+        // shift the indices refering the stored data.
+        if ( M_current_index != INVALID_INDEX )
+        {
+            M_current_index = ( M_current_index < removed
+                                ? 0
+                                : M_current_index - removed );
+        }
 
-/*-------------------------------------------------------------------*/
-/*!
-
- */
-bool
-DispHolder::handleShow( const rcss::rcg::ShowInfoT & show )
-{
-    DispPtr disp( new rcss::rcg::DispInfoT );
+        std::vector< size_t >::iterator it = std::remove_if( M_score_changed_index.begin(),
+                                                             M_score_changed_index.end(),
+                                                             [removed]( const size_t idx )
+                                                             {
+                                                                 return idx < removed;
+                                                             } );
+        M_score_changed_index.erase( it, M_score_changed_index.end() );
+        for ( size_t & idx : M_score_changed_index )
+        {
+            idx -= removed;
+        }
 
-    disp->pmode_ = M_playmode;
-    disp->team_[0] = M_teams[0];
-    disp->team_[1] = M_teams[1];
-    disp->show_ = show;
+        M_cached_index = INVALID_INDEX;
+        M_released_size += removed;
 
-#if 0
-    if ( ! M_disp_cont.empty() )
-    {
-        if ( ( M_playmode == rcss::rcg::PM_BeforeKickOff
-               && M_disp_cont.back()->pmode_ == rcss::rcg::PM_BeforeKickOff )
-             || ( M_playmode == rcss::rcg::PM_TimeOver
-                  && M_disp_cont.back()->pmode_ == rcss::rcg::PM_TimeOver ) )
+        // the stoppage entries are registered in the order of the index.
+        while ( ! M_stoppage_keys.empty() )
         {
-            M_disp_cont.pop_back();
+            std::unordered_map< std::uint64_t, size_t >::iterator s = M_stoppage_index.find( M_stoppage_keys.front() );
+            if ( s != M_stoppage_index.end()
+                 && s->second >= M_released_size )
+            {
+                break;
+            }
+
+            if ( s != M_stoppage_index.end() )
+            {
+                M_stoppage_index.erase( s );
+            }
+            M_stoppage_keys.pop_front();
         }
     }
-#endif
 
-    if ( M_disp_cont.size() <= MAX_SIZE )
+    //
+    // update the cycle index
+    //
+    const size_t abs_index = M_released_size + M_disp_cont.size() - 1;
+    if ( show.time_ >= M_cycle_index.size()
+         && show.time_ < MAX_INDEXED_CYCLE )
     {
-        M_disp_cont.push_back( disp );
+        // the skipped cycles also refer to this data
+        M_cycle_index.resize( show.time_ + 1, abs_index );
     }
 
-    M_disp = disp;
+    if ( show.stime_ > 0 )
+    {
+        const std::uint64_t key = stoppage_key( show.time_, show.stime_ );
+        if ( M_stoppage_index.emplace( key, abs_index ).second )
+        {
+            M_stoppage_keys.push_back( key );
+        }
+    }
 
     return true;
 }
@@ -329,34 +382,18 @@ DispHolder::handleTeam( const int /* time */,
 bool
 DispHolder::handleDrawClear( const int time )
 {
-    M_point_cont.erase( time );
-    M_circle_cont.erase( time );
-    M_line_cont.erase( time );
-
-//     {
-//         PointCont::iterator first = M_point_cont.lower_bound( 0 );
-//         PointCont::iterator last = M_point_cont.upper_bound( time );
-//         M_point_cont.erase( first, last );
-//     }
-//     {
-//         CircleCont::iterator first = M_circle_cont.lower_bound( 0 );
-//         CircleCont::iterator last = M_circle_cont.upper_bound( time );
-//         M_circle_cont.erase( first, last );
-//     }
-//     {
-//         LineCont::iterator first = M_line_cont.lower_bound( 0 );
-//         LineCont::iterator last = M_line_cont.upper_bound( time );
-//         M_line_cont.erase( first, last );
-//     }
+    M_draw_store.clear( time );
     return true;
 }
 
 /*-------------------------------------------------------------------*/
 bool
 DispHolder::handleDrawPoint( const int time,
-                             const rcss::rcg::PointT & point )
+                             const float x,
+                             const float y,
+                             const char * color )
 {
-    M_point_cont[time].push_back( point );
+    M_draw_store.addPoint( time, x, y, color );
     return true;
 }
 
@@ -366,9 +403,12 @@ DispHolder::handleDrawPoint( const int time,
  */
 bool
 DispHolder::handleDrawCircle( const int time,
-                              const rcss::rcg::CircleT & circle )
+                              const float x,
+                              const float y,
+                              const float r,
+                              const char * color )
 {
-    M_circle_cont[time].push_back( circle );
+    M_draw_store.addCircle( time, x, y, r, color );
     return true;
 }
 
@@ -378,9 +418,13 @@ DispHolder::handleDrawCircle( const int time,
  */
 bool
 DispHolder::handleDrawLine( const int time,
-                            const rcss::rcg::LineT & line )
+                            const float x1,
+                            const float y1,
+                            const float x2,
+                            const float y2,
+                            const char * color )
 {
-    M_line_cont[time].push_back( line );
+    M_draw_store.addLine( time, x1, y1, x2, y2, color );
     return true;
 }
 
@@ -392,6 +436,7 @@ bool
 DispHolder::handleServerParam( const rcss::rcg::ServerParamT & param )
 {
     M_server_param.copyFrom( param );
+    ++M_param_revision;
     return true;
 }
 
@@ -414,6 +459,7 @@ bool
 DispHolder::handlePlayerType( const rcss::rcg::PlayerTypeT & param )
 {
     M_player_types.insert( std::pair< int, rcss::rcg::PlayerTypeT >( param.id_, param ) );
+    ++M_param_revision;
     return true;
 }
 
@@ -574,9 +620,10 @@ DispHolder::setIndex( const size_t idx )
 
  */
 bool
-DispHolder::setCycle( const int cycle )
+DispHolder::setCycle( const int cycle,
+                      const int stime )
 {
-    std::size_t idx = getIndex( cycle );
+    std::size_t idx = getIndex( cycle, stime );
 
     if ( idx == M_current_index
          || idx == INVALID_INDEX )
@@ -593,21 +640,52 @@ DispHolder::setCycle( const int cycle )
 
  */
 size_t
-DispHolder::getIndex( const int cycle ) const
+DispHolder::getIndex( const int cycle,
+                      const int stime ) const
 {
-    DispCont::const_iterator it = std::lower_bound( M_disp_cont.begin(),
-                                                    M_disp_cont.end(),
-                                                    rcss::rcg::UInt32( cycle ),
-                                                    //TimeCmp() );
-                                                    []( const DispConstPtr & lhs,
-                                                        const rcss::rcg::UInt32 rhs )
-                                                    {
-                                                        return lhs->show_.time_ < rhs;
-                                                    } );
-    if ( it == M_disp_cont.end() )
+    if ( M_disp_cont.empty() )
+    {
+        return INVALID_INDEX;
+    }
+
+    if ( cycle < 0 )
+    {
+        return 0;
+    }
+
+    if ( stime > 0 )
+    {
+        std::unordered_map< std::uint64_t, size_t >::const_iterator it
+            = M_stoppage_index.find( stoppage_key( rcss::rcg::UInt32( cycle ),
+                                                   rcss::rcg::UInt32( stime ) ) );
+        if ( it != M_stoppage_index.end()
+             && it->second >= M_released_size )
+        {
+            return it->second - M_released_size;
+        }
+    }
+
+    if ( static_cast< size_t >( cycle ) < M_cycle_index.size() )
+    {
+        const size_t abs_index = M_cycle_index[cycle];
+        // if the data have been released, the oldest remaining data is the lower bound.
+        return ( abs_index < M_released_size
+                 ? 0
+                 : abs_index - M_released_size );
+    }
+
+    if ( M_disp_cont.time( M_disp_cont.size() - 1 ) < rcss::rcg::UInt32( cycle ) )
+    {
+        // no data after the cycle
+        return INVALID_INDEX;
+    }
+
+    // the cycle beyond the dense index
+    const size_t idx = M_disp_cont.lowerBound( rcss::rcg::UInt32( cycle ) );
+    if ( idx >= M_disp_cont.size() )
     {
         return INVALID_INDEX;
     }
 
-    return std::distance( M_disp_cont.begin(), it );
+    return idx;
 }
@@ -35,23 +35,22 @@
 
 #include <rcss/rcg/types.h>
 
+#include <cstdint>
+#include <deque>
 #include <memory>
 #include <vector>
 #include <unordered_map>
 
+#include "disp_store.h"
+#include "draw_store.h"
 #include "team_graphic.h"
 
 typedef std::shared_ptr< rcss::rcg::DispInfoT > DispPtr;
 typedef std::shared_ptr< const rcss::rcg::DispInfoT > DispConstPtr;
-typedef std::vector< DispConstPtr > DispCont;
-typedef std::unordered_map< int, std::vector< rcss::rcg::PointT > > PointCont;
-typedef std::unordered_map< int, std::vector< rcss::rcg::CircleT > > CircleCont;
-typedef std::unordered_map< int, std::vector< rcss::rcg::LineT > > LineCont;
 
 class DispHolder {
 public:
     static const size_t INVALID_INDEX;
-    static const size_t MAX_SIZE;
 
 private:
 
@@ -59,13 +58,13 @@ private:
     rcss::rcg::PlayerParamT M_player_param;
     rcss::rcg::PlayerTypeT M_default_player_type;
     std::unordered_map< int, rcss::rcg::PlayerTypeT > M_player_types;
+    //! incremented when the server parameters or the player types are changed
+    std::size_t M_param_revision;
 
     TeamGraphic M_team_graphic_left;
     TeamGraphic M_team_graphic_right;
 
-    PointCont M_point_cont;
-    CircleCont M_circle_cont;
-    LineCont M_line_cont;
+    DrawStore M_draw_store; //!< points, circles and lines for debug drawing
 
     rcss::rcg::PlayMode M_playmode; //!< last handled playmode
     rcss::rcg::TeamT M_teams[2]; //!< last handled team info
@@ -77,11 +76,23 @@ private:
     std::vector< std::pair< int, rcss::rcg::PlayMode > > M_penalty_scores_left;
     std::vector< std::pair< int, rcss::rcg::PlayMode > > M_penalty_scores_right;
 
-    DispPtr M_disp; //!< the last handled display data
-    DispCont M_disp_cont; //!< the container of all display data
+    DispStore M_disp_cont; //!< the container of all display data
+
+    //! the number of the data released by the memory budget.
+    //! (the index in M_disp_cont) = (the absolute index) - M_released_size
+    size_t M_released_size;
+    //! the absolute index of the first data whose time is not less than the cycle
+    std::vector< size_t > M_cycle_index;
+    //! the absolute index of the stoppage time data. key: ( time << 32 ) | stime
+    std::unordered_map< std::uint64_t, size_t > M_stoppage_index;
+    //! the keys of M_stoppage_index in the order of the absolute index
+    std::deque< std::uint64_t > M_stoppage_keys;
 
     size_t M_current_index;
 
+    mutable size_t M_cached_index; //!< index of M_cached_disp
+    mutable DispPtr M_cached_disp; //!< the display data rebuilt from M_disp_cont
+
     // not used
     DispHolder( const DispHolder & ) = delete;
     DispHolder operator=( const DispHolder & ) = delete;
@@ -97,6 +108,7 @@ public:
     const rcss::rcg::PlayerParamT & playerParam() const { return M_player_param; }
     const std::unordered_map< int, rcss::rcg::PlayerTypeT > & playerTypes() const { return M_player_types; }
     const rcss::rcg::PlayerTypeT & playerType( const int id ) const;
+    std::size_t paramRevision() const { return M_param_revision; }
 
     rcss::rcg::PlayMode playmode() const { return M_playmode; }
 
@@ -117,18 +129,14 @@ public:
           return M_penalty_scores_right;
       }
 
-    const PointCont & pointCont() const { return M_point_cont; }
-    const CircleCont & circleCont() const { return M_circle_cont; }
-    const LineCont & lineCont() const { return M_line_cont; }
+    const DrawStore & drawStore() const { return M_draw_store; }
 
     size_t currentIndex() const { return M_current_index; }
     DispConstPtr currentDisp() const;
-    const DispCont & dispCont() const { return M_disp_cont; }
+    const DispStore & dispCont() const { return M_disp_cont; }
 
     bool addDispInfoV1( const rcss::rcg::dispinfo_t & disp );
     bool addDispInfoV2( const rcss::rcg::dispinfo_t2 & disp );
-    bool addDispInfoV3( const char * msg );
-    bool addJSON( const char * msg );
 
 public:
 
@@ -160,13 +168,22 @@ public:
     bool handleDrawClear( const int time );
 
     bool handleDrawPoint( const int time,
-                          const rcss::rcg::PointT & point );
+                          const float x,
+                          const float y,
+                          const char * color );
 
     bool handleDrawCircle( const int time,
-                           const rcss::rcg::CircleT & circle );
+                           const float x,
+                           const float y,
+                           const float r,
+                           const char * color );
 
     bool handleDrawLine( const int time,
-                         const rcss::rcg::LineT & line );
+                         const float x1,
+                         const float y1,
+                         const float x2,
+                         const float y2,
+                         const char * color );
 
 private:
     void analyzeTeamGraphic( const std::string & msg );
@@ -178,8 +195,10 @@ public:
     bool setIndexStepBack();
     bool setIndexStepForward();
     bool setIndex( const size_t idx );
-    bool setCycle( const int cycle );
-    size_t getIndex( const int cycle ) const;
+    bool setCycle( const int cycle,
+                   const int stime = 0 );
+    size_t getIndex( const int cycle,
+                     const int stime = 0 ) const;
 
 
 };
@@ -0,0 +1,449 @@
+// -*-c++-*-
+
+/*!
+  \file disp_store.cpp
+  \brief columnar display data store class Source File.
+*/
+
+/*
+ *Copyright:
+
+ Copyright (C) The RoboCup Soccer Server Maintenance Group.
+ Hidehisa AKIYAMA
+
+ This code is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 3, or (at your option)
+ any later version.
+
+ This code is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this code; see the file COPYING.	If not, write to
+ the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+
+ *EndCopyright:
+ */
+
+/////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "disp_store.h"
+
+#include <algorithm>
+
+const size_t DispStore::PLAYER_SIZE;
+const size_t DispStore::CHUNK_SIZE;
+const size_t DispStore::MAX_SPARE_CHUNKS;
+const size_t DispStore::COUNT_SIZE;
+const size_t DispStore::Chunk::ROWS;
+
+namespace {
+
+//! the counter members of PlayerT in the order of DispStore::PlayerCount
+rcss::rcg::UInt16 rcss::rcg::PlayerT::* const COUNT_MEMBERS[DispStore::COUNT_SIZE] = {
+    &rcss::rcg::PlayerT::kick_count_,
+    &rcss::rcg::PlayerT::dash_count_,
+    &rcss::rcg::PlayerT::turn_count_,
+    &rcss::rcg::PlayerT::catch_count_,
+    &rcss::rcg::PlayerT::move_count_,
+    &rcss::rcg::PlayerT::turn_neck_count_,
+    &rcss::rcg::PlayerT::change_view_count_,
+    &rcss::rcg::PlayerT::say_count_,
+    &rcss::rcg::PlayerT::tackle_count_,
+    &rcss::rcg::PlayerT::pointto_count_,
+    &rcss::rcg::PlayerT::attentionto_count_,
+    &rcss::rcg::PlayerT::change_focus_count_,
+};
+
+inline
+bool
+same_team( const rcss::rcg::TeamT & lhs,
+           const rcss::rcg::TeamT & rhs )
+{
+    return ( lhs.score_ == rhs.score_
+             && lhs.pen_score_ == rhs.pen_score_
+             && lhs.pen_miss_ == rhs.pen_miss_
+             && lhs.name_ == rhs.name_ );
+}
+
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+DispStore::PlayerAttr::PlayerAttr( const rcss::rcg::PlayerT & p )
+    : unum_( p.unum_ ),
+      type_( p.type_ ),
+      focus_unum_( p.focus_unum_ ),
+      side_( p.side_ ),
+      view_quality_( p.view_quality_ ),
+      focus_side_( p.focus_side_ ),
+      point_x_( p.point_x_ ),
+      point_y_( p.point_y_ ),
+      view_width_( p.view_width_ ),
+      focus_dist_( p.focus_dist_ ),
+      focus_dir_( p.focus_dir_ )
+{
+
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+bool
+DispStore::PlayerAttr::equals( const rcss::rcg::PlayerT & p ) const
+{
+    return ( unum_ == p.unum_
+             && type_ == p.type_
+             && focus_unum_ == p.focus_unum_
+             && side_ == p.side_
+             && view_quality_ == p.view_quality_
+             && focus_side_ == p.focus_side_
+             && point_x_ == p.point_x_
+             && point_y_ == p.point_y_
+             && view_width_ == p.view_width_
+             && focus_dist_ == p.focus_dist_
+             && focus_dir_ == p.focus_dir_ );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+DispStore::PlayerStatus::PlayerStatus( const rcss::rcg::PlayerT & p )
+    : state_( p.state_ ),
+      effort_( p.effort_ ),
+      recovery_( p.recovery_ )
+{
+
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+bool
+DispStore::PlayerStatus::equals( const rcss::rcg::PlayerT & p ) const
+{
+    return ( state_ == p.state_
+             && effort_ == p.effort_
+             && recovery_ == p.recovery_ );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+const DispStore::Segment &
+DispStore::Chunk::segment( const size_t i ) const
+{
+    std::vector< Segment >::const_iterator it
+        = std::upper_bound( segments_.begin(), segments_.end(),
+                            i,
+                            []( const size_t idx, const Segment & s )
+                            {
+                                return idx < s.first_;
+                            } );
+    return *( it - 1 );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+DispStore::DispStore()
+    : M_size( 0 ),
+      M_max_chunks( 0 )
+{
+    M_last_attr.fill( 0 );
+    M_last_status.fill( 0 );
+    M_last_count.fill( 0 );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+DispStore::clear()
+{
+    for ( std::unique_ptr< Chunk > & c : M_chunks )
+    {
+        if ( M_spare_chunks.size() >= MAX_SPARE_CHUNKS )
+        {
+            break;
+        }
+
+        c->clear();
+        M_spare_chunks.push_back( std::move( c ) );
+    }
+
+    M_chunks.clear();
+    M_size = 0;
+    M_last_attr.fill( 0 );
+    M_last_status.fill( 0 );
+    M_last_count.fill( 0 );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+DispStore::setMemoryLimit( const size_t bytes )
+{
+    if ( bytes == 0 )
+    {
+        M_max_chunks = 0;
+        return;
+    }
+
+    // keep at least two chunks not to lose the latest data at the chunk boundary.
+    M_max_chunks = std::max( size_t( 2 ), bytes / sizeof( Chunk ) );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+DispStore::Chunk &
+DispStore::appendChunk( size_t * removed )
+{
+    if ( M_max_chunks != 0
+         && M_chunks.size() >= M_max_chunks )
+    {
+        // recycle the oldest chunk
+        std::unique_ptr< Chunk > chunk = std::move( M_chunks.front() );
+        M_chunks.erase( M_chunks.begin() );
+
+        *removed += chunk->size_;
+        M_size -= chunk->size_;
+
+        chunk->clear();
+        M_chunks.push_back( std::move( chunk ) );
+    }
+    else if ( ! M_spare_chunks.empty() )
+    {
+        M_chunks.push_back( std::move( M_spare_chunks.back() ) );
+        M_spare_chunks.pop_back();
+    }
+    else
+    {
+        M_chunks.emplace_back( new Chunk() );
+    }
+
+    M_last_attr.fill( 0 );
+    M_last_status.fill( 0 );
+    M_last_count.fill( 0 );
+    return *M_chunks.back();
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+size_t
+DispStore::push_back( const rcss::rcg::PlayMode pmode,
+                      const rcss::rcg::TeamT & team_l,
+                      const rcss::rcg::TeamT & team_r,
+                      const rcss::rcg::ShowInfoT & show )
+{
+    size_t removed = 0;
+
+    Chunk & c = ( M_chunks.empty() || M_chunks.back()->size_ == CHUNK_SIZE
+                  ? appendChunk( &removed )
+                  : *M_chunks.back() );
+
+    const size_t idx = c.size_;
+
+    //
+    // playmode and team
+    //
+    if ( c.teams_.empty()
+         || ! same_team( c.teams_.back()[0], team_l )
+         || ! same_team( c.teams_.back()[1], team_r ) )
+    {
+        c.teams_.push_back( { team_l, team_r } );
+    }
+
+    if ( c.segments_.empty()
+         || c.segments_.back().pmode_ != pmode
+         || c.segments_.back().teams_ != c.teams_.size() - 1 )
+    {
+        c.segments_.push_back( Segment{ idx, pmode, c.teams_.size() - 1 } );
+    }
+
+    //
+    // ball
+    //
+    c.time_[idx] = show.time_;
+    c.stime_[idx] = show.stime_;
+
+    c.ball_x_[idx] = show.ball_.x_;
+    c.ball_y_[idx] = show.ball_.y_;
+    c.ball_vx_[idx] = show.ball_.vx_;
+    c.ball_vy_[idx] = show.ball_.vy_;
+
+    //
+    // players
+    //
+    const size_t first = idx * PLAYER_SIZE;
+    for ( size_t i = 0; i < PLAYER_SIZE; ++i )
+    {
+        const rcss::rcg::PlayerT & p = show.player_[i];
+        const size_t row = first + i;
+
+        c.player_x_[row] = p.x_;
+        c.player_y_[row] = p.y_;
+        c.player_vx_[row] = p.vx_;
+        c.player_vy_[row] = p.vy_;
+        c.player_body_[row] = p.body_;
+        c.player_neck_[row] = p.neck_;
+        c.player_stamina_[row] = p.stamina_;
+        c.player_stamina_capacity_[row] = p.stamina_capacity_;
+
+        if ( c.attrs_.empty()
+             || ! c.attrs_[M_last_attr[i]].equals( p ) )
+        {
+            M_last_attr[i] = static_cast< rcss::rcg::UInt16 >( c.attrs_.size() );
+            c.attrs_.emplace_back( p );
+        }
+        c.player_attr_[row] = M_last_attr[i];
+
+        if ( c.status_.empty()
+             || ! c.status_[M_last_status[i]].equals( p ) )
+        {
+            M_last_status[i] = static_cast< rcss::rcg::UInt16 >( c.status_.size() );
+            c.status_.emplace_back( p );
+        }
+        c.player_status_[row] = M_last_status[i];
+
+        // the counters only increase in a game.
+        // a new base is added if any increment does not fit in 8 bits.
+        CountDelta & delta = c.player_count_delta_[row];
+        bool fit = ! c.counts_.empty();
+        for ( size_t k = 0; fit && k < COUNT_SIZE; ++k )
+        {
+            const int d = int( p.*COUNT_MEMBERS[k] ) - int( c.counts_[M_last_count[i]][k] );
+            fit = ( 0 <= d && d <= 0xFF );
+            delta[k] = static_cast< std::uint8_t >( d );
+        }
+
+        if ( ! fit )
+        {
+            M_last_count[i] = static_cast< rcss::rcg::UInt16 >( c.counts_.size() );
+            c.counts_.emplace_back();
+            for ( size_t k = 0; k < COUNT_SIZE; ++k )
+            {
+                c.counts_.back()[k] = p.*COUNT_MEMBERS[k];
+            }
+            delta.fill( 0 );
+        }
+        c.player_count_[row] = M_last_count[i];
+    }
+
+    c.size_ += 1;
+    M_size += 1;
+
+    return removed;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+DispStore::get( const size_t idx,
+                rcss::rcg::DispInfoT & disp ) const
+{
+    const Chunk & c = *M_chunks[idx / CHUNK_SIZE];
+    const size_t i = idx % CHUNK_SIZE;
+    const Segment & seg = c.segment( i );
+
+    disp.pmode_ = seg.pmode_;
+    disp.team_[0] = c.teams_[seg.teams_][0];
+    disp.team_[1] = c.teams_[seg.teams_][1];
+
+    disp.show_.time_ = c.time_[i];
+    disp.show_.stime_ = c.stime_[i];
+
+    disp.show_.ball_.x_ = c.ball_x_[i];
+    disp.show_.ball_.y_ = c.ball_y_[i];
+    disp.show_.ball_.vx_ = c.ball_vx_[i];
+    disp.show_.ball_.vy_ = c.ball_vy_[i];
+
+    const size_t first = i * PLAYER_SIZE;
+    for ( size_t k = 0; k < PLAYER_SIZE; ++k )
+    {
+        rcss::rcg::PlayerT & p = disp.show_.player_[k];
+        const size_t row = first + k;
+        const PlayerAttr & a = c.attrs_[c.player_attr_[row]];
+        const PlayerStatus & st = c.status_[c.player_status_[row]];
+        const PlayerCount & n = c.counts_[c.player_count_[row]];
+        const CountDelta & delta = c.player_count_delta_[row];
+
+        p.side_ = a.side_;
+        p.unum_ = a.unum_;
+        p.type_ = a.type_;
+        p.view_quality_ = a.view_quality_;
+        p.focus_side_ = a.focus_side_;
+        p.focus_unum_ = a.focus_unum_;
+        p.state_ = st.state_;
+        p.x_ = c.player_x_[row];
+        p.y_ = c.player_y_[row];
+        p.vx_ = c.player_vx_[row];
+        p.vy_ = c.player_vy_[row];
+        p.body_ = c.player_body_[row];
+        p.neck_ = c.player_neck_[row];
+        p.point_x_ = a.point_x_;
+        p.point_y_ = a.point_y_;
+        p.view_width_ = a.view_width_;
+        p.focus_dist_ = a.focus_dist_;
+        p.focus_dir_ = a.focus_dir_;
+        p.stamina_ = c.player_stamina_[row];
+        p.effort_ = st.effort_;
+        p.recovery_ = st.recovery_;
+        p.stamina_capacity_ = c.player_stamina_capacity_[row];
+        for ( size_t j = 0; j < COUNT_SIZE; ++j )
+        {
+            p.*COUNT_MEMBERS[j] = static_cast< rcss::rcg::UInt16 >( n[j] + delta[j] );
+        }
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+size_t
+DispStore::lowerBound( const rcss::rcg::UInt32 t ) const
+{
+    size_t first = 0;
+    size_t count = M_size;
+
+    while ( count > 0 )
+    {
+        const size_t step = count / 2;
+        const size_t idx = first + step;
+        if ( time( idx ) < t )
+        {
+            first = idx + 1;
+            count -= step + 1;
+        }
+        else
+        {
+            count = step;
+        }
+    }
+
+    return first;
+}
@@ -0,0 +1,306 @@
+// -*-c++-*-
+
+/*!
+  \file disp_store.h
+  \brief columnar display data store class Header File.
+*/
+
+/*
+ *Copyright:
+
+ Copyright (C) The RoboCup Soccer Server Maintenance Group.
+ Hidehisa AKIYAMA
+
+ This code is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 3, or (at your option)
+ any later version.
+
+ This code is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this code; see the file COPYING.	If not, write to
+ the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+
+ *EndCopyright:
+ */
+
+/////////////////////////////////////////////////////////////////////
+
+#ifndef RCSSMONITOR_DISP_STORE_H
+#define RCSSMONITOR_DISP_STORE_H
+
+#include <rcss/rcg/types.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/*!
+  \class DispStore
+  \brief structure-of-arrays container of the display data.
+
+  The data are stored in the fixed size chunks. Each chunk holds
+  CHUNK_SIZE cycles as fixed-width rows of the ball/player columns, so
+  the store grows without reallocating or copying the stored data.
+  Playmode and team information are stored only when they are changed,
+  as the segments that start at the given index. Player attributes that
+  rarely change (type, view mode, focus, pointing...) and the status
+  (state flags, effort, recovery) are interned in the same way for each
+  player. The command counters are stored as the 8 bit increments from
+  an interned base. All of them are kept in each chunk so that a chunk
+  can be released independently. No value is quantized, i.e., get()
+  returns exactly the pushed data.
+  If the maximum number of chunks is set, the oldest chunk is recycled
+  when a new chunk is required. The chunks released by clear() are also
+  kept (up to MAX_SPARE_CHUNKS) and reused for the next data, so that
+  reopening logs does not repeat large allocations.
+  DispInfoT is rebuilt on demand by get().
+*/
+class DispStore {
+public:
+    //! the number of player rows in one cycle
+    static const size_t PLAYER_SIZE = rcss::rcg::MAX_PLAYER * 2;
+    //! the number of cycles in one chunk
+    static const size_t CHUNK_SIZE = 1024;
+    //! the maximum number of released chunks kept for reuse
+    static const size_t MAX_SPARE_CHUNKS = 8;
+    //! the number of the command counters
+    static const size_t COUNT_SIZE = 12;
+
+private:
+
+    /*!
+      \brief player variables rarely changed.
+      successive cycles share the same instance.
+     */
+    struct PlayerAttr {
+        rcss::rcg::Int16 unum_;
+        rcss::rcg::Int16 type_;
+        rcss::rcg::Int16 focus_unum_;
+        char side_;
+        char view_quality_;
+        char focus_side_;
+
+        float point_x_;
+        float point_y_;
+        float view_width_;
+        float focus_dist_;
+        float focus_dir_;
+
+        PlayerAttr() = default;
+        explicit
+        PlayerAttr( const rcss::rcg::PlayerT & p );
+
+        bool equals( const rcss::rcg::PlayerT & p ) const;
+    };
+
+    /*!
+      \brief player status changed only by the events (kick, collision, stamina decay...).
+      successive cycles share the same instance.
+     */
+    struct PlayerStatus {
+        rcss::rcg::Int32 state_;
+        float effort_;
+        float recovery_;
+
+        PlayerStatus() = default;
+        explicit
+        PlayerStatus( const rcss::rcg::PlayerT & p );
+
+        bool equals( const rcss::rcg::PlayerT & p ) const;
+    };
+
+    /*!
+      \brief command counters in the order of COUNT_MEMBERS.
+      used as the base of CountDelta.
+     */
+    typedef std::array< rcss::rcg::UInt16, COUNT_SIZE > PlayerCount;
+
+    /*!
+      \brief increments of the command counters from the base PlayerCount
+     */
+    typedef std::array< std::uint8_t, COUNT_SIZE > CountDelta;
+
+    /*!
+      \brief playmode and team information shared by the successive cycles
+     */
+    struct Segment {
+        size_t first_; //!< the first index of this segment in the chunk
+        rcss::rcg::PlayMode pmode_;
+        size_t teams_; //!< index of Chunk::teams_
+    };
+
+    /*!
+      \brief columns of CHUNK_SIZE cycles
+     */
+    struct Chunk {
+        static const size_t ROWS = CHUNK_SIZE * PLAYER_SIZE;
+
+        size_t size_; //!< the number of stored cycles
+
+        std::array< rcss::rcg::UInt32, CHUNK_SIZE > time_;
+        std::array< rcss::rcg::UInt32, CHUNK_SIZE > stime_;
+
+        std::array< float, CHUNK_SIZE > ball_x_;
+        std::array< float, CHUNK_SIZE > ball_y_;
+        std::array< float, CHUNK_SIZE > ball_vx_;
+        std::array< float, CHUNK_SIZE > ball_vy_;
+
+        // PLAYER_SIZE rows for each cycle
+        std::array< float, ROWS > player_x_;
+        std::array< float, ROWS > player_y_;
+        std::array< float, ROWS > player_vx_;
+        std::array< float, ROWS > player_vy_;
+        std::array< float, ROWS > player_body_;
+        std::array< float, ROWS > player_neck_;
+        std::array< float, ROWS > player_stamina_;
+        std::array< float, ROWS > player_stamina_capacity_;
+        std::array< rcss::rcg::UInt16, ROWS > player_attr_; //!< index of attrs_
+        std::array< rcss::rcg::UInt16, ROWS > player_status_; //!< index of status_
+        std::array< rcss::rcg::UInt16, ROWS > player_count_; //!< index of counts_
+        std::array< CountDelta, ROWS > player_count_delta_;
+
+        std::vector< PlayerAttr > attrs_; //!< interned player attributes
+        std::vector< PlayerStatus > status_; //!< interned player status
+        std::vector< PlayerCount > counts_; //!< interned base command counters
+        std::vector< std::array< rcss::rcg::TeamT, 2 > > teams_; //!< interned team information
+        std::vector< Segment > segments_;
+
+        Chunk()
+            : size_( 0 )
+          { }
+
+        void clear()
+          {
+              size_ = 0;
+              attrs_.clear();
+              status_.clear();
+              counts_.clear();
+              teams_.clear();
+              segments_.clear();
+          }
+
+        const Segment & segment( const size_t i ) const;
+    };
+
+    std::vector< std::unique_ptr< Chunk > > M_chunks;
+    std::vector< std::unique_ptr< Chunk > > M_spare_chunks; //!< released chunks kept for reuse
+    size_t M_size; //!< total number of stored cycles
+    size_t M_max_chunks; //!< the maximum number of chunks. 0 means unlimited.
+
+    std::array< rcss::rcg::UInt16, PLAYER_SIZE > M_last_attr; //!< the last attribute index of each player
+    std::array< rcss::rcg::UInt16, PLAYER_SIZE > M_last_status; //!< the last status index of each player
+    std::array< rcss::rcg::UInt16, PLAYER_SIZE > M_last_count; //!< the last base counter index of each player
+
+    // not used
+    DispStore( const DispStore & ) = delete;
+    DispStore & operator=( const DispStore & ) = delete;
+
+public:
+
+    DispStore();
+
+    /*!
+      \brief remove all data. released chunks are kept for reuse.
+     */
+    void clear();
+
+    /*!
+      \brief set the memory budget.
+      \param bytes the maximum memory size. 0 means unlimited.
+     */
+    void setMemoryLimit( const size_t bytes );
+
+    bool empty() const
+      {
+          return M_size == 0;
+      }
+
+    size_t size() const
+      {
+          return M_size;
+      }
+
+    /*!
+      \brief append the data of one cycle
+      \param pmode playmode at this cycle
+      \param team_l left team information at this cycle
+      \param team_r right team information at this cycle
+      \param show positional data
+      \return the number of the oldest cycles removed to keep the memory budget.
+      The index of the remaining data is decreased by this value.
+     */
+    size_t push_back( const rcss::rcg::PlayMode pmode,
+                      const rcss::rcg::TeamT & team_l,
+                      const rcss::rcg::TeamT & team_r,
+                      const rcss::rcg::ShowInfoT & show );
+
+    /*!
+      \brief rebuild the display data at the index
+      \param idx index of the cycle
+      \param disp reference to the result variable
+     */
+    void get( const size_t idx,
+              rcss::rcg::DispInfoT & disp ) const;
+
+    /*!
+      \brief get the index of the first cycle whose time is not less than the given time
+      \return index value, or size() if not found
+     */
+    size_t lowerBound( const rcss::rcg::UInt32 time ) const;
+
+    //
+    // column accessors for the analysis passes.
+    //
+
+    rcss::rcg::UInt32 time( const size_t idx ) const
+      {
+          return M_chunks[idx / CHUNK_SIZE]->time_[idx % CHUNK_SIZE];
+      }
+
+    rcss::rcg::PlayMode playmode( const size_t idx ) const
+      {
+          return M_chunks[idx / CHUNK_SIZE]->segment( idx % CHUNK_SIZE ).pmode_;
+      }
+
+    const rcss::rcg::TeamT & team( const size_t idx,
+                                   const int side ) const
+      {
+          const Chunk & c = *M_chunks[idx / CHUNK_SIZE];
+          return c.teams_[c.segment( idx % CHUNK_SIZE ).teams_][side];
+      }
+
+    float ballX( const size_t idx ) const
+      {
+          return M_chunks[idx / CHUNK_SIZE]->ball_x_[idx % CHUNK_SIZE];
+      }
+
+    float ballY( const size_t idx ) const
+      {
+          return M_chunks[idx / CHUNK_SIZE]->ball_y_[idx % CHUNK_SIZE];
+      }
+
+    float playerX( const size_t idx,
+                   const size_t player ) const
+      {
+          return M_chunks[idx / CHUNK_SIZE]->player_x_[( idx % CHUNK_SIZE ) * PLAYER_SIZE + player];
+      }
+
+    float playerY( const size_t idx,
+                   const size_t player ) const
+      {
+          return M_chunks[idx / CHUNK_SIZE]->player_y_[( idx % CHUNK_SIZE ) * PLAYER_SIZE + player];
+      }
+
+private:
+
+    Chunk & appendChunk( size_t * removed );
+
+};
+
+#endif
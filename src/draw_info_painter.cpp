@@ -56,6 +56,7 @@
 DrawInfoPainter::DrawInfoPainter( const DispHolder & disp_holder )
     : M_disp_holder( disp_holder )
     , M_pen( QColor( 255, 255, 255 ), 0, Qt::SolidLine )
+    , M_shape_renderer( nullptr )
 {
 
 }
@@ -92,77 +93,216 @@ DrawInfoPainter::draw( QPainter & painter )
 
     const int current_time = disp->show_.time_;
 
+    // all items are drawn by one call.
+    if ( M_shape_renderer
+         && M_shape_renderer->isAvailable() )
+    {
+        M_shape_batch.clear();
+        addShapes( M_shape_batch, current_time );
+        M_shape_renderer->render( painter, M_shape_batch );
+        return;
+    }
+
     painter.setBrush( Qt::NoBrush );
 
+    const DrawStore & store = M_disp_holder.drawStore();
+
+    // the pen is changed only when the color index is changed.
+    std::uint32_t pen_color = std::uint32_t( -1 );
+
     //
     // draw point
     //
+    for ( const DrawStore::Point & p : store.points( current_time ) )
     {
-        PointCont::const_iterator points = M_disp_holder.pointCont().find( current_time );
-        if ( points != M_disp_holder.pointCont().end() )
+        if ( p.color_ != pen_color )
         {
-            for ( decltype( points->second )::const_reference & p : points->second )
+            const DrawStore::Color & col = store.color( p.color_ );
+            if ( ! col.valid_ )
             {
-                QColor col( p.color_.c_str() );
-                if ( col.isValid() )
-                {
-                    M_pen.setColor( col );
-                    painter.setPen( M_pen );
-                    painter.drawRect( opt.screenX( p.x_ ) - 1,
-                                      opt.screenY( p.y_ ) - 1,
-                                      3, 3 );
-                }
+                continue;
             }
+            pen_color = p.color_;
+            M_pen.setColor( QColor::fromRgba( col.rgba_ ) );
+            painter.setPen( M_pen );
         }
+
+        painter.drawRect( opt.screenX( p.x_ ) - 1,
+                          opt.screenY( p.y_ ) - 1,
+                          3, 3 );
     }
 
     //
     // draw circle
     //
+    for ( const DrawStore::Circle & c : store.circles( current_time ) )
     {
-        CircleCont::const_iterator circles = M_disp_holder.circleCont().find( current_time );
-        if ( circles != M_disp_holder.circleCont().end() )
+        if ( c.color_ != pen_color )
         {
-            for ( decltype( circles->second )::const_reference c : circles->second )
+            const DrawStore::Color & col = store.color( c.color_ );
+            if ( ! col.valid_ )
             {
-                QColor col( c.color_.c_str() );
-                if ( col.isValid() )
-                {
-                    M_pen.setColor( col );
-                    painter.setPen( M_pen );
-
-                    int r = opt.scale( c.r_ );
-                    painter.drawEllipse( opt.screenX( c.x_ ) - r,
-                                         opt.screenY( c.y_ ) - r,
-                                         r * 2,
-                                         r * 2 );
-                }
+                continue;
             }
+            pen_color = c.color_;
+            M_pen.setColor( QColor::fromRgba( col.rgba_ ) );
+            painter.setPen( M_pen );
         }
+
+        int r = opt.scale( c.r_ );
+        painter.drawEllipse( opt.screenX( c.x_ ) - r,
+                             opt.screenY( c.y_ ) - r,
+                             r * 2,
+                             r * 2 );
     }
 
     //
     // draw line
     //
+    for ( const DrawStore::Line & l : store.lines( current_time ) )
     {
-        LineCont::const_iterator lines = M_disp_holder.lineCont().find( current_time );
-        if ( lines != M_disp_holder.lineCont().end() )
+        if ( l.color_ != pen_color )
         {
-            for ( decltype( lines->second )::const_reference l : lines->second )
+            const DrawStore::Color & col = store.color( l.color_ );
+            if ( ! col.valid_ )
             {
-                QColor col( l.color_.c_str() );
-                if ( col.isValid() )
-                {
-                    M_pen.setColor( col );
-                    painter.setPen( M_pen );
-
-                    painter.drawLine( opt.screenX( l.x1_ ),
-                                      opt.screenY( l.y1_ ),
-                                      opt.screenX( l.x2_ ),
-                                      opt.screenY( l.y2_ ) );
-                }
+                continue;
             }
+            pen_color = l.color_;
+            M_pen.setColor( QColor::fromRgba( col.rgba_ ) );
+            painter.setPen( M_pen );
         }
+
+        painter.drawLine( opt.screenX( l.x1_ ),
+                          opt.screenY( l.y1_ ),
+                          opt.screenX( l.x2_ ),
+                          opt.screenY( l.y2_ ) );
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief add the items at the current time to the batch in the drawing order of draw().
+ */
+void
+DrawInfoPainter::addShapes( ShapeBatch & batch,
+                            const int current_time ) const
+{
+    const Options & opt = Options::instance();
+    const DrawStore & store = M_disp_holder.drawStore();
+
+    // the pen is changed only when the color index is changed.
+    std::uint32_t pen_color = std::uint32_t( -1 );
+    QPen pen = M_pen;
+
+    for ( const DrawStore::Point & p : store.points( current_time ) )
+    {
+        if ( p.color_ != pen_color )
+        {
+            const DrawStore::Color & col = store.color( p.color_ );
+            if ( ! col.valid_ )
+            {
+                continue;
+            }
+            pen_color = p.color_;
+            pen.setColor( QColor::fromRgba( col.rgba_ ) );
+        }
+
+        // the 3x3 rectangle of draw()
+        batch.addRect( QPointF( opt.screenX( p.x_ ) + 0.5,
+                                opt.screenY( p.y_ ) + 0.5 ),
+                       1.5, pen );
+    }
+
+    for ( const DrawStore::Circle & c : store.circles( current_time ) )
+    {
+        if ( c.color_ != pen_color )
+        {
+            const DrawStore::Color & col = store.color( c.color_ );
+            if ( ! col.valid_ )
+            {
+                continue;
+            }
+            pen_color = c.color_;
+            pen.setColor( QColor::fromRgba( col.rgba_ ) );
+        }
+
+        batch.addCircle( QPointF( opt.screenX( c.x_ ), opt.screenY( c.y_ ) ),
+                         opt.scale( c.r_ ),
+                         pen, QBrush( Qt::NoBrush ) );
+    }
+
+    for ( const DrawStore::Line & l : store.lines( current_time ) )
+    {
+        if ( l.color_ != pen_color )
+        {
+            const DrawStore::Color & col = store.color( l.color_ );
+            if ( ! col.valid_ )
+            {
+                continue;
+            }
+            pen_color = l.color_;
+            pen.setColor( QColor::fromRgba( col.rgba_ ) );
+        }
+
+        batch.addLine( QPointF( opt.screenX( l.x1_ ), opt.screenY( l.y1_ ) ),
+                       QPointF( opt.screenX( l.x2_ ), opt.screenY( l.y2_ ) ),
+                       pen );
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+*/
+bool
+DrawInfoPainter::addFrameRegion( QRegion & region ) const
+{
+    const Options & opt = Options::instance();
+
+    if ( ! opt.showDrawInfo() )
+    {
+        return true;
+    }
+
+    DispConstPtr disp = M_disp_holder.currentDisp();
+
+    if ( ! disp )
+    {
+        return true;
+    }
+
+    const int current_time = disp->show_.time_;
+
+    const DrawStore & store = M_disp_holder.drawStore();
+
+    // one bounding rectangle is used for all items,
+    // because the region with many rectangles is slow.
+    QRect rect;
+
+    for ( const DrawStore::Point & p : store.points( current_time ) )
+    {
+        rect |= QRect( opt.screenX( p.x_ ) - 2,
+                       opt.screenY( p.y_ ) - 2,
+                       5, 5 );
+    }
+
+    for ( const DrawStore::Circle & c : store.circles( current_time ) )
+    {
+        const int r = opt.scale( c.r_ ) + 1;
+        rect |= QRect( opt.screenX( c.x_ ) - r,
+                       opt.screenY( c.y_ ) - r,
+                       r * 2 + 1,
+                       r * 2 + 1 );
+    }
+
+    for ( const DrawStore::Line & l : store.lines( current_time ) )
+    {
+        rect |= QRect( QPoint( opt.screenX( l.x1_ ), opt.screenY( l.y1_ ) ),
+                       QPoint( opt.screenX( l.x2_ ), opt.screenY( l.y2_ ) ) )
+            .normalized().adjusted( -1, -1, 1, 1 );
     }
 
+    region += rect;
+    return true;
 }
@@ -34,6 +34,7 @@
 #define RCSSMONITOR_DRAW_INFO_PAINTER_H
 
 #include "painter_interface.h"
+#include "shape_batch.h"
 
 #include <QPen>
 #include <QBrush>
@@ -49,6 +50,12 @@ private:
 
     QPen M_pen;
 
+    //! the renderer of the batched shapes. if null, all items are drawn by QPainter.
+    ShapeRenderer * M_shape_renderer;
+
+    //! the points, the circles and the lines in the current frame
+    ShapeBatch M_shape_batch;
+
     // not used
     DrawInfoPainter() = delete;
     DrawInfoPainter( const DrawInfoPainter & ) = delete;
@@ -60,6 +67,21 @@ public:
     ~DrawInfoPainter();
 
     void draw( QPainter & painter ) override;
+    bool addFrameRegion( QRegion & region ) const override;
+
+    /*!
+      \brief set the renderer used to draw all points, circles and lines at once.
+      \param renderer the renderer owned by the caller, or null to draw them by QPainter.
+     */
+    void setShapeRenderer( ShapeRenderer * renderer )
+      {
+          M_shape_renderer = renderer;
+      }
+
+private:
+
+    void addShapes( ShapeBatch & batch,
+                    const int current_time ) const;
 
 };
 
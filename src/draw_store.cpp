@@ -0,0 +1,294 @@
+// -*-c++-*-
+
+/*!
+  \file draw_store.cpp
+  \brief flat draw information store class Source File.
+*/
+
+/*
+ *Copyright:
+
+ Copyright (C) The RoboCup Soccer Server Maintenance Group.
+ Hidehisa AKIYAMA
+
+ This code is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 3, or (at your option)
+ any later version.
+
+ This code is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this code; see the file COPYING.	If not, write to
+ the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+
+ *EndCopyright:
+ */
+
+/////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <QColor>
+#include <QString>
+
+#include "draw_store.h"
+
+#include <rcss/rcg/types.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+template < typename T >
+struct TimeCmp {
+    bool operator()( const T & lhs,
+                     const int rhs ) const
+      {
+          return lhs.time_ < rhs;
+      }
+    bool operator()( const int lhs,
+                     const T & rhs ) const
+      {
+          return lhs < rhs.time_;
+      }
+};
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief insert the primitive keeping the time order.
+  the data usually arrive in time order, so they are simply appended.
+ */
+template < typename T >
+void
+insert_item( std::vector< T > & cont,
+             const T & item )
+{
+    if ( cont.empty()
+         || cont.back().time_ <= item.time_ )
+    {
+        cont.push_back( item );
+    }
+    else
+    {
+        cont.insert( std::upper_bound( cont.begin(), cont.end(), item.time_, TimeCmp< T >() ),
+                     item );
+    }
+}
+
+/*-------------------------------------------------------------------*/
+template < typename T >
+DrawStore::Range< T >
+time_range( const std::vector< T > & cont,
+            const int time )
+{
+    const T * first = cont.data();
+    const T * last = first + cont.size();
+
+    DrawStore::Range< T > range;
+    if ( first == last
+         || last[-1].time_ < time
+         || time < first->time_ )
+    {
+        range.begin_ = range.end_ = last;
+        return range;
+    }
+
+    const std::pair< const T *, const T * > r = std::equal_range( first, last, time, TimeCmp< T >() );
+    range.begin_ = r.first;
+    range.end_ = r.second;
+    return range;
+}
+
+/*-------------------------------------------------------------------*/
+template < typename T >
+void
+erase_time( std::vector< T > & cont,
+            const int time )
+{
+    const std::pair< typename std::vector< T >::iterator,
+                     typename std::vector< T >::iterator > r
+        = std::equal_range( cont.begin(), cont.end(), time, TimeCmp< T >() );
+    cont.erase( r.first, r.second );
+}
+
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+DrawStore::DrawStore()
+    : M_last_color( 0 )
+{
+
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+DrawStore::clear()
+{
+    M_colors.clear();
+    M_color_index.clear();
+    M_last_color = 0;
+
+    M_points.clear();
+    M_circles.clear();
+    M_lines.clear();
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+DrawStore::clear( const int time )
+{
+    erase_time( M_points, time );
+    erase_time( M_circles, time );
+    erase_time( M_lines, time );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+std::uint32_t
+DrawStore::internColor( const char * color )
+{
+    const size_t len = ::strnlen( color, rcss::rcg::COLOR_NAME_MAX );
+
+    // successive primitives usually have the same color.
+    if ( M_last_color < M_colors.size() )
+    {
+        const std::string & last = M_colors[M_last_color].name_;
+        if ( last.size() == len
+             && last.compare( 0, len, color, len ) == 0 )
+        {
+            return M_last_color;
+        }
+    }
+
+    std::string name( color, len );
+    std::unordered_map< std::string, std::uint32_t >::const_iterator it = M_color_index.find( name );
+    if ( it != M_color_index.end() )
+    {
+        M_last_color = it->second;
+        return M_last_color;
+    }
+
+    const QColor col( QString::fromLatin1( name.c_str(), static_cast< int >( len ) ) );
+
+    Color c;
+    c.name_ = name;
+    c.rgba_ = col.rgba();
+    c.valid_ = col.isValid();
+
+    M_last_color = static_cast< std::uint32_t >( M_colors.size() );
+    M_colors.push_back( c );
+    M_color_index.emplace( std::move( name ), M_last_color );
+
+    return M_last_color;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+DrawStore::addPoint( const int time,
+                     const float x,
+                     const float y,
+                     const char * color )
+{
+    Point p;
+    p.time_ = time;
+    p.color_ = internColor( color );
+    p.x_ = x;
+    p.y_ = y;
+
+    insert_item( M_points, p );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+DrawStore::addCircle( const int time,
+                      const float x,
+                      const float y,
+                      const float r,
+                      const char * color )
+{
+    Circle c;
+    c.time_ = time;
+    c.color_ = internColor( color );
+    c.x_ = x;
+    c.y_ = y;
+    c.r_ = r;
+
+    insert_item( M_circles, c );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+DrawStore::addLine( const int time,
+                    const float x1,
+                    const float y1,
+                    const float x2,
+                    const float y2,
+                    const char * color )
+{
+    Line l;
+    l.time_ = time;
+    l.color_ = internColor( color );
+    l.x1_ = x1;
+    l.y1_ = y1;
+    l.x2_ = x2;
+    l.y2_ = y2;
+
+    insert_item( M_lines, l );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+DrawStore::Range< DrawStore::Point >
+DrawStore::points( const int time ) const
+{
+    return time_range( M_points, time );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+DrawStore::Range< DrawStore::Circle >
+DrawStore::circles( const int time ) const
+{
+    return time_range( M_circles, time );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+DrawStore::Range< DrawStore::Line >
+DrawStore::lines( const int time ) const
+{
+    return time_range( M_lines, time );
+}
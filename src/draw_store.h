@@ -0,0 +1,170 @@
+// -*-c++-*-
+
+/*!
+  \file draw_store.h
+  \brief flat draw information store class Header File.
+*/
+
+/*
+ *Copyright:
+
+ Copyright (C) The RoboCup Soccer Server Maintenance Group.
+ Hidehisa AKIYAMA
+
+ This code is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 3, or (at your option)
+ any later version.
+
+ This code is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this code; see the file COPYING.	If not, write to
+ the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+
+ *EndCopyright:
+ */
+
+/////////////////////////////////////////////////////////////////////
+
+#ifndef RCSSMONITOR_DRAW_STORE_H
+#define RCSSMONITOR_DRAW_STORE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*!
+  \class DrawStore
+  \brief flat container of the draw information (points, circles and lines).
+
+  Each kind of primitive is stored in one array sorted by time, so that
+  the primitives of one cycle are a contiguous range. The color names are
+  interned into the color table when the primitives are added, and each
+  table entry holds the RGBA value resolved only once. Primitives only
+  have the index of the color table.
+*/
+class DrawStore {
+public:
+
+    /*!
+      \brief interned color
+     */
+    struct Color {
+        std::string name_; //!< the color name in the game log
+        std::uint32_t rgba_; //!< resolved ARGB value
+        bool valid_; //!< false if the name is not a known color
+    };
+
+    struct Point {
+        int time_;
+        std::uint32_t color_; //!< index of the color table
+        float x_;
+        float y_;
+    };
+
+    struct Circle {
+        int time_;
+        std::uint32_t color_; //!< index of the color table
+        float x_;
+        float y_;
+        float r_;
+    };
+
+    struct Line {
+        int time_;
+        std::uint32_t color_; //!< index of the color table
+        float x1_;
+        float y1_;
+        float x2_;
+        float y2_;
+    };
+
+    /*!
+      \brief the primitives of one cycle
+     */
+    template < typename T >
+    struct Range {
+        const T * begin_;
+        const T * end_;
+
+        const T * begin() const { return begin_; }
+        const T * end() const { return end_; }
+        bool empty() const { return begin_ == end_; }
+    };
+
+private:
+
+    std::vector< Color > M_colors;
+    std::unordered_map< std::string, std::uint32_t > M_color_index;
+    std::uint32_t M_last_color; //!< the last interned color
+
+    std::vector< Point > M_points;
+    std::vector< Circle > M_circles;
+    std::vector< Line > M_lines;
+
+    // not used
+    DrawStore( const DrawStore & ) = delete;
+    DrawStore & operator=( const DrawStore & ) = delete;
+
+public:
+
+    DrawStore();
+
+    /*!
+      \brief remove all primitives and the color table.
+     */
+    void clear();
+
+    /*!
+      \brief remove the primitives at the time
+      \param time game time
+     */
+    void clear( const int time );
+
+    /*!
+      \brief add a point
+      \param color color name. the length is limited to rcss::rcg::COLOR_NAME_MAX.
+     */
+    void addPoint( const int time,
+                   const float x,
+                   const float y,
+                   const char * color );
+
+    void addCircle( const int time,
+                    const float x,
+                    const float y,
+                    const float r,
+                    const char * color );
+
+    void addLine( const int time,
+                  const float x1,
+                  const float y1,
+                  const float x2,
+                  const float y2,
+                  const char * color );
+
+    Range< Point > points( const int time ) const;
+    Range< Circle > circles( const int time ) const;
+    Range< Line > lines( const int time ) const;
+
+    const Color & color( const std::uint32_t idx ) const
+      {
+          return M_colors[idx];
+      }
+
+    size_t pointSize() const { return M_points.size(); }
+    size_t circleSize() const { return M_circles.size(); }
+    size_t lineSize() const { return M_lines.size(); }
+
+private:
+
+    std::uint32_t internColor( const char * color );
+
+};
+
+#endif
@@ -42,8 +42,17 @@
 #include <QtGui>
 #endif
 
+#ifdef USE_GLWIDGET
+#include <QOpenGLContext>
+#include <QOpenGLWidget>
+#endif
+
 #include "field_canvas.h"
 
+#ifdef USE_GLWIDGET
+#include "gl_shape_renderer.h"
+#endif
+
 #include "disp_holder.h"
 #include "field_painter.h"
 
@@ -58,19 +67,145 @@
 #include <iostream>
 #include <cmath>
 
+#ifdef USE_GLWIDGET
+
+namespace {
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief check if the OpenGL context can be created.
+ */
+bool
+opengl_available()
+{
+    static int s_result = -1;
+
+    if ( s_result < 0 )
+    {
+        QOpenGLContext context;
+        s_result = ( context.create() ? 1 : 0 );
+        if ( s_result == 0 )
+        {
+            std::cerr << "failed to create the OpenGL context."
+                      << " the field is rendered by the software." << std::endl;
+        }
+    }
+
+    return ( s_result == 1 );
+}
+
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief the OpenGL render target of FieldCanvas.
+
+  The painters draw with the OpenGL paint engine of QPainter, and the
+  player shapes are drawn by the instanced GLShapeRenderer. The frame
+  buffer object keeps the last frame, and only the dirty region
+  requested by the canvas is painted again.
+ */
+class FieldCanvas::GLView
+    : public QOpenGLWidget {
+private:
+
+    FieldCanvas & M_canvas;
+
+    //! the area painted in the next paintGL()
+    QRegion M_dirty_region;
+
+    //! the instanced renderer passed to the player painter
+    GLShapeRenderer M_shape_renderer;
+
+public:
+
+    explicit
+    GLView( FieldCanvas & canvas )
+        : QOpenGLWidget( &canvas ),
+          M_canvas( canvas )
+      {
+          QSurfaceFormat format = this->format();
+          format.setSamples( 4 );
+          this->setFormat( format );
+
+          this->setUpdateBehavior( QOpenGLWidget::PartialUpdate );
+
+          // the canvas handles all user inputs
+          this->setAttribute( Qt::WA_TransparentForMouseEvents );
+          this->setFocusPolicy( Qt::NoFocus );
+      }
+
+    ~GLView()
+      {
+          if ( this->context() )
+          {
+              QObject::disconnect( this->context(), nullptr, this, nullptr );
+              cleanupGL();
+          }
+      }
+
+    ShapeRenderer * shapeRenderer()
+      {
+          return &M_shape_renderer;
+      }
+
+    void updateRegion( const QRegion & region )
+      {
+          M_dirty_region += region;
+          this->update();
+      }
+
+protected:
+
+    void initializeGL() override
+      {
+          // the context is created again when the widget is reparented.
+          QObject::connect( this->context(), &QOpenGLContext::aboutToBeDestroyed,
+                            this, [this]() { cleanupGL(); } );
+          M_shape_renderer.initialize();
+      }
+
+    void resizeGL( int, int ) override
+      {
+          // the frame buffer object is created again
+          M_dirty_region = QRegion( this->rect() );
+      }
+
+    void paintGL() override
+      {
+          if ( M_dirty_region.isEmpty() )
+          {
+              return;
+          }
+
+          QPainter painter( this );
+          painter.setClipRegion( M_dirty_region );
+          M_dirty_region = QRegion();
+
+          M_canvas.paintCanvas( painter );
+      }
+
+private:
+
+    void cleanupGL()
+      {
+          this->makeCurrent();
+          M_shape_renderer.cleanup();
+          this->doneCurrent();
+      }
+};
+
+#endif
+
 /*-------------------------------------------------------------------*/
 /*!
 
 */
 FieldCanvas::FieldCanvas( DispHolder & disp_holder )
-    :
-#ifdef USE_GLWIDGET
-    QGLWidget( QGLFormat( QGL::SampleBuffers ) ),
-#else
-    QWidget( /* parent, flags */ ),
-#endif
-    M_disp_holder( disp_holder ),
-    M_monitor_menu( static_cast< QMenu * >( 0 ) )
+    : QWidget( /* parent, flags */ ),
+      M_disp_holder( disp_holder ),
+      M_gl_view( static_cast< GLView * >( 0 ) ),
+      M_monitor_menu( static_cast< QMenu * >( 0 ) )
 {
     M_focus_move_mouse = &M_mouse_state[0];
     M_measure_mouse = &M_mouse_state[1];
@@ -79,6 +214,18 @@ FieldCanvas::FieldCanvas( DispHolder & disp_holder )
     this->setMouseTracking( true ); // need for the MouseMoveEvent
     this->setFocusPolicy( Qt::WheelFocus );
 
+#ifdef USE_GLWIDGET
+    if ( Options::instance().openGL()
+         && opengl_available() )
+    {
+        M_gl_view = new GLView( *this );
+
+        QVBoxLayout * layout = new QVBoxLayout( this );
+        layout->setContentsMargins( 0, 0, 0, 0 );
+        layout->addWidget( M_gl_view );
+    }
+#endif
+
     createPainters();
 }
 
@@ -94,6 +241,21 @@ FieldCanvas::~FieldCanvas()
 /*-------------------------------------------------------------------*/
 /*!
 
+*/
+bool
+FieldCanvas::isShapeRendererAvailable() const
+{
+#ifdef USE_GLWIDGET
+    return ( M_gl_view
+             && M_gl_view->shapeRenderer()->isAvailable() );
+#else
+    return false;
+#endif
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
 */
 QMenu *
 FieldCanvas::createPopupMenu()
@@ -121,9 +283,23 @@ FieldCanvas::createPainters()
 
     M_painters.push_back( std::shared_ptr< PainterInterface >( new ScoreBoardPainter( M_disp_holder ) ) );
     M_painters.push_back( std::shared_ptr< PainterInterface >( new TeamGraphicPainter( M_disp_holder ) ) );
-    M_painters.push_back( std::shared_ptr< PainterInterface >( new PlayerPainter( M_disp_holder ) ) );
+    std::shared_ptr< PlayerPainter > player_painter( new PlayerPainter( M_disp_holder ) );
+#ifdef USE_GLWIDGET
+    if ( M_gl_view )
+    {
+        player_painter->setShapeRenderer( M_gl_view->shapeRenderer() );
+    }
+#endif
+    M_painters.push_back( player_painter );
     M_painters.push_back( std::shared_ptr< PainterInterface >( new BallPainter( M_disp_holder ) ) );
-    M_painters.push_back( std::shared_ptr< PainterInterface >( new DrawInfoPainter( M_disp_holder ) ) );
+    std::shared_ptr< DrawInfoPainter > draw_info_painter( new DrawInfoPainter( M_disp_holder ) );
+#ifdef USE_GLWIDGET
+    if ( M_gl_view )
+    {
+        draw_info_painter->setShapeRenderer( M_gl_view->shapeRenderer() );
+    }
+#endif
+    M_painters.push_back( draw_info_painter );
 }
 
 /*-------------------------------------------------------------------*/
@@ -255,9 +431,9 @@ FieldCanvas::mouseMoveEvent( QMouseEvent * event )
         }
         // draw mouse measure
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 0, 0))
-        this->update( s_last_rect.united( new_rect ) );
+        updateRegion( s_last_rect.united( new_rect ) );
 #else
-        this->update( s_last_rect.unite( new_rect ) );
+        updateRegion( s_last_rect.unite( new_rect ) );
 #endif
         s_last_rect = new_rect;
     }
@@ -289,14 +465,36 @@ FieldCanvas::contextMenuEvent( QContextMenuEvent * event )
 void
 FieldCanvas::paintEvent( QPaintEvent * )
 {
+    if ( M_gl_view )
+    {
+        // painted by the child widget
+        return;
+    }
+
     QPainter painter( this );
 
+    paintCanvas( painter );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+*/
+void
+FieldCanvas::paintCanvas( QPainter & painter )
+{
     draw( painter );
 
     if ( M_measure_mouse->isDragged() )
     {
         drawMouseMeasure( painter );
     }
+
+    M_frame_region = QRegion();
+    if ( ! addFrameRegion( M_frame_region ) )
+    {
+        M_frame_region = QRegion( this->rect() );
+    }
 }
 
 /*-------------------------------------------------------------------*/
@@ -384,6 +582,81 @@ FieldCanvas::updateFocus()
 /*-------------------------------------------------------------------*/
 /*!
 
+*/
+bool
+FieldCanvas::addFrameRegion( QRegion & region ) const
+{
+    if ( ! M_field_painter->addFrameRegion( region ) )
+    {
+        return false;
+    }
+
+    for ( std::vector< std::shared_ptr< PainterInterface > >::const_iterator it = M_painters.begin();
+          it != M_painters.end();
+          ++it )
+    {
+        if ( ! (*it)->addFrameRegion( region ) )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+*/
+void
+FieldCanvas::updateFrame()
+{
+    // the same state as draw(). the options may be shared by other canvases.
+    updateFocus();
+    Options::instance().updateFieldSize( this->width(), this->height() );
+
+    QRegion region;
+    if ( ! addFrameRegion( region ) )
+    {
+        updateView();
+        return;
+    }
+
+    // erase the last frame and draw the new one over the cached field
+    updateRegion( M_frame_region + region );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+*/
+void
+FieldCanvas::updateView()
+{
+    updateRegion( QRegion( this->rect() ) );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+*/
+void
+FieldCanvas::updateRegion( const QRegion & region )
+{
+#ifdef USE_GLWIDGET
+    if ( M_gl_view )
+    {
+        M_gl_view->updateRegion( region );
+        return;
+    }
+#endif
+
+    this->update( region );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
 */
 void
 FieldCanvas::draw( QPainter & painter )
@@ -33,14 +33,11 @@
 #ifndef RCSSMONITOR_FIELD_CANVAS_H
 #define RCSSMONITOR_FIELD_CANVAS_H
 
-#ifdef USE_GLWIDGET
-#include <QGLWidget>
-#else
 #include <QWidget>
-#endif
 
 #include <QPen>
 #include <QFont>
+#include <QRegion>
 
 #include "mouse_state.h"
 
@@ -52,26 +49,36 @@ class DispHolder;
 class FieldPainter;
 class PainterInterface;
 
+/*!
+  \class FieldCanvas
+  \brief the field view widget.
+
+  If the OpenGL rendering is enabled, the painters draw on the child
+  QOpenGLWidget covering this widget, and this widget only handles the
+  user inputs.
+*/
 class FieldCanvas
-		:
-#ifdef USE_GLWIDGET
-    public QGLWidget
-#else
-    public QWidget
-#endif
-{
+    : public QWidget {
 
     Q_OBJECT
 
 private:
 
+    class GLView;
+
     DispHolder & M_disp_holder;
 
+    //! the OpenGL render target. null if the software rendering is used.
+    GLView * M_gl_view;
+
     QMenu * M_monitor_menu;
 
     std::shared_ptr< FieldPainter > M_field_painter;
     std::vector< std::shared_ptr< PainterInterface > > M_painters;
 
+    //! the screen area of the last painted frame
+    QRegion M_frame_region;
+
     //! 0: left, 1: middle, 2: right
     MouseState M_mouse_state[3];
 
@@ -92,12 +99,31 @@ public:
 
     QMenu * createPopupMenu();
 
+    /*!
+      \brief check if the field is rendered by OpenGL.
+      \return true if the OpenGL render target is used.
+     */
+    bool isOpenGL() const
+      {
+          return M_gl_view != nullptr;
+      }
+
+    /*!
+      \brief check if the shapes are drawn by the instanced OpenGL renderer.
+      \return false if the software rendering is used or the renderer could not be initialized.
+     */
+    bool isShapeRendererAvailable() const;
+
 private:
 
     void createPainters();
 
     void updateFocus();
 
+    bool addFrameRegion( QRegion & region ) const;
+
+    void updateRegion( const QRegion & region );
+
 protected:
 
     // overrided methods
@@ -112,11 +138,22 @@ protected:
 
 private:
 
+    void paintCanvas( QPainter & painter );
     void draw( QPainter & painter );
     void drawMouseMeasure( QPainter & painter );
 
 public slots:
 
+    /*!
+      \brief repaint the whole canvas.
+     */
+    void updateView();
+
+    /*!
+      \brief repaint only the areas changed from the last painted frame.
+     */
+    void updateFrame();
+
     void dropBall();
     void freeKickLeft();
     void freeKickRight();
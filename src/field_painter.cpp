@@ -68,6 +68,58 @@ FieldPainter::~FieldPainter()
 
 }
 
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+bool
+FieldPainter::CacheKey::operator==( const CacheKey & other ) const
+{
+    return ( size_ == other.size_
+             && device_pixel_ratio_ == other.device_pixel_ratio_
+             && field_scale_ == other.field_scale_
+             && field_center_ == other.field_center_
+             && field_brush_ == other.field_brush_
+             && line_pen_ == other.line_pen_
+             && font_ == other.font_
+             && show_flag_ == other.show_flag_
+             && grid_step_ == other.grid_step_
+             && show_grid_coord_ == other.show_grid_coord_
+             && show_keepaway_area_ == other.show_keepaway_area_
+             && keepaway_length_ == other.keepaway_length_
+             && keepaway_width_ == other.keepaway_width_ );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+FieldPainter::CacheKey
+FieldPainter::createCacheKey( const QSize & size,
+                              const double device_pixel_ratio,
+                              const QFont & font ) const
+{
+    const Options & opt = Options::instance();
+    const rcss::rcg::ServerParamT & SP = M_disp_holder.serverParam();
+
+    CacheKey key;
+    key.size_ = size;
+    key.device_pixel_ratio_ = device_pixel_ratio;
+    key.field_scale_ = opt.fieldScale();
+    key.field_center_ = opt.fieldCenter();
+    key.field_brush_ = opt.fieldBrush();
+    key.line_pen_ = opt.linePen();
+    key.font_ = font;
+    key.show_flag_ = opt.showFlag();
+    key.grid_step_ = opt.gridStep();
+    key.show_grid_coord_ = opt.showGridCoord();
+    key.show_keepaway_area_ = ( opt.showKeepawayArea() || SP.keepaway_mode_ );
+    key.keepaway_length_ = SP.keepaway_length_;
+    key.keepaway_width_ = SP.keepaway_width_;
+
+    return key;
+}
+
 /*-------------------------------------------------------------------*/
 /*!
 
@@ -75,11 +127,61 @@ FieldPainter::~FieldPainter()
 void
 FieldPainter::draw( QPainter & painter )
 {
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 6, 0))
+    const double device_pixel_ratio = painter.device()->devicePixelRatioF();
+#else
+    const double device_pixel_ratio = painter.device()->devicePixelRatio();
+#endif
+    const CacheKey key = createCacheKey( painter.window().size(),
+                                         device_pixel_ratio,
+                                         painter.font() );
+
+    if ( M_cache.isNull()
+         || ! ( key == M_cache_key ) )
+    {
+        M_cache = QPixmap( key.size_ * key.device_pixel_ratio_ );
+        M_cache.setDevicePixelRatio( key.device_pixel_ratio_ );
+
+        QPainter cache_painter( &M_cache );
+        cache_painter.setFont( key.font_ );
+        drawField( cache_painter );
+        cache_painter.end();
+
+        M_cache_key = key;
+    }
+
+    painter.drawPixmap( 0, 0, M_cache );
+
+    // the other painters use the anti-aliasing
     if ( Options::instance().antiAliasing() )
     {
-        painter.setRenderHint( QPainter::Antialiasing, false );
+        painter.setRenderHint( QPainter::Antialiasing );
     }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+bool
+FieldPainter::addFrameRegion( QRegion & ) const
+{
+    // the field image does not depend on the frame.
+    // if it has to be rendered again (e.g. the focus point is moved),
+    // the whole canvas must be repainted.
+    return ( ! M_cache.isNull()
+             && createCacheKey( M_cache_key.size_,
+                                M_cache_key.device_pixel_ratio_,
+                                M_cache_key.font_ ) == M_cache_key );
+}
 
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+FieldPainter::drawField( QPainter & painter ) const
+{
     drawBackGround( painter );
     drawLines( painter );
     drawPenaltyAreaLines( painter );
@@ -93,11 +195,6 @@ FieldPainter::draw( QPainter & painter )
     {
         drawGrid( painter );
     }
-
-    if ( Options::instance().antiAliasing() )
-    {
-        painter.setRenderHint( QPainter::Antialiasing );
-    }
 }
 
 /*-------------------------------------------------------------------*/
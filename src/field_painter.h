@@ -36,15 +36,51 @@
 
 #include <QPen>
 #include <QBrush>
+#include <QFont>
+#include <QPixmap>
+#include <QPoint>
+#include <QSize>
 
 class DispHolder;
 
+/*!
+  \class FieldPainter
+  \brief the painter of the static field image.
+
+  The field image is rendered into the cached pixmap, and the pixmap is
+  simply copied while the canvas size, the view transformation and the
+  field drawing options are not changed.
+*/
 class FieldPainter
     : public PainterInterface {
 private:
 
+    /*!
+      \brief the values that affect the field image
+     */
+    struct CacheKey {
+        QSize size_;
+        double device_pixel_ratio_;
+        double field_scale_;
+        QPoint field_center_;
+        QBrush field_brush_;
+        QPen line_pen_;
+        QFont font_;
+        bool show_flag_;
+        double grid_step_;
+        bool show_grid_coord_;
+        bool show_keepaway_area_;
+        double keepaway_length_;
+        double keepaway_width_;
+
+        bool operator==( const CacheKey & other ) const;
+    };
+
     const DispHolder & M_disp_holder;
 
+    QPixmap M_cache; //!< the rendered field image
+    CacheKey M_cache_key; //!< the values used to render M_cache
+
     // not used
     FieldPainter() = delete;
     FieldPainter( const FieldPainter & ) = delete;
@@ -55,9 +91,15 @@ public:
     ~FieldPainter();
 
     void draw( QPainter & painter ) override;
+    bool addFrameRegion( QRegion & region ) const override;
 
 private:
 
+    CacheKey createCacheKey( const QSize & size,
+                             const double device_pixel_ratio,
+                             const QFont & font ) const;
+    void drawField( QPainter & painter ) const;
+
     void drawBackGround( QPainter & painter ) const;
     void drawLines( QPainter & painter ) const;
     void drawPenaltyAreaLines( QPainter & painter ) const;
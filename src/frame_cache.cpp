@@ -0,0 +1,1007 @@
+// -*-c++-*-
+
+/*!
+  \file frame_cache.cpp
+  \brief binary cache file of the parsed game log Source File.
+*/
+
+/*
+ *Copyright:
+
+ Copyright (C) The RoboCup Soccer Server Maintenance Group.
+ Hidehisa AKIYAMA
+
+ This code is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 3, or (at your option)
+ any later version.
+
+ This code is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this code; see the file COPYING.	If not, write to
+ the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+
+ *EndCopyright:
+ */
+
+/////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "frame_cache.h"
+
+#include <rcss/rcg/types.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <limits>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char CACHE_MAGIC[8] = { 'R', 'C', 'G', 'F', 'R', 'A', 'M', 'E' };
+const std::uint32_t CACHE_VERSION = 1;
+
+//! the encoded size of one player
+const std::size_t PLAYER_RECORD_SIZE = 3 // side, view quality, focus side
+    + 2 * 3 // unum, type, focus unum
+    + 4 // state
+    + 4 * 15 // position, velocity, angles, view and focus, stamina
+    + 2 * 12; // command counts
+
+//! the encoded size of one frame (ShowInfoT)
+const std::size_t FRAME_SIZE = 4 * 2 // time, stime
+    + 4 * 4 // ball
+    + PLAYER_RECORD_SIZE * rcss::rcg::MAX_PLAYER * 2;
+
+//! the size of the file header
+const std::size_t HEADER_SIZE = sizeof( CACHE_MAGIC ) + 4 * 3 + 8 * 4;
+
+enum EventType {
+    EVENT_PLAYMODE = 1,
+    EVENT_TEAM,
+    EVENT_MSG,
+    EVENT_DRAW,
+    EVENT_SERVER_PARAM,
+    EVENT_PLAYER_PARAM,
+    EVENT_PLAYER_TYPE,
+    EVENT_TEAM_GRAPHIC,
+};
+
+//! player type parameters stored in the cache, except for id_
+double rcss::rcg::PlayerTypeT::* const PLAYER_TYPE_MEMBERS[] = {
+    &rcss::rcg::PlayerTypeT::player_speed_max_,
+    &rcss::rcg::PlayerTypeT::stamina_inc_max_,
+    &rcss::rcg::PlayerTypeT::player_decay_,
+    &rcss::rcg::PlayerTypeT::inertia_moment_,
+    &rcss::rcg::PlayerTypeT::dash_power_rate_,
+    &rcss::rcg::PlayerTypeT::player_size_,
+    &rcss::rcg::PlayerTypeT::kickable_margin_,
+    &rcss::rcg::PlayerTypeT::kick_rand_,
+    &rcss::rcg::PlayerTypeT::extra_stamina_,
+    &rcss::rcg::PlayerTypeT::effort_max_,
+    &rcss::rcg::PlayerTypeT::effort_min_,
+    &rcss::rcg::PlayerTypeT::kick_power_rate_,
+    &rcss::rcg::PlayerTypeT::foul_detect_probability_,
+    &rcss::rcg::PlayerTypeT::catchable_area_l_stretch_,
+    &rcss::rcg::PlayerTypeT::unum_far_length_,
+    &rcss::rcg::PlayerTypeT::unum_too_far_length_,
+    &rcss::rcg::PlayerTypeT::team_far_length_,
+    &rcss::rcg::PlayerTypeT::team_too_far_length_,
+    &rcss::rcg::PlayerTypeT::player_max_observation_length_,
+    &rcss::rcg::PlayerTypeT::ball_vel_far_length_,
+    &rcss::rcg::PlayerTypeT::ball_vel_too_far_length_,
+    &rcss::rcg::PlayerTypeT::ball_max_observation_length_,
+    &rcss::rcg::PlayerTypeT::flag_chg_far_length_,
+    &rcss::rcg::PlayerTypeT::flag_chg_too_far_length_,
+    &rcss::rcg::PlayerTypeT::flag_max_observation_length_,
+    &rcss::rcg::PlayerTypeT::dist_noise_rate_,
+    &rcss::rcg::PlayerTypeT::focus_dist_noise_rate_,
+    &rcss::rcg::PlayerTypeT::land_dist_noise_rate_,
+    &rcss::rcg::PlayerTypeT::land_focus_dist_noise_rate_,
+};
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief get the size and the modification time of the file
+ */
+bool
+file_stamp( const std::string & path,
+            std::uint64_t * size,
+            std::uint64_t * mtime )
+{
+    struct stat st;
+    if ( ::stat( path.c_str(), &st ) != 0 )
+    {
+        return false;
+    }
+
+    *size = static_cast< std::uint64_t >( st.st_size );
+    *mtime = static_cast< std::uint64_t >( st.st_mtime );
+    return true;
+}
+
+//
+// encoder
+//
+
+/*-------------------------------------------------------------------*/
+void
+put_uint( std::vector< unsigned char > & buf,
+          std::uint64_t val,
+          const int bytes )
+{
+    for ( int i = 0; i < bytes; ++i )
+    {
+        buf.push_back( static_cast< unsigned char >( val & 0xff ) );
+        val >>= 8;
+    }
+}
+
+/*-------------------------------------------------------------------*/
+void
+put_int( std::vector< unsigned char > & buf,
+         const std::int64_t val,
+         const int bytes )
+{
+    put_uint( buf, static_cast< std::uint64_t >( val ), bytes );
+}
+
+/*-------------------------------------------------------------------*/
+void
+put_float( std::vector< unsigned char > & buf,
+           const float val )
+{
+    std::uint32_t bits;
+    std::memcpy( &bits, &val, sizeof( bits ) );
+    put_uint( buf, bits, 4 );
+}
+
+/*-------------------------------------------------------------------*/
+void
+put_double( std::vector< unsigned char > & buf,
+            const double val )
+{
+    std::uint64_t bits;
+    std::memcpy( &bits, &val, sizeof( bits ) );
+    put_uint( buf, bits, 8 );
+}
+
+/*-------------------------------------------------------------------*/
+void
+put_string( std::vector< unsigned char > & buf,
+            const std::string & str )
+{
+    put_uint( buf, str.size(), 4 );
+    buf.insert( buf.end(), str.begin(), str.end() );
+}
+
+/*-------------------------------------------------------------------*/
+void
+put_team( std::vector< unsigned char > & buf,
+          const rcss::rcg::TeamT & team )
+{
+    put_string( buf, team.name_ );
+    put_uint( buf, team.score_, 2 );
+    put_uint( buf, team.pen_score_, 2 );
+    put_uint( buf, team.pen_miss_, 2 );
+}
+
+/*-------------------------------------------------------------------*/
+void
+put_show( std::vector< unsigned char > & buf,
+          const rcss::rcg::ShowInfoT & show )
+{
+    put_uint( buf, show.time_, 4 );
+    put_uint( buf, show.stime_, 4 );
+
+    put_float( buf, show.ball_.x_ );
+    put_float( buf, show.ball_.y_ );
+    put_float( buf, show.ball_.vx_ );
+    put_float( buf, show.ball_.vy_ );
+
+    for ( const rcss::rcg::PlayerT & p : show.player_ )
+    {
+        put_int( buf, p.side_, 1 );
+        put_int( buf, p.view_quality_, 1 );
+        put_int( buf, p.focus_side_, 1 );
+        put_int( buf, p.unum_, 2 );
+        put_int( buf, p.type_, 2 );
+        put_int( buf, p.focus_unum_, 2 );
+        put_int( buf, p.state_, 4 );
+
+        put_float( buf, p.x_ );
+        put_float( buf, p.y_ );
+        put_float( buf, p.vx_ );
+        put_float( buf, p.vy_ );
+        put_float( buf, p.body_ );
+        put_float( buf, p.neck_ );
+        put_float( buf, p.point_x_ );
+        put_float( buf, p.point_y_ );
+        put_float( buf, p.view_width_ );
+        put_float( buf, p.focus_dist_ );
+        put_float( buf, p.focus_dir_ );
+        put_float( buf, p.stamina_ );
+        put_float( buf, p.effort_ );
+        put_float( buf, p.recovery_ );
+        put_float( buf, p.stamina_capacity_ );
+
+        put_uint( buf, p.kick_count_, 2 );
+        put_uint( buf, p.dash_count_, 2 );
+        put_uint( buf, p.turn_count_, 2 );
+        put_uint( buf, p.catch_count_, 2 );
+        put_uint( buf, p.move_count_, 2 );
+        put_uint( buf, p.turn_neck_count_, 2 );
+        put_uint( buf, p.change_view_count_, 2 );
+        put_uint( buf, p.say_count_, 2 );
+        put_uint( buf, p.tackle_count_, 2 );
+        put_uint( buf, p.pointto_count_, 2 );
+        put_uint( buf, p.attentionto_count_, 2 );
+        put_uint( buf, p.change_focus_count_, 2 );
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief encode the parameter message with the full precision.
+ */
+template < typename T >
+std::string
+param_string( const T & param )
+{
+    std::ostringstream os;
+    os.precision( std::numeric_limits< double >::max_digits10 );
+    param.toServerString( os );
+    return os.str();
+}
+
+//
+// decoder
+//
+
+/*!
+  \brief sequential reader of the encoded data.
+  all read values are zero after the end of data is reached.
+ */
+class Decoder {
+private:
+    const unsigned char * M_ptr;
+    const unsigned char * M_end;
+    bool M_ok;
+
+public:
+    Decoder( const unsigned char * ptr,
+             const std::size_t size )
+        : M_ptr( ptr ),
+          M_end( ptr + size ),
+          M_ok( true )
+      { }
+
+    bool ok() const { return M_ok; }
+    bool atEnd() const { return M_ptr == M_end; }
+
+    std::uint64_t getUInt( const int bytes )
+      {
+          if ( M_end - M_ptr < bytes )
+          {
+              M_ok = false;
+              M_ptr = M_end;
+              return 0;
+          }
+
+          std::uint64_t val = 0;
+          for ( int i = bytes - 1; i >= 0; --i )
+          {
+              val = ( val << 8 ) | M_ptr[i];
+          }
+          M_ptr += bytes;
+          return val;
+      }
+
+    std::int64_t getInt( const int bytes )
+      {
+          const std::uint64_t val = getUInt( bytes );
+          const int shift = 64 - bytes * 8;
+          return static_cast< std::int64_t >( val << shift ) >> shift;
+      }
+
+    float getFloat()
+      {
+          const std::uint32_t bits = static_cast< std::uint32_t >( getUInt( 4 ) );
+          float val;
+          std::memcpy( &val, &bits, sizeof( val ) );
+          return val;
+      }
+
+    double getDouble()
+      {
+          const std::uint64_t bits = getUInt( 8 );
+          double val;
+          std::memcpy( &val, &bits, sizeof( val ) );
+          return val;
+      }
+
+    std::string getString()
+      {
+          const std::uint64_t size = getUInt( 4 );
+          if ( static_cast< std::uint64_t >( M_end - M_ptr ) < size )
+          {
+              M_ok = false;
+              M_ptr = M_end;
+              return std::string();
+          }
+
+          std::string str( reinterpret_cast< const char * >( M_ptr ), size );
+          M_ptr += size;
+          return str;
+      }
+
+    void getTeam( rcss::rcg::TeamT & team )
+      {
+          team.name_ = getString();
+          team.score_ = static_cast< rcss::rcg::UInt16 >( getUInt( 2 ) );
+          team.pen_score_ = static_cast< rcss::rcg::UInt16 >( getUInt( 2 ) );
+          team.pen_miss_ = static_cast< rcss::rcg::UInt16 >( getUInt( 2 ) );
+      }
+
+    void getShow( rcss::rcg::ShowInfoT & show )
+      {
+          show.time_ = static_cast< rcss::rcg::UInt32 >( getUInt( 4 ) );
+          show.stime_ = static_cast< rcss::rcg::UInt32 >( getUInt( 4 ) );
+
+          show.ball_.x_ = getFloat();
+          show.ball_.y_ = getFloat();
+          show.ball_.vx_ = getFloat();
+          show.ball_.vy_ = getFloat();
+
+          for ( rcss::rcg::PlayerT & p : show.player_ )
+          {
+              p.side_ = static_cast< char >( getInt( 1 ) );
+              p.view_quality_ = static_cast< char >( getInt( 1 ) );
+              p.focus_side_ = static_cast< char >( getInt( 1 ) );
+              p.unum_ = static_cast< rcss::rcg::Int16 >( getInt( 2 ) );
+              p.type_ = static_cast< rcss::rcg::Int16 >( getInt( 2 ) );
+              p.focus_unum_ = static_cast< rcss::rcg::Int16 >( getInt( 2 ) );
+              p.state_ = static_cast< rcss::rcg::Int32 >( getInt( 4 ) );
+
+              p.x_ = getFloat();
+              p.y_ = getFloat();
+              p.vx_ = getFloat();
+              p.vy_ = getFloat();
+              p.body_ = getFloat();
+              p.neck_ = getFloat();
+              p.point_x_ = getFloat();
+              p.point_y_ = getFloat();
+              p.view_width_ = getFloat();
+              p.focus_dist_ = getFloat();
+              p.focus_dir_ = getFloat();
+              p.stamina_ = getFloat();
+              p.effort_ = getFloat();
+              p.recovery_ = getFloat();
+              p.stamina_capacity_ = getFloat();
+
+              p.kick_count_ = static_cast< rcss::rcg::UInt16 >( getUInt( 2 ) );
+              p.dash_count_ = static_cast< rcss::rcg::UInt16 >( getUInt( 2 ) );
+              p.turn_count_ = static_cast< rcss::rcg::UInt16 >( getUInt( 2 ) );
+              p.catch_count_ = static_cast< rcss::rcg::UInt16 >( getUInt( 2 ) );
+              p.move_count_ = static_cast< rcss::rcg::UInt16 >( getUInt( 2 ) );
+              p.turn_neck_count_ = static_cast< rcss::rcg::UInt16 >( getUInt( 2 ) );
+              p.change_view_count_ = static_cast< rcss::rcg::UInt16 >( getUInt( 2 ) );
+              p.say_count_ = static_cast< rcss::rcg::UInt16 >( getUInt( 2 ) );
+              p.tackle_count_ = static_cast< rcss::rcg::UInt16 >( getUInt( 2 ) );
+              p.pointto_count_ = static_cast< rcss::rcg::UInt16 >( getUInt( 2 ) );
+              p.attentionto_count_ = static_cast< rcss::rcg::UInt16 >( getUInt( 2 ) );
+              p.change_focus_count_ = static_cast< rcss::rcg::UInt16 >( getUInt( 2 ) );
+          }
+      }
+};
+
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief read-only view of the cache file.
+  The file is memory-mapped if possible. Otherwise, it is read into the buffer.
+*/
+struct FrameCacheReader::Image {
+    const unsigned char * data_;
+    std::size_t size_;
+#ifdef HAVE_SYS_MMAN_H
+    void * map_;
+#endif
+    std::string buffer_;
+
+    explicit
+    Image( const std::string & filepath )
+        : data_( nullptr ),
+          size_( 0 )
+#ifdef HAVE_SYS_MMAN_H
+        , map_( MAP_FAILED )
+#endif
+      {
+#ifdef HAVE_SYS_MMAN_H
+          const int fd = ::open( filepath.c_str(), O_RDONLY );
+          if ( fd < 0 )
+          {
+              return;
+          }
+
+          struct stat st;
+          if ( ::fstat( fd, &st ) == 0
+               && st.st_size > 0 )
+          {
+              map_ = ::mmap( nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+              if ( map_ != MAP_FAILED )
+              {
+                  data_ = static_cast< const unsigned char * >( map_ );
+                  size_ = st.st_size;
+              }
+          }
+          ::close( fd );
+
+          if ( data_ )
+          {
+              return;
+          }
+#endif
+          std::ifstream fin( filepath, std::ios_base::in | std::ios_base::binary );
+          if ( fin )
+          {
+              buffer_.assign( std::istreambuf_iterator< char >( fin ),
+                              std::istreambuf_iterator< char >() );
+              data_ = reinterpret_cast< const unsigned char * >( buffer_.data() );
+              size_ = buffer_.size();
+          }
+      }
+
+    ~Image()
+      {
+#ifdef HAVE_SYS_MMAN_H
+          if ( map_ != MAP_FAILED )
+          {
+              ::munmap( map_, size_ );
+          }
+#endif
+      }
+
+    Image( const Image & ) = delete;
+    Image & operator=( const Image & ) = delete;
+};
+
+/*-------------------------------------------------------------------*/
+/*-------------------------------------------------------------------*/
+/*-------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+FrameCacheWriter::FrameCacheWriter( rcss::rcg::Handler & handler,
+                                    const std::string & source_path )
+    : M_handler( handler ),
+      M_source_path( source_path ),
+      M_source_size( 0 ),
+      M_source_mtime( 0 ),
+      M_frame_count( 0 )
+{
+    if ( ! file_stamp( source_path, &M_source_size, &M_source_mtime ) )
+    {
+        M_source_path.clear();
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+bool
+FrameCacheWriter::save() const
+{
+    if ( M_source_path.empty() )
+    {
+        return false;
+    }
+
+    std::vector< unsigned char > header( CACHE_MAGIC, CACHE_MAGIC + sizeof( CACHE_MAGIC ) );
+    put_uint( header, CACHE_VERSION, 4 );
+    put_uint( header, FRAME_SIZE, 4 );
+    put_int( header, logVersion(), 4 );
+    put_uint( header, M_source_size, 8 );
+    put_uint( header, M_source_mtime, 8 );
+    put_uint( header, M_frame_count, 8 );
+    put_uint( header, M_events.size(), 8 );
+
+    // write to the temporary file, so that a broken file is never read.
+    const std::string path = FrameCacheReader::cache_path( M_source_path );
+    const std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream fout( tmp_path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc );
+        fout.write( reinterpret_cast< const char * >( header.data() ), header.size() );
+        fout.write( reinterpret_cast< const char * >( M_frames.data() ), M_frames.size() );
+        fout.write( reinterpret_cast< const char * >( M_events.data() ), M_events.size() );
+        fout.close();
+
+        if ( ! fout )
+        {
+            std::cerr << "failed to write the frame cache [" << tmp_path << "]" << std::endl;
+            std::remove( tmp_path.c_str() );
+            return false;
+        }
+    }
+
+    if ( std::rename( tmp_path.c_str(), path.c_str() ) != 0 )
+    {
+        std::cerr << "failed to write the frame cache [" << path << "]" << std::endl;
+        std::remove( tmp_path.c_str() );
+        return false;
+    }
+
+    return true;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+FrameCacheWriter::putEvent( const int type )
+{
+    put_uint( M_events, type, 1 );
+    put_uint( M_events, M_frame_count, 8 );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+bool
+FrameCacheWriter::handleLogVersion( const int ver )
+{
+    rcss::rcg::Handler::handleLogVersion( ver );
+    return M_handler.handleLogVersion( ver );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+bool
+FrameCacheWriter::handleEOF()
+{
+    return M_handler.handleEOF();
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+bool
+FrameCacheWriter::handleShow( const rcss::rcg::ShowInfoT & show )
+{
+    put_show( M_frames, show );
+    ++M_frame_count;
+    return M_handler.handleShow( show );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+bool
+FrameCacheWriter::handleMsg( const int time,
+                             const int board,
+                             const std::string & msg )
+{
+    putEvent( EVENT_MSG );
+    put_int( M_events, time, 4 );
+    put_int( M_events, board, 4 );
+    put_string( M_events, msg );
+    return M_handler.handleMsg( time, board, msg );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+bool
+FrameCacheWriter::handleDraw( const int time,
+                              const rcss::rcg::drawinfo_t & draw )
+{
+    putEvent( EVENT_DRAW );
+    put_int( M_events, time, 4 );
+    put_int( M_events, draw.mode, 2 );
+
+    // the values are kept in the byte order of drawinfo_t
+    const char * color = nullptr;
+    switch ( draw.mode ) {
+    case rcss::rcg::DrawPoint:
+        put_int( M_events, draw.object.pinfo.x, 2 );
+        put_int( M_events, draw.object.pinfo.y, 2 );
+        color = draw.object.pinfo.color;
+        break;
+    case rcss::rcg::DrawCircle:
+        put_int( M_events, draw.object.cinfo.x, 2 );
+        put_int( M_events, draw.object.cinfo.y, 2 );
+        put_int( M_events, draw.object.cinfo.r, 2 );
+        color = draw.object.cinfo.color;
+        break;
+    case rcss::rcg::DrawLine:
+        put_int( M_events, draw.object.linfo.x1, 2 );
+        put_int( M_events, draw.object.linfo.y1, 2 );
+        put_int( M_events, draw.object.linfo.x2, 2 );
+        put_int( M_events, draw.object.linfo.y2, 2 );
+        color = draw.object.linfo.color;
+        break;
+    default:
+        break;
+    }
+
+    if ( color )
+    {
+        M_events.insert( M_events.end(), color, color + rcss::rcg::COLOR_NAME_MAX );
+    }
+
+    return M_handler.handleDraw( time, draw );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+bool
+FrameCacheWriter::handlePlayMode( const int time,
+                                  const rcss::rcg::PlayMode pmode )
+{
+    putEvent( EVENT_PLAYMODE );
+    put_int( M_events, time, 4 );
+    put_uint( M_events, pmode, 1 );
+    return M_handler.handlePlayMode( time, pmode );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+bool
+FrameCacheWriter::handleTeam( const int time,
+                              const rcss::rcg::TeamT & team_l,
+                              const rcss::rcg::TeamT & team_r )
+{
+    putEvent( EVENT_TEAM );
+    put_int( M_events, time, 4 );
+    put_team( M_events, team_l );
+    put_team( M_events, team_r );
+    return M_handler.handleTeam( time, team_l, team_r );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+bool
+FrameCacheWriter::handleServerParam( const rcss::rcg::ServerParamT & param )
+{
+    putEvent( EVENT_SERVER_PARAM );
+    put_string( M_events, param_string( param ) );
+    return M_handler.handleServerParam( param );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+bool
+FrameCacheWriter::handlePlayerParam( const rcss::rcg::PlayerParamT & param )
+{
+    putEvent( EVENT_PLAYER_PARAM );
+    put_string( M_events, param_string( param ) );
+    return M_handler.handlePlayerParam( param );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+bool
+FrameCacheWriter::handlePlayerType( const rcss::rcg::PlayerTypeT & param )
+{
+    // PlayerTypeT::toServerString() rounds the values. they are stored as binary.
+    putEvent( EVENT_PLAYER_TYPE );
+    put_int( M_events, param.id_, 4 );
+    for ( double rcss::rcg::PlayerTypeT::* const member : PLAYER_TYPE_MEMBERS )
+    {
+        put_double( M_events, param.*member );
+    }
+    return M_handler.handlePlayerType( param );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+bool
+FrameCacheWriter::handleTeamGraphic( const char side,
+                                     const int x,
+                                     const int y,
+                                     const std::vector< std::string > & xpm_data )
+{
+    putEvent( EVENT_TEAM_GRAPHIC );
+    put_int( M_events, side, 1 );
+    put_int( M_events, x, 4 );
+    put_int( M_events, y, 4 );
+    put_uint( M_events, xpm_data.size(), 4 );
+    for ( const std::string & line : xpm_data )
+    {
+        put_string( M_events, line );
+    }
+    return M_handler.handleTeamGraphic( side, x, y, xpm_data );
+}
+
+/*-------------------------------------------------------------------*/
+/*-------------------------------------------------------------------*/
+/*-------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+FrameCacheReader::FrameCacheReader( const std::string & source_path )
+    : M_log_version( 0 ),
+      M_frame_count( 0 ),
+      M_frames( nullptr ),
+      M_events( nullptr ),
+      M_events_size( 0 )
+{
+    std::uint64_t source_size = 0, source_mtime = 0;
+    if ( ! file_stamp( source_path, &source_size, &source_mtime ) )
+    {
+        return;
+    }
+
+    std::unique_ptr< Image > image( new Image( cache_path( source_path ) ) );
+    if ( image->size_ < HEADER_SIZE
+         || std::memcmp( image->data_, CACHE_MAGIC, sizeof( CACHE_MAGIC ) ) != 0 )
+    {
+        return;
+    }
+
+    Decoder header( image->data_ + sizeof( CACHE_MAGIC ), HEADER_SIZE - sizeof( CACHE_MAGIC ) );
+    const std::uint64_t version = header.getUInt( 4 );
+    const std::uint64_t frame_size = header.getUInt( 4 );
+    const int log_version = static_cast< int >( header.getInt( 4 ) );
+    const std::uint64_t size = header.getUInt( 8 );
+    const std::uint64_t mtime = header.getUInt( 8 );
+    const std::uint64_t frame_count = header.getUInt( 8 );
+    const std::uint64_t events_size = header.getUInt( 8 );
+
+    if ( version != CACHE_VERSION
+         || frame_size != FRAME_SIZE
+         || size != source_size
+         || mtime != source_mtime
+         || frame_count > ( image->size_ - HEADER_SIZE ) / FRAME_SIZE
+         || HEADER_SIZE + frame_count * FRAME_SIZE + events_size != image->size_ )
+    {
+        return;
+    }
+
+    M_log_version = log_version;
+    M_frame_count = frame_count;
+    M_frames = image->data_ + HEADER_SIZE;
+    M_events = M_frames + frame_count * FRAME_SIZE;
+    M_events_size = events_size;
+    M_image = std::move( image );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+FrameCacheReader::~FrameCacheReader()
+{
+
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+std::string
+FrameCacheReader::cache_path( const std::string & source_path )
+{
+    return source_path + ".rcgcache";
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+bool
+FrameCacheReader::read( rcss::rcg::Handler & handler ) const
+{
+    if ( ! M_image )
+    {
+        return false;
+    }
+
+    if ( ! handler.handleLogVersion( M_log_version ) )
+    {
+        return false;
+    }
+
+    rcss::rcg::ShowInfoT show;
+    std::uint64_t frame = 0;
+
+    // pass the frames until the given index
+    auto read_frames = [&]( const std::uint64_t last )
+    {
+        for ( ; frame < last; ++frame )
+        {
+            Decoder decoder( M_frames + frame * FRAME_SIZE, FRAME_SIZE );
+            decoder.getShow( show );
+            if ( ! handler.handleShow( show ) )
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    Decoder events( M_events, M_events_size );
+    while ( ! events.atEnd() )
+    {
+        const int type = static_cast< int >( events.getUInt( 1 ) );
+        const std::uint64_t position = events.getUInt( 8 );
+        if ( ! events.ok()
+             || position < frame
+             || M_frame_count < position )
+        {
+            std::cerr << "(FrameCacheReader::read) broken event list." << std::endl;
+            return false;
+        }
+
+        if ( ! read_frames( position ) )
+        {
+            return false;
+        }
+
+        bool result = true;
+        switch ( type ) {
+        case EVENT_PLAYMODE:
+            {
+                const int time = static_cast< int >( events.getInt( 4 ) );
+                const rcss::rcg::PlayMode pmode = static_cast< rcss::rcg::PlayMode >( events.getUInt( 1 ) );
+                result = handler.handlePlayMode( time, pmode );
+                break;
+            }
+        case EVENT_TEAM:
+            {
+                const int time = static_cast< int >( events.getInt( 4 ) );
+                rcss::rcg::TeamT team_l, team_r;
+                events.getTeam( team_l );
+                events.getTeam( team_r );
+                result = handler.handleTeam( time, team_l, team_r );
+                break;
+            }
+        case EVENT_MSG:
+            {
+                const int time = static_cast< int >( events.getInt( 4 ) );
+                const int board = static_cast< int >( events.getInt( 4 ) );
+                const std::string msg = events.getString();
+                result = handler.handleMsg( time, board, msg );
+                break;
+            }
+        case EVENT_DRAW:
+            {
+                const int time = static_cast< int >( events.getInt( 4 ) );
+                rcss::rcg::drawinfo_t draw;
+                std::memset( &draw, 0, sizeof( draw ) );
+                draw.mode = static_cast< rcss::rcg::Int16 >( events.getInt( 2 ) );
+
+                char * color = nullptr;
+                switch ( draw.mode ) {
+                case rcss::rcg::DrawPoint:
+                    draw.object.pinfo.x = static_cast< rcss::rcg::Int16 >( events.getInt( 2 ) );
+                    draw.object.pinfo.y = static_cast< rcss::rcg::Int16 >( events.getInt( 2 ) );
+                    color = draw.object.pinfo.color;
+                    break;
+                case rcss::rcg::DrawCircle:
+                    draw.object.cinfo.x = static_cast< rcss::rcg::Int16 >( events.getInt( 2 ) );
+                    draw.object.cinfo.y = static_cast< rcss::rcg::Int16 >( events.getInt( 2 ) );
+                    draw.object.cinfo.r = static_cast< rcss::rcg::Int16 >( events.getInt( 2 ) );
+                    color = draw.object.cinfo.color;
+                    break;
+                case rcss::rcg::DrawLine:
+                    draw.object.linfo.x1 = static_cast< rcss::rcg::Int16 >( events.getInt( 2 ) );
+                    draw.object.linfo.y1 = static_cast< rcss::rcg::Int16 >( events.getInt( 2 ) );
+                    draw.object.linfo.x2 = static_cast< rcss::rcg::Int16 >( events.getInt( 2 ) );
+                    draw.object.linfo.y2 = static_cast< rcss::rcg::Int16 >( events.getInt( 2 ) );
+                    color = draw.object.linfo.color;
+                    break;
+                default:
+                    break;
+                }
+
+                for ( int i = 0; color && i < rcss::rcg::COLOR_NAME_MAX; ++i )
+                {
+                    color[i] = static_cast< char >( events.getInt( 1 ) );
+                }
+
+                result = handler.handleDraw( time, draw );
+                break;
+            }
+        case EVENT_SERVER_PARAM:
+            {
+                rcss::rcg::ServerParamT param;
+                result = ( param.fromServerString( events.getString() )
+                           && handler.handleServerParam( param ) );
+                break;
+            }
+        case EVENT_PLAYER_PARAM:
+            {
+                rcss::rcg::PlayerParamT param;
+                result = ( param.fromServerString( events.getString() )
+                           && handler.handlePlayerParam( param ) );
+                break;
+            }
+        case EVENT_PLAYER_TYPE:
+            {
+                rcss::rcg::PlayerTypeT param;
+                param.id_ = static_cast< int >( events.getInt( 4 ) );
+                for ( double rcss::rcg::PlayerTypeT::* const member : PLAYER_TYPE_MEMBERS )
+                {
+                    param.*member = events.getDouble();
+                }
+                result = handler.handlePlayerType( param );
+                break;
+            }
+        case EVENT_TEAM_GRAPHIC:
+            {
+                const char side = static_cast< char >( events.getInt( 1 ) );
+                const int x = static_cast< int >( events.getInt( 4 ) );
+                const int y = static_cast< int >( events.getInt( 4 ) );
+                const std::uint64_t n = events.getUInt( 4 );
+                std::vector< std::string > xpm_data;
+                for ( std::uint64_t i = 0; i < n && events.ok(); ++i )
+                {
+                    xpm_data.push_back( events.getString() );
+                }
+                result = ( events.ok()
+                           && handler.handleTeamGraphic( side, x, y, xpm_data ) );
+                break;
+            }
+        default:
+            result = false;
+            break;
+        }
+
+        if ( ! events.ok()
+             || ! result )
+        {
+            if ( ! events.ok() )
+            {
+                std::cerr << "(FrameCacheReader::read) broken event data." << std::endl;
+            }
+            return false;
+        }
+    }
+
+    return ( read_frames( M_frame_count )
+             && handler.handleEOF() );
+}
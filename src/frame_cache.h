@@ -0,0 +1,188 @@
+// -*-c++-*-
+
+/*!
+  \file frame_cache.h
+  \brief binary cache file of the parsed game log Header File.
+*/
+
+/*
+ *Copyright:
+
+ Copyright (C) The RoboCup Soccer Server Maintenance Group.
+ Hidehisa AKIYAMA
+
+ This code is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 3, or (at your option)
+ any later version.
+
+ This code is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this code; see the file COPYING.	If not, write to
+ the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+
+ *EndCopyright:
+ */
+
+/////////////////////////////////////////////////////////////////////
+
+#ifndef RCSSMONITOR_FRAME_CACHE_H
+#define RCSSMONITOR_FRAME_CACHE_H
+
+#include <rcss/rcg/handler.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+  The cache file ("<game log path>.rcgcache") consists of the header,
+  the frame table and the event list. All values are little-endian.
+
+  header: magic "RCGFRAME", version, frame size, log version,
+          source file size, source file mtime, frame count, event list size
+  frame table: the fixed size records of ShowInfoT
+  event list: the other handled data (playmode, team, message, draw,
+              parameters, player types and team graphics). each event
+              has the number of the preceding frames, so the original
+              order of the handler calls is reproduced.
+
+  The cache is used only if the size and the modification time of the
+  source file are not changed.
+*/
+
+/*!
+  \class FrameCacheWriter
+  \brief the handler that records the handled data for the cache file.
+
+  All data are passed to the given handler as they are.
+*/
+class FrameCacheWriter
+    : public rcss::rcg::Handler {
+private:
+
+    rcss::rcg::Handler & M_handler; //!< the handler that receives all data
+    std::string M_source_path;
+    std::uint64_t M_source_size;
+    std::uint64_t M_source_mtime;
+
+    std::vector< unsigned char > M_frames; //!< encoded frame table
+    std::uint64_t M_frame_count;
+    std::vector< unsigned char > M_events; //!< encoded event list
+
+    // not used
+    FrameCacheWriter() = delete;
+    FrameCacheWriter( const FrameCacheWriter & ) = delete;
+    FrameCacheWriter & operator=( const FrameCacheWriter & ) = delete;
+
+public:
+
+    /*!
+      \brief record the size and the modification time of the source file.
+      \param handler the handler that receives all data
+      \param source_path game log file path
+     */
+    FrameCacheWriter( rcss::rcg::Handler & handler,
+                      const std::string & source_path );
+
+    /*!
+      \brief write the cache file of the recorded data.
+      \return false if the file could not be written.
+     */
+    bool save() const;
+
+    bool handleLogVersion( const int ver ) override;
+
+    bool handleEOF() override;
+
+    bool handleShow( const rcss::rcg::ShowInfoT & show ) override;
+    bool handleMsg( const int time,
+                    const int board,
+                    const std::string & msg ) override;
+    bool handleDraw( const int time,
+                     const rcss::rcg::drawinfo_t & draw ) override;
+    bool handlePlayMode( const int time,
+                         const rcss::rcg::PlayMode pmode ) override;
+    bool handleTeam( const int time,
+                     const rcss::rcg::TeamT & team_l,
+                     const rcss::rcg::TeamT & team_r ) override;
+    bool handleServerParam( const rcss::rcg::ServerParamT & param ) override;
+    bool handlePlayerParam( const rcss::rcg::PlayerParamT & param ) override;
+    bool handlePlayerType( const rcss::rcg::PlayerTypeT & param ) override;
+    bool handleTeamGraphic( const char side,
+                            const int x,
+                            const int y,
+                            const std::vector< std::string > & xpm_data ) override;
+
+private:
+
+    void putEvent( const int type );
+
+};
+
+/*!
+  \class FrameCacheReader
+  \brief memory-mapped cache file.
+*/
+class FrameCacheReader {
+private:
+
+    struct Image;
+
+    std::unique_ptr< Image > M_image;
+
+    int M_log_version;
+    std::uint64_t M_frame_count;
+    const unsigned char * M_frames; //!< the first frame in the image
+    const unsigned char * M_events; //!< the event list in the image
+    std::uint64_t M_events_size;
+
+    // not used
+    FrameCacheReader() = delete;
+    FrameCacheReader( const FrameCacheReader & ) = delete;
+    FrameCacheReader & operator=( const FrameCacheReader & ) = delete;
+
+public:
+
+    /*!
+      \brief open the cache file of the source file and check its header.
+      \param source_path game log file path
+     */
+    explicit
+    FrameCacheReader( const std::string & source_path );
+
+    ~FrameCacheReader();
+
+    /*!
+      \brief check if the cache file is available for the source file
+     */
+    bool isValid() const
+      {
+          return static_cast< bool >( M_image );
+      }
+
+    std::uint64_t frameCount() const
+      {
+          return M_frame_count;
+      }
+
+    /*!
+      \brief pass all cached data to the handler in the original order.
+      \return false if the data are broken or the handler returns false.
+     */
+    bool read( rcss::rcg::Handler & handler ) const;
+
+    /*!
+      \brief get the cache file path of the source file
+     */
+    static
+    std::string cache_path( const std::string & source_path );
+
+};
+
+#endif
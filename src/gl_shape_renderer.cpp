@@ -0,0 +1,397 @@
+// -*-c++-*-
+
+/*!
+  \file gl_shape_renderer.cpp
+  \brief OpenGL instanced shape renderer Source File.
+*/
+
+/*
+ *Copyright:
+
+ Copyright (C) The RoboCup Soccer Server Maintenance Group.
+ Hidehisa AKIYAMA
+
+ This code is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 3, or (at your option)
+ any later version.
+
+ This code is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this code; see the file COPYING.  If not, write to
+ the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+
+ *EndCopyright:
+ */
+
+/////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef USE_GLWIDGET
+
+#include <QOpenGLContext>
+#include <QOpenGLShaderProgram>
+#include <QPainter>
+#include <QPaintDevice>
+#include <QRegion>
+
+#include "gl_shape_renderer.h"
+
+#include <iostream>
+#include <cmath>
+#include <cstddef>
+
+namespace {
+
+//! the vertex attribute locations
+enum {
+    CORNER_ATTR = 0,
+    GEOM_ATTR = 1,
+    ARC_ATTR = 2,
+    FILL_ATTR = 3,
+    LINE_ATTR = 4,
+};
+
+//! if the clip region has more rectangles, its bounding rectangle is used.
+const int MAX_SCISSOR_RECTS = 16;
+
+const char * VERTEX_SHADER =
+    "in vec2 a_corner;\n"
+    "in vec4 a_geom;\n"
+    "in vec4 a_arc;\n"
+    "in vec4 a_fill;\n"
+    "in vec4 a_line;\n"
+    "uniform vec2 u_viewport;\n"
+    "out vec2 v_local;\n"
+    "flat out vec4 v_geom;\n"
+    "flat out vec4 v_arc;\n"
+    "flat out vec4 v_fill;\n"
+    "flat out vec4 v_line;\n"
+    "void main()\n"
+    "{\n"
+    // one more pixel for the anti-aliasing
+    "    float extent = a_geom.z + a_geom.w + 1.0;\n"
+    "    v_local = a_corner * extent;\n"
+    "    vec2 pos = a_geom.xy + v_local;\n"
+    "    gl_Position = vec4( pos.x / u_viewport.x * 2.0 - 1.0,\n"
+    "                        1.0 - pos.y / u_viewport.y * 2.0,\n"
+    "                        0.0, 1.0 );\n"
+    "    v_geom = a_geom;\n"
+    "    v_arc = a_arc;\n"
+    "    v_fill = a_fill;\n"
+    "    v_line = a_line;\n"
+    "}\n";
+
+const char * FRAGMENT_SHADER =
+    "in vec2 v_local;\n"
+    "flat in vec4 v_geom;\n"
+    "flat in vec4 v_arc;\n"
+    "flat in vec4 v_fill;\n"
+    "flat in vec4 v_line;\n"
+    "out vec4 frag_color;\n"
+    "const float TWO_PI = 6.28318531;\n"
+    "float coverage( float dist, float half_width, float aa )\n"
+    "{\n"
+    "    return 1.0 - smoothstep( half_width - aa, half_width + aa, dist );\n"
+    "}\n"
+    "float ray( float angle, float radius, float half_width, float aa )\n"
+    "{\n"
+    "    vec2 dir = vec2( cos( angle ), -sin( angle ) );\n"
+    "    float t = clamp( dot( v_local, dir ), 0.0, radius );\n"
+    "    return coverage( length( v_local - dir * t ), half_width, aa );\n"
+    "}\n"
+    "void main()\n"
+    "{\n"
+    "    float radius = v_geom.z;\n"
+    "    float half_width = v_geom.w * 0.5;\n"
+    "    float dist = length( v_local );\n"
+    "    float aa = max( fwidth( dist ), 0.001 ) * 0.5;\n"
+    "    float line = 0.0;\n"
+    "    float fill_alpha = 0.0;\n"
+    "    if ( v_arc.z > 2.5 )\n"
+    "    {\n"
+    // the outline of the square
+    "        float d = max( abs( v_local.x ), abs( v_local.y ) );\n"
+    "        line = coverage( abs( d - radius ), half_width, aa );\n"
+    "    }\n"
+    "    else if ( v_arc.z > 1.5 )\n"
+    "    {\n"
+    // the line segment through the center
+    "        vec2 dir = vec2( cos( v_arc.x ), -sin( v_arc.x ) );\n"
+    "        float t = clamp( dot( v_local, dir ), -radius, radius );\n"
+    "        line = coverage( length( v_local - dir * t ), half_width, aa );\n"
+    "    }\n"
+    "    else\n"
+    "    {\n"
+    // counter-clockwise on the screen, the screen y axis points down.
+    "        float angle = mod( atan( -v_local.y, v_local.x ) - v_arc.x, TWO_PI );\n"
+    "        bool full = ( v_arc.y >= TWO_PI - 0.0001 );\n"
+    "        float in_span = ( full || angle <= v_arc.y ) ? 1.0 : 0.0;\n"
+    "        line = coverage( abs( dist - radius ), half_width, aa ) * in_span;\n"
+    "        if ( v_arc.w > 0.0 )\n"
+    "        {\n"
+    "            line *= step( mod( angle * radius, v_arc.w ), v_arc.w / 3.0 );\n"
+    "        }\n"
+    "        if ( v_arc.z > 0.5 )\n"
+    "        {\n"
+    "            line = max( line, ray( v_arc.x, radius, half_width, aa ) );\n"
+    "            line = max( line, ray( v_arc.x + v_arc.y, radius, half_width, aa ) );\n"
+    "        }\n"
+    "        fill_alpha = full ? coverage( dist, radius, aa ) * v_fill.a : 0.0;\n"
+    "    }\n"
+    "    float line_alpha = line * v_line.a;\n"
+    // premultiplied, the line is drawn over the fill.
+    "    float alpha = line_alpha + fill_alpha * ( 1.0 - line_alpha );\n"
+    "    if ( alpha <= 0.0 )\n"
+    "    {\n"
+    "        discard;\n"
+    "    }\n"
+    "    frag_color = vec4( v_line.rgb * line_alpha\n"
+    "                       + v_fill.rgb * fill_alpha * ( 1.0 - line_alpha ),\n"
+    "                       alpha );\n"
+    "}\n";
+
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+GLShapeRenderer::GLShapeRenderer()
+    : M_quad_buffer( QOpenGLBuffer::VertexBuffer ),
+      M_instance_buffer( QOpenGLBuffer::VertexBuffer ),
+      M_viewport_location( -1 ),
+      M_valid( false )
+{
+
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+GLShapeRenderer::~GLShapeRenderer()
+{
+    // the owner has to call cleanup() while the context is alive.
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+bool
+GLShapeRenderer::initialize()
+{
+    cleanup();
+
+    QOpenGLContext * context = QOpenGLContext::currentContext();
+    if ( ! context )
+    {
+        return false;
+    }
+
+    const bool es = context->isOpenGLES();
+    const QPair< int, int > version = context->format().version();
+    if ( version < ( es ? qMakePair( 3, 0 ) : qMakePair( 3, 3 ) ) )
+    {
+        std::cerr << "OpenGL " << version.first << '.' << version.second
+                  << ( es ? " ES" : "" )
+                  << ": the instanced rendering is not available."
+                  << " the player shapes are drawn by QPainter." << std::endl;
+        return false;
+    }
+
+    initializeOpenGLFunctions();
+
+    if ( ! createProgram( es ) )
+    {
+        cleanup();
+        return false;
+    }
+
+    static const float corners[] = { -1.0f, -1.0f,
+                                     1.0f, -1.0f,
+                                     -1.0f, 1.0f,
+                                     1.0f, 1.0f };
+
+    M_vao.create();
+    QOpenGLVertexArrayObject::Binder vao_binder( &M_vao );
+
+    M_quad_buffer.create();
+    M_quad_buffer.bind();
+    M_quad_buffer.allocate( corners, sizeof( corners ) );
+    M_program->enableAttributeArray( CORNER_ATTR );
+    M_program->setAttributeBuffer( CORNER_ATTR, GL_FLOAT, 0, 2 );
+    M_quad_buffer.release();
+
+    M_instance_buffer.create();
+    M_instance_buffer.setUsagePattern( QOpenGLBuffer::DynamicDraw );
+    M_instance_buffer.bind();
+
+    const int stride = sizeof( ShapeBatch::Shape );
+    const int offsets[] = { static_cast< int >( offsetof( ShapeBatch::Shape, geom_ ) ),
+                            static_cast< int >( offsetof( ShapeBatch::Shape, arc_ ) ),
+                            static_cast< int >( offsetof( ShapeBatch::Shape, fill_ ) ),
+                            static_cast< int >( offsetof( ShapeBatch::Shape, line_ ) ) };
+    for ( int i = 0; i < 4; ++i )
+    {
+        M_program->enableAttributeArray( GEOM_ATTR + i );
+        M_program->setAttributeBuffer( GEOM_ATTR + i, GL_FLOAT, offsets[i], 4, stride );
+        glVertexAttribDivisor( GEOM_ATTR + i, 1 );
+    }
+    M_instance_buffer.release();
+
+    M_valid = true;
+    return true;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+bool
+GLShapeRenderer::createProgram( const bool es )
+{
+    const QByteArray header = ( es
+                                ? "#version 300 es\nprecision highp float;\n"
+                                : "#version 330 core\n" );
+
+    M_program.reset( new QOpenGLShaderProgram() );
+
+    if ( ! M_program->addShaderFromSourceCode( QOpenGLShader::Vertex,
+                                               header + VERTEX_SHADER )
+         || ! M_program->addShaderFromSourceCode( QOpenGLShader::Fragment,
+                                                  header + FRAGMENT_SHADER ) )
+    {
+        std::cerr << "failed to compile the shape shader. "
+                  << M_program->log().toStdString() << std::endl;
+        return false;
+    }
+
+    M_program->bindAttributeLocation( "a_corner", CORNER_ATTR );
+    M_program->bindAttributeLocation( "a_geom", GEOM_ATTR );
+    M_program->bindAttributeLocation( "a_arc", ARC_ATTR );
+    M_program->bindAttributeLocation( "a_fill", FILL_ATTR );
+    M_program->bindAttributeLocation( "a_line", LINE_ATTR );
+
+    if ( ! M_program->link() )
+    {
+        std::cerr << "failed to link the shape shader. "
+                  << M_program->log().toStdString() << std::endl;
+        return false;
+    }
+
+    M_viewport_location = M_program->uniformLocation( "u_viewport" );
+    return true;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+GLShapeRenderer::cleanup()
+{
+    M_valid = false;
+
+    if ( M_vao.isCreated() )
+    {
+        M_vao.destroy();
+    }
+    if ( M_quad_buffer.isCreated() )
+    {
+        M_quad_buffer.destroy();
+    }
+    if ( M_instance_buffer.isCreated() )
+    {
+        M_instance_buffer.destroy();
+    }
+    M_program.reset();
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+GLShapeRenderer::render( QPainter & painter,
+                         const ShapeBatch & batch )
+{
+    if ( ! M_valid
+         || batch.empty() )
+    {
+        return;
+    }
+
+    const QPaintDevice * device = painter.device();
+    const int width = device->width();
+    const int height = device->height();
+    const qreal dpr = device->devicePixelRatioF();
+
+    QRegion clip = ( painter.hasClipping()
+                     ? painter.clipRegion()
+                     : QRegion( 0, 0, width, height ) );
+    if ( clip.rectCount() > MAX_SCISSOR_RECTS )
+    {
+        clip = QRegion( clip.boundingRect() );
+    }
+
+    const std::vector< ShapeBatch::Shape > & shapes = batch.shapes();
+
+    painter.beginNativePainting();
+
+    glViewport( 0, 0,
+                static_cast< GLsizei >( std::ceil( width * dpr ) ),
+                static_cast< GLsizei >( std::ceil( height * dpr ) ) );
+    glDisable( GL_DEPTH_TEST );
+    glDisable( GL_STENCIL_TEST );
+    glEnable( GL_BLEND );
+    glBlendFunc( GL_ONE, GL_ONE_MINUS_SRC_ALPHA );
+    glEnable( GL_SCISSOR_TEST );
+
+    M_program->bind();
+    M_program->setUniformValue( M_viewport_location,
+                                static_cast< GLfloat >( width ),
+                                static_cast< GLfloat >( height ) );
+
+    {
+        QOpenGLVertexArrayObject::Binder vao_binder( &M_vao );
+
+        M_instance_buffer.bind();
+        M_instance_buffer.allocate( shapes.data(),
+                                    static_cast< int >( shapes.size() * sizeof( ShapeBatch::Shape ) ) );
+
+#if QT_VERSION >= QT_VERSION_CHECK( 5, 8, 0 )
+        for ( const QRect & r : clip )
+#else
+        for ( const QRect & r : clip.rects() )
+#endif
+        {
+            // the frame buffer origin is the bottom left corner.
+            const int x0 = static_cast< int >( std::floor( r.left() * dpr ) );
+            const int y0 = static_cast< int >( std::floor( ( height - r.top() - r.height() ) * dpr ) );
+            const int x1 = static_cast< int >( std::ceil( ( r.left() + r.width() ) * dpr ) );
+            const int y1 = static_cast< int >( std::ceil( ( height - r.top() ) * dpr ) );
+
+            glScissor( x0, y0, x1 - x0, y1 - y0 );
+            glDrawArraysInstanced( GL_TRIANGLE_STRIP, 0, 4,
+                                   static_cast< GLsizei >( shapes.size() ) );
+        }
+
+        M_instance_buffer.release();
+    }
+
+    M_program->release();
+    glDisable( GL_SCISSOR_TEST );
+
+    painter.endNativePainting();
+}
+
+#endif
@@ -0,0 +1,103 @@
+// -*-c++-*-
+
+/*!
+  \file gl_shape_renderer.h
+  \brief OpenGL instanced shape renderer Header File.
+*/
+
+/*
+ *Copyright:
+
+ Copyright (C) The RoboCup Soccer Server Maintenance Group.
+ Hidehisa AKIYAMA
+
+ This code is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 3, or (at your option)
+ any later version.
+
+ This code is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this code; see the file COPYING.  If not, write to
+ the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+
+ *EndCopyright:
+ */
+
+/////////////////////////////////////////////////////////////////////
+
+#ifndef RCSSMONITOR_GL_SHAPE_RENDERER_H
+#define RCSSMONITOR_GL_SHAPE_RENDERER_H
+
+#include <QOpenGLBuffer>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLVertexArrayObject>
+
+#include "shape_batch.h"
+
+#include <memory>
+
+class QOpenGLShaderProgram;
+
+/*!
+  \class GLShapeRenderer
+  \brief draw all shapes of ShapeBatch by one instanced draw call per clip rectangle.
+
+  Each shape is a screen aligned quad, and the fragment shader computes
+  the disc, the ring, the arc span, the dot pattern, the pie edges, the
+  line segment and the square outline.
+  OpenGL 3.3 or OpenGL ES 3.0 is required. Otherwise, isAvailable()
+  returns false and the painters draw the shapes by QPainter.
+*/
+class GLShapeRenderer
+    : public ShapeRenderer,
+      protected QOpenGLExtraFunctions {
+private:
+
+    std::unique_ptr< QOpenGLShaderProgram > M_program;
+    QOpenGLVertexArrayObject M_vao;
+    QOpenGLBuffer M_quad_buffer; //!< the corners of the unit quad
+    QOpenGLBuffer M_instance_buffer; //!< ShapeBatch::Shape array
+
+    int M_viewport_location; //!< the uniform location of the viewport size
+
+    bool M_valid;
+
+    // not used
+    GLShapeRenderer( const GLShapeRenderer & ) = delete;
+    GLShapeRenderer & operator=( const GLShapeRenderer & ) = delete;
+
+public:
+
+    GLShapeRenderer();
+    ~GLShapeRenderer();
+
+    /*!
+      \brief create the shader program and the buffers. the context has to be current.
+      \return true if the instanced rendering is available.
+     */
+    bool initialize();
+
+    /*!
+      \brief release the OpenGL resources. the context has to be current.
+     */
+    void cleanup();
+
+    bool isAvailable() const override
+      {
+          return M_valid;
+      }
+
+    void render( QPainter & painter,
+                 const ShapeBatch & batch ) override;
+
+private:
+
+    bool createProgram( const bool es );
+};
+
+#endif
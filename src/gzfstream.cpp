@@ -36,34 +36,1317 @@
 
 #include "gzfstream.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 #include <cstdio>
+#include <cstring>
+#include <cstdint>
+
+#include <sys/types.h>
+#include <sys/stat.h>
 
 #ifdef HAVE_LIBZ
 #include <zlib.h>
 #endif
 
-/////////////////////////////////////////////////////////////////////
+#ifdef HAVE_LIBZ
+namespace {
+
+//! input buffer size of the compressed data
+const std::size_t IN_BUF_SIZE = 64 * 1024;
+
+//! the minimum distance between access points (inflated bytes)
+const std::int64_t INDEX_SPAN = 1024 * 1024;
+
+//! inflate window size
+const std::size_t WINDOW_SIZE = 32768;
+
+//! the size of the read-ahead buffer (inflated bytes)
+const std::size_t READ_AHEAD_SIZE = 1024 * 1024;
+
+//! the maximum number of the filled read-ahead buffers
+const std::size_t READ_AHEAD_COUNT = 4;
+
+//! the header size of the BGZF block
+const std::size_t BGZF_HEADER_SIZE = 18;
+
+//! the trailer size of the gzip member
+const std::size_t GZIP_TRAILER_SIZE = 8;
+
+//! the header of the index file
+const char INDEX_MAGIC[8] = { 'R', 'C', 'G', 'Z', 'I', 'D', 'X', '1' };
+
+/*!
+  \brief an access point of the compressed stream.
+  the inflate state at the deflate block boundary can be restored from
+  the input offset, the unused bits of the previous byte and the window.
+ */
+struct AccessPoint {
+    std::int64_t out_; //!< offset in the inflated data
+    std::int64_t in_; //!< offset of the first complete byte in the compressed file
+    int bits_; //!< the number of bits (1-7) from the byte at in_ - 1, or 0
+    std::vector< unsigned char > window_; //!< the preceding inflated data (up to 32K)
+};
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief check the BGZF block header (a gzip member with the 'BC' extra field).
+  \return the size of the whole member, or 0 if the header is not BGZF.
+ */
+std::size_t
+bgzf_block_size( const unsigned char * header )
+{
+    if ( header[0] != 0x1f
+         || header[1] != 0x8b
+         || header[2] != 8 // deflate
+         || header[3] != 4 // FEXTRA only
+         || header[10] != 6
+         || header[11] != 0 // XLEN
+         || header[12] != 'B'
+         || header[13] != 'C'
+         || header[14] != 2
+         || header[15] != 0 )
+    {
+        return 0;
+    }
+
+    return ( std::size_t( header[16] ) | ( std::size_t( header[17] ) << 8 ) ) + 1;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief little-endian 32 bit value in the gzip trailer
+ */
+std::uint32_t
+get_uint32( const unsigned char * ptr )
+{
+    return std::uint32_t( ptr[0] )
+        | ( std::uint32_t( ptr[1] ) << 8 )
+        | ( std::uint32_t( ptr[2] ) << 16 )
+        | ( std::uint32_t( ptr[3] ) << 24 );
+}
+
+/*!
+  \brief a BGZF block read into the batch buffer
+ */
+struct BgzfBlock {
+    std::size_t in_offset_; //!< offset in the compressed batch buffer
+    std::size_t in_size_; //!< the size of the whole member
+    std::size_t out_offset_; //!< offset in the inflated batch buffer
+    std::size_t out_size_; //!< the inflated size (ISIZE)
+};
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief inflate a BGZF block and check its CRC.
+ */
+bool
+inflate_bgzf_block( z_stream & strm,
+                    const unsigned char * member,
+                    const std::size_t member_size,
+                    char * out,
+                    const std::size_t out_size )
+{
+    if ( inflateReset( &strm ) != Z_OK )
+    {
+        return false;
+    }
+
+    strm.next_in = const_cast< Bytef * >( member + BGZF_HEADER_SIZE );
+    strm.avail_in = static_cast< uInt >( member_size - BGZF_HEADER_SIZE - GZIP_TRAILER_SIZE );
+    strm.next_out = reinterpret_cast< Bytef * >( out );
+    strm.avail_out = static_cast< uInt >( out_size );
+
+    if ( inflate( &strm, Z_FINISH ) != Z_STREAM_END
+         || strm.avail_out != 0 )
+    {
+        return false;
+    }
+
+    const uLong crc = crc32( 0L, reinterpret_cast< const Bytef * >( out ), static_cast< uInt >( out_size ) );
+    return crc == get_uint32( member + member_size - GZIP_TRAILER_SIZE );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief move the file position to the absolute offset.
+  the offset beyond 2GB is available if the platform supports it.
+  \return 0 if successful
+ */
+int
+seek_file( std::FILE * fp,
+           const std::int64_t offset )
+{
+#if defined(_WIN32)
+    return _fseeki64( fp, offset, SEEK_SET );
+#elif defined(HAVE_FSEEKO)
+    if ( offset > static_cast< std::int64_t >( std::numeric_limits< off_t >::max() ) )
+    {
+        return -1;
+    }
+    return fseeko( fp, static_cast< off_t >( offset ), SEEK_SET );
+#else
+    if ( offset > static_cast< std::int64_t >( std::numeric_limits< long >::max() ) )
+    {
+        return -1;
+    }
+    return std::fseek( fp, static_cast< long >( offset ), SEEK_SET );
+#endif
+}
+
+/*!
+  \brief the worker threads that inflate the BGZF blocks.
+  the threads and their z_streams are created at the first batch and
+  reused until stop() is called.
+ */
+class InflateWorkers {
+private:
+    std::vector< std::thread > threads_;
+    std::mutex mutex_;
+    std::condition_variable start_cond_;
+    std::condition_variable done_cond_;
+
+    //! the current batch. set by the caller thread under the lock.
+    const std::vector< BgzfBlock > * blocks_;
+    const unsigned char * comp_;
+    char * out_;
+
+    std::atomic< std::size_t > next_block_;
+    std::atomic< bool > failed_;
+    //! incremented for each batch to wake up the workers
+    std::size_t generation_;
+    //! the number of the workers processing the current batch
+    std::size_t busy_;
+    bool stop_;
+
+    //! z_stream used by the caller thread
+    z_stream strm_;
+    bool strm_init_;
+
+    // not used
+    InflateWorkers( const InflateWorkers & ) = delete;
+    InflateWorkers & operator=( const InflateWorkers & ) = delete;
+
+public:
+
+    InflateWorkers()
+        : blocks_( nullptr ),
+          comp_( nullptr ),
+          out_( nullptr ),
+          next_block_( 0 ),
+          failed_( false ),
+          generation_( 0 ),
+          busy_( 0 ),
+          stop_( false ),
+          strm_init_( false )
+      { }
+
+    ~InflateWorkers()
+      {
+          stop();
+      }
+
+    bool inflate( const std::vector< BgzfBlock > & blocks,
+                  const unsigned char * comp,
+                  char * out );
+    void stop();
+
+private:
+
+    void run();
+    void inflateBlocks( z_stream & strm );
+};
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief inflate all blocks in the batch by the worker threads and the caller thread.
+  \return false if any block is broken.
+ */
+bool
+InflateWorkers::inflate( const std::vector< BgzfBlock > & blocks,
+                         const unsigned char * comp,
+                         char * out )
+{
+    if ( ! strm_init_ )
+    {
+        std::memset( &strm_, 0, sizeof( strm_ ) );
+        if ( inflateInit2( &strm_, -15 ) != Z_OK )
+        {
+            return false;
+        }
+        strm_init_ = true;
+
+        const std::size_t n_threads = std::max( static_cast< std::size_t >( std::thread::hardware_concurrency() ),
+                                                std::size_t( 1 ) );
+        for ( std::size_t i = 1; i < n_threads; ++i )
+        {
+            threads_.emplace_back( &InflateWorkers::run, this );
+        }
+    }
+
+    {
+        std::lock_guard< std::mutex > lock( mutex_ );
+        blocks_ = &blocks;
+        comp_ = comp;
+        out_ = out;
+        next_block_ = 0;
+        failed_ = false;
+        busy_ = threads_.size();
+        ++generation_;
+    }
+    start_cond_.notify_all();
+
+    inflateBlocks( strm_ );
+
+    {
+        std::unique_lock< std::mutex > lock( mutex_ );
+        done_cond_.wait( lock, [this]() { return busy_ == 0; } );
+        blocks_ = nullptr;
+    }
+
+    return ! failed_;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief terminate the worker threads.
+ */
+void
+InflateWorkers::stop()
+{
+    {
+        std::lock_guard< std::mutex > lock( mutex_ );
+        stop_ = true;
+    }
+    start_cond_.notify_all();
+
+    for ( std::thread & t : threads_ )
+    {
+        t.join();
+    }
+    threads_.clear();
+    stop_ = false;
+
+    if ( strm_init_ )
+    {
+        inflateEnd( &strm_ );
+        strm_init_ = false;
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief the worker thread. wait for the batch and inflate the blocks.
+ */
+void
+InflateWorkers::run()
+{
+    z_stream strm;
+    std::memset( &strm, 0, sizeof( strm ) );
+    const bool init = ( inflateInit2( &strm, -15 ) == Z_OK );
+
+    std::size_t generation = 0;
+    while ( true )
+    {
+        {
+            std::unique_lock< std::mutex > lock( mutex_ );
+            start_cond_.wait( lock, [&]() { return stop_
+                                                   || generation_ != generation; } );
+            if ( stop_ )
+            {
+                break;
+            }
+            generation = generation_;
+        }
+
+        if ( init )
+        {
+            inflateBlocks( strm );
+        }
+        else
+        {
+            failed_ = true;
+        }
+
+        {
+            std::lock_guard< std::mutex > lock( mutex_ );
+            --busy_;
+        }
+        done_cond_.notify_one();
+    }
+
+    if ( init )
+    {
+        inflateEnd( &strm );
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief take the blocks of the current batch until no block is left.
+ */
+void
+InflateWorkers::inflateBlocks( z_stream & strm )
+{
+    std::size_t i;
+    while ( ! failed_
+            && ( i = next_block_++ ) < blocks_->size() )
+    {
+        const BgzfBlock & b = ( *blocks_ )[i];
+        if ( ! inflate_bgzf_block( strm,
+                                   comp_ + b.in_offset_, b.in_size_,
+                                   out_ + b.out_offset_, b.out_size_ ) )
+        {
+            failed_ = true;
+        }
+    }
+}
+
+/*-------------------------------------------------------------------*/
+void
+put_uint( std::vector< unsigned char > & buf,
+          std::uint64_t val,
+          const int bytes )
+{
+    for ( int i = 0; i < bytes; ++i )
+    {
+        buf.push_back( static_cast< unsigned char >( val & 0xff ) );
+        val >>= 8;
+    }
+}
+
+/*-------------------------------------------------------------------*/
+bool
+get_uint( const unsigned char *& ptr,
+          const unsigned char * end,
+          std::uint64_t * val,
+          const int bytes )
+{
+    if ( end - ptr < bytes )
+    {
+        return false;
+    }
+
+    *val = 0;
+    for ( int i = bytes - 1; i >= 0; --i )
+    {
+        *val = ( *val << 8 ) | ptr[i];
+    }
+    ptr += bytes;
+    return true;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief get the size and the modification time of the file
+ */
+bool
+file_stamp( const std::string & path,
+            std::uint64_t * size,
+            std::uint64_t * mtime )
+{
+    struct stat st;
+    if ( ::stat( path.c_str(), &st ) != 0 )
+    {
+        return false;
+    }
+
+    *size = static_cast< std::uint64_t >( st.st_size );
+    *mtime = static_cast< std::uint64_t >( st.st_mtime );
+    return true;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief read the index file. the index is used only if it was created
+  from the current source file.
+  \param points the result. if null, only the header is checked.
+ */
+bool
+load_index( const std::string & index_path,
+            const std::string & source_path,
+            std::vector< AccessPoint > * points )
+{
+    std::uint64_t src_size = 0, src_mtime = 0;
+    if ( ! file_stamp( source_path, &src_size, &src_mtime ) )
+    {
+        return false;
+    }
+
+    std::FILE * fp = std::fopen( index_path.c_str(), "rb" );
+    if ( ! fp )
+    {
+        return false;
+    }
+
+    std::vector< unsigned char > data;
+    unsigned char buf[8192];
+    std::size_t n;
+    while ( ( n = std::fread( buf, 1, sizeof( buf ), fp ) ) > 0 )
+    {
+        data.insert( data.end(), buf, buf + n );
+        if ( ! points )
+        {
+            break;
+        }
+    }
+    std::fclose( fp );
+
+    const unsigned char * ptr = data.data();
+    const unsigned char * end = ptr + data.size();
+    std::uint64_t size = 0, mtime = 0, span = 0, count = 0;
+
+    if ( data.size() < sizeof( INDEX_MAGIC )
+         || std::memcmp( ptr, INDEX_MAGIC, sizeof( INDEX_MAGIC ) ) != 0 )
+    {
+        return false;
+    }
+    ptr += sizeof( INDEX_MAGIC );
+
+    if ( ! get_uint( ptr, end, &size, 8 )
+         || ! get_uint( ptr, end, &mtime, 8 )
+         || ! get_uint( ptr, end, &span, 8 )
+         || ! get_uint( ptr, end, &count, 4 )
+         || size != src_size
+         || mtime != src_mtime )
+    {
+        return false;
+    }
+
+    if ( ! points )
+    {
+        return true;
+    }
+
+    std::vector< AccessPoint > result( count );
+    for ( AccessPoint & p : result )
+    {
+        std::uint64_t out = 0, in = 0, bits = 0, window_size = 0, comp_size = 0;
+        if ( ! get_uint( ptr, end, &out, 8 )
+             || ! get_uint( ptr, end, &in, 8 )
+             || ! get_uint( ptr, end, &bits, 1 )
+             || ! get_uint( ptr, end, &window_size, 4 )
+             || ! get_uint( ptr, end, &comp_size, 4 )
+             || bits > 7
+             || window_size > WINDOW_SIZE
+             || static_cast< std::uint64_t >( end - ptr ) < comp_size )
+        {
+            return false;
+        }
+
+        p.out_ = static_cast< std::int64_t >( out );
+        p.in_ = static_cast< std::int64_t >( in );
+        p.bits_ = static_cast< int >( bits );
+        p.window_.resize( window_size );
+
+        uLongf dest_len = static_cast< uLongf >( window_size );
+        if ( window_size > 0
+             && ( uncompress( p.window_.data(), &dest_len, ptr, static_cast< uLong >( comp_size ) ) != Z_OK
+                  || dest_len != window_size ) )
+        {
+            return false;
+        }
+        ptr += comp_size;
+    }
+
+    points->swap( result );
+    return true;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief write the index file. the window data are compressed.
+ */
+bool
+save_index( const std::string & index_path,
+            const std::string & source_path,
+            const std::vector< AccessPoint > & points )
+{
+    std::uint64_t src_size = 0, src_mtime = 0;
+    if ( ! file_stamp( source_path, &src_size, &src_mtime ) )
+    {
+        return false;
+    }
+
+    std::vector< unsigned char > data( INDEX_MAGIC, INDEX_MAGIC + sizeof( INDEX_MAGIC ) );
+    put_uint( data, src_size, 8 );
+    put_uint( data, src_mtime, 8 );
+    put_uint( data, INDEX_SPAN, 8 );
+    put_uint( data, points.size(), 4 );
+
+    std::vector< unsigned char > comp;
+    for ( const AccessPoint & p : points )
+    {
+        uLongf comp_len = compressBound( static_cast< uLong >( p.window_.size() ) );
+        comp.resize( comp_len );
+        if ( ! p.window_.empty()
+             && compress( comp.data(), &comp_len, p.window_.data(), static_cast< uLong >( p.window_.size() ) ) != Z_OK )
+        {
+            return false;
+        }
+        if ( p.window_.empty() )
+        {
+            comp_len = 0;
+        }
+
+        put_uint( data, static_cast< std::uint64_t >( p.out_ ), 8 );
+        put_uint( data, static_cast< std::uint64_t >( p.in_ ), 8 );
+        put_uint( data, static_cast< std::uint64_t >( p.bits_ ), 1 );
+        put_uint( data, p.window_.size(), 4 );
+        put_uint( data, comp_len, 4 );
+        data.insert( data.end(), comp.data(), comp.data() + comp_len );
+    }
+
+    std::FILE * fp = std::fopen( index_path.c_str(), "wb" );
+    if ( ! fp )
+    {
+        return false;
+    }
+
+    const bool result = ( std::fwrite( data.data(), 1, data.size(), fp ) == data.size() );
+    return ( std::fclose( fp ) == 0 ) && result;
+}
+
+}
+#endif
+
+/////////////////////////////////////////////////////////////////////
+
+//! the implementation of file stream buffer
+struct gzfilebuf::Impl {
+
+    //! file open mode flag
+    std::ios_base::openmode open_mode_;
+
+#ifdef HAVE_LIBZ
+    //! gzip file (output)
+    gzFile file_;
+
+    //
+    // input. inflated by the z_stream directly to build the index.
+    //
+
+    //! compressed file
+    std::FILE * in_file_;
+    //! the path of the opened file
+    std::string path_;
+    //! true if the file is not gzipped. the data are read as is.
+    bool transparent_;
+
+    z_stream strm_;
+    bool strm_init_;
+    //! true if the stream was restored from an access point (no gzip header)
+    bool raw_;
+    //! true if the end of the data has been reached
+    bool eof_;
+
+    std::vector< unsigned char > in_buf_;
+    //! the number of bytes read from the file
+    std::int64_t in_total_;
+    //! offset of the next inflated byte
+    std::int64_t out_pos_;
+
+    //! access points, sorted by the offset
+    std::vector< AccessPoint > points_;
+    //! true if the access points cover the whole file (read from or saved to the index file)
+    bool index_complete_;
+    //! true if the access points have to be read from the index file
+    bool index_pending_;
+
+    //! true if the file consists of BGZF blocks
+    bool bgzf_;
+    //! true if the z_stream is at the start of a gzip member
+    bool member_start_;
+    //! inflate the BGZF blocks in parallel
+    InflateWorkers inflate_workers_;
+
+    //
+    // read-ahead. the reader thread owns the inflate state while it is running.
+    //
+
+    //! inflated data
+    struct Chunk {
+        std::vector< char > data_;
+        std::size_t size_; //!< the size of the valid data
+        std::int64_t end_; //!< the offset of the end of the data
+    };
+
+    std::thread reader_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque< Chunk > filled_;
+    std::vector< std::vector< char > > spare_;
+    bool stop_reader_;
+    bool reader_done_;
+
+    //! the chunk used as the get area
+    Chunk current_;
+    //! the offset of the end of the get area
+    std::int64_t get_end_;
+#endif
+
+    //! constructor
+    Impl()
+        : open_mode_( static_cast< std::ios_base::openmode >( 0 ) )
+#ifdef HAVE_LIBZ
+        , file_( nullptr )
+        , in_file_( nullptr )
+        , transparent_( false )
+        , strm_init_( false )
+        , raw_( false )
+        , eof_( false )
+        , in_total_( 0 )
+        , out_pos_( 0 )
+        , index_complete_( false )
+        , index_pending_( false )
+        , bgzf_( false )
+        , member_start_( false )
+        , stop_reader_( false )
+        , reader_done_( false )
+        , get_end_( 0 )
+#endif
+      { }
+
+#ifdef HAVE_LIBZ
+
+    std::string indexPath() const
+      {
+          return path_ + ".gzidx";
+      }
+
+    bool openInput( const char * path );
+    void closeInput();
+
+    bool fillInput( const unsigned int size );
+    bool startMember();
+    bool rewind();
+    bool restore( const AccessPoint & point );
+    int read( char * buf,
+              const int size );
+    int readBgzf( std::vector< char > & buf );
+    void addPoint();
+    void saveIndex();
+
+    void runReader();
+    void stopReader();
+    bool nextChunk();
+#endif
+};
+
+#ifdef HAVE_LIBZ
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief open the file for reading.
+ */
+bool
+gzfilebuf::Impl::openInput( const char * path )
+{
+    in_file_ = std::fopen( path, "rb" );
+    if ( ! in_file_ )
+    {
+        return false;
+    }
+
+    path_ = path;
+    in_buf_.resize( IN_BUF_SIZE );
+
+    std::memset( &strm_, 0, sizeof( strm_ ) );
+    if ( inflateInit2( &strm_, 15 + 16 ) != Z_OK ) // gzip only
+    {
+        std::fclose( in_file_ );
+        in_file_ = nullptr;
+        return false;
+    }
+    strm_init_ = true;
+
+    strm_.next_in = in_buf_.data();
+    strm_.avail_in = 0;
+    in_total_ = 0;
+    out_pos_ = 0;
+    raw_ = false;
+    eof_ = false;
+
+    // same as gzread, a file without the gzip header is read as is.
+    transparent_ = ! ( fillInput( 2 )
+                       && strm_.next_in[0] == 0x1f
+                       && strm_.next_in[1] == 0x8b );
+    bgzf_ = ( ! transparent_
+              && fillInput( BGZF_HEADER_SIZE )
+              && bgzf_block_size( strm_.next_in ) > 0 );
+    member_start_ = true;
+    get_end_ = 0;
+
+    // the access points are read when they are required first.
+    points_.clear();
+    index_complete_ = ( ! transparent_
+                        && load_index( indexPath(), path_, nullptr ) );
+    index_pending_ = index_complete_;
+    return true;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief release the input resources.
+ */
+void
+gzfilebuf::Impl::closeInput()
+{
+    stopReader();
+    inflate_workers_.stop();
+
+    if ( strm_init_ )
+    {
+        inflateEnd( &strm_ );
+        strm_init_ = false;
+    }
+
+    if ( in_file_ )
+    {
+        std::fclose( in_file_ );
+        in_file_ = nullptr;
+    }
+
+    std::vector< unsigned char >().swap( in_buf_ );
+    std::vector< AccessPoint >().swap( points_ );
+    std::vector< std::vector< char > >().swap( spare_ );
+    std::vector< char >().swap( current_.data_ );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief read the compressed data until at least size bytes are available.
+  \return false if the end of file is reached.
+ */
+bool
+gzfilebuf::Impl::fillInput( const unsigned int size )
+{
+    while ( strm_.avail_in < size )
+    {
+        if ( strm_.avail_in > 0
+             && strm_.next_in != in_buf_.data() )
+        {
+            std::memmove( in_buf_.data(), strm_.next_in, strm_.avail_in );
+        }
+        strm_.next_in = in_buf_.data();
+
+        const std::size_t n = std::fread( in_buf_.data() + strm_.avail_in, 1,
+                                          in_buf_.size() - strm_.avail_in, in_file_ );
+        if ( n == 0 )
+        {
+            return false;
+        }
+
+        strm_.avail_in += static_cast< uInt >( n );
+        in_total_ += static_cast< std::int64_t >( n );
+    }
+
+    return true;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief check the next gzip member after the end of the previous member.
+  \return false if no more member exists.
+ */
+bool
+gzfilebuf::Impl::startMember()
+{
+    if ( raw_ )
+    {
+        // the trailer is not consumed by the raw inflate
+        if ( ! fillInput( 8 ) )
+        {
+            return false;
+        }
+        strm_.next_in += 8;
+        strm_.avail_in -= 8;
+    }
+
+    // trailing garbage is ignored as gzread does.
+    if ( ! fillInput( 2 )
+         || strm_.next_in[0] != 0x1f
+         || strm_.next_in[1] != 0x8b )
+    {
+        return false;
+    }
+
+    raw_ = false;
+    member_start_ = true;
+    return inflateReset2( &strm_, 15 + 16 ) == Z_OK;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief restart inflating from the beginning of the file
+ */
+bool
+gzfilebuf::Impl::rewind()
+{
+    if ( seek_file( in_file_, 0 ) != 0
+         || inflateReset2( &strm_, 15 + 16 ) != Z_OK )
+    {
+        return false;
+    }
+
+    strm_.next_in = in_buf_.data();
+    strm_.avail_in = 0;
+    in_total_ = 0;
+    out_pos_ = 0;
+    raw_ = false;
+    member_start_ = true;
+    eof_ = false;
+    return true;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief restore the inflate state at the access point
+ */
+bool
+gzfilebuf::Impl::restore( const AccessPoint & point )
+{
+    const std::int64_t in = point.in_ - ( point.bits_ ? 1 : 0 );
+    if ( seek_file( in_file_, in ) != 0
+         || inflateReset2( &strm_, -15 ) != Z_OK ) // raw deflate
+    {
+        return false;
+    }
+
+    strm_.next_in = in_buf_.data();
+    strm_.avail_in = 0;
+    in_total_ = in;
+    raw_ = true;
+    member_start_ = false;
+    eof_ = false;
+
+    if ( point.bits_ )
+    {
+        if ( ! fillInput( 1 ) )
+        {
+            return false;
+        }
+        const int c = strm_.next_in[0];
+        ++strm_.next_in;
+        --strm_.avail_in;
+        if ( inflatePrime( &strm_, point.bits_, c >> ( 8 - point.bits_ ) ) != Z_OK )
+        {
+            return false;
+        }
+    }
+
+    if ( ! point.window_.empty()
+         && inflateSetDictionary( &strm_,
+                                  point.window_.data(),
+                                  static_cast< uInt >( point.window_.size() ) ) != Z_OK )
+    {
+        return false;
+    }
+
+    out_pos_ = point.out_;
+    return true;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief record the current inflate state as an access point.
+ */
+void
+gzfilebuf::Impl::addPoint()
+{
+    AccessPoint point;
+    point.out_ = out_pos_;
+    point.in_ = in_total_ - strm_.avail_in;
+    point.bits_ = strm_.data_type & 7;
+    point.window_.resize( WINDOW_SIZE );
+
+    uInt len = static_cast< uInt >( WINDOW_SIZE );
+    if ( inflateGetDictionary( &strm_, point.window_.data(), &len ) != Z_OK )
+    {
+        return;
+    }
+    point.window_.resize( len );
+
+    points_.push_back( std::move( point ) );
+}
 
-//! the implementation of file stream buffer
-struct gzfilebuf::Impl {
+/*-------------------------------------------------------------------*/
+/*!
+  \brief inflate the data.
+  \return the inflated size, 0 at the end of data, or -1 on error.
+ */
+int
+gzfilebuf::Impl::read( char * buf,
+                       const int size )
+{
+    if ( transparent_ )
+    {
+        const std::size_t n = ( strm_.avail_in > 0
+                                ? std::min( static_cast< std::size_t >( size ),
+                                            static_cast< std::size_t >( strm_.avail_in ) )
+                                : std::fread( buf, 1, size, in_file_ ) );
+        if ( strm_.avail_in > 0 )
+        {
+            // the bytes read to check the magic number
+            std::memcpy( buf, strm_.next_in, n );
+            strm_.next_in += n;
+            strm_.avail_in -= static_cast< uInt >( n );
+        }
+        out_pos_ += static_cast< std::int64_t >( n );
+        return static_cast< int >( n );
+    }
 
-    //! file open mode flag
-    std::ios_base::openmode open_mode_;
+    if ( eof_ )
+    {
+        return 0;
+    }
 
-#ifdef HAVE_LIBZ
-    //! gzip file
-    gzFile file_;
-#endif
+    strm_.next_out = reinterpret_cast< Bytef * >( buf );
+    strm_.avail_out = static_cast< uInt >( size );
+
+    while ( strm_.avail_out > 0 )
+    {
+        if ( strm_.avail_in == 0 )
+        {
+            fillInput( 1 );
+        }
+
+        // stop at the block boundary if the next access point is required.
+        // the access points are recorded only beyond the last point.
+        const bool need_point = ( ! index_complete_
+                                  && out_pos_ >= ( points_.empty()
+                                                   ? INDEX_SPAN
+                                                   : points_.back().out_ + INDEX_SPAN ) );
+
+        const uInt avail_out = strm_.avail_out;
+        member_start_ = false;
+        const int ret = inflate( &strm_, need_point ? Z_BLOCK : Z_NO_FLUSH );
+        out_pos_ += avail_out - strm_.avail_out;
+
+        if ( ret == Z_STREAM_END )
+        {
+            if ( ! startMember() )
+            {
+                eof_ = true;
+                saveIndex();
+                break;
+            }
+
+            if ( bgzf_
+                 && strm_.avail_out < static_cast< uInt >( size ) )
+            {
+                // the following blocks can be inflated in parallel
+                break;
+            }
+            continue;
+        }
+
+        if ( ret == Z_BUF_ERROR
+             && strm_.avail_in == 0 )
+        {
+            // truncated file
+            eof_ = true;
+            break;
+        }
+
+        if ( ret != Z_OK
+             && ret != Z_BUF_ERROR )
+        {
+            eof_ = true;
+            return -1;
+        }
+
+        if ( need_point
+             && ( strm_.data_type & 128 )
+             && ! ( strm_.data_type & 64 ) )
+        {
+            addPoint();
+        }
+    }
+
+    return size - static_cast< int >( strm_.avail_out );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief save the access points if they cover the whole file.
+ */
+void
+gzfilebuf::Impl::saveIndex()
+{
+    if ( ! index_complete_
+         && ! points_.empty() )
+    {
+        save_index( indexPath(), path_, points_ );
+        index_complete_ = true;
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief read the BGZF blocks and inflate them in parallel.
+  \return the inflated size, 0 at the end of data, or -1 on error.
+
+  The z_stream must be at the start of a member. It is left at the
+  start of the next member.
+ */
+int
+gzfilebuf::Impl::readBgzf( std::vector< char > & buf )
+{
+    if ( eof_ )
+    {
+        return 0;
+    }
+
+    // the members are read directly from the file
+    std::int64_t member_offset = in_total_ - strm_.avail_in;
+    if ( strm_.avail_in > 0 )
+    {
+        if ( seek_file( in_file_, member_offset ) != 0 )
+        {
+            return -1;
+        }
+        strm_.next_in = in_buf_.data();
+        strm_.avail_in = 0;
+        in_total_ = member_offset;
+    }
+
+    std::vector< unsigned char > comp;
+    std::vector< BgzfBlock > blocks;
+    std::size_t out_size = 0;
+
+    while ( out_size < READ_AHEAD_SIZE )
+    {
+        const std::size_t offset = comp.size();
+        comp.resize( offset + BGZF_HEADER_SIZE );
+
+        const std::size_t n = std::fread( comp.data() + offset, 1, BGZF_HEADER_SIZE, in_file_ );
+        const std::size_t member_size = ( n == BGZF_HEADER_SIZE
+                                          ? bgzf_block_size( comp.data() + offset )
+                                          : 0 );
+        if ( member_size < BGZF_HEADER_SIZE + GZIP_TRAILER_SIZE )
+        {
+            comp.resize( offset );
+
+            // a normal gzip member follows. read it sequentially.
+            // otherwise, the end of file or trailing garbage.
+            if ( seek_file( in_file_, member_offset ) != 0 )
+            {
+                return -1;
+            }
+            in_total_ = member_offset;
+
+            if ( blocks.empty() )
+            {
+                bgzf_ = false;
+                if ( ! fillInput( 2 )
+                     || strm_.next_in[0] != 0x1f
+                     || strm_.next_in[1] != 0x8b )
+                {
+                    eof_ = true;
+                    saveIndex();
+                    return 0;
+                }
+
+                buf.resize( READ_AHEAD_SIZE );
+                return read( buf.data(), static_cast< int >( buf.size() ) );
+            }
+            break;
+        }
+
+        comp.resize( offset + member_size );
+        if ( std::fread( comp.data() + offset + BGZF_HEADER_SIZE, 1,
+                         member_size - BGZF_HEADER_SIZE, in_file_ ) != member_size - BGZF_HEADER_SIZE )
+        {
+            return -1;
+        }
+
+        BgzfBlock block;
+        block.in_offset_ = offset;
+        block.in_size_ = member_size;
+        block.out_offset_ = out_size;
+        block.out_size_ = get_uint32( comp.data() + offset + member_size - 4 );
+        if ( block.out_size_ > 65536 ) // the limit of BGZF
+        {
+            return -1;
+        }
+
+        // the access point at the start of the deflate data
+        if ( ! index_complete_
+             && out_pos_ + static_cast< std::int64_t >( out_size )
+             >= ( points_.empty() ? INDEX_SPAN : points_.back().out_ + INDEX_SPAN ) )
+        {
+            AccessPoint point;
+            point.out_ = out_pos_ + static_cast< std::int64_t >( out_size );
+            point.in_ = member_offset + static_cast< std::int64_t >( BGZF_HEADER_SIZE );
+            point.bits_ = 0;
+            points_.push_back( std::move( point ) );
+        }
+
+        blocks.push_back( block );
+        out_size += block.out_size_;
+        member_offset += static_cast< std::int64_t >( member_size );
+        in_total_ = member_offset;
+    }
+
+    buf.resize( std::max( out_size, READ_AHEAD_SIZE ) );
+
+    if ( ! inflate_workers_.inflate( blocks, comp.data(), buf.data() ) )
+    {
+        return -1;
+    }
+
+    // the z_stream is at the start of the next member
+    raw_ = false;
+    member_start_ = true;
+    if ( inflateReset2( &strm_, 15 + 16 ) != Z_OK )
+    {
+        return -1;
+    }
+
+    if ( out_size == 0 )
+    {
+        // only the empty blocks, e.g. the BGZF end-of-file marker
+        return readBgzf( buf );
+    }
+
+    out_pos_ += static_cast< std::int64_t >( out_size );
+    return static_cast< int >( out_size );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief the reader thread. fill the read-ahead buffers.
+ */
+void
+gzfilebuf::Impl::runReader()
+{
+    while ( true )
+    {
+        std::vector< char > buf;
+        {
+            std::unique_lock< std::mutex > lock( mutex_ );
+            cond_.wait( lock, [this]() { return stop_reader_
+                                                || filled_.size() < READ_AHEAD_COUNT; } );
+            if ( stop_reader_ )
+            {
+                return;
+            }
+
+            if ( ! spare_.empty() )
+            {
+                buf.swap( spare_.back() );
+                spare_.pop_back();
+            }
+        }
+
+        int n = 0;
+        if ( bgzf_
+             && member_start_ )
+        {
+            n = readBgzf( buf );
+        }
+        else
+        {
+            buf.resize( READ_AHEAD_SIZE );
+            n = read( buf.data(), static_cast< int >( buf.size() ) );
+        }
+
+        {
+            std::lock_guard< std::mutex > lock( mutex_ );
+            if ( n > 0 )
+            {
+                Chunk chunk;
+                chunk.data_.swap( buf );
+                chunk.size_ = static_cast< std::size_t >( n );
+                chunk.end_ = out_pos_;
+                filled_.push_back( std::move( chunk ) );
+            }
+            else
+            {
+                reader_done_ = true;
+            }
+        }
+        cond_.notify_all();
+
+        if ( n <= 0 )
+        {
+            return;
+        }
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief stop the reader thread and discard the read-ahead data.
+  the inflate state is owned by the caller after this call.
+ */
+void
+gzfilebuf::Impl::stopReader()
+{
+    if ( reader_.joinable() )
+    {
+        {
+            std::lock_guard< std::mutex > lock( mutex_ );
+            stop_reader_ = true;
+        }
+        cond_.notify_all();
+        reader_.join();
+    }
+
+    stop_reader_ = false;
+    reader_done_ = false;
+
+    for ( Chunk & c : filled_ )
+    {
+        spare_.push_back( std::move( c.data_ ) );
+    }
+    filled_.clear();
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief (consumer) get the next inflated chunk into current_.
+  \return false at the end of data.
+ */
+bool
+gzfilebuf::Impl::nextChunk()
+{
+    if ( ! reader_.joinable() )
+    {
+        reader_ = std::thread( &Impl::runReader, this );
+    }
+
+    {
+        std::unique_lock< std::mutex > lock( mutex_ );
+        cond_.wait( lock, [this]() { return ! filled_.empty()
+                                            || reader_done_; } );
+        if ( filled_.empty() )
+        {
+            return false;
+        }
+
+        if ( ! current_.data_.empty() )
+        {
+            spare_.push_back( std::move( current_.data_ ) );
+        }
+        current_ = std::move( filled_.front() );
+        filled_.pop_front();
+    }
+    cond_.notify_all();
+
+    get_end_ = current_.end_;
+    return true;
+}
 
-    //! constructor
-    Impl()
-        : open_mode_( static_cast< std::ios_base::openmode >( 0 ) )
-#ifdef HAVE_LIBZ
-        , file_( nullptr )
 #endif
-      { }
-};
 
 /////////////////////////////////////////////////////////////////////
 
@@ -74,8 +1357,7 @@ struct gzfilebuf::Impl {
 gzfilebuf::gzfilebuf()
     : M_impl( new Impl ),
       M_buf_size( 8192 ),
-      M_buf( nullptr ),
-      M_remained_size( 0 )
+      M_buf( nullptr )
 {
 
 }
@@ -106,7 +1388,8 @@ gzfilebuf::is_open()
 {
 #ifdef HAVE_LIBZ
     if ( M_impl
-         && M_impl->file_ != nullptr  )
+         && ( M_impl->file_ != nullptr
+              || M_impl->in_file_ != nullptr ) )
     {
         return true;
     }
@@ -143,17 +1426,27 @@ gzfilebuf::open( const char * path,
             return ret;
         }
 
-        std::string mode_str = makeModeString( mode, level, strategy );
-        if ( mode_str.empty() )
+        if ( testi )
         {
-            return ret;
+            if ( ! M_impl->openInput( path ) )
+            {
+                return ret;
+            }
         }
+        else
+        {
+            std::string mode_str = makeModeString( mode, level, strategy );
+            if ( mode_str.empty() )
+            {
+                return ret;
+            }
 
-        M_impl->file_ = gzopen( path, mode_str.c_str() );
+            M_impl->file_ = gzopen( path, mode_str.c_str() );
 
-        if ( M_impl->file_ == nullptr )
-        {
-            return ret;
+            if ( M_impl->file_ == nullptr )
+            {
+                return ret;
+            }
         }
 
         if ( M_buf )
@@ -167,7 +1460,6 @@ gzfilebuf::open( const char * path,
         {
             // initial end point is same to start point,
             // because no data is read at first.
-            M_remained_size = 0;
             this->setg( M_buf, M_buf, M_buf );
             M_impl->open_mode_ = std::ios_base::in;
         }
@@ -202,14 +1494,14 @@ gzfilebuf::close() throw()
             return nullptr;
         }
 
-        if ( M_impl->file_ == nullptr )
+        if ( M_impl->file_ != nullptr )
         {
-            return nullptr;
+            // TODO: checking close status...
+            gzclose( M_impl->file_ );
+            M_impl->file_ = nullptr;
         }
 
-        // TODO: checking close status...
-        gzclose( M_impl->file_ );
-        M_impl->file_ = nullptr;
+        M_impl->closeInput();
         M_impl->open_mode_ = static_cast< std::ios_base::openmode >( 0 );
     }
 #endif
@@ -338,7 +1630,6 @@ gzfilebuf::destroyInternalBuffer() throw()
     {
         delete [] M_buf;
         M_buf = nullptr;
-        M_remained_size = 0;
         this->setg( nullptr, nullptr, nullptr );
         this->setp( nullptr, nullptr );
     }
@@ -390,22 +1681,17 @@ gzfilebuf::seekoff( std::streamoff off,
 #ifdef HAVE_LIBZ
     if ( M_impl->open_mode_ & std::ios_base::in )
     {
-        if ( way & std::ios_base::beg )
+        if ( way == std::ios_base::beg )
         {
-            ret = gzseek( M_impl->file_, off, SEEK_SET );
-            M_remained_size = 0;
-            this->setg( M_buf, M_buf, M_buf );
+            ret = seekInput( off );
         }
 
-        if ( way & std::ios_base::cur )
+        if ( way == std::ios_base::cur )
         {
-            ret = gzseek( M_impl->file_, off, SEEK_CUR );
-            ret -= this->egptr() - this->gptr();
-            if ( off != 0 )
-            {
-                M_remained_size = 0;
-                this->setg( M_buf, M_buf, M_buf );
-            }
+            const std::streamoff cur = M_impl->get_end_ - ( this->egptr() - this->gptr() );
+            ret = ( off == 0
+                    ? std::streampos( cur )
+                    : seekInput( cur + off ) );
         }
     }
 
@@ -453,10 +1739,7 @@ gzfilebuf::seekpos( std::streampos pos,
     if ( ( M_impl->open_mode_ & std::ios_base::in )
          && ( mode & std::ios_base::in ) )
     {
-        ret = gzseek( M_impl->file_, pos, SEEK_SET );
-        // and reset buffer pointer to initial position
-        M_remained_size = 0;
-        this->setg( M_buf, M_buf, M_buf );
+        ret = seekInput( pos );
     }
 
     if ( ( M_impl->open_mode_ & std::ios_base::out )
@@ -509,36 +1792,148 @@ std::streambuf::int_type
 gzfilebuf::underflow()
 {
 #ifdef HAVE_LIBZ
-    if ( ! is_open() || ! gptr() )
+    if ( ! is_open()
+         || ! gptr()
+         || ! M_impl->in_file_ )
     {
         return traits_type::eof();
     }
 
-    if ( M_remained_size )
+    if ( ! M_impl->transparent_ )
     {
-        M_buf[0] = M_remained_char;
+        // the data inflated by the reader thread
+        if ( ! M_impl->nextChunk() )
+        {
+            this->setg( this->eback(), this->egptr(), this->egptr() );
+            return traits_type::eof();
+        }
+
+        char_type * buf = M_impl->current_.data_.data();
+        this->setg( buf, buf, buf + M_impl->current_.size_ / sizeof( char_type ) );
+        return sgetc();
     }
 
-    int read_size = gzread( M_impl->file_,
-                            ( void* )( M_buf + M_remained_size ),
-                            M_buf_size * sizeof( char_type ) - M_remained_size );
+    const int read_size = M_impl->read( M_buf, M_buf_size * sizeof( char_type ) );
     if ( read_size <= 0 )
     {
+        this->setg( M_buf, M_buf, M_buf );
         return traits_type::eof();
     }
 
-    int total_size = read_size + M_remained_size;
-    this->setg( M_buf, M_buf, M_buf + total_size / sizeof( char_type ) );
+    this->setg( M_buf, M_buf, M_buf + read_size / sizeof( char_type ) );
+    M_impl->get_end_ = M_impl->out_pos_;
+
+    return sgetc();
+#else
+    return traits_type::eof();
+#endif
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+*/
+std::streampos
+gzfilebuf::seekInput( std::streamoff pos )
+{
+#ifdef HAVE_LIBZ
+    if ( pos < 0
+         || ! M_impl->in_file_ )
+    {
+        return -1;
+    }
+
+    Impl & impl = *M_impl;
 
-    M_remained_size = total_size % sizeof( char_type );
-    if ( M_remained_size )
+    const std::int64_t buf_begin = impl.get_end_ - ( this->egptr() - this->eback() );
+    if ( buf_begin <= pos
+         && pos <= impl.get_end_ )
     {
-        M_remained_char = M_buf[total_size / sizeof( char_type )];
+        this->setg( this->eback(), this->eback() + ( pos - buf_begin ), this->egptr() );
+        return pos;
     }
 
-    return sgetc();
+    // the inflate state is owned by this thread until the next underflow.
+    impl.stopReader();
+    this->setg( M_buf, M_buf, M_buf );
+    impl.get_end_ = impl.out_pos_;
+
+    const std::int64_t buf_end = impl.out_pos_;
+
+    if ( impl.transparent_ )
+    {
+        if ( seek_file( impl.in_file_, pos ) != 0 )
+        {
+            return -1;
+        }
+        impl.strm_.avail_in = 0;
+        impl.out_pos_ = pos;
+        impl.get_end_ = pos;
+        return pos;
+    }
+
+    if ( impl.index_pending_ )
+    {
+        impl.index_pending_ = false;
+        if ( ! load_index( impl.indexPath(), impl.path_, &impl.points_ ) )
+        {
+            impl.points_.clear();
+            impl.index_complete_ = false;
+        }
+    }
+
+    // the last access point before pos
+    std::vector< AccessPoint >::const_iterator it
+        = std::upper_bound( impl.points_.begin(), impl.points_.end(), pos,
+                            []( const std::int64_t val, const AccessPoint & p )
+                            {
+                                return val < p.out_;
+                            } );
+    const AccessPoint * point = ( it == impl.points_.begin() ? nullptr : &*( it - 1 ) );
+
+    if ( buf_end <= pos
+         && ( ! point || point->out_ <= buf_end ) )
+    {
+        // inflate forward from the current position
+    }
+    else if ( point )
+    {
+        if ( ! impl.restore( *point ) )
+        {
+            return -1;
+        }
+    }
+    else
+    {
+        if ( ! impl.rewind() )
+        {
+            return -1;
+        }
+    }
+
+    // inflate and skip the data until pos
+    while ( impl.out_pos_ < pos )
+    {
+        const std::int64_t start = impl.out_pos_;
+        const int read_size = impl.read( M_buf, M_buf_size * sizeof( char_type ) );
+        if ( read_size <= 0 )
+        {
+            this->setg( M_buf, M_buf, M_buf );
+            impl.get_end_ = impl.out_pos_;
+            return -1;
+        }
+
+        this->setg( M_buf, M_buf, M_buf + read_size );
+        impl.get_end_ = impl.out_pos_;
+        if ( impl.out_pos_ >= pos )
+        {
+            this->setg( M_buf, M_buf + ( pos - start ), M_buf + read_size );
+        }
+    }
+
+    return pos;
 #else
-    return traits_type::eof();
+    return -1;
 #endif
 }
 
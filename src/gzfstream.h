@@ -41,9 +41,23 @@
   \brief gzip file stream buffer class.
 
   This class implements basic_filebuf for gzipped files.
-  It doesn't yet support seeking (allowed by zlib but slow/limited),
-  putback and read/write access(tricky). Otherwise, it attempts
-  to be a drop-in replacement for the standard file streambuf.
+  It doesn't yet support putback and read/write access(tricky).
+  Otherwise, it attempts to be a drop-in replacement for the standard
+  file streambuf.
+
+  In the input mode, the access points (the inflate state at a deflate
+  block boundary and the preceding 32K window) are recorded every 1MB
+  of the inflated data while the file is read. A seek restarts
+  inflating from the nearest access point instead of the beginning of
+  the file. Once the whole file has been read, the access points are
+  saved to the side file ("<path>.gzidx") and they are reused when the
+  same file is opened again.
+
+  The compressed input is inflated by the read-ahead thread into a
+  small ring of 1MB buffers, so inflating overlaps with the parsing in
+  the reader's thread. If the file consists of BGZF blocks (gzip members
+  with the block size in the extra field), the blocks are inflated in
+  parallel. A seek stops the read-ahead thread.
 */
 class gzfilebuf
     : public std::streambuf {
@@ -96,11 +110,6 @@ private:
     //! pointer to the stream buffer. This is used as array.
     char_type * M_buf;
 
-    //! used in underflow
-    int M_remained_size;
-    //! used in underflow
-    char_type M_remained_char;
-
 
     //! not used
     gzfilebuf( const gzfilebuf & );
@@ -189,6 +198,16 @@ private:
      */
     void destroyInternalBuffer() throw();
 
+    /*!
+      \brief move the read position in the input mode.
+      \param pos offset in the inflated data
+      \return new position, or -1 on error.
+
+      If pos is in the current buffer, only the pointer is moved.
+      Otherwise, the data are inflated from the nearest access point.
+     */
+    std::streampos seekInput( std::streamoff pos );
+
 protected:
     //virtual
     //void imbue( const locale& loc );
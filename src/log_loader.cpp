@@ -0,0 +1,342 @@
+// -*-c++-*-
+
+/*!
+  \file log_loader.cpp
+  \brief background game log loader class Source File.
+*/
+
+/*
+ *Copyright:
+
+ Copyright (C) The RoboCup Soccer Server Maintenance Group.
+ Hidehisa AKIYAMA
+
+ This code is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 3, or (at your option)
+ any later version.
+
+ This code is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this code; see the file COPYING.	If not, write to
+ the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+
+ *EndCopyright:
+ */
+
+/////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <QTimer>
+
+#include "log_loader.h"
+
+#include "disp_holder.h"
+#include "frame_cache.h"
+#include "log_record.h"
+#include "options.h"
+
+#ifdef HAVE_LIBZ
+#include "gzfstream.h"
+#endif
+#include <rcss/rcg/parser.h>
+
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+
+namespace {
+
+//! the interval to move the parsed records to the holder
+const int TRANSFER_INTERVAL_MS = 40;
+
+//! the maximum time to move the records in one timer event, so that the GUI keeps responding
+const int TRANSFER_BUDGET_MS = 20;
+
+//! the number of records moved between the checks of the elapsed time
+const int TRANSFER_CHECK_COUNT = 256;
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief check the gzip magic number
+ */
+bool
+is_gzip_file( const QString & filepath )
+{
+    std::ifstream fin( filepath.toLatin1(), std::ios_base::in | std::ios_base::binary );
+    char magic[2] = { 0, 0 };
+
+    return fin.read( magic, 2 )
+        && static_cast< unsigned char >( magic[0] ) == 0x1f
+        && static_cast< unsigned char >( magic[1] ) == 0x8b;
+}
+
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief the data shared by the worker thread and the GUI thread.
+ */
+struct LogLoader::Impl {
+    enum State {
+        LOADING,
+        SUCCEEDED,
+        FAILED,
+    };
+
+    std::unique_ptr< std::istream > stream_;
+    rcss::rcg::Parser::Ptr parser_;
+    std::string filepath_;
+    bool gzip_;
+
+    std::unique_ptr< FrameCacheReader > cache_; //!< the cache read instead of the file
+    bool write_cache_; //!< if true, the cache file is created after parsing
+
+    LogRecordQueue queue_;
+    std::atomic< bool > canceled_;
+    std::atomic< int > state_;
+
+    std::thread thread_;
+
+    Impl()
+        : gzip_( false ),
+          write_cache_( false ),
+          canceled_( false ),
+          state_( LOADING )
+      { }
+
+    bool parse( rcss::rcg::Handler & handler )
+      {
+          // an uncompressed file is directly read by the parser.
+          // (memory-mapped and multi-threaded in case of rcg v4 or later)
+          return ( gzip_
+                   ? parser_->parse( *stream_, handler )
+                   : parser_->parse( filepath_, handler ) );
+      }
+
+    void run()
+      {
+          RecordHandler handler( queue_, canceled_ );
+
+          bool result = false;
+          if ( cache_ )
+          {
+              result = cache_->read( handler );
+          }
+          else if ( write_cache_ )
+          {
+              FrameCacheWriter writer( handler, filepath_ );
+              result = parse( writer );
+              // the cache of the canceled loading is incomplete.
+              if ( result
+                   && ! canceled_.load( std::memory_order_relaxed ) )
+              {
+                  writer.save();
+              }
+          }
+          else
+          {
+              result = parse( handler );
+          }
+
+          state_.store( result ? SUCCEEDED : FAILED, std::memory_order_release );
+      }
+};
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+LogLoader::LogLoader( QObject * parent,
+                      DispHolder & disp_holder )
+    : QObject( parent ),
+      M_disp_holder( disp_holder ),
+      M_handler( disp_holder ),
+      M_timer( new QTimer( this ) )
+{
+    connect( M_timer, SIGNAL( timeout() ),
+             this, SLOT( handleTimer() ) );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+LogLoader::~LogLoader()
+{
+    cancel();
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+bool
+LogLoader::open( const QString & filepath )
+{
+    cancel();
+
+    std::unique_ptr< Impl > impl( new Impl() );
+    impl->filepath_ = filepath.toLatin1().constData();
+
+    if ( Options::instance().frameCache() )
+    {
+        impl->cache_.reset( new FrameCacheReader( impl->filepath_ ) );
+        if ( ! impl->cache_->isValid() )
+        {
+            impl->cache_.reset();
+            impl->write_cache_ = true;
+        }
+    }
+
+    if ( ! impl->cache_ )
+    {
+        impl->gzip_ = is_gzip_file( filepath );
+
+#ifdef HAVE_LIBZ
+        impl->stream_.reset( new gzifstream( filepath.toLatin1() ) );
+#else
+        impl->stream_.reset( new std::ifstream( filepath.toLatin1() ) );
+#endif
+
+        if ( ! *impl->stream_ )
+        {
+            std::cerr << "failed to open the rcg file. [" << impl->filepath_ << "]"
+                      << std::endl;
+            return false;
+        }
+    }
+
+    if ( ! impl->cache_ )
+    {
+        impl->parser_ = rcss::rcg::Parser::create( *impl->stream_ );
+        if ( ! impl->parser_ )
+        {
+            return false;
+        }
+    }
+
+    // the current data are kept if the file cannot be read.
+    M_disp_holder.clear();
+
+    M_file_path = filepath;
+    M_elapsed_timer.start();
+
+    M_impl = std::move( impl );
+    M_impl->thread_ = std::thread( &Impl::run, M_impl.get() );
+
+    M_timer->start( TRANSFER_INTERVAL_MS );
+    return true;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+LogLoader::cancel()
+{
+    M_timer->stop();
+
+    if ( M_impl )
+    {
+        M_impl->canceled_ = true;
+        M_impl->thread_.join();
+        M_impl.reset();
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+LogLoader::handleTimer()
+{
+    if ( ! M_impl )
+    {
+        M_timer->stop();
+        return;
+    }
+
+    // the state must be read before the queue is drained,
+    // so that all records are transferred when the parser has stopped.
+    const int state = M_impl->state_.load( std::memory_order_acquire );
+
+    // the rest of the records are moved by the next timer event
+    // if the parser is ahead of the GUI thread.
+    QElapsedTimer transfer_timer;
+    transfer_timer.start();
+
+    RecordApplier applier{ M_handler };
+    bool updated = false;
+    bool drained = true;
+    int count = 0;
+    LogRecord rec;
+    while ( M_impl->queue_.pop( rec ) )
+    {
+        if ( ! std::visit( applier, rec ) )
+        {
+            std::cerr << "failed to handle the data in [" << M_impl->filepath_ << "]"
+                      << std::endl;
+            finish( false );
+            return;
+        }
+        updated = true;
+
+        if ( ++count % TRANSFER_CHECK_COUNT == 0
+             && transfer_timer.elapsed() >= TRANSFER_BUDGET_MS )
+        {
+            drained = false;
+            break;
+        }
+    }
+
+    if ( updated )
+    {
+        emit received();
+    }
+
+    if ( drained
+         && state != Impl::LOADING )
+    {
+        finish( state == Impl::SUCCEEDED );
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+LogLoader::finish( const bool result )
+{
+    cancel();
+
+    if ( result )
+    {
+        rcss::rcg::Handler & handler = M_handler;
+        handler.handleEOF();
+    }
+
+    std::cerr << "parsing elapsed " << M_elapsed_timer.elapsed() << " [ms]" << std::endl;
+
+    std::cerr << "opened rcg file [" << M_file_path.toStdString()
+              << "]. data size = "
+              << M_disp_holder.dispCont().size()
+              << std::endl;
+
+    emit finished( result );
+}
@@ -0,0 +1,119 @@
+// -*-c++-*-
+
+/*!
+  \file log_loader.h
+  \brief background game log loader class Header File.
+*/
+
+/*
+ *Copyright:
+
+ Copyright (C) The RoboCup Soccer Server Maintenance Group.
+ Hidehisa AKIYAMA
+
+ This code is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 3, or (at your option)
+ any later version.
+
+ This code is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this code; see the file COPYING.	If not, write to
+ the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+
+ *EndCopyright:
+ */
+
+/////////////////////////////////////////////////////////////////////
+
+#ifndef RCSSMONITOR_LOG_LOADER_H
+#define RCSSMONITOR_LOG_LOADER_H
+
+#include <QObject>
+#include <QString>
+#include <QElapsedTimer>
+
+#include "rcg_handler.h"
+
+#include <memory>
+
+class QTimer;
+class DispHolder;
+
+/*!
+  \class LogLoader
+  \brief parse a game log file in the worker thread.
+
+  The worker thread only parses the file and appends the parsed records
+  to the lock-free queue. The records are moved to DispHolder in the GUI
+  thread by the timer, so the loaded data can be displayed and played
+  while the rest of the file is being parsed.
+  If the frame cache option is enabled, the cache file is read instead
+  of the game log file when it is valid. Otherwise, it is created after
+  the file has been parsed.
+*/
+class LogLoader
+    : public QObject {
+
+    Q_OBJECT
+
+private:
+
+    struct Impl;
+
+    DispHolder & M_disp_holder;
+    RCGHandler M_handler; //!< the handler that applies the records to M_disp_holder
+
+    QTimer * M_timer;
+    QElapsedTimer M_elapsed_timer;
+    QString M_file_path;
+
+    std::unique_ptr< Impl > M_impl; //!< the running worker thread
+
+    // not used
+    LogLoader() = delete;
+    LogLoader( const LogLoader & ) = delete;
+    LogLoader & operator=( const LogLoader & ) = delete;
+
+public:
+
+    LogLoader( QObject * parent,
+               DispHolder & disp_holder );
+    ~LogLoader();
+
+    /*!
+      \brief clear the display data and start loading the file.
+      \param filepath game log file path
+      \return false if the file could not be opened or its format is unknown.
+     */
+    bool open( const QString & filepath );
+
+    /*!
+      \brief stop the worker thread. the loaded data are kept.
+     */
+    void cancel();
+
+    bool isLoading() const { return static_cast< bool >( M_impl ); }
+
+    const QString & filePath() const { return M_file_path; }
+
+private:
+
+    void finish( const bool result );
+
+private slots:
+
+    void handleTimer();
+
+signals:
+
+    void received();
+    void finished( bool result );
+
+};
+
+#endif
@@ -35,6 +35,7 @@
 #endif
 
 #include <QApplication>
+#include <QScreen>
 #include <QTimer>
 
 #include "disp_holder.h"
@@ -52,12 +53,27 @@ LogPlayer::LogPlayer( DispHolder & disp_holder,
     : QObject( parent ),
       M_disp_holder( disp_holder ),
       M_timer( new QTimer( this ) ),
-      M_live_mode( false )
+      M_live_mode( false ),
+      M_live_timer( new QTimer( this ) ),
+      M_live_interval( 16 )
 {
     connect( M_timer, SIGNAL( timeout() ),
              this, SLOT( handleTimer() ) );
 
     M_timer->setInterval( Options::instance().timerInterval() );
+
+    // the live view is updated at most once per display refresh.
+    const QScreen * screen = QGuiApplication::primaryScreen();
+    if ( screen
+         && screen->refreshRate() > 1.0 )
+    {
+        M_live_interval = static_cast< int >( 1000.0 / screen->refreshRate() );
+    }
+
+    M_live_timer->setSingleShot( true );
+    M_live_timer->setTimerType( Qt::PreciseTimer );
+    connect( M_live_timer, SIGNAL( timeout() ),
+             this, SLOT( handleLiveTimer() ) );
 }
 
 /*-------------------------------------------------------------------*/
@@ -82,6 +98,8 @@ LogPlayer::clear()
     }
 
     M_live_mode = false;
+    M_live_timer->stop();
+    M_live_elapsed.invalidate();
 
     M_timer->setInterval( Options::instance().timerInterval() );
 }
@@ -374,9 +392,10 @@ LogPlayer::goToIndex( int index )
 
 */
 void
-LogPlayer::goToCycle( int cycle )
+LogPlayer::goToCycle( int cycle,
+                      int stime )
 {
-    if ( M_disp_holder.setCycle( cycle ) )
+    if ( M_disp_holder.setCycle( cycle, stime ) )
     {
         M_live_mode = false;
         //M_timer->stop();
@@ -393,12 +412,18 @@ LogPlayer::goToCycle( int cycle )
 void
 LogPlayer::showLive()
 {
-    if ( M_disp_holder.setIndexLast() )
+    // all received data are already stored in the holder. only the newest
+    // data are shown, and the intermediate data are skipped if they arrive
+    // faster than the display refresh.
+    if ( ! M_live_elapsed.isValid()
+         || M_live_elapsed.elapsed() >= M_live_interval )
     {
-        M_timer->stop();
-
-        emit indexUpdated( M_disp_holder.currentIndex(), M_disp_holder.dispCont().size() );
-        //emit updated();
+        M_live_timer->stop();
+        showLiveImpl();
+    }
+    else if ( ! M_live_timer->isActive() )
+    {
+        M_live_timer->start( M_live_interval - static_cast< int >( M_live_elapsed.elapsed() ) );
     }
 
     if ( M_disp_holder.playmode() == rcss::rcg::PM_TimeOver )
@@ -417,6 +442,37 @@ LogPlayer::showLive()
 /*-------------------------------------------------------------------*/
 /*!
 
+*/
+void
+LogPlayer::handleLiveTimer()
+{
+    if ( M_live_mode )
+    {
+        showLiveImpl();
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+*/
+void
+LogPlayer::showLiveImpl()
+{
+    M_live_elapsed.start();
+
+    if ( M_disp_holder.setIndexLast() )
+    {
+        M_timer->stop();
+
+        emit indexUpdated( M_disp_holder.currentIndex(), M_disp_holder.dispCont().size() );
+        //emit updated();
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
 */
 void
 LogPlayer::setLiveMode()
@@ -442,3 +498,16 @@ LogPlayer::startTimer()
         M_timer->start( Options::instance().timerInterval() );
     }
 }
+
+/*-------------------------------------------------------------------*/
+/*!
+
+*/
+void
+LogPlayer::updateRange()
+{
+    if ( M_disp_holder.currentIndex() != DispHolder::INVALID_INDEX )
+    {
+        emit indexUpdated( M_disp_holder.currentIndex(), M_disp_holder.dispCont().size() );
+    }
+}
@@ -34,6 +34,7 @@
 #define RCSSMONITOR_LOG_PLAYER_H
 
 #include <QObject>
+#include <QElapsedTimer>
 
 class QTimer;
 
@@ -52,6 +53,13 @@ private:
 
     bool M_live_mode;
 
+    //! the timer to show the newest data at the next display refresh
+    QTimer * M_live_timer;
+    //! the elapsed time since the newest data were shown in live mode
+    QElapsedTimer M_live_elapsed;
+    //! the minimum interval [ms] between the live view updates (the display refresh period)
+    int M_live_interval;
+
     // not used
     LogPlayer() = delete;
     LogPlayer( const LogPlayer & ) = delete;
@@ -68,15 +76,23 @@ public:
 
     void startTimer();
 
+    /*!
+      \brief notify the current index and the new data size after the data are appended.
+     */
+    void updateRange();
+
 private:
 
     void stepBackwardImpl();
     void stepForwardImpl();
 
+    void showLiveImpl();
+
 
 private slots:
 
     void handleTimer();
+    void handleLiveTimer();
 
 public slots:
 
@@ -99,7 +115,8 @@ public slots:
     void goToLast();
 
     void goToIndex( int index );
-    void goToCycle( int cycle );
+    void goToCycle( int cycle,
+                    int stime = 0 );
 
     void showLive();
     void setLiveMode();
@@ -0,0 +1,246 @@
+// -*-c++-*-
+
+/*!
+  \file log_record.h
+  \brief handler records passed between threads Header File.
+*/
+
+/*
+ *Copyright:
+
+ Copyright (C) The RoboCup Soccer Server Maintenance Group.
+ Hidehisa AKIYAMA
+
+ This code is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 3, or (at your option)
+ any later version.
+
+ This code is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this code; see the file COPYING.	If not, write to
+ the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+
+ *EndCopyright:
+ */
+
+/////////////////////////////////////////////////////////////////////
+
+#ifndef RCSSMONITOR_LOG_RECORD_H
+#define RCSSMONITOR_LOG_RECORD_H
+
+#include "append_queue.h"
+
+#include <rcss/rcg/handler.h>
+#include <rcss/rcg/types.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+/*
+  The worker threads (the game log loader and the network receiver)
+  parse the data with RecordHandler, which appends each handler call to
+  LogRecordQueue. The GUI thread pops the records and passes them to its
+  own handler with RecordApplier, in the original order.
+*/
+
+struct PlayModeRecord {
+    int time_;
+    rcss::rcg::PlayMode pmode_;
+};
+
+struct TeamRecord {
+    int time_;
+    rcss::rcg::TeamT team_l_;
+    rcss::rcg::TeamT team_r_;
+};
+
+struct MsgRecord {
+    int time_;
+    int board_;
+    std::string msg_;
+};
+
+struct DrawRecord {
+    int time_;
+    rcss::rcg::drawinfo_t draw_;
+};
+
+struct TeamGraphicRecord {
+    char side_;
+    int x_;
+    int y_;
+    std::vector< std::string > xpm_data_;
+};
+
+//! one handler callback recorded by the worker thread
+typedef std::variant< std::monostate,
+                      rcss::rcg::ShowInfoT,
+                      PlayModeRecord,
+                      TeamRecord,
+                      MsgRecord,
+                      DrawRecord,
+                      std::unique_ptr< rcss::rcg::ServerParamT >,
+                      std::unique_ptr< rcss::rcg::PlayerParamT >,
+                      rcss::rcg::PlayerTypeT,
+                      TeamGraphicRecord > LogRecord;
+
+typedef AppendQueue< LogRecord > LogRecordQueue;
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief the handler used in the worker thread.
+  all handled data are appended to the queue.
+ */
+class RecordHandler
+    : public rcss::rcg::Handler {
+private:
+    LogRecordQueue & M_queue;
+    const std::atomic< bool > & M_canceled;
+
+public:
+    RecordHandler( LogRecordQueue & queue,
+                   const std::atomic< bool > & canceled )
+        : M_queue( queue ),
+          M_canceled( canceled )
+      { }
+
+    bool handleEOF() override
+      {
+          return true;
+      }
+
+    bool handleShow( const rcss::rcg::ShowInfoT & show ) override
+      {
+          M_queue.push( LogRecord( show ) );
+          return ! M_canceled.load( std::memory_order_relaxed );
+      }
+
+    bool handleMsg( const int time,
+                    const int board,
+                    const std::string & msg ) override
+      {
+          M_queue.push( LogRecord( MsgRecord{ time, board, msg } ) );
+          return ! M_canceled.load( std::memory_order_relaxed );
+      }
+
+    bool handleDraw( const int time,
+                     const rcss::rcg::drawinfo_t & draw ) override
+      {
+          M_queue.push( LogRecord( DrawRecord{ time, draw } ) );
+          return ! M_canceled.load( std::memory_order_relaxed );
+      }
+
+    bool handlePlayMode( const int time,
+                         const rcss::rcg::PlayMode pmode ) override
+      {
+          M_queue.push( LogRecord( PlayModeRecord{ time, pmode } ) );
+          return ! M_canceled.load( std::memory_order_relaxed );
+      }
+
+    bool handleTeam( const int time,
+                     const rcss::rcg::TeamT & team_l,
+                     const rcss::rcg::TeamT & team_r ) override
+      {
+          M_queue.push( LogRecord( TeamRecord{ time, team_l, team_r } ) );
+          return ! M_canceled.load( std::memory_order_relaxed );
+      }
+
+    bool handleServerParam( const rcss::rcg::ServerParamT & param ) override
+      {
+          std::unique_ptr< rcss::rcg::ServerParamT > ptr( new rcss::rcg::ServerParamT() );
+          ptr->copyFrom( param );
+          M_queue.push( LogRecord( std::move( ptr ) ) );
+          return ! M_canceled.load( std::memory_order_relaxed );
+      }
+
+    bool handlePlayerParam( const rcss::rcg::PlayerParamT & param ) override
+      {
+          std::unique_ptr< rcss::rcg::PlayerParamT > ptr( new rcss::rcg::PlayerParamT() );
+          ptr->copyFrom( param );
+          M_queue.push( LogRecord( std::move( ptr ) ) );
+          return ! M_canceled.load( std::memory_order_relaxed );
+      }
+
+    bool handlePlayerType( const rcss::rcg::PlayerTypeT & param ) override
+      {
+          M_queue.push( LogRecord( param ) );
+          return ! M_canceled.load( std::memory_order_relaxed );
+      }
+
+    bool handleTeamGraphic( const char side,
+                            const int x,
+                            const int y,
+                            const std::vector< std::string > & xpm_data ) override
+      {
+          M_queue.push( LogRecord( TeamGraphicRecord{ side, x, y, xpm_data } ) );
+          return ! M_canceled.load( std::memory_order_relaxed );
+      }
+};
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief pass the recorded data to the handler in the GUI thread.
+ */
+struct RecordApplier {
+    rcss::rcg::Handler & handler_;
+
+    bool operator()( const std::monostate & )
+      {
+          return true;
+      }
+
+    bool operator()( const rcss::rcg::ShowInfoT & show )
+      {
+          return handler_.handleShow( show );
+      }
+
+    bool operator()( const PlayModeRecord & rec )
+      {
+          return handler_.handlePlayMode( rec.time_, rec.pmode_ );
+      }
+
+    bool operator()( const TeamRecord & rec )
+      {
+          return handler_.handleTeam( rec.time_, rec.team_l_, rec.team_r_ );
+      }
+
+    bool operator()( const MsgRecord & rec )
+      {
+          return handler_.handleMsg( rec.time_, rec.board_, rec.msg_ );
+      }
+
+    bool operator()( const DrawRecord & rec )
+      {
+          return handler_.handleDraw( rec.time_, rec.draw_ );
+      }
+
+    bool operator()( const std::unique_ptr< rcss::rcg::ServerParamT > & param )
+      {
+          return handler_.handleServerParam( *param );
+      }
+
+    bool operator()( const std::unique_ptr< rcss::rcg::PlayerParamT > & param )
+      {
+          return handler_.handlePlayerParam( *param );
+      }
+
+    bool operator()( const rcss::rcg::PlayerTypeT & param )
+      {
+          return handler_.handlePlayerType( param );
+      }
+
+    bool operator()( const TeamGraphicRecord & rec )
+      {
+          return handler_.handleTeamGraphic( rec.side_, rec.x_, rec.y_, rec.xpm_data_ );
+      }
+};
+
+#endif
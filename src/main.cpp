@@ -51,6 +51,11 @@ main( int argc,
               << "Copyright (C) 2009 - 2022 RoboCup Soccer Simulator Maintenance Group.\n"
               << std::endl;
 
+#ifdef USE_GLWIDGET
+    // the canvases share the textures and the glyph caches of the OpenGL paint engine
+    QApplication::setAttribute( Qt::AA_ShareOpenGLContexts );
+#endif
+
     QApplication app( argc, argv );
     QApplication::setApplicationName( PACKAGE_NAME );
     QApplication::setApplicationVersion( VERSION );
@@ -46,19 +46,16 @@
 
 #include "config_dialog.h"
 #include "field_canvas.h"
+#include "log_loader.h"
 #include "log_player.h"
 #include "log_player_slider.h"
 #include "monitor_client.h"
+#include "monitor_relay.h"
+#include "multi_monitor_view.h"
 #include "player_type_dialog.h"
 #include "options.h"
-#include "rcg_handler.h"
 
-
-#ifdef HAVE_LIBZ
-#include "gzfstream.h"
-#endif
 #include <rcss/rcg/util.h>
-#include <rcss/rcg/parser.h>
 
 #include <string>
 #include <iostream>
@@ -97,6 +94,9 @@ MainWindow::MainWindow()
       M_config_dialog( static_cast< ConfigDialog * >( 0 ) ),
       M_field_canvas( static_cast< FieldCanvas * >( 0 ) ),
       M_monitor_client( static_cast< MonitorClient * >( 0 ) ),
+      M_monitor_relay( static_cast< MonitorRelay * >( 0 ) ),
+      M_multi_monitor_view( static_cast< MultiMonitorView * >( 0 ) ),
+      M_log_loader( new LogLoader( this, M_disp_holder ) ),
       M_log_player( new LogPlayer( M_disp_holder, this ) )
 {
     this->setWindowIcon( QIcon( QPixmap( rcss_xpm ) ) );
@@ -109,18 +109,40 @@ MainWindow::MainWindow()
     createMenus();
     createToolBars();
     createStatusBar();
-    createFieldCanvas();
+    if ( ! Options::instance().serverList().empty() )
+    {
+        createMultiMonitorView();
+    }
+    else
+    {
+        createFieldCanvas();
+
+        connect( M_field_canvas, SIGNAL( focusChanged( const QPoint & ) ),
+                 this, SLOT( setFocusPoint( const QPoint & ) ) );
+
+        if ( Options::instance().relayPort() > 0 )
+        {
+            M_monitor_relay = new MonitorRelay( this,
+                                                Options::instance().relayPort(),
+                                                Options::instance().relayTimeout() );
+            if ( ! M_monitor_relay->isOpen() )
+            {
+                delete M_monitor_relay;
+                M_monitor_relay = static_cast< MonitorRelay * >( 0 );
+            }
+        }
+    }
 
     createConfigDialog();
 
-    connect( M_field_canvas, SIGNAL( focusChanged( const QPoint & ) ),
-             this, SLOT( setFocusPoint( const QPoint & ) ) );
     // connect( M_log_player, SIGNAL( updated() ),
     //          this, SIGNAL( viewUpdated() ) );
-    connect( M_log_player, SIGNAL( indexUpdated( size_t, size_t ) ),
-             this, SIGNAL( viewUpdated() ) );
     connect( M_log_player, SIGNAL( quitRequested() ),
              this, SLOT( setQuitTimer() ) );
+    connect( M_log_loader, SIGNAL( received() ),
+             this, SLOT( receiveLogData() ) );
+    connect( M_log_loader, SIGNAL( finished( bool ) ),
+             this, SLOT( finishLogLoading( bool ) ) );
 
     this->resize( Options::instance().windowWidth() > 0
                   ? Options::instance().windowWidth()
@@ -143,6 +165,12 @@ MainWindow::MainWindow()
 MainWindow::~MainWindow()
 {
     writeSettings();
+
+    // the network thread must be stopped before the relay is deleted.
+    if ( M_monitor_client )
+    {
+        M_monitor_client->disconnect();
+    }
 }
 
 /*-------------------------------------------------------------------*/
@@ -178,7 +206,11 @@ MainWindow::init()
     toggleStatusBar( Options::instance().showStatusBar() );
 
 
-    if ( ! Options::instance().gameLogFile().empty() )
+    if ( M_multi_monitor_view )
+    {
+        connectMultiMonitor();
+    }
+    else if ( ! Options::instance().gameLogFile().empty() )
     {
         std::cerr << "open game log " << Options::instance().gameLogFile() << std::endl;
         QTimer::singleShot( 100, [this]() { openGameLogFile( QString::fromStdString( Options::instance().gameLogFile() ) ); } );
@@ -468,6 +500,21 @@ MainWindow::createActionsLogPlayer()
 
         M_log_player_go_to_last_act = act;
     }
+    {
+        QAction * act = new QAction( tr( "Go to Cycle" ), this );
+#ifdef Q_WS_MAC
+        act->setShortcut( Qt::META + Qt::Key_J );
+#else
+        act->setShortcut( Qt::CTRL + Qt::Key_J );
+#endif
+        act->setStatusTip( tr( "Jump to the input cycle. The stoppage time can be given as CYCLE.STIME.(" )
+                           + act->shortcut().toString() + tr( ")" ) );
+        connect( act, SIGNAL( triggered() ),
+                 this, SLOT( goToCycle() ) );
+        this->addAction( act );
+
+        M_log_player_go_to_cycle_act = act;
+    }
 }
 
 /*-------------------------------------------------------------------*/
@@ -668,6 +715,7 @@ MainWindow::createMenuMonitor()
     menu->addSeparator();
 
     menu->addAction( M_live_mode_act );
+    menu->addAction( M_log_player_go_to_cycle_act );
 }
 
 /*-------------------------------------------------------------------*/
@@ -896,6 +944,13 @@ MainWindow::createStatusBar()
     M_position_label->setAlignment( Qt::AlignRight );
 
     this->statusBar()->addPermanentWidget( M_position_label );
+
+    //
+
+    M_receive_label = new QLabel();
+    M_receive_label->setToolTip( tr( "received / parsed / rejected / gaps of the monitor datagrams" ) );
+
+    this->statusBar()->addPermanentWidget( M_receive_label );
 }
 
 /*-------------------------------------------------------------------*/
@@ -917,7 +972,10 @@ MainWindow::createFieldCanvas()
     M_field_canvas->setFocus();
 
     connect( this, SIGNAL( viewUpdated() ),
-             M_field_canvas, SLOT( update() ) );
+             M_field_canvas, SLOT( updateView() ) );
+    // the new frame is drawn only in the changed areas
+    connect( M_log_player, SIGNAL( indexUpdated( size_t, size_t ) ),
+             M_field_canvas, SLOT( updateFrame() ) );
 
     connect( M_field_canvas, SIGNAL( mouseMoved( const QPoint & ) ),
              this, SLOT( updatePositionLabel( const QPoint & ) ) );
@@ -977,6 +1035,29 @@ MainWindow::createFieldCanvas()
 
 }
 
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+MainWindow::createMultiMonitorView()
+{
+    M_multi_monitor_view = new MultiMonitorView();
+
+    this->setCentralWidget( M_multi_monitor_view );
+
+    connect( this, SIGNAL( viewUpdated() ),
+             M_multi_monitor_view, SLOT( updateAll() ) );
+
+    // the game log and the single connection are not available in this mode
+    M_open_act->setEnabled( false );
+    M_connect_monitor_act->setEnabled( false );
+    M_connect_monitor_to_act->setEnabled( false );
+    M_disconnect_monitor_act->setEnabled( false );
+    M_live_mode_act->setEnabled( false );
+    M_log_player_tool_bar->setEnabled( false );
+}
+
 /*-------------------------------------------------------------------*/
 /*!
 
@@ -1345,53 +1426,100 @@ MainWindow::openGameLogFile( const QString & filepath )
     M_log_player->stop();
     disconnectMonitor();
 
-    if ( ! openGameLogFileImpl( filepath ) )
+    if ( ! M_log_loader->open( filepath ) )
     {
-        QString err_msg = tr( "Failed to read [" );
-        err_msg += filepath;
-        err_msg += tr( "]" );
-        if ( Options::instance().autoQuitMode() )
-        {
-            err_msg += tr( "\nQuit the application...");
-        }
+        showOpenError( tr( "Failed to read [" ) + filepath + tr( "]" ) );
+        return;
+    }
 
-        QMessageBox::critical( this,
-                               tr( "Error" ),
-                               err_msg,
-                               QMessageBox::Ok, QMessageBox::NoButton );
-        this->setWindowTitle( tr( PACKAGE_NAME ) );
-        this->statusBar()->showMessage( tr( "Ready" ) );
+    // set window title
+    QFileInfo fileinfo( filepath );
+    QString name = fileinfo.fileName();
+    if ( name.length() > 128 )
+    {
+        name.replace( 125, name.length() - 125, tr( "..." ) );
+    }
+    this->setWindowTitle( name + tr( " - " ) + tr( PACKAGE_NAME ) );
+    this->statusBar()->showMessage( tr( "Loading %1 ..." ).arg( name ) );
+}
 
-        if ( Options::instance().autoQuitMode() )
-        {
-            QTimer::singleShot( 100, qApp, SLOT( quit() ) );
-        }
+/*-------------------------------------------------------------------*/
+/*!
 
-        return;
+ */
+void
+MainWindow::showOpenError( const QString & message )
+{
+    QString err_msg = message;
+    if ( Options::instance().autoQuitMode() )
+    {
+        err_msg += tr( "\nQuit the application...");
+    }
+
+    QMessageBox::critical( this,
+                           tr( "Error" ),
+                           err_msg,
+                           QMessageBox::Ok, QMessageBox::NoButton );
+    this->setWindowTitle( tr( PACKAGE_NAME ) );
+    this->statusBar()->showMessage( tr( "Ready" ) );
+
+    if ( Options::instance().autoQuitMode() )
+    {
+        QTimer::singleShot( 100, qApp, SLOT( quit() ) );
     }
+}
 
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+MainWindow::receiveLogData()
+{
     if ( M_disp_holder.dispCont().empty() )
     {
-        QString err_msg = tr( "Empty log file [" );
-        err_msg += filepath;
-        err_msg += tr( "]" );
-        if ( Options::instance().autoQuitMode() )
+        return;
+    }
+
+    if ( M_disp_holder.currentIndex() == DispHolder::INVALID_INDEX )
+    {
+        // the first data have arrived.
+        if ( M_config_dialog )
         {
-            err_msg += tr( "\nQuit the application...");
+            M_config_dialog->fitToScreen();
         }
 
-        QMessageBox::critical( this,
-                               tr( "Error" ),
-                               err_msg,
-                               QMessageBox::Ok, QMessageBox::NoButton );
-        this->setWindowTitle( tr( PACKAGE_NAME ) );
-        this->statusBar()->showMessage( tr( "Ready" ) );
+        M_log_player->goToFirst();
+        M_toggle_tool_bar_act->setChecked( true );
+    }
+    else
+    {
+        // extend the slider range
+        M_log_player->updateRange();
+    }
 
-        if ( Options::instance().autoQuitMode() )
-        {
-            QTimer::singleShot( 100, qApp, SLOT( quit() ) );
-        }
+    const DispStore & disp_cont = M_disp_holder.dispCont();
+    this->statusBar()->showMessage( tr( "Loading ... %1" ).arg( disp_cont.time( disp_cont.size() - 1 ) ) );
+}
 
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+MainWindow::finishLogLoading( bool result )
+{
+    const QString & filepath = M_log_loader->filePath();
+
+    if ( ! result )
+    {
+        showOpenError( tr( "Failed to read [" ) + filepath + tr( "]" ) );
+        return;
+    }
+
+    if ( M_disp_holder.dispCont().empty() )
+    {
+        showOpenError( tr( "Empty log file [" ) + filepath + tr( "]" ) );
         return;
     }
 
@@ -1406,20 +1534,15 @@ MainWindow::openGameLogFile( const QString & filepath )
         M_config_dialog->fitToScreen();
     }
 
-    // set window title
     QFileInfo fileinfo( filepath );
     QString name = fileinfo.fileName();
     if ( name.length() > 128 )
     {
         name.replace( 125, name.length() - 125, tr( "..." ) );
     }
-    this->setWindowTitle( name + tr( " - " ) + tr( PACKAGE_NAME ) );
     this->statusBar()->showMessage( name );
 
-    //M_log_player_slider->updateIndex( 0, M_disp_holder.dispCont().size() );
-    M_log_player->goToFirst();
-
-    M_toggle_tool_bar_act->setChecked( true );
+    M_log_player->updateRange();
 
     if ( Options::instance().autoQuitMode() )
     {
@@ -1429,93 +1552,6 @@ MainWindow::openGameLogFile( const QString & filepath )
     emit viewUpdated();
 }
 
-/*-------------------------------------------------------------------*/
-/*!
-
- */
-bool
-MainWindow::openGameLogFileImpl( const QString & filepath )
-{
-#ifdef HAVE_LIBZ
-    gzifstream fin( filepath.toLatin1() );
-#else
-    std::ifstream fin( filepath.toLatin1() );
-#endif
-
-    if ( ! fin )
-    {
-        std::cerr << "failed to open the rcg file. [" << filepath.toStdString() << "]"
-                  << std::endl;
-        return false;
-    }
-
-    M_disp_holder.clear();
-
-    RCGHandler handler( this, M_disp_holder );
-    // // show progress dialog
-    // QProgressDialog progress_dialog( this );
-    // progress_dialog.setWindowTitle( QObject::tr( "parsing a game log file..." ) );
-    // progress_dialog.setRange( 0, 6000 );
-    // progress_dialog.setValue( 0 );
-    // progress_dialog.setLabelText( QObject::tr( "Time: 0" ) );
-    // progress_dialog.setCancelButton( 0 ); // no cancel button
-    // progress_dialog.setMinimumDuration( 0 ); // no duration
-
-    QElapsedTimer timer;
-    timer.start();
-
-    rcss::rcg::Parser::Ptr parser = rcss::rcg::Parser::create( fin );
-    if ( ! parser
-         || ! parser->parse( fin, handler ) )
-    {
-        return false;
-    }
-    // int count = 0;
-    // while ( parser->parse( fin, M_disp_holder ) )
-    // {
-    //     ++count;
-    //     if ( count % 32 == 1 )
-    //     {
-    //         if ( ! M_disp_holder.dispCont().empty() )
-    //         {
-    //             int time = M_disp_holder.dispCont().back()->show_.time_;
-    //             if ( time > progress_dialog.maximum() )
-    //             {
-    //                 progress_dialog.setMaximum( progress_dialog.maximum() + 6000 );
-    //             }
-    //             progress_dialog.setValue( time );
-    //             progress_dialog.setLabelText( QString( "Time: %1" ).arg( time ) );
-    //         }
-    //     }
-
-    //     if ( count % 512 == 1 )
-    //     {
-    //         qApp->processEvents();
-    //         std::fprintf( stdout, "parsing... %d\r", count );
-    //         std::fflush( stdout );
-    //     }
-    // }
-
-    std::cerr << "parsing elapsed " << timer.elapsed() << " [ms]" << std::endl;
-
-    // if ( ! fin.eof() )
-    // {
-    //     std::cerr << "Failed to parse the rcg file [" << filepath.toStdString() << "]."
-    //               << std::endl;
-    //     fin.close();
-    //     return false;
-    // }
-
-    fin.close();
-
-    std::cerr << "opened rcg file [" << filepath.toStdString()
-              << "]. data size = "
-              << M_disp_holder.dispCont().size()
-              << std::endl;
-
-    return true;
-}
-
 /*-------------------------------------------------------------------*/
 /*!
 
@@ -1552,6 +1588,7 @@ MainWindow::connectMonitorTo( const char * hostname )
     }
 
     // reset all data
+    M_log_loader->cancel();
     M_disp_holder.clear();
     M_log_player->clear();
 
@@ -1567,6 +1604,11 @@ MainWindow::connectMonitorTo( const char * hostname )
 
     Options::instance().setServerHost( hostname );
 
+    if ( M_monitor_relay )
+    {
+        M_monitor_client->setRelay( M_monitor_relay );
+    }
+
 //     M_save_image_act->setEnabled( false );
 //     M_open_output_act->setEnabled( true );
 
@@ -1597,6 +1639,31 @@ MainWindow::connectMonitorTo( const char * hostname )
 
 }
 
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+MainWindow::connectMultiMonitor()
+{
+    std::vector< std::pair< std::string, int > > servers;
+    if ( ! MultiMonitorView::parse_server_list( Options::instance().serverList(),
+                                                Options::instance().serverHost(),
+                                                Options::instance().serverPort(),
+                                                servers ) )
+    {
+        std::cerr << "Illegal server list [" << Options::instance().serverList() << "]"
+                  << std::endl;
+        this->statusBar()->showMessage( tr( "Illegal server list." ), 5000 );
+        return;
+    }
+
+    M_multi_monitor_view->connectTo( servers );
+
+    this->statusBar()->showMessage( tr( "Connect to %1 servers ..." ).arg( servers.size() ),
+                                    5000 );
+}
+
 /*-------------------------------------------------------------------*/
 /*!
 
@@ -1826,6 +1893,50 @@ MainWindow::connectMonitorTo()
     }
 }
 
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+MainWindow::goToCycle()
+{
+    bool ok = true;
+    QString text = QInputDialog::getText( this,
+                                          tr( "Go to cycle" ),
+                                          tr( "Cycle (CYCLE or CYCLE.STIME): " ),
+                                          QLineEdit::Normal,
+                                          QString(),
+                                          & ok );
+    if ( ! ok
+         || text.isEmpty() )
+    {
+        return;
+    }
+
+    // the stoppage time is given after the period.
+    const QStringList values = text.trimmed().split( '.' );
+    const int cycle = values.front().toInt( &ok );
+    int stime = 0;
+    if ( ok
+         && values.size() == 2 )
+    {
+        stime = values.back().toInt( &ok );
+    }
+
+    if ( ! ok
+         || values.size() > 2
+         || cycle < 0
+         || stime < 0 )
+    {
+        QMessageBox::warning( this,
+                              tr( "Go to cycle" ),
+                              tr( "Illegal cycle: " ) + text );
+        return;
+    }
+
+    M_log_player->goToCycle( cycle, stime );
+}
+
 /*-------------------------------------------------------------------*/
 /*!
 
@@ -2425,6 +2536,20 @@ MainWindow::changePlayMode( int mode,
 void
 MainWindow::receiveMonitorPacket()
 {
+    // the counters are updated at most once a second
+    if ( M_monitor_client
+         && ( ! M_receive_label_timer.isValid()
+              || M_receive_label_timer.elapsed() >= 1000 ) )
+    {
+        const MonitorClient::Statistics stats = M_monitor_client->statistics();
+        M_receive_label->setText( tr( "recv %1 / parsed %2 / rejected %3 / gaps %4" )
+                                  .arg( stats.received_ )
+                                  .arg( stats.parsed_ )
+                                  .arg( stats.rejected_ )
+                                  .arg( stats.gaps_ ) );
+        M_receive_label_timer.start();
+    }
+
     if ( M_log_player->isLiveMode() )
     {
         M_log_player->showLive();
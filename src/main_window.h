@@ -35,6 +35,7 @@
 
 #include <QMainWindow>
 #include <QString>
+#include <QElapsedTimer>
 
 #include "disp_holder.h"
 
@@ -43,9 +44,12 @@ class QLabel;
 
 class ConfigDialog;
 class FieldCanvas;
+class LogLoader;
 class LogPlayer;
 class LogPlayerSlider;
 class MonitorClient;
+class MonitorRelay;
+class MultiMonitorView;
 class PlayerTypeDialog;
 
 class MainWindow
@@ -65,10 +69,15 @@ private:
     ConfigDialog * M_config_dialog;
     FieldCanvas * M_field_canvas;
     MonitorClient * M_monitor_client;
+    MonitorRelay * M_monitor_relay; //!< the relay server for the other monitors
+    MultiMonitorView * M_multi_monitor_view; //!< the tiled view used instead of M_field_canvas
+    LogLoader * M_log_loader;
     LogPlayer * M_log_player;
     //LogPlayerSlider * M_log_player_slider;
 
     QLabel * M_position_label;
+    QLabel * M_receive_label; //!< the datagram counters of the monitor client
+    QElapsedTimer M_receive_label_timer;
 
     // file actions
     QAction * M_open_act;
@@ -96,6 +105,7 @@ private:
     QAction * M_log_player_next_score_act;
     QAction * M_log_player_go_to_first_act;
     QAction * M_log_player_go_to_last_act;
+    QAction * M_log_player_go_to_cycle_act;
 
     // view actions
     QAction * M_toggle_menu_bar_act;
@@ -141,6 +151,7 @@ private:
     void createStatusBar();
 
     void createFieldCanvas();
+    void createMultiMonitorView();
     void createConfigDialog();
 
 protected:
@@ -156,9 +167,10 @@ protected:
 private:
 
     void openGameLogFile( const QString & filepath );
-    bool openGameLogFileImpl( const QString & filepath );
+    void showOpenError( const QString & message );
 
     void connectMonitorTo( const char * hostname );
+    void connectMultiMonitor();
 
 private slots:
 
@@ -176,6 +188,7 @@ private slots:
     void connectMonitorTo(); // open host input dialog
     void disconnectMonitor();
     void reconnectMonitor();
+    void goToCycle(); // open cycle input dialog
 
     // view menu actions slots
     void toggleMenuBar( bool checked );
@@ -203,6 +216,8 @@ private slots:
 
     //
     void receiveMonitorPacket();
+    void receiveLogData();
+    void finishLogLoading( bool result );
     void resizeCanvas( const QSize & size );
     void updatePositionLabel( const QPoint & point );
 
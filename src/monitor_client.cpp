@@ -39,17 +39,573 @@
 #include "monitor_client.h"
 
 #include "disp_holder.h"
+#include "log_record.h"
+#include "monitor_relay.h"
 #include "options.h"
 
+#include <rcss/rcg/parser_v4.h>
+#include <rcss/rcg/parser_simdjson.h>
+
+#if defined(HAVE_SYS_SOCKET_H) && defined(HAVE_POLL_H)
+#define USE_NETWORK_THREAD
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <poll.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
 #include <sstream>
 #include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <cassert>
+#include <cerrno>
+#include <cstring>
 
 
 namespace {
 const int POLL_INTERVAL_MS = 1000;
+const int MAX_PACKET_SIZE = 8192;
+
+//! the size of one receive buffer. extra bytes are reserved for the JSON parser.
+const size_t BUFFER_SIZE = MAX_PACKET_SIZE + rcss::rcg::ParserSimdJSON::PADDING;
+
+#ifdef USE_NETWORK_THREAD
+//! the timeout of poll() to check the stop request
+const int RECEIVER_TIMEOUT_MS = 100;
+#endif
+
+#ifdef HAVE_RECVMMSG
+//! the maximum number of datagrams received by one recvmmsg() call
+const int RECV_BATCH_SIZE = 32;
+#else
+const int RECV_BATCH_SIZE = 1;
+#endif
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief RecordHandler that detects the gaps of the received show data.
+ */
+class ReceiveHandler
+    : public RecordHandler {
+public:
+    //! the kind of the parameter data needed by the monitors connecting later
+    enum Header {
+        NO_HEADER,
+        SESSION_HEADER, //!< server_param, the first data of the session
+        PARAM_HEADER, //!< player_param and player_type
+        TEAM_GRAPHIC_HEADER, //!< team graphic tile
+    };
+
+private:
+    int M_last_time;
+    int M_last_stime;
+    bool M_gap; //!< true if a gap was found in the last show data
+    Header M_header; //!< the kind of the last parameter data
+
+public:
+    ReceiveHandler( LogRecordQueue & queue,
+                    const std::atomic< bool > & canceled )
+        : RecordHandler( queue, canceled ),
+          M_last_time( -1 ),
+          M_last_stime( 0 ),
+          M_gap( false ),
+          M_header( NO_HEADER )
+      { }
+
+    /*!
+      \brief get and reset the kind of the last parameter data
+     */
+    Header takeHeader()
+      {
+          const Header header = M_header;
+          M_header = NO_HEADER;
+          return header;
+      }
+
+    bool handleServerParam( const rcss::rcg::ServerParamT & param ) override
+      {
+          M_header = SESSION_HEADER;
+          return RecordHandler::handleServerParam( param );
+      }
+
+    bool handlePlayerParam( const rcss::rcg::PlayerParamT & param ) override
+      {
+          M_header = PARAM_HEADER;
+          return RecordHandler::handlePlayerParam( param );
+      }
+
+    bool handlePlayerType( const rcss::rcg::PlayerTypeT & param ) override
+      {
+          M_header = PARAM_HEADER;
+          return RecordHandler::handlePlayerType( param );
+      }
+
+    bool handleTeamGraphic( const char side,
+                            const int x,
+                            const int y,
+                            const std::vector< std::string > & xpm_data ) override
+      {
+          M_header = TEAM_GRAPHIC_HEADER;
+          return RecordHandler::handleTeamGraphic( side, x, y, xpm_data );
+      }
+
+    /*!
+      \brief get and reset the gap flag
+     */
+    bool takeGap()
+      {
+          const bool gap = M_gap;
+          M_gap = false;
+          return gap;
+      }
+
+    bool handleShow( const rcss::rcg::ShowInfoT & show ) override
+      {
+          const int time = static_cast< int >( show.time_ );
+          const int stime = static_cast< int >( show.stime_ );
+
+          // the time going back means a new game.
+          if ( M_last_time >= 0 )
+          {
+              if ( time == M_last_time )
+              {
+                  M_gap = ( stime > M_last_stime + 1 );
+              }
+              else
+              {
+                  M_gap = ( time > M_last_time + 1 );
+              }
+          }
+
+          M_last_time = time;
+          M_last_stime = stime;
+
+          return RecordHandler::handleShow( show );
+      }
+};
+
+#ifdef USE_NETWORK_THREAD
+inline
+int
+port_of( const sockaddr_storage & addr )
+{
+    if ( addr.ss_family == AF_INET )
+    {
+        return ntohs( reinterpret_cast< const sockaddr_in & >( addr ).sin_port );
+    }
+
+    if ( addr.ss_family == AF_INET6 )
+    {
+        return ntohs( reinterpret_cast< const sockaddr_in6 & >( addr ).sin6_port );
+    }
+
+    return 0;
+}
+#endif
+
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief the parsers and the data shared with the network thread.
+ */
+struct MonitorClient::Impl {
+    const int version_; //!< protocol version
+    const int fd_; //!< the socket descriptor
+    MonitorClient * const client_; //!< the owner notified by the network thread
+
+    //! the parsers reused for all received packets
+    rcss::rcg::ParserV4 sexp_parser_;
+    rcss::rcg::ParserSimdJSON json_parser_;
+
+    //! RECV_BATCH_SIZE receive buffers
+    std::vector< char > buffer_;
+
+    LogRecordQueue queue_; //!< the parsed records not yet applied
+    std::atomic< bool > stop_;
+    ReceiveHandler handler_; //!< the handler used by the receiving thread
+
+    std::atomic< bool > notified_; //!< true while handleReceive() is queued
+    std::atomic< int > received_count_; //!< the number of datagrams not yet reported
+    std::atomic< int > from_port_; //!< the source port of the last datagram
+    std::atomic< MonitorRelay * > relay_; //!< the relay server, or nullptr
+
+    // the counters written only by the receiving thread
+    std::atomic< unsigned long > received_;
+    std::atomic< unsigned long > parsed_;
+    std::atomic< unsigned long > rejected_;
+    std::atomic< unsigned long > gaps_;
+
+#if defined(USE_NETWORK_THREAD) && defined(HAVE_RECVMMSG)
+    std::vector< mmsghdr > msgs_;
+    std::vector< iovec > iovs_;
+    std::vector< sockaddr_storage > addrs_;
+#endif
+
+    Impl( const int version,
+          const int fd,
+          MonitorClient * client )
+        : version_( version ),
+          fd_( fd ),
+          client_( client ),
+          buffer_( BUFFER_SIZE * RECV_BATCH_SIZE, '\0' ),
+          stop_( false ),
+          handler_( queue_, stop_ ),
+          notified_( false ),
+          received_count_( 0 ),
+          from_port_( 0 ),
+          relay_( nullptr ),
+          received_( 0 ),
+          parsed_( 0 ),
+          rejected_( 0 ),
+          gaps_( 0 )
+      {
+#if defined(USE_NETWORK_THREAD) && defined(HAVE_RECVMMSG)
+          msgs_.resize( RECV_BATCH_SIZE );
+          iovs_.resize( RECV_BATCH_SIZE );
+          addrs_.resize( RECV_BATCH_SIZE );
+          for ( int i = 0; i < RECV_BATCH_SIZE; ++i )
+          {
+              iovs_[i].iov_base = buffer_.data() + BUFFER_SIZE * i;
+              iovs_[i].iov_len = MAX_PACKET_SIZE - 1;
+              std::memset( &msgs_[i], 0, sizeof( mmsghdr ) );
+              msgs_[i].msg_hdr.msg_iov = &iovs_[i];
+              msgs_[i].msg_hdr.msg_iovlen = 1;
+              msgs_[i].msg_hdr.msg_name = &addrs_[i];
+          }
+#endif
+      }
+
+    bool parse( char * buf,
+                const int len );
+
+    void handleDatagram( char * buf,
+                         const int len );
+
+#ifdef USE_NETWORK_THREAD
+    void receive();
+#endif
+};
+
+#ifdef USE_NETWORK_THREAD
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief the network thread shared by all connections.
+
+  The thread is started when the first connection is registered, and
+  stopped when the last one is removed. The registered list is locked
+  while the sockets are drained, so a removed connection is never
+  accessed after remove() returns.
+ */
+class MonitorClient::Receiver {
+private:
+    std::mutex M_control_mutex; //!< serializes add() and remove()
+    std::mutex M_mutex; //!< protects M_clients
+    std::vector< Impl * > M_clients;
+
+    std::atomic< bool > M_stop;
+    std::thread M_thread;
+
+    Receiver()
+        : M_stop( false )
+      { }
+
+    void run();
+
+public:
+
+    ~Receiver()
+      {
+          if ( M_thread.joinable() )
+          {
+              M_stop = true;
+              M_thread.join();
+          }
+      }
+
+    static
+    Receiver & instance()
+      {
+          static Receiver s_instance;
+          return s_instance;
+      }
+
+    void add( Impl * impl );
+    void remove( Impl * impl );
+};
+
+#endif
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief parse one datagram.
+  \param buf the received data terminated by '\0'.
+  BUFFER_SIZE bytes must be allocated.
+ */
+bool
+MonitorClient::Impl::parse( char * buf,
+                            const int len )
+{
+    if ( version_ == -1 ) // JSON
+    {
+        // the padding area after the data is kept in buffer_
+        return json_parser_.parseData( buf, len, handler_ );
+    }
+
+    if ( version_ >= 3 ) // S-Expression
+    {
+        return sexp_parser_.parseLine( -1, std::string_view( buf, len ), handler_ );
+    }
+
+    if ( version_ == 2 ) // binary format v2
+    {
+        rcss::rcg::dispinfo_t2 disp2;
+        std::memset( &disp2, 0, sizeof( disp2 ) );
+        std::memcpy( &disp2, buf, std::min( sizeof( disp2 ), static_cast< size_t >( len ) ) );
+        return handler_.handleDispInfo2( disp2 );
+    }
+
+    if ( version_ == 1 ) // binary format v1
+    {
+        rcss::rcg::dispinfo_t disp1;
+        std::memset( &disp1, 0, sizeof( disp1 ) );
+        std::memcpy( &disp1, buf, std::min( sizeof( disp1 ), static_cast< size_t >( len ) ) );
+        return handler_.handleDispInfo( disp1 );
+    }
+
+    return false;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief parse one datagram and update the counters.
+  \param buf the received data. BUFFER_SIZE bytes must be allocated.
+ */
+void
+MonitorClient::Impl::handleDatagram( char * buf,
+                                     const int len )
+{
+    received_.fetch_add( 1, std::memory_order_relaxed );
+
+    if ( len <= 0 )
+    {
+        rejected_.fetch_add( 1, std::memory_order_relaxed );
+        return;
+    }
+
+    // forward the datagram before parsing it
+    MonitorRelay * relay = relay_.load( std::memory_order_acquire );
+    if ( relay )
+    {
+        relay->relay( buf, len );
+    }
+
+    buf[len] = '\0';
+    const bool result = parse( buf, len );
+    const ReceiveHandler::Header header = handler_.takeHeader();
+    if ( result )
+    {
+        parsed_.fetch_add( 1, std::memory_order_relaxed );
+
+        if ( relay
+             && header != ReceiveHandler::NO_HEADER )
+        {
+            relay->addHeader( buf, len,
+                              ( header == ReceiveHandler::SESSION_HEADER
+                                ? MonitorRelay::SESSION_HEADER
+                                : header == ReceiveHandler::TEAM_GRAPHIC_HEADER
+                                ? MonitorRelay::TEAM_GRAPHIC_HEADER
+                                : MonitorRelay::PARAM_HEADER ) );
+        }
+    }
+    else
+    {
+        rejected_.fetch_add( 1, std::memory_order_relaxed );
+        if ( ! stop_.load( std::memory_order_relaxed ) )
+        {
+            std::cerr << "recv: " << buf << std::endl;
+        }
+    }
+
+    if ( handler_.takeGap() )
+    {
+        gaps_.fetch_add( 1, std::memory_order_relaxed );
+    }
+}
+
+#ifdef USE_NETWORK_THREAD
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief (network thread) receive all pending datagrams and append
+  the parsed records to the queue.
+ */
+void
+MonitorClient::Impl::receive()
+{
+    int count = 0;
+#ifdef HAVE_RECVMMSG
+    while ( true )
+    {
+        for ( int i = 0; i < RECV_BATCH_SIZE; ++i )
+        {
+            msgs_[i].msg_hdr.msg_namelen = sizeof( sockaddr_storage );
+        }
+
+        const int n = ::recvmmsg( fd_, msgs_.data(), RECV_BATCH_SIZE, MSG_DONTWAIT, nullptr );
+        if ( n <= 0 )
+        {
+            break;
+        }
+
+        for ( int i = 0; i < n; ++i )
+        {
+            handleDatagram( buffer_.data() + BUFFER_SIZE * i,
+                            static_cast< int >( msgs_[i].msg_len ) );
+        }
+        from_port_.store( port_of( addrs_[n - 1] ), std::memory_order_relaxed );
+
+        count += n;
+        if ( n < RECV_BATCH_SIZE )
+        {
+            break;
+        }
+    }
+#else
+    while ( true )
+    {
+        sockaddr_storage addr;
+        socklen_t addr_len = sizeof( addr );
+        const ssize_t n = ::recvfrom( fd_, buffer_.data(), MAX_PACKET_SIZE - 1, MSG_DONTWAIT,
+                                      reinterpret_cast< sockaddr * >( &addr ), &addr_len );
+        if ( n < 0 )
+        {
+            break;
+        }
+
+        handleDatagram( buffer_.data(), static_cast< int >( n ) );
+        from_port_.store( port_of( addr ), std::memory_order_relaxed );
+        ++count;
+    }
+#endif
+
+    if ( count > 0 )
+    {
+        received_count_.fetch_add( count );
+        // post only one event until the GUI thread handles it.
+        if ( ! notified_.exchange( true ) )
+        {
+            QMetaObject::invokeMethod( client_, "handleReceive", Qt::QueuedConnection );
+        }
+    }
 }
 
+/*-------------------------------------------------------------------*/
+/*!
+  \brief register the connection. the thread is started if needed.
+ */
+void
+MonitorClient::Receiver::add( Impl * impl )
+{
+    std::lock_guard< std::mutex > control_lock( M_control_mutex );
+
+    {
+        std::lock_guard< std::mutex > lock( M_mutex );
+        M_clients.push_back( impl );
+    }
+
+    if ( ! M_thread.joinable() )
+    {
+        M_stop = false;
+        M_thread = std::thread( &Receiver::run, this );
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief unregister the connection. the thread is stopped if no
+  connection remains.
+ */
+void
+MonitorClient::Receiver::remove( Impl * impl )
+{
+    std::lock_guard< std::mutex > control_lock( M_control_mutex );
+
+    bool empty = false;
+    {
+        std::lock_guard< std::mutex > lock( M_mutex );
+        M_clients.erase( std::remove( M_clients.begin(), M_clients.end(), impl ),
+                         M_clients.end() );
+        empty = M_clients.empty();
+    }
+
+    if ( empty
+         && M_thread.joinable() )
+    {
+        M_stop = true;
+        M_thread.join();
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief the network thread. wait for the datagrams on all registered
+  sockets, and drain the readable ones.
+ */
+void
+MonitorClient::Receiver::run()
+{
+    std::vector< Impl * > targets;
+    std::vector< pollfd > fds;
+
+    while ( ! M_stop.load( std::memory_order_relaxed ) )
+    {
+        {
+            std::lock_guard< std::mutex > lock( M_mutex );
+            targets = M_clients;
+
+            fds.resize( targets.size() );
+            for ( size_t i = 0; i < targets.size(); ++i )
+            {
+                fds[i].fd = targets[i]->fd_;
+                fds[i].events = POLLIN;
+                fds[i].revents = 0;
+            }
+        }
+
+        const int ret = ::poll( fds.data(), fds.size(), RECEIVER_TIMEOUT_MS );
+        if ( ret < 0
+             && errno != EINTR )
+        {
+            std::cerr << "MonitorClient. poll() failed. " << std::strerror( errno )
+                      << std::endl;
+            break;
+        }
+
+        if ( ret <= 0 )
+        {
+            continue;
+        }
+
+        std::lock_guard< std::mutex > lock( M_mutex );
+        for ( size_t i = 0; i < targets.size(); ++i )
+        {
+            // skip the connections removed while polling
+            if ( ( fds[i].revents & POLLIN )
+                 && std::find( M_clients.begin(), M_clients.end(), targets[i] ) != M_clients.end() )
+            {
+                targets[i]->receive();
+            }
+        }
+    }
+}
+
+#endif
+
 /*-------------------------------------------------------------------*/
 /*!
 
@@ -67,6 +623,7 @@ MonitorClient::MonitorClient( QObject * parent,
     , M_timer( new QTimer( this ) )
     , M_version( version )
     , M_waited_msec( 0 )
+    , M_handler( disp_holder )
 {
     assert( parent );
 
@@ -109,11 +666,22 @@ MonitorClient::MonitorClient( QObject * parent,
         return;
     }
 
-    // setReadBufferSize() makes no effect for QUdpSocet...
-    // M_socket->setReadBufferSize( 8192 * 256 );
+    // setReadBufferSize() makes no effect for QUdpSocet.
+    // the kernel buffer (SO_RCVBUF) is enlarged instead.
+    if ( Options::instance().receiveBufferSize() > 0 )
+    {
+        const int size = Options::instance().receiveBufferSize() * 1024;
+        M_socket->setSocketOption( QAbstractSocket::ReceiveBufferSizeSocketOption, size );
 
-    connect( M_socket, SIGNAL( readyRead() ),
-             this, SLOT( handleReceive() ) );
+        const int actual = M_socket->socketOption( QAbstractSocket::ReceiveBufferSizeSocketOption ).toInt();
+        if ( actual < size )
+        {
+            std::cerr << "MonitorClient. the receive buffer size is limited to "
+                      << actual << " bytes by the system." << std::endl;
+        }
+    }
+
+    startReceiver();
 
     connect( M_timer, SIGNAL( timeout() ),
              this, SLOT( handleTimer() ) );
@@ -143,6 +711,9 @@ MonitorClient::disconnect()
         M_timer->stop();
     }
 
+    // the network thread must be stopped before the socket is closed.
+    stopReceiver();
+
     if ( isConnected() )
     {
         sendDispBye();
@@ -153,6 +724,76 @@ MonitorClient::disconnect()
 /*-------------------------------------------------------------------*/
 /*!
 
+*/
+MonitorClient::Statistics
+MonitorClient::statistics() const
+{
+    Statistics stats = { 0, 0, 0, 0 };
+    if ( M_impl )
+    {
+        stats.received_ = M_impl->received_.load( std::memory_order_relaxed );
+        stats.parsed_ = M_impl->parsed_.load( std::memory_order_relaxed );
+        stats.rejected_ = M_impl->rejected_.load( std::memory_order_relaxed );
+        stats.gaps_ = M_impl->gaps_.load( std::memory_order_relaxed );
+    }
+    return stats;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+*/
+void
+MonitorClient::setRelay( MonitorRelay * relay )
+{
+    if ( M_impl )
+    {
+        M_impl->relay_.store( relay, std::memory_order_release );
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+*/
+void
+MonitorClient::startReceiver()
+{
+    M_impl.reset( new Impl( M_version,
+                            static_cast< int >( M_socket->socketDescriptor() ),
+                            this ) );
+
+#ifdef USE_NETWORK_THREAD
+    // QUdpSocket is used only to send the commands. Because nobody reads
+    // the datagrams through QUdpSocket, its read notification is disabled
+    // after the first readyRead().
+    Receiver::instance().add( M_impl.get() );
+#else
+    connect( M_socket, SIGNAL( readyRead() ),
+             this, SLOT( handleReceive() ) );
+#endif
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+*/
+void
+MonitorClient::stopReceiver()
+{
+#ifdef USE_NETWORK_THREAD
+    if ( M_impl
+         && ! M_impl->stop_ )
+    {
+        M_impl->stop_ = true;
+        Receiver::instance().remove( M_impl.get() );
+    }
+#endif
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
 */
 bool
 MonitorClient::isConnected() const
@@ -167,134 +808,64 @@ MonitorClient::isConnected() const
 void
 MonitorClient::handleReceive()
 {
+    if ( ! M_impl )
+    {
+        return;
+    }
+
     int receive_count = 0;
 
-    if ( M_version == -1 ) // JSON
+#ifdef USE_NETWORK_THREAD
     {
-        char buf[8192];
-        while ( M_socket->hasPendingDatagrams() )
+        // the datagrams received by the network thread
+        M_impl->notified_.exchange( false );
+        receive_count = M_impl->received_count_.exchange( 0 );
+
+        const int from_port = M_impl->from_port_.load( std::memory_order_relaxed );
+        if ( from_port != 0
+             && from_port != M_server_port )
         {
-            quint16 from_port;
-            int n = M_socket->readDatagram( buf,
-                                            8192,
-                                            0, // QHostAddress*
-                                            &from_port );
-            if ( n > 0 )
-            {
-                buf[n] = '\0';
-                if ( ! M_disp_holder.addJSON( buf ) )
-                {
-                    std::cerr << "recv: " << buf << std::endl;
-                }
-
-                if ( from_port != M_server_port )
-                {
-                    std::cerr << "updated server port number = "
-                              << from_port
-                        //<< "  localPort = "
-                        //<< M_socket->localPort()
-                              << std::endl;
-
-                    M_server_port = from_port;
-                }
-            }
-            ++receive_count;
+            std::cerr << "updated server port number = "
+                      << from_port
+                      << std::endl;
+
+            M_server_port = static_cast< quint16 >( from_port );
         }
     }
-    else if ( M_version >= 3 ) // S-Expression
+#else
     {
-        char buf[8192];
+        char * buf = M_impl->buffer_.data();
         while ( M_socket->hasPendingDatagrams() )
         {
             quint16 from_port;
             int n = M_socket->readDatagram( buf,
-                                            8192,
-                                            0, // QHostAddress*
-                                            &from_port );
-            if ( n > 0 )
-            {
-                buf[n] = '\0';
-                if ( ! M_disp_holder.addDispInfoV3( buf ) )
-                {
-                    std::cerr << "recv: " << buf << std::endl;
-                }
-
-                if ( from_port != M_server_port )
-                {
-                    std::cerr << "updated server port number = "
-                              << from_port
-                        //<< "  localPort = "
-                        //<< M_socket->localPort()
-                              << std::endl;
-
-                    M_server_port = from_port;
-                }
-            }
-            ++receive_count;
-        }
-    }
-    else if ( M_version == 2 ) // binary format v2
-    {
-        rcss::rcg::dispinfo_t2 disp2;
-        while ( M_socket->hasPendingDatagrams() )
-        {
-            quint16 from_port;
-            int n = M_socket->readDatagram( reinterpret_cast< char * >( &disp2 ),
-                                            sizeof( disp2 ),
+                                            MAX_PACKET_SIZE - 1,
                                             0, // QHostAddress*
                                             &from_port );
-            if ( n > 0 )
+            M_impl->handleDatagram( buf, n );
+
+            if ( n > 0
+                 && from_port != M_server_port )
             {
-                if ( ! M_disp_holder.addDispInfoV2( disp2 ) )
-                {
-                    std::cerr << "recv: "
-                              << reinterpret_cast< char * >( &disp2 )
-                              << std::endl;
-                }
-
-                if ( from_port != M_server_port )
-                {
-                    std::cerr << "updated server port number = "
-                              << from_port
-                        //<< "  localPort = "
-                        //<< M_socket->localPort()
-                              << std::endl;
-
-                    M_server_port = from_port;
-                }
+                std::cerr << "updated server port number = "
+                          << from_port
+                    //<< "  localPort = "
+                    //<< M_socket->localPort()
+                          << std::endl;
+
+                M_server_port = from_port;
             }
             ++receive_count;
         }
     }
-    else if ( M_version == 1 ) // binary format v1
+#endif
+
+    // apply the parsed records to the holder
+    RecordApplier applier{ M_handler };
+    LogRecord rec;
+    while ( M_impl->queue_.pop( rec ) )
     {
-        rcss::rcg::dispinfo_t disp1;
-        while ( M_socket->hasPendingDatagrams() )
-        {
-            quint16 from_port;
-            int n =  M_socket->readDatagram( reinterpret_cast< char * >( &disp1 ),
-                                             sizeof( disp1 ),
-                                             0, // QHostAddress*
-                                             &from_port );
-            if ( n > 0 )
-            {
-                if ( ! M_disp_holder.addDispInfoV1( disp1 ) )
-                {
-                    std::cerr << "recv: "
-                              << reinterpret_cast< char * >( &disp1 )
-                              << std::endl;
-                }
-
-                if ( from_port != M_server_port )
-                {
-                    std::cerr << "updated port number = "
-                              << from_port << std::endl;
-
-                    M_server_port = from_port;
-                }
-            }
-            ++receive_count;
-        }
+        std::visit( applier, rec );
     }
 
     if ( receive_count > 0 )
@@ -38,18 +38,49 @@
 
 #include <rcss/rcg/types.h>
 
+#include "rcg_handler.h"
+
+#include <memory>
+
 class QHostInfo;
 class QTimer;
 class QUdpSocket;
 class DispHolder;
+class MonitorRelay;
 
+/*!
+  \class MonitorClient
+  \brief the monitor connection to rcssserver.
+
+  On POSIX systems, the datagrams are received and parsed by the
+  network thread, which drains the sockets in batches (recvmmsg() if
+  available). Only one network thread is shared by all connections.
+  The parsed records are handed to the GUI thread through the
+  lock-free queue, and applied to DispHolder in handleReceive().
+  Otherwise, the datagrams are received and parsed in the GUI thread.
+*/
 class MonitorClient
     : public QObject {
 
     Q_OBJECT
 
+public:
+
+    /*!
+      \brief the numbers of the datagrams since the connection
+     */
+    struct Statistics {
+        unsigned long received_; //!< received datagrams
+        unsigned long parsed_; //!< successfully parsed datagrams
+        unsigned long rejected_; //!< datagrams that could not be parsed
+        unsigned long gaps_; //!< show data whose time is not consecutive to the previous one
+    };
+
 private:
 
+    struct Impl;
+    class Receiver;
+
     DispHolder & M_disp_holder;
 
     QHostAddress M_server_addr;
@@ -61,6 +92,11 @@ private:
 
     int M_waited_msec;
 
+    //! the handler that applies the received data to M_disp_holder
+    RCGHandler M_handler;
+
+    //! the parsers and the network thread
+    std::unique_ptr< Impl > M_impl;
 
     //! not used
     MonitorClient() = delete;
@@ -80,10 +116,25 @@ public:
 
     bool isConnected() const;
 
+    /*!
+      \brief get the datagram counters. they are updated by the receiving thread.
+     */
+    Statistics statistics() const;
+
+    /*!
+      \brief set the relay server to which the received datagrams are forwarded.
+      \param relay the relay server. it must not be deleted before this
+      client is disconnected. nullptr stops forwarding.
+     */
+    void setRelay( MonitorRelay * relay );
+
 private:
 
     void sendCommand( const std::string & com );
 
+    void startReceiver();
+    void stopReceiver();
+
 public:
 
     // monitor command
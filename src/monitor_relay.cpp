@@ -0,0 +1,472 @@
+// -*-c++-*-
+
+/*!
+  \file monitor_relay.cpp
+  \brief monitor packet relay server Source File.
+*/
+
+/*
+ *Copyright:
+
+ Copyright (C) The RoboCup Soccer Server Maintenance Group.
+ Hidehisa AKIYAMA
+
+ This code is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 3, or (at your option)
+ any later version.
+
+ This code is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this code; see the file COPYING.  If not, write to
+ the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+
+ *EndCopyright:
+ */
+
+/////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <QtNetwork>
+#include <QElapsedTimer>
+#include <QTimer>
+
+#include "monitor_relay.h"
+
+#include "team_graphic.h"
+
+#ifdef HAVE_SYS_SOCKET_H
+#define USE_SOCKET_API
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif
+
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+#include <vector>
+#include <cstring>
+
+namespace {
+
+const int MAX_COMMAND_SIZE = 512;
+
+//! the maximum number of the kept server_param, player_param and player_type datagrams
+const std::size_t MAX_PARAM_HEADERS = 64;
+
+//! the maximum number of the kept team graphic datagrams, all tiles of both teams
+const std::size_t MAX_TEAM_GRAPHIC_HEADERS = 2
+    * ( TeamGraphic::MAX_WIDTH / TeamGraphic::TILE_SIZE )
+    * ( TeamGraphic::MAX_HEIGHT / TeamGraphic::TILE_SIZE );
+
+//! the interval to check the idle subscribers
+const int IDLE_CHECK_INTERVAL_MS = 1000;
+
+#ifdef USE_SOCKET_API
+#ifdef HAVE_SENDMMSG
+typedef mmsghdr SendRequest;
+inline msghdr & header_of( SendRequest & req ) { return req.msg_hdr; }
+#else
+typedef msghdr SendRequest;
+inline msghdr & header_of( SendRequest & req ) { return req; }
+#endif
+#endif
+
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief the data shared with the network thread.
+ */
+struct MonitorRelay::Impl {
+
+    /*!
+      \brief the address of the downstream monitor
+     */
+    struct Subscriber {
+        QHostAddress addr_;
+        quint16 port_;
+        qint64 last_received_; //!< the time of the last command from this monitor [ms]
+#ifdef USE_SOCKET_API
+        sockaddr_in sockaddr_;
+#endif
+    };
+
+    QUdpSocket * socket_; //!< the relay socket
+    int fd_; //!< the relay socket descriptor
+
+    mutable std::mutex mutex_;
+    std::vector< Subscriber > subscribers_;
+    std::vector< std::vector< char > > params_; //!< the parameter datagrams
+    std::vector< std::vector< char > > team_graphics_; //!< the team graphic datagrams
+
+    QElapsedTimer clock_; //!< the clock of the last received time
+
+#ifdef USE_SOCKET_API
+    std::vector< SendRequest > requests_; //!< reused send requests
+#endif
+
+    explicit
+    Impl( QUdpSocket * socket )
+        : socket_( socket ),
+          fd_( -1 )
+      {
+          clock_.start();
+      }
+
+    void send( const char * buf,
+               const int len,
+               const Subscriber * first,
+               const Subscriber * last );
+};
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief send one datagram to the subscribers. mutex_ must be locked.
+ */
+void
+MonitorRelay::Impl::send( const char * buf,
+                          const int len,
+                          const Subscriber * first,
+                          const Subscriber * last )
+{
+#ifdef USE_SOCKET_API
+    // all requests share one iovec pointing to the received data.
+    iovec iov;
+    iov.iov_base = const_cast< char * >( buf );
+    iov.iov_len = static_cast< size_t >( len );
+
+    const std::size_t n = last - first;
+    requests_.resize( n );
+    for ( std::size_t i = 0; i < n; ++i )
+    {
+        std::memset( &requests_[i], 0, sizeof( SendRequest ) );
+        msghdr & hdr = header_of( requests_[i] );
+        hdr.msg_name = const_cast< sockaddr_in * >( &first[i].sockaddr_ );
+        hdr.msg_namelen = sizeof( sockaddr_in );
+        hdr.msg_iov = &iov;
+        hdr.msg_iovlen = 1;
+    }
+
+#ifdef HAVE_SENDMMSG
+    std::size_t sent = 0;
+    while ( sent < n )
+    {
+        const int ret = ::sendmmsg( fd_, requests_.data() + sent,
+                                    static_cast< unsigned int >( n - sent ), MSG_DONTWAIT );
+        if ( ret <= 0 )
+        {
+            // the rest is dropped, as rcssserver does when the buffer is full.
+            break;
+        }
+        sent += ret;
+    }
+#else
+    for ( std::size_t i = 0; i < n; ++i )
+    {
+        ::sendmsg( fd_, &requests_[i], MSG_DONTWAIT );
+    }
+#endif
+#else
+    // without the socket API, MonitorClient calls relay() only in the GUI thread.
+    for ( const Subscriber * s = first; s != last; ++s )
+    {
+        socket_->writeDatagram( buf, len, s->addr_, s->port_ );
+    }
+#endif
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+MonitorRelay::MonitorRelay( QObject * parent,
+                            const int port,
+                            const int idle_timeout )
+    : QObject( parent ),
+      M_socket( new QUdpSocket( this ) ),
+      M_idle_timer( new QTimer( this ) ),
+      M_idle_timeout( std::max( 0, idle_timeout ) * qint64( 1000 ) ),
+      M_impl( new Impl( M_socket ) )
+{
+    // the subscribers are kept as IPv4 addresses.
+    if ( ! M_socket->bind( QHostAddress::AnyIPv4, static_cast< quint16 >( port ) ) )
+    {
+        std::cerr << "MonitorRelay. failed to bind the relay port " << port << ". "
+                  << M_socket->errorString().toStdString() << std::endl;
+        return;
+    }
+
+    M_impl->fd_ = static_cast< int >( M_socket->socketDescriptor() );
+
+    connect( M_socket, SIGNAL( readyRead() ),
+             this, SLOT( handleReceive() ) );
+
+    if ( M_idle_timeout > 0 )
+    {
+        connect( M_idle_timer, SIGNAL( timeout() ),
+                 this, SLOT( removeIdleSubscribers() ) );
+        M_idle_timer->start( IDLE_CHECK_INTERVAL_MS );
+    }
+
+    std::cerr << "MonitorRelay. waiting for the monitors on port " << port << std::endl;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+MonitorRelay::~MonitorRelay()
+{
+
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+bool
+MonitorRelay::isOpen() const
+{
+    return ( M_impl->fd_ != -1 );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+std::size_t
+MonitorRelay::subscriberCount() const
+{
+    std::lock_guard< std::mutex > lock( M_impl->mutex_ );
+    return M_impl->subscribers_.size();
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+MonitorRelay::relay( const char * buf,
+                     const int len )
+{
+    if ( len <= 0 )
+    {
+        return;
+    }
+
+    std::lock_guard< std::mutex > lock( M_impl->mutex_ );
+
+    if ( ! M_impl->subscribers_.empty() )
+    {
+        M_impl->send( buf, len,
+                      M_impl->subscribers_.data(),
+                      M_impl->subscribers_.data() + M_impl->subscribers_.size() );
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+MonitorRelay::addHeader( const char * buf,
+                         const int len,
+                         const HeaderType type )
+{
+    if ( len <= 0 )
+    {
+        return;
+    }
+
+    std::lock_guard< std::mutex > lock( M_impl->mutex_ );
+
+    if ( type == SESSION_HEADER )
+    {
+        M_impl->params_.clear();
+        M_impl->team_graphics_.clear();
+    }
+
+    // the team graphics are kept separately not to drop the parameters.
+    std::vector< std::vector< char > > & headers = ( type == TEAM_GRAPHIC_HEADER
+                                                     ? M_impl->team_graphics_
+                                                     : M_impl->params_ );
+    const std::size_t max_size = ( type == TEAM_GRAPHIC_HEADER
+                                   ? MAX_TEAM_GRAPHIC_HEADERS
+                                   : MAX_PARAM_HEADERS );
+    if ( headers.size() < max_size )
+    {
+        headers.emplace_back( buf, buf + len );
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+MonitorRelay::addSubscriber( const QHostAddress & addr,
+                             const quint16 port )
+{
+    std::lock_guard< std::mutex > lock( M_impl->mutex_ );
+
+    Impl::Subscriber s;
+    s.addr_ = addr;
+    s.port_ = port;
+    s.last_received_ = M_impl->clock_.elapsed();
+#ifdef USE_SOCKET_API
+    std::memset( &s.sockaddr_, 0, sizeof( sockaddr_in ) );
+    s.sockaddr_.sin_family = AF_INET;
+    s.sockaddr_.sin_addr.s_addr = htonl( addr.toIPv4Address() );
+    s.sockaddr_.sin_port = htons( port );
+#endif
+
+    std::vector< Impl::Subscriber >::iterator it
+        = std::find_if( M_impl->subscribers_.begin(), M_impl->subscribers_.end(),
+                        [&]( const Impl::Subscriber & v )
+                        {
+                            return v.addr_ == addr && v.port_ == port;
+                        } );
+    if ( it != M_impl->subscribers_.end() )
+    {
+        it->last_received_ = s.last_received_;
+    }
+    else
+    {
+        M_impl->subscribers_.push_back( s );
+        std::cerr << "MonitorRelay. new monitor " << addr.toString().toStdString() << ":" << port
+                  << " (" << M_impl->subscribers_.size() << " monitors)" << std::endl;
+    }
+
+    // the new monitor needs the parameters sent at the beginning
+    for ( const std::vector< char > & h : M_impl->params_ )
+    {
+        M_impl->send( h.data(), static_cast< int >( h.size() ), &s, &s + 1 );
+    }
+    for ( const std::vector< char > & h : M_impl->team_graphics_ )
+    {
+        M_impl->send( h.data(), static_cast< int >( h.size() ), &s, &s + 1 );
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+MonitorRelay::removeSubscriber( const QHostAddress & addr,
+                                const quint16 port )
+{
+    std::lock_guard< std::mutex > lock( M_impl->mutex_ );
+
+    std::vector< Impl::Subscriber >::iterator it
+        = std::remove_if( M_impl->subscribers_.begin(), M_impl->subscribers_.end(),
+                          [&]( const Impl::Subscriber & v )
+                          {
+                              return v.addr_ == addr && v.port_ == port;
+                          } );
+    if ( it != M_impl->subscribers_.end() )
+    {
+        M_impl->subscribers_.erase( it, M_impl->subscribers_.end() );
+        std::cerr << "MonitorRelay. monitor left " << addr.toString().toStdString() << ":" << port
+                  << " (" << M_impl->subscribers_.size() << " monitors)" << std::endl;
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+MonitorRelay::touchSubscriber( const QHostAddress & addr,
+                               const quint16 port )
+{
+    std::lock_guard< std::mutex > lock( M_impl->mutex_ );
+
+    for ( Impl::Subscriber & s : M_impl->subscribers_ )
+    {
+        if ( s.addr_ == addr && s.port_ == port )
+        {
+            s.last_received_ = M_impl->clock_.elapsed();
+            break;
+        }
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+MonitorRelay::removeIdleSubscribers()
+{
+    std::lock_guard< std::mutex > lock( M_impl->mutex_ );
+
+    const qint64 now = M_impl->clock_.elapsed();
+    const qint64 timeout = M_idle_timeout;
+
+    std::vector< Impl::Subscriber >::iterator it
+        = std::remove_if( M_impl->subscribers_.begin(), M_impl->subscribers_.end(),
+                          [now, timeout]( const Impl::Subscriber & v )
+                          {
+                              return now - v.last_received_ > timeout;
+                          } );
+    if ( it == M_impl->subscribers_.end() )
+    {
+        return;
+    }
+
+    const std::size_t remaining = it - M_impl->subscribers_.begin();
+    for ( ; it != M_impl->subscribers_.end(); ++it )
+    {
+        std::cerr << "MonitorRelay. monitor timed out " << it->addr_.toString().toStdString() << ":" << it->port_
+                  << " (" << remaining << " monitors)" << std::endl;
+    }
+    M_impl->subscribers_.resize( remaining );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+MonitorRelay::handleReceive()
+{
+    char buf[MAX_COMMAND_SIZE];
+
+    while ( M_socket->hasPendingDatagrams() )
+    {
+        QHostAddress addr;
+        quint16 port = 0;
+        const qint64 n = M_socket->readDatagram( buf, MAX_COMMAND_SIZE - 1, &addr, &port );
+        if ( n <= 0 )
+        {
+            continue;
+        }
+        buf[n] = '\0';
+
+        if ( ! std::strncmp( buf, "(dispinit", 9 ) )
+        {
+            addSubscriber( addr, port );
+        }
+        else if ( ! std::strncmp( buf, "(dispbye", 8 ) )
+        {
+            removeSubscriber( addr, port );
+        }
+        else
+        {
+            // the other commands also keep the subscription.
+            touchSubscriber( addr, port );
+            std::cerr << "MonitorRelay. ignored the command from "
+                      << addr.toString().toStdString() << ":" << port
+                      << " " << buf << std::endl;
+        }
+    }
+}
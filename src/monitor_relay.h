@@ -0,0 +1,145 @@
+// -*-c++-*-
+
+/*!
+  \file monitor_relay.h
+  \brief monitor packet relay server Header File.
+*/
+
+/*
+ *Copyright:
+
+ Copyright (C) The RoboCup Soccer Server Maintenance Group.
+ Hidehisa AKIYAMA
+
+ This code is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 3, or (at your option)
+ any later version.
+
+ This code is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this code; see the file COPYING.  If not, write to
+ the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+
+ *EndCopyright:
+ */
+
+/////////////////////////////////////////////////////////////////////
+
+#ifndef RCSSMONITOR_MONITOR_RELAY_H
+#define RCSSMONITOR_MONITOR_RELAY_H
+
+#include <QObject>
+#include <QHostAddress>
+
+#include <memory>
+
+class QTimer;
+class QUdpSocket;
+
+/*!
+  \class MonitorRelay
+  \brief UDP server that forwards the datagrams received from rcssserver
+  to the downstream monitors.
+
+  The downstream monitors connect to the relay port in the same way as
+  to rcssserver ("(dispinit ...)" and "(dispbye)"). Other commands are
+  not forwarded to rcssserver, and the downstream monitors have to use
+  the same protocol version as this monitor. Every received datagram is
+  sent to all subscribers directly from the receive buffer of
+  MonitorClient (sendmmsg() if available), and only the parameter and
+  the team graphic datagrams are copied to be sent to the monitors that
+  connect later. relay() may be called from the network thread.
+
+  If the idle timeout is given, the monitors that send nothing during
+  the timeout are removed. They have to send "(dispinit ...)" again.
+*/
+class MonitorRelay
+    : public QObject {
+
+    Q_OBJECT
+
+public:
+
+    //! the kind of the datagram kept for the monitors connecting later
+    enum HeaderType {
+        SESSION_HEADER, //!< server_param. the previously kept datagrams are discarded.
+        PARAM_HEADER, //!< player_param and player_type
+        TEAM_GRAPHIC_HEADER, //!< one tile of the team graphic
+    };
+
+private:
+
+    struct Impl;
+
+    QUdpSocket * M_socket;
+    QTimer * M_idle_timer;
+
+    //! the idle timeout [ms]. 0 means no timeout.
+    const qint64 M_idle_timeout;
+
+    //! the subscribers and the cached datagrams, shared with the network thread
+    std::unique_ptr< Impl > M_impl;
+
+    // not used
+    MonitorRelay() = delete;
+    MonitorRelay( const MonitorRelay & ) = delete;
+    MonitorRelay & operator=( const MonitorRelay & ) = delete;
+
+public:
+
+    /*!
+      \brief bind the relay socket.
+      \param parent parent object
+      \param port the port number waiting for the downstream monitors
+      \param idle_timeout the seconds to keep the silent monitors. 0 means no timeout.
+     */
+    MonitorRelay( QObject * parent,
+                  const int port,
+                  const int idle_timeout );
+
+    ~MonitorRelay();
+
+    bool isOpen() const;
+
+    /*!
+      \brief send the datagram to all subscribers.
+      \param buf the received datagram
+      \param len the length of the datagram
+     */
+    void relay( const char * buf,
+                const int len );
+
+    /*!
+      \brief keep the copy of the parameter datagram for the new subscribers.
+      \param buf the received datagram
+      \param len the length of the datagram
+      \param type the kind of the datagram
+     */
+    void addHeader( const char * buf,
+                    const int len,
+                    const HeaderType type );
+
+    std::size_t subscriberCount() const;
+
+private:
+
+    void addSubscriber( const QHostAddress & addr,
+                        const quint16 port );
+    void removeSubscriber( const QHostAddress & addr,
+                           const quint16 port );
+    void touchSubscriber( const QHostAddress & addr,
+                          const quint16 port );
+
+private slots:
+
+    void handleReceive();
+    void removeIdleSubscribers();
+
+};
+
+#endif
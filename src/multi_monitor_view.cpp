@@ -0,0 +1,319 @@
+// -*-c++-*-
+
+/*!
+  \file multi_monitor_view.cpp
+  \brief tiled view of the multiple monitor connections Source File.
+*/
+
+/*
+ *Copyright:
+
+ Copyright (C) The RoboCup Soccer Server Maintenance Group.
+ Hidehisa AKIYAMA
+
+ This code is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 3, or (at your option)
+ any later version.
+
+ This code is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this code; see the file COPYING.  If not, write to
+ the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+
+ *EndCopyright:
+ */
+
+/////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <QGridLayout>
+#include <QTimer>
+
+#include "multi_monitor_view.h"
+
+#include "disp_holder.h"
+#include "field_canvas.h"
+#include "log_player.h"
+#include "monitor_client.h"
+#include "options.h"
+
+#include <iostream>
+#include <sstream>
+#include <cmath>
+#include <cstdlib>
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief the data of one connection.
+ */
+struct MultiMonitorView::Entry {
+    std::string host_;
+    int port_;
+
+    DispHolder disp_holder_;
+    MonitorClient * monitor_client_;
+    LogPlayer * log_player_;
+    FieldCanvas * field_canvas_;
+
+    Entry( const std::string & host,
+           const int port )
+        : host_( host ),
+          port_( port ),
+          monitor_client_( nullptr ),
+          log_player_( nullptr ),
+          field_canvas_( nullptr )
+      { }
+};
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+MultiMonitorView::MultiMonitorView( QWidget * parent )
+    : QWidget( parent ),
+      M_layout( new QGridLayout( this ) )
+{
+    M_layout->setContentsMargins( 0, 0, 0, 0 );
+    M_layout->setSpacing( 2 );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+MultiMonitorView::~MultiMonitorView()
+{
+    disconnectAll();
+
+    // the child widgets refer to the holders in M_entries
+    for ( std::unique_ptr< Entry > & entry : M_entries )
+    {
+        delete entry->field_canvas_;
+        delete entry->log_player_;
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+MultiMonitorView::connectTo( const std::vector< std::pair< std::string, int > > & servers )
+{
+    const int cols = static_cast< int >( std::ceil( std::sqrt( static_cast< double >( servers.size() ) ) ) );
+
+    for ( const std::pair< std::string, int > & server : servers )
+    {
+        M_entries.emplace_back( new Entry( server.first, server.second ) );
+        Entry & entry = *M_entries.back();
+
+        const int i = static_cast< int >( M_entries.size() ) - 1;
+
+        entry.field_canvas_ = new FieldCanvas( entry.disp_holder_ );
+        entry.field_canvas_->setMinimumSize( 160, 120 );
+        M_layout->addWidget( entry.field_canvas_, i / cols, i % cols );
+
+        entry.log_player_ = new LogPlayer( entry.disp_holder_, this );
+        connect( entry.log_player_, SIGNAL( indexUpdated( size_t, size_t ) ),
+                 entry.field_canvas_, SLOT( updateFrame() ) );
+
+        connectEntry( entry );
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+MultiMonitorView::disconnectAll()
+{
+    for ( std::unique_ptr< Entry > & entry : M_entries )
+    {
+        disconnectEntry( *entry );
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+MultiMonitorView::connectEntry( Entry & entry )
+{
+    std::cerr << "Connect to [" << entry.host_ << ":" << entry.port_ << "] ..." << std::endl;
+
+    MonitorClient * client = new MonitorClient( this,
+                                                entry.disp_holder_,
+                                                entry.host_.c_str(),
+                                                entry.port_,
+                                                Options::instance().clientVersion() );
+    if ( ! client->isConnected() )
+    {
+        std::cerr << "Connection to [" << entry.host_ << ":" << entry.port_ << "] failed."
+                  << std::endl;
+        delete client;
+        return;
+    }
+
+    entry.disp_holder_.clear();
+    entry.log_player_->clear();
+
+    entry.monitor_client_ = client;
+
+    connect( client, SIGNAL( received() ),
+             entry.log_player_, SLOT( showLive() ) );
+    connect( client, SIGNAL( disconnectRequested() ),
+             this, SLOT( disconnectServer() ) );
+    connect( client, SIGNAL( reconnectRequested() ),
+             this, SLOT( reconnectServer() ) );
+
+    entry.log_player_->setLiveMode();
+    client->sendDispInit();
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+MultiMonitorView::disconnectEntry( Entry & entry )
+{
+    if ( entry.monitor_client_ )
+    {
+        entry.monitor_client_->disconnect();
+        // the client may be the sender of the current signal
+        entry.monitor_client_->deleteLater();
+        entry.monitor_client_ = nullptr;
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+MultiMonitorView::Entry *
+MultiMonitorView::findEntry( const QObject * client )
+{
+    for ( std::unique_ptr< Entry > & entry : M_entries )
+    {
+        if ( entry->monitor_client_ == client )
+        {
+            return entry.get();
+        }
+    }
+
+    return nullptr;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+MultiMonitorView::updateAll()
+{
+    for ( std::unique_ptr< Entry > & entry : M_entries )
+    {
+        entry->field_canvas_->updateView();
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+MultiMonitorView::disconnectServer()
+{
+    Entry * entry = findEntry( sender() );
+    if ( entry )
+    {
+        std::cerr << "Disconnect from [" << entry->host_ << ":" << entry->port_ << "]"
+                  << std::endl;
+        disconnectEntry( *entry );
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+MultiMonitorView::reconnectServer()
+{
+    Entry * entry = findEntry( sender() );
+    if ( entry )
+    {
+        disconnectEntry( *entry );
+        std::cerr << "Trying to reconnect to [" << entry->host_ << ":" << entry->port_ << "] ..."
+                  << std::endl;
+        QTimer::singleShot( 1 * 1000,
+                            this, [this, entry]() { connectEntry( *entry ); } );
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+bool
+MultiMonitorView::parse_server_list( const std::string & str,
+                                     const std::string & default_host,
+                                     const int default_port,
+                                     std::vector< std::pair< std::string, int > > & servers )
+{
+    servers.clear();
+
+    std::istringstream istr( str );
+    std::string item;
+    while ( std::getline( istr, item, ',' ) )
+    {
+        const std::string::size_type first = item.find_first_not_of( " \t" );
+        if ( first == std::string::npos )
+        {
+            continue;
+        }
+        item = item.substr( first, item.find_last_not_of( " \t" ) - first + 1 );
+
+        std::string host = item;
+        int port = default_port;
+
+        const std::string::size_type colon = item.rfind( ':' );
+        if ( colon != std::string::npos )
+        {
+            host = item.substr( 0, colon );
+
+            const std::string port_str = item.substr( colon + 1 );
+            char * end = nullptr;
+            const long value = std::strtol( port_str.c_str(), &end, 10 );
+            if ( port_str.empty()
+                 || *end != '\0'
+                 || value <= 0
+                 || 65535 < value )
+            {
+                std::cerr << "Illegal port number in the server list [" << item << "]"
+                          << std::endl;
+                return false;
+            }
+            port = static_cast< int >( value );
+        }
+
+        if ( host.empty() )
+        {
+            host = default_host;
+        }
+
+        servers.emplace_back( host, port );
+    }
+
+    return ! servers.empty();
+}
@@ -0,0 +1,123 @@
+// -*-c++-*-
+
+/*!
+  \file multi_monitor_view.h
+  \brief tiled view of the multiple monitor connections Header File.
+*/
+
+/*
+ *Copyright:
+
+ Copyright (C) The RoboCup Soccer Server Maintenance Group.
+ Hidehisa AKIYAMA
+
+ This code is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 3, or (at your option)
+ any later version.
+
+ This code is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this code; see the file COPYING.  If not, write to
+ the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+
+ *EndCopyright:
+ */
+
+/////////////////////////////////////////////////////////////////////
+
+#ifndef RCSSMONITOR_MULTI_MONITOR_VIEW_H
+#define RCSSMONITOR_MULTI_MONITOR_VIEW_H
+
+#include <QWidget>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+class QGridLayout;
+
+class MonitorClient;
+
+/*!
+  \class MultiMonitorView
+  \brief the grid of the field canvases connected to the different servers.
+
+  Each connection has its own DispHolder, and is always shown in live
+  mode. The datagrams of all connections are received by the network
+  thread shared by all MonitorClient instances.
+*/
+class MultiMonitorView
+    : public QWidget {
+
+    Q_OBJECT
+
+private:
+
+    struct Entry;
+
+    QGridLayout * M_layout;
+
+    std::vector< std::unique_ptr< Entry > > M_entries;
+
+    // not used
+    MultiMonitorView( const MultiMonitorView & ) = delete;
+    const MultiMonitorView & operator=( const MultiMonitorView & ) = delete;
+
+public:
+
+    explicit
+    MultiMonitorView( QWidget * parent = nullptr );
+    ~MultiMonitorView();
+
+    /*!
+      \brief create the canvases and connect to all servers.
+      \param servers the list of the host name and the port number
+     */
+    void connectTo( const std::vector< std::pair< std::string, int > > & servers );
+
+    /*!
+      \brief disconnect from all servers.
+     */
+    void disconnectAll();
+
+    std::size_t size() const { return M_entries.size(); }
+
+    /*!
+      \brief parse the server list string
+      \param str comma separated list of "[host][:port]"
+      \param default_host the host name used if omitted
+      \param default_port the port number used if omitted
+      \param servers reference to the result variable
+      \return false if the string is illegal
+     */
+    static
+    bool parse_server_list( const std::string & str,
+                            const std::string & default_host,
+                            const int default_port,
+                            std::vector< std::pair< std::string, int > > & servers );
+
+private:
+
+    void connectEntry( Entry & entry );
+    void disconnectEntry( Entry & entry );
+
+    Entry * findEntry( const QObject * client );
+
+public slots:
+
+    void updateAll();
+
+private slots:
+
+    void disconnectServer();
+    void reconnectServer();
+
+};
+
+#endif
@@ -212,12 +212,18 @@ Options::Options()
     M_server_host( "127.0.0.1" ),
     M_server_port( 6000 ),
     M_client_version( 5 ),
+    M_receive_buffer_size( 0 ),
+    M_server_list(),
+    M_relay_port( 0 ),
+    M_relay_timeout( 0 ),
     M_auto_quit_mode( false ),
     M_auto_quit_wait( 5 ),
     M_auto_reconnect_mode( false ),
     M_auto_reconnect_wait( 5 ),
     M_auto_loop_mode( false ),
     M_timer_interval( DEFAULT_TIMER_INTERVAL ),
+    M_max_disp_memory( 0 ),
+    M_frame_cache( false ),
     // window options
     M_window_x( -1 ),
     M_window_y( -1 ),
@@ -232,6 +238,7 @@ Options::Options()
     M_show_status_bar( false ),
     // view options
     M_anti_aliasing( true ),
+    M_opengl( false ),
     M_show_score_board( true ),
     M_show_keepaway_area( false ),
     M_show_team_graphic( true ),
@@ -405,6 +412,9 @@ Options::readSettings()
     val = settings.value( "client_version" );
     if ( val.isValid() ) M_client_version = val.toInt();
 
+    val = settings.value( "receive_buffer_size" );
+    if ( val.isValid() ) M_receive_buffer_size = val.toInt();
+
     val = settings.value( "auto_quit_mode" );
     if ( val.isValid() ) M_auto_quit_mode = val.toBool();
 
@@ -423,6 +433,12 @@ Options::readSettings()
     val = settings.value( "timer_interval" );
     if ( val.isValid() ) M_timer_interval = val.toInt();
 
+    val = settings.value( "max_disp_memory" );
+    if ( val.isValid() ) M_max_disp_memory = val.toInt();
+
+    val = settings.value( "frame_cache" );
+    if ( val.isValid() ) M_frame_cache = val.toBool();
+
     settings.endGroup();
 
     //
@@ -434,6 +450,9 @@ Options::readSettings()
     val = settings.value( "anti_aliasing" );
     if ( val.isValid() ) M_anti_aliasing = val.toBool();
 
+    val = settings.value( "opengl" );
+    if ( val.isValid() ) M_opengl = val.toBool();
+
     val = settings.value( "show_score_board" );
     if ( val.isValid() ) M_show_score_board = val.toBool();
 
@@ -727,12 +746,15 @@ Options::writeSettings( bool all )
         settings.setValue( "server_host", QString::fromStdString( M_server_host ) );
         settings.setValue( "server_port", M_server_port );
         settings.setValue( "client_version", M_client_version );
+        settings.setValue( "receive_buffer_size", M_receive_buffer_size );
         settings.setValue( "auto_quit_mode", M_auto_quit_mode );
         settings.setValue( "auto_quit_wait", M_auto_quit_wait );
         settings.setValue( "auto_reconnect_mode", M_auto_reconnect_mode );
         settings.setValue( "auto_reconnect_wait", M_auto_reconnect_wait );
         settings.setValue( "auto_loop_mode", M_auto_loop_mode );
         settings.setValue( "timer_interval", M_timer_interval );
+        settings.setValue( "max_disp_memory", M_max_disp_memory );
+        settings.setValue( "frame_cache", M_frame_cache );
         settings.endGroup();
     }
 
@@ -741,6 +763,7 @@ Options::writeSettings( bool all )
     //
     settings.beginGroup( "View" );
     settings.setValue( "anti_aliasing", M_anti_aliasing );
+    settings.setValue( "opengl", M_opengl );
     settings.setValue( "show_score_board", M_show_score_board );
     settings.setValue( "show_keepaway_area", M_show_keepaway_area );
     settings.setValue( "show_team_graphic", M_show_team_graphic );
@@ -867,11 +890,40 @@ Options::parseCmdLine( int argc,
                                            "int",
                                            QString::number( M_client_version ) );
     parser.addOption( opt_client_version );
+    QCommandLineOption opt_receive_buffer_size( "receive-buffer-size",
+                                                "Set the socket receive buffer size [KB] for the monitor client. 0 means the system default. (Default=" + QString::number( M_receive_buffer_size ) + ")",
+                                                "int",
+                                                QString::number( M_receive_buffer_size ) );
+    parser.addOption( opt_receive_buffer_size );
+    QCommandLineOption opt_server_list( "server-list",
+                                        "Connect to the multiple soccer servers at once, and show them in the tiled view. Comma separated list of [host][:port]. The omitted values are given by --server-host and --server-port.",
+                                        "str" );
+    parser.addOption( opt_server_list );
+    QCommandLineOption opt_relay_port( "relay-port",
+                                       "Relay the data received from the soccer server to the other monitors connecting to this port. 0 means disabled. (Default=" + QString::number( M_relay_port ) + ")",
+                                       "int",
+                                       QString::number( M_relay_port ) );
+    parser.addOption( opt_relay_port );
+    QCommandLineOption opt_relay_timeout( "relay-timeout",
+                                          "Remove the relayed monitors that send nothing for the given seconds. 0 means no timeout. (Default=" + QString::number( M_relay_timeout ) + ")",
+                                          "int",
+                                          QString::number( M_relay_timeout ) );
+    parser.addOption( opt_relay_timeout );
     QCommandLineOption opt_timer_interval( "timer-interval",
                                            "Set the default timer interval [ms] for replaying a game log file. (Default=" + QString::number( M_timer_interval ) + ")",
                                            "int",
                                            QString::number( M_timer_interval ) );
     parser.addOption( opt_timer_interval );
+    QCommandLineOption opt_max_disp_memory( "max-disp-memory",
+                                            "Set the memory budget [MB] for the display data. The oldest data are released when it is exceeded. 0 means unlimited. (Default=" + QString::number( M_max_disp_memory ) + ")",
+                                            "int",
+                                            QString::number( M_max_disp_memory ) );
+    parser.addOption( opt_max_disp_memory );
+    QCommandLineOption opt_frame_cache( "frame-cache",
+                                        "Save the parsed game log data to the cache file (<file>.rcgcache), and read it instead of parsing the same file again. (Default=" + to_onoff( M_frame_cache ) + ")",
+                                        "bool",
+                                        to_onoff( M_frame_cache ) );
+    parser.addOption( opt_frame_cache );
     QCommandLineOption opt_auto_quit_mode( "auto-quit-mode",
                                            "Enable the automatic quit mode. (Default=" + to_onoff( M_auto_quit_mode ) + ")",
                                            "bool",
@@ -929,6 +981,11 @@ Options::parseCmdLine( int argc,
                                           "bool",
                                           to_onoff( M_anti_aliasing ) );
     parser.addOption( opt_anti_aliasing );
+    QCommandLineOption opt_opengl( "opengl",
+                                   "Render the field by OpenGL. (Default=" + to_onoff( M_opengl ) + ")",
+                                   "bool",
+                                   to_onoff( M_opengl ) );
+    parser.addOption( opt_opengl );
     QCommandLineOption opt_show_score_board( "show-score-board",
                                              "Display a score board. (Default=" + to_onoff( M_show_score_board ) + ")" ,
                                              "bool",
@@ -1071,7 +1128,13 @@ Options::parseCmdLine( int argc,
     if ( parser.isSet( opt_server_host ) ) M_server_host = parser.value( opt_server_host ).toStdString();
     if ( parser.isSet( opt_server_port ) ) M_server_port = parser.value( opt_server_port ).toInt();
     if ( parser.isSet( opt_client_version ) ) M_client_version = parser.value( opt_client_version ).toInt();
+    if ( parser.isSet( opt_receive_buffer_size ) ) M_receive_buffer_size = parser.value( opt_receive_buffer_size ).toInt();
+    if ( parser.isSet( opt_server_list ) ) M_server_list = parser.value( opt_server_list ).toStdString();
+    if ( parser.isSet( opt_relay_port ) ) M_relay_port = parser.value( opt_relay_port ).toInt();
+    if ( parser.isSet( opt_relay_timeout ) ) M_relay_timeout = parser.value( opt_relay_timeout ).toInt();
     if ( parser.isSet( opt_timer_interval ) ) M_timer_interval = parser.value( opt_timer_interval ).toInt();
+    if ( parser.isSet( opt_max_disp_memory ) ) M_max_disp_memory = parser.value( opt_max_disp_memory ).toInt();
+    if ( parser.isSet( opt_frame_cache ) ) M_frame_cache = to_bool( parser.value( opt_frame_cache ), M_frame_cache );
     if ( parser.isSet( opt_auto_quit_mode ) ) M_auto_quit_mode = to_bool( parser.value( opt_auto_quit_mode ), M_auto_quit_mode );
     if ( parser.isSet( opt_auto_quit_wait ) ) M_auto_quit_wait = parser.value( opt_auto_quit_wait ).toInt();
     if ( parser.isSet( opt_auto_reconnect_mode ) ) M_auto_reconnect_mode = to_bool( parser.value( opt_auto_reconnect_mode ), M_auto_reconnect_mode );
@@ -1086,6 +1149,7 @@ Options::parseCmdLine( int argc,
     if ( parser.isSet( opt_show_status_bar ) ) M_show_status_bar = to_bool( parser.value( opt_show_status_bar ), M_show_status_bar );
     // view options
     if ( parser.isSet( opt_anti_aliasing ) ) M_anti_aliasing = to_bool( parser.value( opt_anti_aliasing ), M_anti_aliasing );
+    if ( parser.isSet( opt_opengl ) ) M_opengl = to_bool( parser.value( opt_opengl ), M_opengl );
     if ( parser.isSet( opt_show_score_board ) ) M_show_score_board = to_bool( parser.value( opt_show_score_board ), M_show_score_board );
     if ( parser.isSet( opt_show_keepaway_area ) ) M_show_keepaway_area = to_bool( parser.value( opt_show_keepaway_area ), M_show_keepaway_area );
     if ( parser.isSet( opt_show_team_graphic ) ) M_show_team_graphic = to_bool( parser.value( opt_show_team_graphic ), M_show_team_graphic );
@@ -1142,9 +1206,27 @@ Options::parseCmdLine( int argc,
         ( "client-version",
           po::value< int >( &M_client_version )->default_value( M_client_version ),
           "set a monitor client protocol version." )
+        ( "receive-buffer-size",
+          po::value< int >( &M_receive_buffer_size )->default_value( M_receive_buffer_size ),
+          "set the socket receive buffer size [KB] for the monitor client. 0 means the system default." )
+        ( "server-list",
+          po::value< std::string >( &M_server_list ),
+          "connect to the multiple soccer servers at once, and show them in the tiled view. comma separated list of [host][:port]." )
+        ( "relay-port",
+          po::value< int >( &M_relay_port )->default_value( M_relay_port ),
+          "relay the data received from the soccer server to the other monitors connecting to this port. 0 means disabled." )
+        ( "relay-timeout",
+          po::value< int >( &M_relay_timeout )->default_value( M_relay_timeout ),
+          "remove the relayed monitors that send nothing for the given seconds. 0 means no timeout." )
         ( "timer-interval",
           po::value< int >( &M_timer_interval )->default_value( M_timer_interval ),
           "set the default timer interval [ms] for replaying a game log file." )
+        ( "max-disp-memory",
+          po::value< int >( &M_max_disp_memory )->default_value( M_max_disp_memory ),
+          "set the memory budget [MB] for the display data. 0 means unlimited." )
+        ( "frame-cache",
+          po::value< bool >( &M_frame_cache )->default_value( M_frame_cache, to_onoff( M_frame_cache ) ),
+          "save the parsed game log data to the cache file, and read it instead of parsing the same file again." )
         ( "auto-quit-mode",
           po::value< bool >( &M_auto_quit_mode )->default_value( M_auto_quit_mode, to_onoff( M_auto_quit_mode ) ),
           "enable automatic quit mode." )
@@ -1183,6 +1265,9 @@ Options::parseCmdLine( int argc,
         ( "anti-aliasing",
           po::value< bool >( &M_anti_aliasing )->default_value( M_anti_aliasing, to_onoff( M_anti_aliasing ) ),
           "show anti-aliased objects." )
+        ( "opengl",
+          po::value< bool >( &M_opengl )->default_value( M_opengl, to_onoff( M_opengl ) ),
+          "render the field by OpenGL." )
         ( "show-score-board",
           po::value< bool >( &M_show_score_board )->default_value( M_show_score_board, to_onoff( M_show_score_board ) ),
           "show score board." )
@@ -1413,6 +1498,44 @@ Options::checkConsistensy()
         M_timer_interval = 5000;
     }
 
+    if ( M_receive_buffer_size < 0 )
+    {
+        std::cerr << "Illegal receive buffer size " << M_receive_buffer_size
+                  << ". replaced by 0 (system default)." << std::endl;
+        M_receive_buffer_size = 0;
+    }
+
+    if ( M_relay_port < 0
+         || 65535 < M_relay_port )
+    {
+        std::cerr << "Illegal relay port " << M_relay_port
+                  << ". the relay is disabled." << std::endl;
+        M_relay_port = 0;
+    }
+
+    if ( M_relay_timeout < 0 )
+    {
+        std::cerr << "Illegal relay timeout " << M_relay_timeout
+                  << ". replaced by 0 (no timeout)." << std::endl;
+        M_relay_timeout = 0;
+    }
+
+#ifndef USE_GLWIDGET
+    if ( M_opengl )
+    {
+        std::cerr << "OpenGL rendering is not available in this build."
+                  << " the field is rendered by the software." << std::endl;
+        M_opengl = false;
+    }
+#endif
+
+    if ( M_max_disp_memory < 0 )
+    {
+        std::cerr << "Illegal display data memory budget " << M_max_disp_memory
+                  << ". replaced by 0 (unlimited)." << std::endl;
+        M_max_disp_memory = 0;
+    }
+
     if ( M_ball_size < 0.0 )
     {
         M_ball_size = 0.0;
@@ -146,6 +146,10 @@ private:
     std::string M_server_host;
     int M_server_port;
     int M_client_version;
+    int M_receive_buffer_size; //!< the socket receive buffer size [KB]. 0 means the system default.
+    std::string M_server_list; //!< comma separated "[host][:port]" list to be shown in the tiled view
+    int M_relay_port; //!< the port number to relay the received data to the other monitors. 0 means disabled.
+    int M_relay_timeout; //!< the seconds to keep the relay subscriber sending nothing. 0 means no timeout.
 
     //
     // monitor/logplayer options
@@ -158,6 +162,8 @@ private:
     std::string M_game_log_file; //!< the file path of game log file to be opened
     bool M_auto_loop_mode;
     int M_timer_interval; //!< logplayer timer interval
+    int M_max_disp_memory; //!< the memory budget [MB] for the display data. 0 means unlimited.
+    bool M_frame_cache; //!< if true, the parsed game log data are cached to the file.
 
     //
     // window options
@@ -181,6 +187,7 @@ private:
     //
 
     bool M_anti_aliasing;
+    bool M_opengl; //!< if true, the field is rendered by OpenGL.
 
     bool M_show_score_board;
     bool M_show_keepaway_area;
@@ -331,6 +338,10 @@ public:
 
     int serverPort() const { return M_server_port; }
     int clientVersion() const { return M_client_version; }
+    int receiveBufferSize() const { return M_receive_buffer_size; }
+    const std::string & serverList() const { return M_server_list; }
+    int relayPort() const { return M_relay_port; }
+    int relayTimeout() const { return M_relay_timeout; }
 
     bool autoQuitMode() const { return M_auto_quit_mode; }
     int autoQuitWait() const { return M_auto_quit_wait; }
@@ -344,6 +355,10 @@ public:
 
     int timerInterval() const { return M_timer_interval; }
 
+    int maxDispMemory() const { return M_max_disp_memory; }
+
+    bool frameCache() const { return M_frame_cache; }
+
     //
     // window option
     //
@@ -370,6 +385,8 @@ public:
     bool antiAliasing() const { return M_anti_aliasing; }
     void toggleAntiAliasing() { M_anti_aliasing = ! M_anti_aliasing; }
 
+    bool openGL() const { return M_opengl; }
+
     bool showScoreBoard() const { return M_show_score_board; }
     void toggleShowScoreBoard() { M_show_score_board = ! M_show_score_board; }
 
@@ -34,6 +34,7 @@
 #define RCSSMONITOR_PAINTER_INTERFADE_H
 
 class QPainter;
+class QRegion;
 
 class PainterInterface {
 protected:
@@ -50,6 +51,17 @@ public:
     virtual
     void draw( QPainter & painter ) = 0;
 
+    /*!
+      \brief add the screen area drawn by draw() for the current data.
+      \param region the area to be extended
+      \return false if the area is unknown and the whole canvas has to be repainted.
+     */
+    virtual
+    bool addFrameRegion( QRegion & /*region*/ ) const
+      {
+          return false;
+      }
+
 };
 
 #endif
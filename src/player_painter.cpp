@@ -51,12 +51,116 @@
 
 #include <rcss/rcg/types.h>
 
-#include <cstring>
 #include <cstdio>
 #include <cmath>
 
 namespace {
 const double DEG2RAD = M_PI / 180.0;
+
+//! the margin for the pen width and the anti-aliasing
+const int REGION_MARGIN = 2;
+
+//! the maximum number of the label parts (unum, stamina, capacity and type)
+const int LABEL_PARTS = 4;
+
+//! the number of the cached label parts shared by all players
+const int LABEL_CACHE_SIZE = 1024;
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief get the screen area of the circle
+ */
+inline
+QRect
+circle_rect( const int x,
+             const int y,
+             const int r )
+{
+    const int w = r + REGION_MARGIN;
+    return QRect( x - w, y - w, w * 2 + 1, w * 2 + 1 );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief get the screen area of the line segment
+ */
+inline
+QRect
+line_rect( const int x1,
+           const int y1,
+           const int x2,
+           const int y2 )
+{
+    return QRect( QPoint( x1, y1 ), QPoint( x2, y2 ) ).normalized()
+        .adjusted( -REGION_MARGIN, -REGION_MARGIN, REGION_MARGIN, REGION_MARGIN );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief get the x-coordinates of the offside lines
+ */
+void
+get_offside_lines( const rcss::rcg::ShowInfoT & show,
+                   float & offside_l,
+                   float & offside_r )
+{
+    const float ball_x = show.ball_.x_;
+
+    offside_l = 0.0f;
+    {
+        float min_x = 0.0f;
+        for ( int i = 0; i < rcss::rcg::MAX_PLAYER*2; ++i )
+        {
+            if ( show.player_[i].state_ != 0
+                 && show.player_[i].side_ == rcss::rcg::LEFT )
+            {
+                float x = show.player_[i].x_;
+                if ( x < offside_l )
+                {
+                    if ( x < min_x )
+                    {
+                        offside_l = min_x;
+                        min_x = x;
+                    }
+                    else
+                    {
+                        offside_l = x;
+                    }
+                }
+            }
+        }
+        offside_l = std::min( offside_l, ball_x );
+        offside_l = std::max( offside_l, - float( Options::PITCH_HALF_LENGTH ) );
+    }
+
+    offside_r = 0.0f;
+    {
+        float max_x = 0.0;
+        for ( int i = 0; i < rcss::rcg::MAX_PLAYER*2; ++i )
+        {
+            if ( show.player_[i].state_ != 0
+                 && show.player_[i].side_ == rcss::rcg::RIGHT )
+            {
+                float x = show.player_[i].x_;
+                if ( offside_r < x )
+                {
+                    if ( max_x < x )
+                    {
+                        offside_r = max_x;
+                        max_x = x;
+                    }
+                    else
+                    {
+                        offside_r = x;
+                    }
+                }
+            }
+        }
+        offside_r = std::max( offside_r, ball_x );
+        offside_r = std::min( offside_r, float( Options::PITCH_HALF_LENGTH ) );
+    }
+}
+
 }
 
 /*-------------------------------------------------------------------*/
@@ -66,23 +170,19 @@ const double DEG2RAD = M_PI / 180.0;
 inline
 PlayerPainter::Param::Param(  const rcss::rcg::PlayerT & player,
                               const rcss::rcg::BallT & ball,
-                              const rcss::rcg::ServerParamT & sparam,
-                              const rcss::rcg::PlayerTypeT & ptype )
+                              const TypeGeometry & geom )
     : x_( Options::instance().screenX( player.x_ ) )
     , y_( Options::instance().screenY( player.y_ ) )
-    , body_radius_( Options::instance().scale( ptype.player_size_ ) )
-    , kick_radius_( Options::instance().scale( ptype.player_size_ + ptype.kickable_margin_ + sparam.ball_size_ ) )
+    , body_radius_( geom.body_radius_ )
+    , kick_radius_( geom.kick_radius_ )
+    , draw_radius_( geom.draw_radius_ )
       //, have_full_effort_( std::fabs( player.effort_ - ptype.effort_max_ ) < 1.0e-3 )
     , player_( player )
     , ball_( ball )
-    , player_type_( ptype )
+    , player_type_( *geom.player_type_ )
+    , geom_( geom )
 {
-    if ( body_radius_ < 1 ) body_radius_ = 1;
-    if ( kick_radius_ < 5 ) kick_radius_ = 5;
 
-    draw_radius_ =  ( Options::instance().playerSize() >= 0.01
-                      ? Options::instance().scale( Options::instance().playerSize() )
-                      : kick_radius_ );
 }
 
 /*-------------------------------------------------------------------*/
@@ -90,7 +190,9 @@ PlayerPainter::Param::Param(  const rcss::rcg::PlayerT & player,
 
  */
 PlayerPainter::PlayerPainter( const DispHolder & disp_holder )
-    : M_disp_holder( disp_holder )
+    : M_disp_holder( disp_holder ),
+      M_label_cache( LABEL_CACHE_SIZE ),
+      M_shape_renderer( nullptr )
 {
 
 }
@@ -123,11 +225,26 @@ PlayerPainter::draw( QPainter & painter )
         return;
     }
 
+    updateGeometry();
+
     const rcss::rcg::BallT & ball = disp->show_.ball_;
 
+    // the circles and the arcs of all players are drawn by one call.
+    const bool batched = ( M_shape_renderer
+                           && M_shape_renderer->isAvailable() );
+    if ( batched )
+    {
+        M_shape_batch.clear();
+        for ( int i = 0; i < rcss::rcg::MAX_PLAYER*2; ++i )
+        {
+            addShapes( M_shape_batch, disp->show_.player_[i], ball );
+        }
+        M_shape_renderer->render( painter, M_shape_batch );
+    }
+
     for ( int i = 0; i < rcss::rcg::MAX_PLAYER*2; ++i )
     {
-        drawAll( painter, disp->show_.player_[i], ball );
+        drawAll( painter, disp->show_.player_[i], ball, ! batched );
     }
 
     if ( Options::instance().showOffsideLine() )
@@ -140,24 +257,416 @@ PlayerPainter::draw( QPainter & painter )
 /*
 
  */
+bool
+PlayerPainter::addFrameRegion( QRegion & region ) const
+{
+    const Options & opt = Options::instance();
+
+    if ( ! opt.showPlayer() )
+    {
+        return true;
+    }
+
+    DispConstPtr disp = M_disp_holder.currentDisp();
+
+    if ( ! disp )
+    {
+        return true;
+    }
+
+    updateGeometry();
+
+    const QFontMetrics fm( opt.playerFont() );
+    const rcss::rcg::BallT & ball = disp->show_.ball_;
+
+    for ( int i = 0; i < rcss::rcg::MAX_PLAYER*2; ++i )
+    {
+        addPlayerRegion( region, fm, disp->show_.player_[i], ball );
+    }
+
+    if ( opt.showOffsideLine() )
+    {
+        float offside_l = 0.0f;
+        float offside_r = 0.0f;
+        get_offside_lines( disp->show_, offside_l, offside_r );
+
+        const int top_y = opt.screenY( Options::PITCH_HALF_WIDTH );
+        const int bottom_y = opt.screenY( - Options::PITCH_HALF_WIDTH );
+
+        region += line_rect( opt.screenX( offside_l ), top_y,
+                             opt.screenX( offside_l ), bottom_y );
+        region += line_rect( opt.screenX( offside_r ), top_y,
+                             opt.screenX( offside_r ), bottom_y );
+    }
+
+    return true;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief recompute the cached sizes if the parameters or the scale are changed.
+ */
+void
+PlayerPainter::updateGeometry() const
+{
+    const Options & opt = Options::instance();
+
+    if ( M_geometry.param_revision_ == M_disp_holder.paramRevision()
+         && M_geometry.field_scale_ == opt.fieldScale()
+         && M_geometry.player_size_ == opt.playerSize() )
+    {
+        return;
+    }
+
+    const rcss::rcg::ServerParamT & SP = M_disp_holder.serverParam();
+
+    M_geometry.param_revision_ = M_disp_holder.paramRevision();
+    M_geometry.field_scale_ = opt.fieldScale();
+    M_geometry.player_size_ = opt.playerSize();
+
+    M_geometry.visible_radius_ = opt.scale( SP.visible_distance_ );
+    M_geometry.unum_far_radius_ = opt.scale( 20.0 );
+    M_geometry.team_far_radius_ = opt.scale( 40.0 );
+    M_geometry.team_toofar_radius_ = opt.scale( 60.0 );
+
+    M_geometry.tackle_area_ = std::sqrt( std::pow( std::max( SP.tackle_dist_, SP.tackle_back_dist_ ), 2.0 )
+                                         + std::pow( SP.tackle_width_, 2.0 ) );
+    M_geometry.tackle_rect_ = QRect( opt.scale( - SP.tackle_back_dist_ ),
+                                     opt.scale( - SP.tackle_width_ ),
+                                     opt.scale( SP.tackle_dist_ + SP.tackle_back_dist_ ),
+                                     opt.scale( SP.tackle_width_ * 2.0 ) );
+
+    M_geometry.ball_speed_max_radius_ = opt.scale( SP.ball_speed_max_ );
+    M_geometry.ball_accel_max_radius_ = opt.scale( SP.ball_accel_max_ );
+
+    M_geometry.default_type_ = createTypeGeometry( M_disp_holder.playerType( -1 ) );
+
+    int max_id = -1;
+    for ( const std::pair< const int, rcss::rcg::PlayerTypeT > & v : M_disp_holder.playerTypes() )
+    {
+        max_id = std::max( max_id, v.first );
+    }
+
+    M_geometry.types_.clear();
+    for ( int id = 0; id <= max_id; ++id )
+    {
+        // the pointer refers to the default type if the id is not received.
+        M_geometry.types_.push_back( createTypeGeometry( M_disp_holder.playerType( id ) ) );
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+PlayerPainter::TypeGeometry
+PlayerPainter::createTypeGeometry( const rcss::rcg::PlayerTypeT & ptype ) const
+{
+    const Options & opt = Options::instance();
+    const rcss::rcg::ServerParamT & SP = M_disp_holder.serverParam();
+
+    TypeGeometry geom;
+
+    geom.player_type_ = &ptype;
+
+    geom.kickable_area_ = ptype.player_size_ + ptype.kickable_margin_ + SP.ball_size_;
+    geom.max_kick_power_ = SP.max_power_ * ptype.kick_power_rate_;
+
+    geom.body_radius_ = std::max( 1, opt.scale( ptype.player_size_ ) );
+    geom.kick_radius_ = std::max( 5, opt.scale( geom.kickable_area_ ) );
+    geom.draw_radius_ = ( opt.playerSize() >= 0.01
+                          ? opt.scale( opt.playerSize() )
+                          : geom.kick_radius_ );
+
+    const double half_w2 = std::pow( SP.catchable_area_w_ * 0.5, 2.0 );
+    const double stretch = ptype.catchable_area_l_stretch_;
+
+    geom.catchable_radius_
+        = opt.scale( std::sqrt( half_w2 + std::pow( SP.catchable_area_l_, 2.0 ) ) );
+    geom.max_catchable_radius_
+        = opt.scale( std::sqrt( half_w2 + std::pow( SP.catchable_area_l_ * stretch, 2.0 ) ) );
+    geom.min_catchable_radius_
+        = opt.scale( std::sqrt( half_w2 + std::pow( SP.catchable_area_l_ * ( 1.0 - ( stretch - 1.0 ) ), 2.0 ) ) );
+
+    return geom;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+const PlayerPainter::TypeGeometry &
+PlayerPainter::typeGeometry( const int type ) const
+{
+    if ( 0 <= type
+         && static_cast< std::size_t >( type ) < M_geometry.types_.size() )
+    {
+        return M_geometry.types_[type];
+    }
+
+    return M_geometry.default_type_;
+}
+
+/*-------------------------------------------------------------------*/
+/*
+
+ */
+void
+PlayerPainter::addPlayerRegion( QRegion & region,
+                                const QFontMetrics & fm,
+                                const rcss::rcg::PlayerT & player,
+                                const rcss::rcg::BallT & ball ) const
+{
+    const Options & opt = Options::instance();
+    const Param param( player, ball, typeGeometry( player.type_ ) );
+
+    const bool selected = opt.selectedPlayer( player.side(), player.unum_ );
+
+    //
+    // the circles around the player
+    //
+    int radius = std::max( param.draw_radius_ + 2, param.kick_radius_ );
+
+    if ( player.hasNeck()
+         && player.hasView()
+         && opt.showViewArea() )
+    {
+        radius = std::max( radius, M_geometry.visible_radius_ );
+        if ( selected )
+        {
+            radius = std::max( radius, M_geometry.team_toofar_radius_ );
+        }
+    }
+
+    if ( player.isGoalie()
+         && opt.showCatchArea() )
+    {
+        radius = std::max( radius, param.geom_.catchable_radius_ );
+        radius = std::max( radius, param.geom_.max_catchable_radius_ );
+    }
+
+    QRect rect = circle_rect( param.x_, param.y_, radius );
+
+    //
+    // the text at the right side of the player
+    //
+    const int text_radius = std::min( 40, param.draw_radius_ );
+    const int text_x = param.x_ + text_radius;
+
+    int card_offset = 0;
+    if ( opt.showCard()
+         && ( player.hasRedCard()
+              || player.hasYellowCard() ) )
+    {
+        const int x_size = std::max( 4, fm.ascent() - 2 );
+        const int y_size = std::max( 4, fm.ascent() );
+        card_offset = x_size + 2;
+        rect |= QRect( text_x - 1, param.y_ - y_size - 1, x_size + 2, y_size + 2 );
+    }
+
+    // the label parts are laid out here if not cached, and reused by drawText().
+    QString parts[LABEL_PARTS];
+    const int n_parts = createLabel( param, parts );
+    if ( n_parts > 0 )
+    {
+        qreal width = 0.0;
+        for ( int i = 0; i < n_parts; ++i )
+        {
+            width += M_label_cache.width( parts[i], opt.playerFont() );
+        }
+
+        rect |= QRect( text_x + card_offset, param.y_ - fm.ascent(),
+                       qCeil( width ), fm.height() )
+            .adjusted( -REGION_MARGIN, -REGION_MARGIN, REGION_MARGIN, REGION_MARGIN );
+    }
+
+    if ( opt.showTackleArea() )
+    {
+        // the tackle area and the probability are drawn only if the ball is in the area.
+        const double tackle_r = M_geometry.tackle_area_;
+        if ( std::pow( ball.x_ - player.x_, 2.0 ) + std::pow( ball.y_ - player.y_, 2.0 )
+             < std::pow( tackle_r, 2.0 ) )
+        {
+            rect |= circle_rect( param.x_, param.y_, opt.scale( tackle_r ) );
+            rect |= fm.boundingRect( QString::fromLatin1( "T=0.000e-00,F=0.000e-00" ) )
+                .translated( text_x, param.y_ + 2 + fm.ascent() )
+                .adjusted( -1, -1, 1, 1 );
+        }
+    }
+
+    region += rect;
+
+    //
+    // the lines to the other points
+    //
+    if ( player.hasNeck()
+         && player.hasView()
+         && opt.showFocusPoint()
+         && player.focusDist() > 1.0e-5
+         && selected )
+    {
+        const AngleDeg focus_angle = player.body_ + player.neck_ + player.focus_dir_;
+        const Vector2D focus_point = Vector2D::from_polar( player.focusDist(), focus_angle );
+        const int ix = opt.screenX( player.x() + focus_point.x );
+        const int iy = opt.screenY( player.y() + focus_point.y );
+
+        region += line_rect( param.x_, param.y_, ix, iy );
+        region += circle_rect( ix, iy, opt.scale( opt.focusPointSize() ) );
+    }
+
+    if ( player.isPointing()
+         && opt.showPointto() )
+    {
+        const int ix = opt.screenX( player.point_x_ );
+        const int iy = opt.screenY( player.point_y_ );
+
+        region += line_rect( param.x_, param.y_, ix, iy );
+        region += circle_rect( ix, iy, 2 );
+    }
+
+    if ( opt.showKickAccelArea()
+         && selected
+         && ball.hasVelocity() )
+    {
+        const int bx = opt.screenX( ball.x_ );
+        const int by = opt.screenY( ball.y_ );
+        const int nx = opt.screenX( ball.x_ + ball.vx_ );
+        const int ny = opt.screenY( ball.y_ + ball.vy_ );
+
+        QRect kick_rect = circle_rect( bx, by, M_geometry.ball_speed_max_radius_ );
+        kick_rect |= circle_rect( nx, ny, M_geometry.ball_accel_max_radius_ );
+        kick_rect |= fm.boundingRect( QString::fromLatin1( "MaxAccel=0.000" ) )
+            .translated( nx + 10, ny + fm.ascent() )
+            .adjusted( -1, -1, 1, 1 );
+        region += kick_rect;
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief add the shapes drawn by drawBody(), drawViewArea() and drawCatchArea().
+ */
+void
+PlayerPainter::addShapes( ShapeBatch & batch,
+                          const rcss::rcg::PlayerT & player,
+                          const rcss::rcg::BallT & ball ) const
+{
+    const Options & opt = Options::instance();
+    const Param param( player, ball, typeGeometry( player.type_ ) );
+    const QPointF center( param.x_, param.y_ );
+    const QBrush no_brush( Qt::NoBrush );
+
+    //
+    // body
+    //
+    QPen body_pen;
+    QBrush body_brush;
+    decideBodyStyle( param, &body_pen, &body_brush );
+
+    batch.addCircle( center, param.draw_radius_, body_pen, body_brush );
+
+    if ( player.hasStamina() )
+    {
+        batch.addCircle( center, param.body_radius_,
+                         QPen( Qt::NoPen ), staminaBrush( param, body_brush ) );
+
+        if ( ! player.hasFullEffort( param.player_type_.effort_max_ ) )
+        {
+            batch.addCircle( center, param.draw_radius_ + 2,
+                             opt.effortDecayedPen(), no_brush );
+        }
+        else if ( ! player.hasFullRecovery() )
+        {
+            batch.addCircle( center, param.draw_radius_ + 2,
+                             opt.recoveryDecayedPen(), no_brush );
+        }
+    }
+
+    batch.addCircle( center, param.body_radius_, opt.playerPen(), no_brush );
+
+    //
+    // view area
+    //
+    if ( player.hasNeck()
+         && player.hasView()
+         && opt.showViewArea() )
+    {
+        const int visible_radius = M_geometry.visible_radius_;
+        const double head = player.body_ + player.neck_;
+        const double start_angle = -head - player.view_width_ * 0.5;
+
+        if ( opt.selectedPlayer( player.side(), player.unum_ ) )
+        {
+            batch.addArc( center, M_geometry.unum_far_radius_,
+                          start_angle, player.view_width_,
+                          opt.largeViewAreaPen(), false );
+            batch.addArc( center, M_geometry.team_far_radius_,
+                          start_angle, player.view_width_,
+                          opt.largeViewAreaPen(), false );
+            // the view cone lines reach the 60m arc.
+            batch.addArc( center, M_geometry.team_toofar_radius_,
+                          start_angle, player.view_width_,
+                          opt.largeViewAreaPen(), true );
+            batch.addCircle( center, visible_radius,
+                             opt.largeViewAreaPen(), no_brush );
+        }
+        else
+        {
+            batch.addArc( center, visible_radius,
+                          start_angle, player.view_width_,
+                          opt.viewAreaPen(), true );
+        }
+    }
+
+    //
+    // catch area
+    //
+    if ( player.isGoalie()
+         && opt.showCatchArea() )
+    {
+        const int catchable = param.geom_.catchable_radius_;
+        batch.addCircle( center, catchable,
+                         ( player.side_ == rcss::rcg::LEFT
+                           ? opt.leftGoaliePen()
+                           : opt.rightGoaliePen() ),
+                         no_brush );
+
+        const int max_r = param.geom_.max_catchable_radius_;
+        if ( max_r > catchable )
+        {
+            const QPen & stretch_pen = ( player.side_ == rcss::rcg::LEFT
+                                         ? opt.leftGoalieStretchPen()
+                                         : opt.rightGoalieStretchPen() );
+            batch.addCircle( center, max_r, stretch_pen, no_brush );
+            batch.addCircle( center, param.geom_.min_catchable_radius_, stretch_pen, no_brush );
+        }
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \param draw_shapes if false, the shapes added by addShapes() are not drawn.
+ */
 void
 PlayerPainter::drawAll( QPainter & painter,
                         const rcss::rcg::PlayerT & player,
-                        const rcss::rcg::BallT & ball ) const
+                        const rcss::rcg::BallT & ball,
+                        const bool draw_shapes ) const
 {
     const Options & opt = Options::instance();
-    const Param param( player,
-                       ball,
-                       M_disp_holder.serverParam(),
-                       M_disp_holder.playerType( player.type_ ) );
+    const Param param( player, ball, typeGeometry( player.type_ ) );
 
-    drawBody( painter, param );
+    if ( draw_shapes )
+    {
+        drawBody( painter, param );
+    }
     drawDir( painter, param );
 
     if ( player.hasNeck()
          && player.hasView() )
     {
-        if ( opt.showViewArea() )
+        if ( draw_shapes
+             && opt.showViewArea() )
         {
             drawViewArea( painter, param );
         }
@@ -170,7 +679,8 @@ PlayerPainter::drawAll( QPainter & painter,
         }
     }
 
-    if ( player.isGoalie()
+    if ( draw_shapes
+         && player.isGoalie()
          && opt.showCatchArea() )
     {
         drawCatchArea( painter, param );
@@ -201,48 +711,49 @@ PlayerPainter::drawAll( QPainter & painter,
 
  */
 void
-PlayerPainter::drawBody( QPainter & painter,
-                         const PlayerPainter::Param & param ) const
+PlayerPainter::decideBodyStyle( const PlayerPainter::Param & param,
+                                QPen * pen,
+                                QBrush * brush ) const
 {
     const Options & opt = Options::instance();
 
     // decide base color
     if ( opt.selectedPlayer( param.player_.side(), param.player_.unum_ ) )
     {
-        painter.setPen( opt.selectedPlayerPen() );
+        *pen = opt.selectedPlayerPen();
     }
     else
     {
-        painter.setPen( opt.playerPen() );
+        *pen = opt.playerPen();
     }
 
     switch ( param.player_.side() ) {
     case rcss::rcg::LEFT:
         if ( param.player_.isGoalie() )
         {
-            painter.setBrush( opt.leftGoalieBrush() );
+            *brush = opt.leftGoalieBrush();
         }
         else
         {
-            painter.setBrush( opt.leftTeamBrush() );
+            *brush = opt.leftTeamBrush();
         }
         break;
     case rcss::rcg::RIGHT:
         if ( param.player_.isGoalie() )
         {
-            painter.setBrush( opt.rightGoalieBrush() );
+            *brush = opt.rightGoalieBrush();
         }
         else
         {
-            painter.setBrush( opt.rightTeamBrush() );
+            *brush = opt.rightTeamBrush();
         }
         break;
     case rcss::rcg::NEUTRAL:
         //std::cerr << "drawBody neutral unum=" << param.player_.unum_ << std::endl;
-        painter.setBrush( Qt::black );
+        *brush = QBrush( Qt::black );
         break;
     default:
-        painter.setBrush( Qt::black );
+        *brush = QBrush( Qt::black );
         break;
     }
 
@@ -250,52 +761,91 @@ PlayerPainter::drawBody( QPainter & painter,
     // decide status color
     if ( ! param.player_.isAlive() )
     {
-        painter.setBrush( Qt::black );
+        *brush = QBrush( Qt::black );
     }
 
     if ( param.player_.isIllegalDefenseState()
          && opt.showIllegalDefense() )
     {
-        painter.setPen( opt.illegalDefensePen() );
+        *pen = opt.illegalDefensePen();
     }
     if ( param.player_.isKicking() )
     {
-        painter.setPen( opt.kickPen() );
+        *pen = opt.kickPen();
     }
     if ( param.player_.isKickingFault() )
     {
-        painter.setBrush( opt.kickFaultBrush() );
+        *brush = opt.kickFaultBrush();
     }
     if ( param.player_.isCatching() )
     {
-        painter.setBrush( opt.catchBrush() );
+        *brush = opt.catchBrush();
     }
     if ( param.player_.isCatchingFault() )
     {
-        painter.setBrush( opt.catchFaultBrush() );
+        *brush = opt.catchFaultBrush();
     }
     if ( param.player_.isTackling() )
     {
-        painter.setPen( opt.tacklePen() );
-        painter.setBrush( opt.tackleBrush() );
+        *pen = opt.tacklePen();
+        *brush = opt.tackleBrush();
     }
     if ( param.player_.isTacklingFault() )
     {
-        painter.setPen( opt.tacklePen() );
-        painter.setBrush( opt.tackleFaultBrush() );
+        *pen = opt.tacklePen();
+        *brush = opt.tackleFaultBrush();
     }
     if ( param.player_.isFoulCharged() )
     {
-        painter.setBrush( opt.foulChargedBrush() );
+        *brush = opt.foulChargedBrush();
     }
     if ( param.player_.isCollidedBall() )
     {
-        painter.setBrush( opt.ballCollideBrush() );
+        *brush = opt.ballCollideBrush();
     }
     if ( param.player_.isCollidedPlayer() )
     {
-        painter.setBrush( opt.playerCollideBrush() );
+        *brush = opt.playerCollideBrush();
     }
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief get the brush of the stamina disc.
+  \param body_brush the brush of the player body
+ */
+QBrush
+PlayerPainter::staminaBrush( const PlayerPainter::Param & param,
+                             const QBrush & body_brush ) const
+{
+    double stamina_rate = param.player_.stamina_ / M_disp_holder.serverParam().stamina_max_;
+    int dark_rate = 200 - static_cast< int >( rint( 200 * rint( stamina_rate / 0.125 ) * 0.125 ) );
+    dark_rate = std::max( 0, dark_rate - 50 );
+
+    if ( dark_rate == 0 )
+    {
+        return body_brush;
+    }
+
+    return QBrush( body_brush.color().darker( 100 + dark_rate ) );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+PlayerPainter::drawBody( QPainter & painter,
+                         const PlayerPainter::Param & param ) const
+{
+    const Options & opt = Options::instance();
+
+    QPen pen;
+    QBrush brush;
+    decideBodyStyle( param, &pen, &brush );
+
+    painter.setPen( pen );
+    painter.setBrush( brush );
 
     painter.drawEllipse( param.x_ - param.draw_radius_ ,
                          param.y_ - param.draw_radius_ ,
@@ -306,19 +856,8 @@ PlayerPainter::drawBody( QPainter & painter,
     if ( param.player_.hasStamina() )
     {
 #if QT_VERSION >= 0x040300
-        double stamina_rate = param.player_.stamina_ / M_disp_holder.serverParam().stamina_max_;
-        int dark_rate = 200 - static_cast< int >( rint( 200 * rint( stamina_rate / 0.125 ) * 0.125 ) );
-        dark_rate = std::max( 0, dark_rate - 50 );
-
         painter.setPen( Qt::NoPen );
-        if ( dark_rate == 0 )
-        {
-            painter.setBrush( painter.brush() );
-        }
-        else
-        {
-            painter.setBrush( painter.brush().color().darker( 100 + dark_rate ) );
-        }
+        painter.setBrush( staminaBrush( param, brush ) );
         painter.drawEllipse( param.x_ - param.body_radius_,
                              param.y_ - param.body_radius_,
                              param.body_radius_ * 2 ,
@@ -376,10 +915,7 @@ PlayerPainter::drawDir( QPainter & painter,
     const Options & opt = Options::instance();
 
     // body direction line
-    double real_r
-        = param.player_type_.player_size_
-        + param.player_type_.kickable_margin_
-        + M_disp_holder.serverParam().ball_size_;
+    const double real_r = param.geom_.kickable_area_;
     double body = param.player_.body_ * DEG2RAD;
 
     int bx = opt.screenX( param.player_.x_ + real_r * std::cos( body ) );
@@ -415,7 +951,7 @@ PlayerPainter::drawViewArea( QPainter & painter,
 {
     const Options & opt = Options::instance();
 
-    const int visible_radius = opt.scale( M_disp_holder.serverParam().visible_distance_ );
+    const int visible_radius = M_geometry.visible_radius_;
     const double head = param.player_.body_ + param.player_.neck_;
     const int view_start_angle = static_cast< int >( rint( ( -head - param.player_.view_width_ * 0.5 ) * 16 ) );
     const int span_angle = static_cast< int >( rint( param.player_.view_width_ * 16 ) );
@@ -425,9 +961,9 @@ PlayerPainter::drawViewArea( QPainter & painter,
                              param.player_.unum_ ) )
     {
         // draw large view area
-        const int UNUM_FAR = opt.scale( 20.0 );
-        const int TEAM_FAR = opt.scale( 40.0 );
-        const int TEAM_TOOFAR = opt.scale( 60.0 );
+        const int UNUM_FAR = M_geometry.unum_far_radius_;
+        const int TEAM_FAR = M_geometry.team_far_radius_;
+        const int TEAM_TOOFAR = M_geometry.team_toofar_radius_;
 
         painter.setPen( opt.largeViewAreaPen() );
         painter.setBrush( Qt::NoBrush );
@@ -532,16 +1068,12 @@ PlayerPainter::drawCatchArea( QPainter & painter,
     // goalie's catchable area
     //
     const Options & opt = Options::instance();
-    const rcss::rcg::ServerParamT & SP = M_disp_holder.serverParam();
 
     //
     // catchable area
     //
 
-    const double catchable_area
-        = std::sqrt( std::pow( SP.catchable_area_w_ * 0.5, 2.0 )
-                     + std::pow( SP.catchable_area_l_, 2.0 ) );
-    const int catchable = opt.scale( catchable_area );
+    const int catchable = param.geom_.catchable_radius_;
     painter.setPen( ( param.player_.side_ == rcss::rcg::LEFT )
                     ? opt.leftGoaliePen()
                     : opt.rightGoaliePen() );
@@ -551,13 +1083,7 @@ PlayerPainter::drawCatchArea( QPainter & painter,
                          catchable * 2,
                          catchable * 2 );
 
-    const double max_catchable_area_l
-        = SP.catchable_area_l_
-        * param.player_type_.catchable_area_l_stretch_;
-    const double max_area
-        = std::sqrt( std::pow( SP.catchable_area_w_ * 0.5, 2.0 )
-                     + std::pow( max_catchable_area_l, 2.0 ) );
-    const int max_r = opt.scale( max_area );
+    const int max_r = param.geom_.max_catchable_radius_;
     if ( max_r > catchable )
     {
         painter.setPen( ( param.player_.side_ == rcss::rcg::LEFT )
@@ -568,13 +1094,7 @@ PlayerPainter::drawCatchArea( QPainter & painter,
                              max_r * 2,
                              max_r * 2 );
 
-        const double min_catchable_area_l
-            = SP.catchable_area_l_
-            * ( 1.0 - ( param.player_type_.catchable_area_l_stretch_ - 1.0 ) );
-        const double min_area
-            = std::sqrt( std::pow( SP.catchable_area_w_ * 0.5, 2.0 )
-                         + std::pow( min_catchable_area_l, 2.0 ) );
-        const int min_r = opt.scale( min_area );
+        const int min_r = param.geom_.min_catchable_radius_;
         painter.drawEllipse( param.x_ - min_r,
                              param.y_ - min_r,
                              min_r * 2,
@@ -666,10 +1186,7 @@ PlayerPainter::drawTackleArea( QPainter & painter,
         painter.setPen( opt.tacklePen() );
         painter.setBrush( Qt::NoBrush );
 
-        painter.drawRect( opt.scale( - SP.tackle_back_dist_ ),
-                          opt.scale( - SP.tackle_width_ ),
-                          opt.scale( SP.tackle_dist_ + SP.tackle_back_dist_ ),
-                          opt.scale( SP.tackle_width_ * 2.0 ) );
+        painter.drawRect( M_geometry.tackle_rect_ );
         painter.restore();
 
         int text_radius = std::min( 40, param.draw_radius_ );
@@ -733,17 +1250,13 @@ PlayerPainter::drawKickAccelArea( QPainter & painter,
 
     double ball_dist = player_to_ball.r();
 
-    if ( ball_dist > ( param.player_type_.player_size_
-                       + param.player_type_.kickable_margin_
-                       + SP.ball_size_ ) )
+    if ( ball_dist > param.geom_.kickable_area_ )
     {
         return;
     }
 
     double max_kick_accel
-        = SP.max_power_
-        //* SP.kick_power_rate_
-        * param.player_type_.kick_power_rate_
+        = param.geom_.max_kick_power_
         * ( 1.0 - 0.25 * player_to_ball.th().abs() / 180.0
             - 0.25
             * ( ball_dist - param.player_type_.player_size_ - SP.ball_size_ )
@@ -761,7 +1274,7 @@ PlayerPainter::drawKickAccelArea( QPainter & painter,
                         opt.screenY( bpos.y ) );
     QPoint bnext_screen( opt.screenX( bnext.x ),
                          opt.screenY( bnext.y ) );
-    int max_speed_screen = opt.scale( SP.ball_speed_max_ );
+    int max_speed_screen = M_geometry.ball_speed_max_radius_;
     int max_kick_accel_screen = opt.scale( max_kick_accel );
 
     painter.setPen( opt.kickAccelPen() );
@@ -906,51 +1419,8 @@ PlayerPainter::drawText( QPainter & painter,
 {
     const Options & opt = Options::instance();
 
-    char main_buf[64];
-    std::memset( main_buf, 0, 64 );
-
-    if ( opt.showPlayerNumber() )
-    {
-        char buf[8];
-        snprintf( buf, 8, "%d", param.player_.unum_ );
-        std::strcat( main_buf, buf );
-    }
-
-    if ( param.player_.hasStamina()
-         && opt.showStamina() )
-    {
-        char buf[16];
-        snprintf( buf, 16, "%4.0f", param.player_.stamina_ );
-        if ( main_buf[0] != '\0' ) std::strcat( main_buf, "," );
-        std::strcat( main_buf, buf );
-    }
-
-    if ( param.player_.hasStaminaCapacity()
-         && opt.showStaminaCapacity() )
-    {
-        char buf[16];
-        snprintf( buf, 16, "%.0f", param.player_.stamina_capacity_ );
-        if ( main_buf[0] != '\0' )
-        {
-            if ( opt.showStamina() )
-            {
-                std::strcat( main_buf, "/" );
-            }
-            else
-            {
-                std::strcat( main_buf, "," );
-            }
-        }
-        std::strcat( main_buf, buf );
-    }
-
-    if ( opt.showPlayerType() )
-    {
-        char buf[8];
-        snprintf( buf, 8, "t%d", param.player_.type_ );
-        if ( main_buf[0] != '\0' ) std::strcat( main_buf, "," );
-        strcat( main_buf, buf );
-    }
+    QString parts[LABEL_PARTS];
+    const int n_parts = createLabel( param, parts );
 
     painter.setFont( opt.playerFont() );
 
@@ -984,7 +1454,7 @@ PlayerPainter::drawText( QPainter & painter,
         }
     }
 
-    if ( main_buf[0] != '\0' )
+    if ( n_parts > 0 )
     {
         //painter.setPen( param.player_.side() == rcss::rcg::LEFT
         //                ? M_left_team_pen
@@ -1006,79 +1476,81 @@ PlayerPainter::drawText( QPainter & painter,
 
         painter.setBrush( Qt::NoBrush );
 
-        painter.drawText( param.x_ + text_radius + card_offset,
-                          param.y_,
-                          QString::fromLatin1( main_buf ) );
+        qreal x = param.x_ + text_radius + card_offset;
+        for ( int i = 0; i < n_parts; ++i )
+        {
+            x += M_label_cache.draw( painter, x, param.y_, parts[i] );
+        }
         painter.setBackgroundMode( Qt::TransparentMode );
     }
 }
 
 /*-------------------------------------------------------------------*/
 /*!
-
+  \brief create the label parts. Each part is laid out and cached separately,
+  because the stamina changes every cycle while the others rarely change.
+  \param param the player parameter
+  \param parts the array of LABEL_PARTS elements to store the result
+  \return the number of the created parts
  */
-void
-PlayerPainter::drawOffsideLine( QPainter & painter,
-                                const rcss::rcg::ShowInfoT & show ) const
+int
+PlayerPainter::createLabel( const PlayerPainter::Param & param,
+                            QString * parts ) const
 {
     const Options & opt = Options::instance();
 
-    const float ball_x = show.ball_.x_;
+    int n = 0;
+    char buf[32];
 
-    float offside_l = 0.0;
+    if ( opt.showPlayerNumber() )
     {
-        float min_x = 0.0f;
-        for ( int i = 0; i < rcss::rcg::MAX_PLAYER*2; ++i )
-        {
-            if ( show.player_[i].state_ != 0
-                 && show.player_[i].side_ == rcss::rcg::LEFT )
-            {
-                float x = show.player_[i].x_;
-                if ( x < offside_l )
-                {
-                    if ( x < min_x )
-                    {
-                        offside_l = min_x;
-                        min_x = x;
-                    }
-                    else
-                    {
-                        offside_l = x;
-                    }
-                }
-            }
-        }
-        offside_l = std::min( offside_l, ball_x );
-        offside_l = std::max( offside_l, - float( Options::PITCH_HALF_LENGTH ) );
+        snprintf( buf, sizeof( buf ), "%d", param.player_.unum_ );
+        parts[n++] = QString::fromLatin1( buf );
     }
 
-    float offside_r = 0.0;
+    if ( param.player_.hasStamina()
+         && opt.showStamina() )
     {
-        float max_x = 0.0;
-        for ( int i = 0; i < rcss::rcg::MAX_PLAYER*2; ++i )
-        {
-            if ( show.player_[i].state_ != 0
-                 && show.player_[i].side_ == rcss::rcg::RIGHT )
-            {
-                float x = show.player_[i].x_;
-                if ( offside_r < x )
-                {
-                    if ( max_x < x )
-                    {
-                        offside_r = max_x;
-                        max_x = x;
-                    }
-                    else
-                    {
-                        offside_r = x;
-                    }
-                }
-            }
-        }
-        offside_r = std::max( offside_r, ball_x );
-        offside_r = std::min( offside_r, float( Options::PITCH_HALF_LENGTH ) );
+        snprintf( buf, sizeof( buf ), "%s%4.0f",
+                  ( n > 0 ? "," : "" ),
+                  param.player_.stamina_ );
+        parts[n++] = QString::fromLatin1( buf );
     }
 
+    if ( param.player_.hasStaminaCapacity()
+         && opt.showStaminaCapacity() )
+    {
+        snprintf( buf, sizeof( buf ), "%s%.0f",
+                  ( n == 0 ? "" : opt.showStamina() ? "/" : "," ),
+                  param.player_.stamina_capacity_ );
+        parts[n++] = QString::fromLatin1( buf );
+    }
+
+    if ( opt.showPlayerType() )
+    {
+        snprintf( buf, sizeof( buf ), "%st%d",
+                  ( n > 0 ? "," : "" ),
+                  param.player_.type_ );
+        parts[n++] = QString::fromLatin1( buf );
+    }
+
+    return n;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+PlayerPainter::drawOffsideLine( QPainter & painter,
+                                const rcss::rcg::ShowInfoT & show ) const
+{
+    const Options & opt = Options::instance();
+
+    float offside_l = 0.0f;
+    float offside_r = 0.0f;
+    get_offside_lines( show, offside_l, offside_r );
+
     const int offside_line_l = opt.screenX( offside_l );
     const int offside_line_r = opt.screenX( offside_r );
 
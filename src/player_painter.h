@@ -36,11 +36,17 @@
 #include <QPen>
 #include <QBrush>
 #include <QFont>
+#include <QRect>
 
 #include "painter_interface.h"
+#include "shape_batch.h"
+#include "static_text_cache.h"
 
 #include <rcss/rcg/types.h>
 
+#include <vector>
+
+class QFontMetrics;
 class QPainter;
 class QPixmap;
 
@@ -50,6 +56,48 @@ class PlayerPainter
     : public PainterInterface {
 private:
 
+    /*!
+      \brief the sizes depending only on the player type and the field scale.
+     */
+    struct TypeGeometry {
+        const rcss::rcg::PlayerTypeT * player_type_;
+        int body_radius_; //!< pixel body radius
+        int kick_radius_; //!< pixel kick area radius
+        int draw_radius_; //!< pixel main draw radius.
+        double kickable_area_; //!< real kickable distance
+        double max_kick_power_; //!< max_power * kick_power_rate
+        int catchable_radius_; //!< pixel catchable area radius
+        int max_catchable_radius_; //!< pixel catchable area radius with the max stretch
+        int min_catchable_radius_; //!< pixel catchable area radius with the min stretch
+    };
+
+    /*!
+      \brief the sizes shared by all players, and the sizes of each player type.
+     */
+    struct Geometry {
+        double field_scale_; //!< the field scale used to compute the sizes
+        double player_size_; //!< the player size option used to compute the sizes
+        std::size_t param_revision_; //!< the parameter revision used to compute the sizes
+
+        int visible_radius_; //!< pixel visible distance
+        int unum_far_radius_; //!< pixel radius of the large view area
+        int team_far_radius_; //!< pixel radius of the large view area
+        int team_toofar_radius_; //!< pixel radius of the large view area
+        double tackle_area_; //!< real radius of the circle containing the tackle area
+        QRect tackle_rect_; //!< pixel tackle area relative to the player
+        int ball_speed_max_radius_; //!< pixel ball_speed_max
+        int ball_accel_max_radius_; //!< pixel ball_accel_max
+
+        TypeGeometry default_type_; //!< used for the unknown player type id
+        std::vector< TypeGeometry > types_; //!< index: player type id
+
+        Geometry()
+            : field_scale_( -1.0 ),
+              player_size_( -1.0 ),
+              param_revision_( 0 )
+          { }
+    };
+
     struct Param {
         int x_; //!< screen X coordinates
         int y_; //!< screen Y coordinates
@@ -60,11 +108,11 @@ private:
         const rcss::rcg::PlayerT & player_;
         const rcss::rcg::BallT & ball_;
         const rcss::rcg::PlayerTypeT & player_type_;
+        const TypeGeometry & geom_;
 
         Param( const rcss::rcg::PlayerT & player,
                const rcss::rcg::BallT & ball,
-               const rcss::rcg::ServerParamT & sparam,
-               const rcss::rcg::PlayerTypeT & ptype );
+               const TypeGeometry & geom );
     private:
         //! not used
         Param() = delete;
@@ -73,6 +121,18 @@ private:
 
     const DispHolder & M_disp_holder;
 
+    //! the cached sizes, updated when the parameters or the field scale are changed
+    mutable Geometry M_geometry;
+
+    //! the laid out parts of the player labels
+    mutable StaticTextCache M_label_cache;
+
+    //! the renderer of the batched shapes. if null, all shapes are drawn by QPainter.
+    ShapeRenderer * M_shape_renderer;
+
+    //! the body and area shapes of all players in the current frame
+    ShapeBatch M_shape_batch;
+
     // not used
     PlayerPainter() = delete;
     PlayerPainter( const PlayerPainter & ) = delete;
@@ -85,12 +145,41 @@ public:
     ~PlayerPainter();
 
     void draw( QPainter & dc ) override;
+    bool addFrameRegion( QRegion & region ) const override;
+
+    /*!
+      \brief set the renderer used to draw the bodies, the view areas and the catch areas at once.
+      \param renderer the renderer owned by the caller, or null to draw them by QPainter.
+     */
+    void setShapeRenderer( ShapeRenderer * renderer )
+      {
+          M_shape_renderer = renderer;
+      }
 
 private:
 
+    void updateGeometry() const;
+    TypeGeometry createTypeGeometry( const rcss::rcg::PlayerTypeT & ptype ) const;
+    const TypeGeometry & typeGeometry( const int type ) const;
+
+    void addPlayerRegion( QRegion & region,
+                          const QFontMetrics & fm,
+                          const rcss::rcg::PlayerT & player,
+                          const rcss::rcg::BallT & ball ) const;
+
+    void addShapes( ShapeBatch & batch,
+                    const rcss::rcg::PlayerT & player,
+                    const rcss::rcg::BallT & ball ) const;
+
     void drawAll( QPainter & painter,
                   const rcss::rcg::PlayerT & player,
-                  const rcss::rcg::BallT & ball ) const;
+                  const rcss::rcg::BallT & ball,
+                  const bool draw_shapes ) const;
+    void decideBodyStyle( const PlayerPainter::Param & param,
+                          QPen * pen,
+                          QBrush * brush ) const;
+    QBrush staminaBrush( const PlayerPainter::Param & param,
+                         const QBrush & body_brush ) const;
     void drawBody( QPainter & painter,
                    const PlayerPainter::Param & param ) const;
     void drawDir( QPainter & painter,
@@ -109,6 +198,8 @@ private:
                             const PlayerPainter::Param & param ) const;
     void drawText( QPainter & painter,
                    const PlayerPainter::Param & param ) const;
+    int createLabel( const PlayerPainter::Param & param,
+                     QString * parts ) const;
 
     void drawOffsideLine( QPainter & painter,
                           const rcss::rcg::ShowInfoT & show ) const;
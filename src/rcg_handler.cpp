@@ -41,13 +41,6 @@
 
 #include <iostream>
 
-#include <QtGlobal>
-#if (QT_VERSION >= QT_VERSION_CHECK(5, 0, 0))
-#include <QtWidgets>
-#else
-#include <QtGui>
-#endif
-
 #ifdef HAVE_ARPA_INET_H
 #include <arpa/inet.h>
 #endif
@@ -56,32 +49,16 @@
 #endif
 
 /*-------------------------------------------------------------------*/
-RCGHandler::RCGHandler( QWidget * parent,
-                        DispHolder & holder )
-    : M_holder( holder ),
-      M_progress( nullptr )
-
+RCGHandler::RCGHandler( DispHolder & holder )
+    : M_holder( holder )
 {
-    if ( parent )
-    {
-        M_progress = new QProgressDialog( parent );
-        M_progress->setWindowTitle( QObject::tr( "parsing a game log file..." ) );
-        M_progress->setRange( 0, 6000 );
-        M_progress->setValue( 0 );
-        M_progress->setLabelText( QObject::tr( "Time: 0" ) );
-        M_progress->setCancelButton( 0 ); // no cancel button
-        M_progress->setMinimumDuration( 0 ); // no duration
-    }
+
 }
 
 /*-------------------------------------------------------------------*/
 RCGHandler::~RCGHandler()
 {
-    if ( M_progress )
-    {
-        delete M_progress;
-        M_progress = nullptr;
-    }
+
 }
 
 /*-------------------------------------------------------------------*/
@@ -95,30 +72,6 @@ RCGHandler::handleEOF()
 bool
 RCGHandler::handleShow( const rcss::rcg::ShowInfoT & show )
 {
-    if ( M_progress )
-    {
-        if ( show.time_ % 32 == 1 )
-        {
-            if ( ! M_holder.dispCont().empty() )
-            {
-                int time = M_holder.dispCont().back()->show_.time_;
-                if ( time > M_progress->maximum() )
-                {
-                    M_progress->setMaximum( M_progress->maximum() + 6000 );
-                }
-                M_progress->setValue( time );
-                M_progress->setLabelText( QString( "Time: %1" ).arg( time ) );
-            }
-        }
-
-        if ( show.time_ % 512 == 1 )
-        {
-            qApp->processEvents();
-            std::fprintf( stdout, "parsing... %d\r", show.time_ );
-            std::fflush( stdout );
-        }
-    }
-
     return M_holder.handleShow( show );
 }
 
@@ -160,24 +113,24 @@ RCGHandler::handleDraw( const int time,
 
     case rcss::rcg::DrawPoint:
         M_holder.handleDrawPoint( time,
-                                  rcss::rcg::PointT( rcss::rcg::nstohf( draw.object.pinfo.x ),
-                                                     rcss::rcg::nstohf( draw.object.pinfo.y ),
-                                                     draw.object.pinfo.color ) );
+                                  rcss::rcg::nstohf( draw.object.pinfo.x ),
+                                  rcss::rcg::nstohf( draw.object.pinfo.y ),
+                                  draw.object.pinfo.color );
         return true;
     case rcss::rcg::DrawCircle:
         M_holder.handleDrawCircle( time,
-                                   rcss::rcg::CircleT( rcss::rcg::nstohf( draw.object.cinfo.x ),
-                                                       rcss::rcg::nstohf( draw.object.cinfo.y ),
-                                                       rcss::rcg::nstohf( draw.object.cinfo.r ),
-                                                       draw.object.cinfo.color ) );
+                                   rcss::rcg::nstohf( draw.object.cinfo.x ),
+                                   rcss::rcg::nstohf( draw.object.cinfo.y ),
+                                   rcss::rcg::nstohf( draw.object.cinfo.r ),
+                                   draw.object.cinfo.color );
         return true;
     case rcss::rcg::DrawLine:
         M_holder.handleDrawLine( time,
-                                 rcss::rcg::LineT( rcss::rcg::nstohf( draw.object.linfo.x1 ),
-                                                   rcss::rcg::nstohf( draw.object.linfo.y1 ),
-                                                   rcss::rcg::nstohf( draw.object.linfo.x2 ),
-                                                   rcss::rcg::nstohf( draw.object.linfo.y2 ),
-                                                   draw.object.linfo.color ) );
+                                 rcss::rcg::nstohf( draw.object.linfo.x1 ),
+                                 rcss::rcg::nstohf( draw.object.linfo.y1 ),
+                                 rcss::rcg::nstohf( draw.object.linfo.x2 ),
+                                 rcss::rcg::nstohf( draw.object.linfo.y2 ),
+                                 draw.object.linfo.color );
         return true;
     default:
         std::cerr << "(RCGHandler::handleDraw) Unknown draw mode " << ntohs( draw.mode )
@@ -36,8 +36,6 @@
 #include <rcss/rcg/types.h>
 #include <rcss/rcg/handler.h>
 
-class QWidget;
-class QProgressDialog;
 class DispHolder;
 
 class RCGHandler
@@ -46,16 +44,14 @@ private:
 
     DispHolder & M_holder;
 
-    QProgressDialog * M_progress;
-
     // not used
     RCGHandler( const RCGHandler & ) = delete;
     RCGHandler operator=( const RCGHandler & ) = delete;
 
 public:
 
-    RCGHandler( QWidget * parent,
-                DispHolder & holder );
+    explicit
+    RCGHandler( DispHolder & holder );
     ~RCGHandler();
 
 protected:
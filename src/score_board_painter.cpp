@@ -49,12 +49,20 @@
 
 #include <iostream>
 
+namespace {
+
+//! the number of the cached texts. the time part is cached for the backward replay.
+const int TEXT_CACHE_SIZE = 256;
+
+}
+
 /*-------------------------------------------------------------------*/
 /*!
 
 */
 ScoreBoardPainter::ScoreBoardPainter( const DispHolder & disp_holder )
-    : M_disp_holder( disp_holder )
+    : M_disp_holder( disp_holder ),
+      M_text_cache( TEXT_CACHE_SIZE )
 {
     //M_font.setBold( true );
     //M_font.setStyleHint( QFont::System, QFont::PreferBitmap );
@@ -138,19 +146,22 @@ ScoreBoardPainter::draw( QPainter & painter )
     }
 
 
+    // the time is laid out separately, because it changes every cycle.
     QString main_buf;
+    QString time_buf;
 
     if ( ! show_pen_score )
     {
         char buf[256];
-        std::snprintf( buf, sizeof( buf ), " %10s %d:%d %-10s %19s %6d    ",
+        std::snprintf( buf, sizeof( buf ), " %10s %d:%d %-10s %19s",
                        all_name_l.c_str(),
                        team_l.score_,
                        team_r.score_,
                        all_name_r.c_str(),
-                       s_playmode_strings[pmode].c_str(),
-                       current_time );
+                       s_playmode_strings[pmode].c_str() );
         main_buf = QString::fromLatin1( buf );
+        std::snprintf( buf, sizeof( buf ), " %6d    ", current_time );
+        time_buf = QString::fromLatin1( buf );
     }
     else
     {
@@ -194,31 +205,59 @@ ScoreBoardPainter::draw( QPainter & painter )
         }
 
         char buf[256];
-        std::snprintf( buf, sizeof( buf ), " %10s %d:%d |%-5s:%-5s| %-10s %19s %6d",
+        std::snprintf( buf, sizeof( buf ), " %10s %d:%d |%-5s:%-5s| %-10s %19s",
                        all_name_l.c_str(),
                        team_l.score_, team_r.score_,
                        left_penalty.c_str(),
                        right_penalty.c_str(),
                        all_name_r.c_str(),
-                       s_playmode_strings[pmode].c_str(),
-                       current_time );
+                       s_playmode_strings[pmode].c_str() );
         main_buf = QString::fromLatin1( buf );
+        std::snprintf( buf, sizeof( buf ), " %6d", current_time );
+        time_buf = QString::fromLatin1( buf );
     }
 
     painter.setFont( opt.scoreBoardFont() );
-    QRect bounding_rect = painter.fontMetrics().boundingRect( main_buf );
+    const QFontMetrics fm = painter.fontMetrics();
+
+    const qreal main_width = M_text_cache.width( main_buf, opt.scoreBoardFont() );
+    const qreal time_width = M_text_cache.width( time_buf, opt.scoreBoardFont() );
 
     QRect rect;
     rect.setLeft( 0 );
-    rect.setTop( painter.window().bottom() - bounding_rect.height() + 1 );
-    rect.setWidth( bounding_rect.width() );
-    rect.setHeight( bounding_rect.height() );
+    rect.setTop( painter.window().bottom() - fm.height() + 1 );
+    rect.setWidth( qCeil( main_width + time_width ) );
+    rect.setHeight( fm.height() );
 
     painter.fillRect( rect, opt.scoreBoardBrush() );
 
     painter.setPen( opt.scoreBoardPen() );
     painter.setBrush( Qt::NoBrush );
-    painter.drawText( rect,
-                      Qt::AlignVCenter,
-                      main_buf );
+
+    const int baseline = rect.top() + fm.ascent();
+    M_text_cache.draw( painter, 0, baseline, main_buf );
+    M_text_cache.draw( painter, main_width, baseline, time_buf );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+*/
+bool
+ScoreBoardPainter::addFrameRegion( QRegion & region ) const
+{
+    const Options & opt = Options::instance();
+
+    if ( ! opt.showScoreBoard()
+         || ! M_disp_holder.currentDisp() )
+    {
+        return true;
+    }
+
+    // the text width changes with the data. the whole strip is used.
+    const int height = QFontMetrics( opt.scoreBoardFont() ).height();
+
+    region += QRect( 0, opt.canvasHeight() - height,
+                     opt.canvasWidth(), height );
+    return true;
 }
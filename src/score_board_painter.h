@@ -34,6 +34,7 @@
 #define RCSSMONITOR_SCORE_BOARD_PAINTER_H
 
 #include "painter_interface.h"
+#include "static_text_cache.h"
 
 #include <QPen>
 #include <QBrush>
@@ -47,6 +48,9 @@ private:
 
     const DispHolder & M_disp_holder;
 
+    //! the laid out parts of the score board text
+    StaticTextCache M_text_cache;
+
     // not used
     ScoreBoardPainter() = delete;
     ScoreBoardPainter( const ScoreBoardPainter & ) = delete;
@@ -58,6 +62,7 @@ public:
     ~ScoreBoardPainter();
 
     void draw( QPainter & painter ) override;
+    bool addFrameRegion( QRegion & region ) const override;
 
 };
 
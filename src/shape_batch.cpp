@@ -0,0 +1,196 @@
+// -*-c++-*-
+
+/*!
+  \file shape_batch.cpp
+  \brief batched circle and arc shapes Source File.
+*/
+
+/*
+ *Copyright:
+
+ Copyright (C) The RoboCup Soccer Server Maintenance Group.
+ Hidehisa AKIYAMA
+
+ This code is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 3, or (at your option)
+ any later version.
+
+ This code is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this code; see the file COPYING.  If not, write to
+ the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+
+ *EndCopyright:
+ */
+
+/////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <QBrush>
+#include <QPen>
+#include <QPointF>
+
+#include "shape_batch.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifndef M_PI
+//! PI value macro
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+
+const double DEG2RAD = M_PI / 180.0;
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief set the rgba values of the color. the transparent color is used if invisible.
+ */
+void
+set_color( float * rgba,
+           const QColor & color,
+           const bool visible )
+{
+    rgba[0] = static_cast< float >( color.redF() );
+    rgba[1] = static_cast< float >( color.greenF() );
+    rgba[2] = static_cast< float >( color.blueF() );
+    rgba[3] = ( visible ? static_cast< float >( color.alphaF() ) : 0.0f );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief set the line width and the dot pattern of the pen.
+ */
+void
+set_pen( ShapeBatch::Shape & shape,
+         const QPen & pen )
+{
+    // the cosmetic pen (width 0) is drawn as 1 pixel.
+    const double width = std::max( 1.0, pen.widthF() );
+
+    shape.geom_[3] = static_cast< float >( width );
+    // Qt::DotLine is a dot and a gap of twice the width.
+    shape.arc_[3] = ( pen.style() == Qt::DotLine
+                      ? static_cast< float >( width * 3.0 )
+                      : 0.0f );
+    set_color( shape.line_, pen.color(), pen.style() != Qt::NoPen );
+}
+
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+ShapeBatch::addCircle( const QPointF & center,
+                       const double radius,
+                       const QPen & pen,
+                       const QBrush & brush )
+{
+    Shape shape;
+    shape.geom_[0] = static_cast< float >( center.x() );
+    shape.geom_[1] = static_cast< float >( center.y() );
+    shape.geom_[2] = static_cast< float >( radius );
+    shape.arc_[0] = 0.0f;
+    shape.arc_[1] = static_cast< float >( 2.0 * M_PI );
+    shape.arc_[2] = static_cast< float >( ARC );
+    set_pen( shape, pen );
+    set_color( shape.fill_, brush.color(), brush.style() != Qt::NoBrush );
+
+    M_shapes.push_back( shape );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+ShapeBatch::addArc( const QPointF & center,
+                    const double radius,
+                    const double start_angle,
+                    const double span_angle,
+                    const QPen & pen,
+                    const bool pie )
+{
+    // the shader expects the non-negative span
+    double start = start_angle;
+    double span = span_angle;
+    if ( span < 0.0 )
+    {
+        start += span;
+        span = -span;
+    }
+    start = std::fmod( start, 360.0 );
+    if ( start < 0.0 ) start += 360.0;
+
+    Shape shape;
+    shape.geom_[0] = static_cast< float >( center.x() );
+    shape.geom_[1] = static_cast< float >( center.y() );
+    shape.geom_[2] = static_cast< float >( radius );
+    shape.arc_[0] = static_cast< float >( start * DEG2RAD );
+    shape.arc_[1] = static_cast< float >( std::min( span, 360.0 ) * DEG2RAD );
+    shape.arc_[2] = static_cast< float >( pie ? PIE : ARC );
+    set_pen( shape, pen );
+    set_color( shape.fill_, QColor(), false );
+
+    M_shapes.push_back( shape );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+ShapeBatch::addLine( const QPointF & p1,
+                     const QPointF & p2,
+                     const QPen & pen )
+{
+    const double dx = p2.x() - p1.x();
+    const double dy = p2.y() - p1.y();
+
+    Shape shape;
+    shape.geom_[0] = static_cast< float >( ( p1.x() + p2.x() ) * 0.5 );
+    shape.geom_[1] = static_cast< float >( ( p1.y() + p2.y() ) * 0.5 );
+    shape.geom_[2] = static_cast< float >( std::sqrt( dx * dx + dy * dy ) * 0.5 );
+    // the screen y axis points down.
+    shape.arc_[0] = static_cast< float >( std::atan2( -dy, dx ) );
+    shape.arc_[1] = 0.0f;
+    shape.arc_[2] = static_cast< float >( LINE );
+    set_pen( shape, pen );
+    set_color( shape.fill_, QColor(), false );
+
+    M_shapes.push_back( shape );
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+void
+ShapeBatch::addRect( const QPointF & center,
+                     const double half_size,
+                     const QPen & pen )
+{
+    Shape shape;
+    shape.geom_[0] = static_cast< float >( center.x() );
+    shape.geom_[1] = static_cast< float >( center.y() );
+    shape.geom_[2] = static_cast< float >( half_size );
+    shape.arc_[0] = 0.0f;
+    shape.arc_[1] = 0.0f;
+    shape.arc_[2] = static_cast< float >( RECT );
+    set_pen( shape, pen );
+    set_color( shape.fill_, QColor(), false );
+
+    M_shapes.push_back( shape );
+}
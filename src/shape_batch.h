@@ -0,0 +1,171 @@
+// -*-c++-*-
+
+/*!
+  \file shape_batch.h
+  \brief batched circle and arc shapes Header File.
+*/
+
+/*
+ *Copyright:
+
+ Copyright (C) The RoboCup Soccer Server Maintenance Group.
+ Hidehisa AKIYAMA
+
+ This code is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 3, or (at your option)
+ any later version.
+
+ This code is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this code; see the file COPYING.  If not, write to
+ the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+
+ *EndCopyright:
+ */
+
+/////////////////////////////////////////////////////////////////////
+
+#ifndef RCSSMONITOR_SHAPE_BATCH_H
+#define RCSSMONITOR_SHAPE_BATCH_H
+
+#include <vector>
+
+class QBrush;
+class QPainter;
+class QPen;
+class QPointF;
+
+/*!
+  \class ShapeBatch
+  \brief the circles, the arcs, the lines and the rectangle outlines of
+  one frame, drawn together by ShapeRenderer.
+
+  The angles follow QPainter::drawArc(), i.e., degrees counter-clockwise
+  from the 3 o'clock position on the screen.
+*/
+class ShapeBatch {
+public:
+
+    //! the type of the shape, stored in Shape::arc_[2]
+    enum Kind {
+        ARC = 0, //!< the circle or the arc
+        PIE = 1, //!< the arc with the radial lines
+        LINE = 2, //!< the line segment. the radius is the half length, and the start angle is the direction.
+        RECT = 3, //!< the outline of the square. the radius is the half size.
+    };
+
+    /*!
+      \brief one shape instance. the layout is used as the vertex attributes.
+     */
+    struct Shape {
+        float geom_[4]; //!< center x, center y, radius, line width (screen coordinates)
+        float arc_[4]; //!< start angle, span angle (radian), Kind, dot period
+        float fill_[4]; //!< fill color (rgba), only for the full circle
+        float line_[4]; //!< line color (rgba)
+    };
+
+private:
+
+    std::vector< Shape > M_shapes;
+
+public:
+
+    void clear()
+      {
+          M_shapes.clear();
+      }
+
+    bool empty() const
+      {
+          return M_shapes.empty();
+      }
+
+    const std::vector< Shape > & shapes() const
+      {
+          return M_shapes;
+      }
+
+    /*!
+      \brief add the circle drawn in the same way as QPainter::drawEllipse()
+      \param center screen coordinates of the center
+      \param radius screen radius
+      \param pen the outline pen
+      \param brush the fill brush
+     */
+    void addCircle( const QPointF & center,
+                    const double radius,
+                    const QPen & pen,
+                    const QBrush & brush );
+
+    /*!
+      \brief add the arc drawn in the same way as QPainter::drawArc() or drawPie()
+      \param center screen coordinates of the center
+      \param radius screen radius
+      \param start_angle start angle in degree
+      \param span_angle span angle in degree
+      \param pen the line pen
+      \param pie if true, the lines from the center to the arc ends are also drawn.
+     */
+    void addArc( const QPointF & center,
+                 const double radius,
+                 const double start_angle,
+                 const double span_angle,
+                 const QPen & pen,
+                 const bool pie );
+
+    /*!
+      \brief add the line drawn in the same way as QPainter::drawLine()
+      \param p1 screen coordinates of the first point
+      \param p2 screen coordinates of the second point
+      \param pen the line pen
+     */
+    void addLine( const QPointF & p1,
+                  const QPointF & p2,
+                  const QPen & pen );
+
+    /*!
+      \brief add the outline of the square drawn in the same way as QPainter::drawRect()
+      \param center screen coordinates of the center
+      \param half_size half of the side length
+      \param pen the outline pen
+     */
+    void addRect( const QPointF & center,
+                  const double half_size,
+                  const QPen & pen );
+
+};
+
+/*!
+  \class ShapeRenderer
+  \brief the interface of the renderer drawing ShapeBatch at once.
+*/
+class ShapeRenderer {
+public:
+
+    virtual
+    ~ShapeRenderer()
+      { }
+
+    /*!
+      \brief check if the shapes can be drawn by this renderer.
+      \return false if the painters have to draw the shapes by QPainter.
+     */
+    virtual
+    bool isAvailable() const = 0;
+
+    /*!
+      \brief draw all shapes inside the clip region of the painter.
+      \param painter the painter on the render target
+      \param batch the shapes
+     */
+    virtual
+    void render( QPainter & painter,
+                 const ShapeBatch & batch ) = 0;
+};
+
+#endif
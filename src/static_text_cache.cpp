@@ -0,0 +1,114 @@
+// -*-c++-*-
+
+/*!
+  \file static_text_cache.cpp
+  \brief cached text layout Source File.
+*/
+
+/*
+ *Copyright:
+
+ Copyright (C) The RoboCup Soccer Server Maintenance Group.
+ Hidehisa AKIYAMA
+
+ This code is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 3, or (at your option)
+ any later version.
+
+ This code is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this code; see the file COPYING.	If not, write to
+ the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+
+ *EndCopyright:
+ */
+
+/////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <QFontMetrics>
+#include <QPainter>
+#include <QTransform>
+
+#include "static_text_cache.h"
+
+#include <algorithm>
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+StaticTextCache::StaticTextCache( const int max_count )
+    : M_ascent( 0 ),
+      M_texts( std::max( 1, max_count ) )
+{
+
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+const StaticTextCache::Entry &
+StaticTextCache::find( const QString & text,
+                       const QFont & font )
+{
+    if ( ! ( font == M_font ) )
+    {
+        M_texts.clear();
+        M_font = font;
+        M_ascent = QFontMetrics( font ).ascent();
+    }
+
+    Entry * entry = M_texts.object( text );
+    if ( entry )
+    {
+        return *entry;
+    }
+
+    entry = new Entry();
+    entry->text_.setTextFormat( Qt::PlainText );
+    entry->text_.setText( text );
+    entry->text_.prepare( QTransform(), font );
+    entry->width_ = entry->text_.size().width();
+
+    // the entry is owned by the cache, and is valid until the next insertion.
+    M_texts.insert( text, entry );
+    return *entry;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+qreal
+StaticTextCache::draw( QPainter & painter,
+                       const qreal x,
+                       const int y,
+                       const QString & text )
+{
+    const Entry & entry = find( text, painter.font() );
+
+    // drawStaticText() takes the top left corner, not the baseline.
+    painter.drawStaticText( QPointF( x, y - M_ascent ), entry.text_ );
+    return entry.width_;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+qreal
+StaticTextCache::width( const QString & text,
+                        const QFont & font )
+{
+    return find( text, font ).width_;
+}
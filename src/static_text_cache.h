@@ -0,0 +1,113 @@
+// -*-c++-*-
+
+/*!
+  \file static_text_cache.h
+  \brief cached text layout Header File.
+*/
+
+/*
+ *Copyright:
+
+ Copyright (C) The RoboCup Soccer Server Maintenance Group.
+ Hidehisa AKIYAMA
+
+ This code is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 3, or (at your option)
+ any later version.
+
+ This code is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this code; see the file COPYING.	If not, write to
+ the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+
+ *EndCopyright:
+ */
+
+/////////////////////////////////////////////////////////////////////
+
+#ifndef RCSSMONITOR_STATIC_TEXT_CACHE_H
+#define RCSSMONITOR_STATIC_TEXT_CACHE_H
+
+#include <QCache>
+#include <QFont>
+#include <QStaticText>
+#include <QString>
+
+class QPainter;
+
+/*!
+  \class StaticTextCache
+  \brief the laid out texts keyed on the text and the font.
+
+  QPainter::drawText() shapes the text every time it is called.
+  The painters split the labels into the parts changing independently
+  (e.g. the uniform number and the stamina), and draw each part by
+  QPainter::drawStaticText() with the laid out text in this cache.
+  The parts are advanced by their unrounded widths, so a label is placed
+  in the same way as the whole text except for the kerning across the
+  part boundaries.
+  The least recently used texts are removed if the number of texts
+  exceeds the limit, and all texts are removed if the font is changed.
+*/
+class StaticTextCache {
+private:
+
+    struct Entry {
+        QStaticText text_;
+        qreal width_; //!< width of the laid out text
+    };
+
+    QFont M_font;
+    int M_ascent; //!< ascent of M_font
+
+    QCache< QString, Entry > M_texts;
+
+    // not used
+    StaticTextCache() = delete;
+    StaticTextCache( const StaticTextCache & ) = delete;
+    const StaticTextCache & operator=( const StaticTextCache & ) = delete;
+
+public:
+
+    /*!
+      \brief create the empty cache.
+      \param max_count the maximum number of the cached texts
+     */
+    explicit
+    StaticTextCache( const int max_count );
+
+    /*!
+      \brief draw the text with the current font of the painter.
+      \param painter the painter
+      \param x the left x coordinate
+      \param y the baseline y coordinate, the same as QPainter::drawText()
+      \param text the text string
+      \return the unrounded width of the text, i.e., the advance to the next part
+     */
+    qreal draw( QPainter & painter,
+                const qreal x,
+                const int y,
+                const QString & text );
+
+    /*!
+      \brief get the pixel width of the text. the text is laid out if not cached.
+      \param text the text string
+      \param font the font used to draw the text
+      \return the unrounded width of the text
+     */
+    qreal width( const QString & text,
+                 const QFont & font );
+
+private:
+
+    const Entry & find( const QString & text,
+                        const QFont & font );
+
+};
+
+#endif
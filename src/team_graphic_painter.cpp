@@ -49,6 +49,7 @@
 
 #include <iostream>
 #include <cstring>
+#include <cmath>
 
 
 /*-------------------------------------------------------------------*/
@@ -250,3 +251,35 @@ TeamGraphicPainter::copyTeamGraphicXpmTile( QPixmap & dst_pixmap,
     painter.drawPixmap( x * 8, y * 8, pixmap );
     painter.end();
 }
+
+/*-------------------------------------------------------------------*/
+/*!
+
+*/
+bool
+TeamGraphicPainter::addFrameRegion( QRegion & region ) const
+{
+    const Options & opt = Options::instance();
+
+    if ( ! opt.showTeamGraphic()
+         || ! M_disp_holder.currentDisp() )
+    {
+        return true;
+    }
+
+    // the graphics may be updated by the new tiles
+    // or may be removed by the change of team names.
+    const double scale = std::max( 0.001, opt.teamGraphicScale() );
+
+    const TeamGraphic & left = M_disp_holder.teamGraphicLeft();
+    const TeamGraphic & right = M_disp_holder.teamGraphicRight();
+
+    const int left_width = static_cast< int >( std::ceil( left.width() * scale ) ) + 1;
+    const int left_height = static_cast< int >( std::ceil( left.height() * scale ) ) + 1;
+    const int right_width = static_cast< int >( std::ceil( right.width() * scale ) ) + 1;
+    const int right_height = static_cast< int >( std::ceil( right.height() * scale ) ) + 1;
+
+    region += QRect( 0, 0, left_width, left_height );
+    region += QRect( opt.canvasWidth() - right_width, 0, right_width, right_height );
+    return true;
+}
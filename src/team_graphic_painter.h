@@ -64,6 +64,7 @@ public:
     TeamGraphicPainter( const DispHolder & disp_holder );
 
     void draw( QPainter & painter ) override;
+    bool addFrameRegion( QRegion & region ) const override;
 
 private:
 
@@ -0,0 +1,225 @@
+// -*-c++-*-
+
+/*!
+  \file field_canvas_gl_test.cpp
+  \brief offscreen smoke test of the OpenGL field rendering
+*/
+
+/*
+ *Copyright:
+
+ Copyright (C) The RoboCup Soccer Server Maintenance Group.
+ Hidehisa AKIYAMA
+
+ This code is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 3, or (at your option)
+ any later version.
+
+ This code is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this code; see the file COPYING.  If not, write to
+ the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+
+ *EndCopyright:
+ */
+
+/////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <QApplication>
+#include <QImage>
+#include <QPixmap>
+
+#include "disp_holder.h"
+#include "field_canvas.h"
+#include "options.h"
+
+#include <rcss/rcg/types.h>
+
+#include <iostream>
+#include <cstdlib>
+
+/*
+  Run with QT_QPA_PLATFORM=offscreen and LIBGL_ALWAYS_SOFTWARE=1.
+  The canvas is created with "--opengl on", and one frame containing
+  all players and a draw-info line is painted. The test fails if the
+  OpenGL render target or the instanced shape renderer is not used, or
+  if the pixels inside a player disc or on the line are not painted.
+ */
+
+namespace {
+
+//! the player whose body pixel is checked. no stamina, so the whole disc has the team color.
+const int PROBE_PLAYER = 1; // left, unum 2
+
+//! the draw-info line, drawn apart from the players and the field lines.
+const float LINE_X1 = 10.0f;
+const float LINE_X2 = 30.0f;
+const float LINE_Y = -25.0f;
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief create the show data with all players standing in the field.
+ */
+rcss::rcg::ShowInfoT
+create_show()
+{
+    rcss::rcg::ShowInfoT show;
+    show.time_ = 1;
+
+    show.ball_.x_ = 0.0f;
+    show.ball_.y_ = 0.0f;
+    show.ball_.vx_ = 1.0f;
+    show.ball_.vy_ = 0.0f;
+
+    for ( int i = 0; i < rcss::rcg::MAX_PLAYER * 2; ++i )
+    {
+        rcss::rcg::PlayerT & p = show.player_[i];
+        const bool left = ( i < rcss::rcg::MAX_PLAYER );
+        const int unum = i % rcss::rcg::MAX_PLAYER + 1;
+
+        p.side_ = ( left ? 'l' : 'r' );
+        p.unum_ = static_cast< rcss::rcg::Int16 >( unum );
+        p.type_ = 0;
+        p.state_ = rcss::rcg::STAND | ( unum == 1 ? rcss::rcg::GOALIE : 0 );
+        p.x_ = ( left ? -1.0f : 1.0f ) * 4.0f * unum;
+        p.y_ = ( unum % 2 == 0 ? 10.0f : -10.0f );
+        p.body_ = ( left ? 0.0f : 180.0f );
+        p.neck_ = 0.0f;
+        p.view_width_ = 90.0f;
+        p.stamina_ = 4000.0f;
+        p.effort_ = 0.8f; // the effort ring is also drawn.
+        p.recovery_ = 1.0f;
+    }
+
+    show.player_[PROBE_PLAYER].stamina_ = rcss::rcg::SHOWINFO_SCALE2F;
+
+    return show;
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+  \brief check if two colors are the same within the blending error.
+ */
+bool
+same_color( const QColor & lhs,
+            const QColor & rhs )
+{
+    return std::abs( lhs.red() - rhs.red() ) <= 8
+        && std::abs( lhs.green() - rhs.green() ) <= 8
+        && std::abs( lhs.blue() - rhs.blue() ) <= 8;
+}
+
+}
+
+/*-------------------------------------------------------------------*/
+/*!
+
+ */
+int
+main( int argc,
+      char ** argv )
+{
+    (void)argc;
+    (void)argv;
+
+    QApplication::setAttribute( Qt::AA_ShareOpenGLContexts );
+
+    // the large player disc has enough pixels between the direction line and the edge.
+    char arg0[] = "field_canvas_gl_test";
+    char arg1[] = "--opengl";
+    char arg2[] = "on";
+    char arg3[] = "--player-size";
+    char arg4[] = "2.0";
+    char * args[] = { arg0, arg1, arg2, arg3, arg4, nullptr };
+    int nargs = 5;
+
+    QApplication app( nargs, args );
+
+    if ( ! Options::instance().parseCmdLine( nargs, args ) )
+    {
+        std::cerr << "failed to parse the options." << std::endl;
+        return 1;
+    }
+
+    DispHolder holder;
+    holder.handleServerParam( rcss::rcg::ServerParamT() );
+    holder.handlePlayerType( rcss::rcg::PlayerTypeT() );
+    const rcss::rcg::ShowInfoT show = create_show();
+    holder.handleShow( show );
+    holder.handleDrawLine( show.time_, LINE_X1, LINE_Y, LINE_X2, LINE_Y, "red" );
+    holder.setIndexLast();
+
+    FieldCanvas canvas( holder );
+    canvas.resize( 640, 480 );
+    canvas.show();
+    app.processEvents();
+
+    if ( ! canvas.isOpenGL() )
+    {
+        std::cerr << "the OpenGL render target is not created." << std::endl;
+        return 1;
+    }
+
+    canvas.updateFrame();
+    app.processEvents();
+
+    const QImage image = canvas.grab().toImage();
+    if ( image.isNull() )
+    {
+        std::cerr << "failed to grab the frame." << std::endl;
+        return 1;
+    }
+
+    if ( ! canvas.isShapeRendererAvailable() )
+    {
+        std::cerr << "the instanced shape renderer is not available." << std::endl;
+        return 1;
+    }
+
+    const Options & opt = Options::instance();
+
+    //
+    // the body disc, drawn by the instanced renderer.
+    // the pixel below the center avoids the body direction line (0 degree) and the label.
+    //
+    const rcss::rcg::PlayerT & probe = show.player_[PROBE_PLAYER];
+    const int radius = opt.scale( opt.playerSize() );
+    const QPoint body_point( opt.screenX( probe.x_ ),
+                             opt.screenY( probe.y_ ) + radius / 2 );
+    const QColor body_color = image.pixelColor( body_point );
+    if ( radius < 4
+         || ! same_color( body_color, opt.leftTeamBrush().color() ) )
+    {
+        std::cerr << "the player disc is not painted. radius=" << radius
+                  << " color=" << body_color.name().toStdString()
+                  << " expected=" << opt.leftTeamBrush().color().name().toStdString()
+                  << std::endl;
+        return 1;
+    }
+
+    //
+    // the draw-info line. the line covers the pixel row on either side of its y coordinate.
+    //
+    const int line_x = opt.screenX( ( LINE_X1 + LINE_X2 ) * 0.5f );
+    const int line_y = opt.screenY( LINE_Y );
+    const QColor grass_color = image.pixelColor( line_x, line_y - 8 );
+    if ( same_color( image.pixelColor( line_x, line_y - 1 ), grass_color )
+         && same_color( image.pixelColor( line_x, line_y ), grass_color ) )
+    {
+        std::cerr << "the draw-info line is not painted." << std::endl;
+        return 1;
+    }
+
+    std::cout << "painted " << image.width() << 'x' << image.height()
+              << " by the instanced renderer." << std::endl;
+    return 0;
+}